@@ -46,216 +46,113 @@ std::string to_string(T var) {
 }
 #endif
 
-void SetLayout(layer_data *device_data, GLOBAL_CB_NODE *pCB, ImageSubresourcePair imgpair, const VkImageLayout &layout) {
-    if (pCB->imageLayoutMap.find(imgpair) != pCB->imageLayoutMap.end()) {
-        pCB->imageLayoutMap[imgpair].layout = layout;
-    } else {
-        assert(imgpair.hasSubresource);
-        IMAGE_CMD_BUF_LAYOUT_NODE node;
-        if (!FindCmdBufLayout(device_data, pCB, imgpair.image, imgpair.subresource, node)) {
-            node.initialLayout = layout;
-        }
-        SetLayout(device_data, pCB, imgpair, {node.initialLayout, layout});
-    }
-}
-template <class OBJECT, class LAYOUT>
-void SetLayout(layer_data *device_data, OBJECT *pObject, VkImage image, VkImageSubresource range, const LAYOUT &layout) {
-    ImageSubresourcePair imgpair = {image, true, range};
-    SetLayout(device_data, pObject, imgpair, layout, VK_IMAGE_ASPECT_COLOR_BIT);
-    SetLayout(device_data, pObject, imgpair, layout, VK_IMAGE_ASPECT_DEPTH_BIT);
-    SetLayout(device_data, pObject, imgpair, layout, VK_IMAGE_ASPECT_STENCIL_BIT);
-    SetLayout(device_data, pObject, imgpair, layout, VK_IMAGE_ASPECT_METADATA_BIT);
-}
-
-template <class OBJECT, class LAYOUT>
-void SetLayout(layer_data *device_data, OBJECT *pObject, ImageSubresourcePair imgpair, const LAYOUT &layout,
-               VkImageAspectFlags aspectMask) {
-    if (imgpair.subresource.aspectMask & aspectMask) {
-        imgpair.subresource.aspectMask = aspectMask;
-        SetLayout(device_data, pObject, imgpair, layout);
+// Get the layout map pCB keeps for image, creating an empty one on first use. Callers go on to change layouts in it.
+static IMAGE_CMD_BUF_LAYOUT_MAP &GetCmdBufLayoutMap(GLOBAL_CB_NODE *pCB, VkImage image, const ImageSubresourceEncoder &encoder) {
+    ++pCB->draw_state_generation;
+    auto layout_map = pCB->imageLayoutMap.find(image);
+    if (layout_map == pCB->imageLayoutMap.end()) {
+        layout_map = pCB->imageLayoutMap.emplace(image, IMAGE_CMD_BUF_LAYOUT_MAP(encoder)).first;
     }
+    return layout_map->second;
 }
 
-// Set the layout in supplied map
-void SetLayout(std::unordered_map<ImageSubresourcePair, IMAGE_LAYOUT_NODE> &imageLayoutMap, ImageSubresourcePair imgpair,
-               VkImageLayout layout) {
-    imageLayoutMap[imgpair].layout = layout;
-}
-
-bool FindLayoutVerifyNode(layer_data const *device_data, GLOBAL_CB_NODE const *pCB, ImageSubresourcePair imgpair,
-                          IMAGE_CMD_BUF_LAYOUT_NODE &node, const VkImageAspectFlags aspectMask) {
-    const debug_report_data *report_data = core_validation::GetReportData(device_data);
-
-    if (!(imgpair.subresource.aspectMask & aspectMask)) {
-        return false;
-    }
-    VkImageAspectFlags oldAspectMask = imgpair.subresource.aspectMask;
-    imgpair.subresource.aspectMask = aspectMask;
-    auto imgsubIt = pCB->imageLayoutMap.find(imgpair);
-    if (imgsubIt == pCB->imageLayoutMap.end()) {
-        return false;
-    }
-    if (node.layout != VK_IMAGE_LAYOUT_MAX_ENUM && node.layout != imgsubIt->second.layout) {
-        log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, HandleToUint64(imgpair.image),
-                __LINE__, DRAWSTATE_INVALID_LAYOUT, "DS",
-                "Cannot query for VkImage 0x%" PRIx64 " layout when combined aspect mask %d has multiple layout types: %s and %s",
-                HandleToUint64(imgpair.image), oldAspectMask, string_VkImageLayout(node.layout),
-                string_VkImageLayout(imgsubIt->second.layout));
-    }
-    if (node.initialLayout != VK_IMAGE_LAYOUT_MAX_ENUM && node.initialLayout != imgsubIt->second.initialLayout) {
-        log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, HandleToUint64(imgpair.image),
-                __LINE__, DRAWSTATE_INVALID_LAYOUT, "DS",
-                "Cannot query for VkImage 0x%" PRIx64
-                " layout when combined aspect mask %d has multiple initial layout types: %s and %s",
-                HandleToUint64(imgpair.image), oldAspectMask, string_VkImageLayout(node.initialLayout),
-                string_VkImageLayout(imgsubIt->second.initialLayout));
-    }
-    node = imgsubIt->second;
-    return true;
-}
-
-bool FindLayoutVerifyLayout(layer_data const *device_data, ImageSubresourcePair imgpair, VkImageLayout &layout,
-                            const VkImageAspectFlags aspectMask) {
-    if (!(imgpair.subresource.aspectMask & aspectMask)) {
-        return false;
-    }
-    const debug_report_data *report_data = core_validation::GetReportData(device_data);
-    VkImageAspectFlags oldAspectMask = imgpair.subresource.aspectMask;
-    imgpair.subresource.aspectMask = aspectMask;
-    auto imgsubIt = (*core_validation::GetImageLayoutMap(device_data)).find(imgpair);
-    if (imgsubIt == (*core_validation::GetImageLayoutMap(device_data)).end()) {
-        return false;
-    }
-    if (layout != VK_IMAGE_LAYOUT_MAX_ENUM && layout != imgsubIt->second.layout) {
-        log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, HandleToUint64(imgpair.image),
-                __LINE__, DRAWSTATE_INVALID_LAYOUT, "DS",
-                "Cannot query for VkImage 0x%" PRIx64 " layout when combined aspect mask %d has multiple layout types: %s and %s",
-                HandleToUint64(imgpair.image), oldAspectMask, string_VkImageLayout(layout),
-                string_VkImageLayout(imgsubIt->second.layout));
-    }
-    layout = imgsubIt->second.layout;
-    return true;
+// Set the layout on the cmdbuf level for every subresource in range. Subresources this command buffer has not touched
+// before also take layout as their initial layout.
+void SetLayout(layer_data *device_data, GLOBAL_CB_NODE *pCB, const IMAGE_STATE *image_state, const VkImageSubresourceRange &range,
+               const VkImageLayout &layout) {
+    auto &layout_map = GetCmdBufLayoutMap(pCB, image_state->image, image_state->subresource_encoder);
+    layout_map.encoder.ForEachRun(range, [&layout_map, layout](uint64_t begin, uint64_t end) {
+        layout_map.layouts.update(begin, end, [layout](const IMAGE_CMD_BUF_LAYOUT_NODE *node) {
+            return IMAGE_CMD_BUF_LAYOUT_NODE(node ? node->initialLayout : layout, layout);
+        });
+    });
 }
 
 // Find layout(s) on the command buffer level
 bool FindCmdBufLayout(layer_data const *device_data, GLOBAL_CB_NODE const *pCB, VkImage image, VkImageSubresource range,
                       IMAGE_CMD_BUF_LAYOUT_NODE &node) {
-    ImageSubresourcePair imgpair = {image, true, range};
     node = IMAGE_CMD_BUF_LAYOUT_NODE(VK_IMAGE_LAYOUT_MAX_ENUM, VK_IMAGE_LAYOUT_MAX_ENUM);
-    FindLayoutVerifyNode(device_data, pCB, imgpair, node, VK_IMAGE_ASPECT_COLOR_BIT);
-    FindLayoutVerifyNode(device_data, pCB, imgpair, node, VK_IMAGE_ASPECT_DEPTH_BIT);
-    FindLayoutVerifyNode(device_data, pCB, imgpair, node, VK_IMAGE_ASPECT_STENCIL_BIT);
-    FindLayoutVerifyNode(device_data, pCB, imgpair, node, VK_IMAGE_ASPECT_METADATA_BIT);
-    if (node.layout == VK_IMAGE_LAYOUT_MAX_ENUM) {
-        imgpair = {image, false, VkImageSubresource()};
-        auto imgsubIt = pCB->imageLayoutMap.find(imgpair);
-        if (imgsubIt == pCB->imageLayoutMap.end()) return false;
-        // TODO: This is ostensibly a find function but it changes state here
-        node = imgsubIt->second;
-    }
-    return true;
-}
+    auto layout_map = pCB->imageLayoutMap.find(image);
+    if (layout_map == pCB->imageLayoutMap.end()) return false;
+    const debug_report_data *report_data = core_validation::GetReportData(device_data);
 
-// Find layout(s) on the global level
-bool FindGlobalLayout(layer_data *device_data, ImageSubresourcePair imgpair, VkImageLayout &layout) {
-    layout = VK_IMAGE_LAYOUT_MAX_ENUM;
-    FindLayoutVerifyLayout(device_data, imgpair, layout, VK_IMAGE_ASPECT_COLOR_BIT);
-    FindLayoutVerifyLayout(device_data, imgpair, layout, VK_IMAGE_ASPECT_DEPTH_BIT);
-    FindLayoutVerifyLayout(device_data, imgpair, layout, VK_IMAGE_ASPECT_STENCIL_BIT);
-    FindLayoutVerifyLayout(device_data, imgpair, layout, VK_IMAGE_ASPECT_METADATA_BIT);
-    if (layout == VK_IMAGE_LAYOUT_MAX_ENUM) {
-        imgpair = {imgpair.image, false, VkImageSubresource()};
-        auto imgsubIt = (*core_validation::GetImageLayoutMap(device_data)).find(imgpair);
-        if (imgsubIt == (*core_validation::GetImageLayoutMap(device_data)).end()) return false;
-        layout = imgsubIt->second.layout;
+    for (uint32_t aspect_index = 0; aspect_index < ImageSubresourceEncoder::kAspectCount; ++aspect_index) {
+        const VkImageAspectFlags aspect = 1u << aspect_index;
+        if (!(range.aspectMask & aspect)) continue;
+        uint64_t index;
+        if (!layout_map->second.encoder.Encode({aspect, range.mipLevel, range.arrayLayer}, &index)) continue;
+        const IMAGE_CMD_BUF_LAYOUT_NODE *found = layout_map->second.layouts.find(index);
+        if (!found) continue;
+        if (node.layout != VK_IMAGE_LAYOUT_MAX_ENUM && node.layout != found->layout) {
+            log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, HandleToUint64(image),
+                    __LINE__, DRAWSTATE_INVALID_LAYOUT, "DS",
+                    "Cannot query for VkImage 0x%" PRIx64 " layout when combined aspect mask %d has multiple layout types: %s and %s",
+                    HandleToUint64(image), range.aspectMask, string_VkImageLayout(node.layout),
+                    string_VkImageLayout(found->layout));
+        }
+        if (node.initialLayout != VK_IMAGE_LAYOUT_MAX_ENUM && node.initialLayout != found->initialLayout) {
+            log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, HandleToUint64(image),
+                    __LINE__, DRAWSTATE_INVALID_LAYOUT, "DS",
+                    "Cannot query for VkImage 0x%" PRIx64
+                    " layout when combined aspect mask %d has multiple initial layout types: %s and %s",
+                    HandleToUint64(image), range.aspectMask, string_VkImageLayout(node.initialLayout),
+                    string_VkImageLayout(found->initialLayout));
+        }
+        node = *found;
     }
-    return true;
+    return node.layout != VK_IMAGE_LAYOUT_MAX_ENUM;
 }
 
+// Find all layouts the subresources of image are currently in on the global level
 bool FindLayouts(layer_data *device_data, VkImage image, std::vector<VkImageLayout> &layouts) {
-    auto sub_data = (*core_validation::GetImageSubresourceMap(device_data)).find(image);
-    if (sub_data == (*core_validation::GetImageSubresourceMap(device_data)).end()) return false;
     auto image_state = GetImageState(device_data, image);
     if (!image_state) return false;
-    bool ignoreGlobal = false;
-    // TODO: Make this robust for >1 aspect mask. Now it will just say ignore potential errors in this case.
-    if (sub_data->second.size() >= (image_state->createInfo.arrayLayers * image_state->createInfo.mipLevels + 1)) {
-        ignoreGlobal = true;
-    }
-    for (auto imgsubpair : sub_data->second) {
-        if (ignoreGlobal && !imgsubpair.hasSubresource) continue;
-        auto img_data = (*core_validation::GetImageLayoutMap(device_data)).find(imgsubpair);
-        if (img_data != (*core_validation::GetImageLayoutMap(device_data)).end()) {
-            layouts.push_back(img_data->second.layout);
-        }
+    const auto &encoder = image_state->subresource_encoder;
+    const auto &layout_map = image_state->layout_map;
+
+    // The creation layout still applies unless every subresource of the format's aspects has since been given a layout
+    const VkFormat format = image_state->createInfo.format;
+    VkImageAspectFlags format_aspects = 0;
+    if (FormatIsColor(format)) format_aspects |= VK_IMAGE_ASPECT_COLOR_BIT;
+    if (FormatHasDepth(format)) format_aspects |= VK_IMAGE_ASPECT_DEPTH_BIT;
+    if (FormatHasStencil(format)) format_aspects |= VK_IMAGE_ASPECT_STENCIL_BIT;
+    bool default_in_use = layout_map.layouts.empty();
+    for (uint32_t aspect_index = 0; aspect_index < ImageSubresourceEncoder::kAspectCount; ++aspect_index) {
+        if (!(format_aspects & (1u << aspect_index))) continue;
+        layout_map.layouts.for_each(encoder.AspectBegin(aspect_index), encoder.AspectEnd(aspect_index),
+                                    [&default_in_use](uint64_t, uint64_t, const VkImageLayout *layout) {
+                                        if (!layout) default_in_use = true;
+                                    });
+    }
+    if (default_in_use) layouts.push_back(layout_map.default_layout);
+    for (const auto &range : layout_map.layouts) {
+        layouts.push_back(range.second.value);
     }
     return true;
 }
-bool FindLayout(const std::unordered_map<ImageSubresourcePair, IMAGE_LAYOUT_NODE> &imageLayoutMap, ImageSubresourcePair imgpair,
-                VkImageLayout &layout, const VkImageAspectFlags aspectMask) {
-    if (!(imgpair.subresource.aspectMask & aspectMask)) {
-        return false;
-    }
-    imgpair.subresource.aspectMask = aspectMask;
-    auto imgsubIt = imageLayoutMap.find(imgpair);
-    if (imgsubIt == imageLayoutMap.end()) {
-        return false;
-    }
-    layout = imgsubIt->second.layout;
-    return true;
-}
 
-// find layout in supplied map
-bool FindLayout(const std::unordered_map<ImageSubresourcePair, IMAGE_LAYOUT_NODE> &imageLayoutMap, ImageSubresourcePair imgpair,
-                VkImageLayout &layout) {
-    layout = VK_IMAGE_LAYOUT_MAX_ENUM;
-    FindLayout(imageLayoutMap, imgpair, layout, VK_IMAGE_ASPECT_COLOR_BIT);
-    FindLayout(imageLayoutMap, imgpair, layout, VK_IMAGE_ASPECT_DEPTH_BIT);
-    FindLayout(imageLayoutMap, imgpair, layout, VK_IMAGE_ASPECT_STENCIL_BIT);
-    FindLayout(imageLayoutMap, imgpair, layout, VK_IMAGE_ASPECT_METADATA_BIT);
-    if (layout == VK_IMAGE_LAYOUT_MAX_ENUM) {
-        imgpair = {imgpair.image, false, VkImageSubresource()};
-        auto imgsubIt = imageLayoutMap.find(imgpair);
-        if (imgsubIt == imageLayoutMap.end()) return false;
-        layout = imgsubIt->second.layout;
-    }
-    return true;
-}
-
-// Set the layout on the global level
-void SetGlobalLayout(layer_data *device_data, ImageSubresourcePair imgpair, const VkImageLayout &layout) {
-    VkImage &image = imgpair.image;
-    (*core_validation::GetImageLayoutMap(device_data))[imgpair].layout = layout;
-    auto &image_subresources = (*core_validation::GetImageSubresourceMap(device_data))[image];
-    auto subresource = std::find(image_subresources.begin(), image_subresources.end(), imgpair);
-    if (subresource == image_subresources.end()) {
-        image_subresources.push_back(imgpair);
+// Propagate the layout transitions recorded in secondary command buffer pSubCB to the primary pCB that executes it
+void SetLayoutsFromSecondaryCmdBuf(layer_data *device_data, GLOBAL_CB_NODE *pCB, GLOBAL_CB_NODE const *pSubCB) {
+    for (const auto &sub_image_data : pSubCB->imageLayoutMap) {
+        auto &layout_map = GetCmdBufLayoutMap(pCB, sub_image_data.first, sub_image_data.second.encoder);
+        for (const auto &range : sub_image_data.second.layouts) {
+            layout_map.layouts.overwrite(range.first, range.second.end, range.second.value);
+        }
     }
 }
 
-// Set the layout on the cmdbuf level
-void SetLayout(layer_data *device_data, GLOBAL_CB_NODE *pCB, ImageSubresourcePair imgpair, const IMAGE_CMD_BUF_LAYOUT_NODE &node) {
-    pCB->imageLayoutMap[imgpair] = node;
-}
 // Set image layout for given VkImageSubresourceRange struct
 void SetImageLayout(layer_data *device_data, GLOBAL_CB_NODE *cb_node, const IMAGE_STATE *image_state,
                     VkImageSubresourceRange image_subresource_range, const VkImageLayout &layout) {
     assert(image_state);
-    for (uint32_t level_index = 0; level_index < image_subresource_range.levelCount; ++level_index) {
-        uint32_t level = image_subresource_range.baseMipLevel + level_index;
-        for (uint32_t layer_index = 0; layer_index < image_subresource_range.layerCount; layer_index++) {
-            uint32_t layer = image_subresource_range.baseArrayLayer + layer_index;
-            VkImageSubresource sub = {image_subresource_range.aspectMask, level, layer};
-            // TODO: If ImageView was created with depth or stencil, transition both layouts as the aspectMask is ignored and both
-            // are used. Verify that the extra implicit layout is OK for descriptor set layout validation
-            if (image_subresource_range.aspectMask & (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT)) {
-                if (FormatIsDepthAndStencil(image_state->createInfo.format)) {
-                    sub.aspectMask |= (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT);
-                }
-            }
-            SetLayout(device_data, cb_node, image_state->image, sub, layout);
+    // TODO: If ImageView was created with depth or stencil, transition both layouts as the aspectMask is ignored and both
+    // are used. Verify that the extra implicit layout is OK for descriptor set layout validation
+    if (image_subresource_range.aspectMask & (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT)) {
+        if (FormatIsDepthAndStencil(image_state->createInfo.format)) {
+            image_subresource_range.aspectMask |= (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT);
         }
     }
+    SetLayout(device_data, cb_node, image_state, image_subresource_range, layout);
 }
 // Set image layout for given VkImageSubresourceLayers struct
 void SetImageLayout(layer_data *device_data, GLOBAL_CB_NODE *cb_node, const IMAGE_STATE *image_state,
@@ -351,28 +248,30 @@ void TransitionSubpassLayouts(layer_data *device_data, GLOBAL_CB_NODE *pCB, cons
     }
 }
 
-bool ValidateImageAspectLayout(layer_data *device_data, GLOBAL_CB_NODE *pCB, const VkImageMemoryBarrier *mem_barrier,
-                               uint32_t level, uint32_t layer, VkImageAspectFlags aspect) {
-    if (!(mem_barrier->subresourceRange.aspectMask & aspect)) {
+// Verify that the subresources a barrier transitions are in its oldLayout, as far as this command buffer knows
+bool ValidateImageBarrierLayout(layer_data *device_data, GLOBAL_CB_NODE *pCB, const VkImageMemoryBarrier *mem_barrier) {
+    if (mem_barrier->oldLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
+        // TODO: Set memory invalid which is in mem_tracker currently
         return false;
     }
-    VkImageSubresource sub = {aspect, level, layer};
-    IMAGE_CMD_BUF_LAYOUT_NODE node;
-    if (!FindCmdBufLayout(device_data, pCB, mem_barrier->image, sub, node)) {
+    auto layout_map = pCB->imageLayoutMap.find(mem_barrier->image);
+    if (layout_map == pCB->imageLayoutMap.end()) {
         return false;
     }
+    const auto &encoder = layout_map->second.encoder;
+    const auto &layouts = layout_map->second.layouts;
     bool skip = false;
-    if (mem_barrier->oldLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
-        // TODO: Set memory invalid which is in mem_tracker currently
-    } else if (node.layout != mem_barrier->oldLayout) {
-        skip |=
-            log_msg(core_validation::GetReportData(device_data), VK_DEBUG_REPORT_ERROR_BIT_EXT,
-                    VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, HandleToUint64(pCB->commandBuffer), __LINE__,
-                    DRAWSTATE_INVALID_IMAGE_LAYOUT, "DS",
-                    "For image 0x%" PRIxLEAST64 " you cannot transition the layout of aspect %d from %s when current layout is %s.",
-                    HandleToUint64(mem_barrier->image), aspect, string_VkImageLayout(mem_barrier->oldLayout),
-                    string_VkImageLayout(node.layout));
-    }
+    encoder.ForEachRun(mem_barrier->subresourceRange, [&](uint64_t begin, uint64_t end) {
+        layouts.for_each(begin, end, [&](uint64_t piece_begin, uint64_t, const IMAGE_CMD_BUF_LAYOUT_NODE *node) {
+            if (!node || node->layout == mem_barrier->oldLayout) return;
+            skip |= log_msg(core_validation::GetReportData(device_data), VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                            VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, HandleToUint64(pCB->commandBuffer), __LINE__,
+                            DRAWSTATE_INVALID_IMAGE_LAYOUT, "DS",
+                            "For image 0x%" PRIxLEAST64 " you cannot transition the layout of aspect %d from %s when current layout is %s.",
+                            HandleToUint64(mem_barrier->image), encoder.Decode(piece_begin).aspectMask,
+                            string_VkImageLayout(mem_barrier->oldLayout), string_VkImageLayout(node->layout));
+        });
+    });
     return skip;
 }
 
@@ -391,24 +290,6 @@ void TransitionBeginRenderPassLayouts(layer_data *device_data, GLOBAL_CB_NODE *c
     TransitionSubpassLayouts(device_data, cb_state, render_pass_state, 0, framebuffer_state);
 }
 
-void TransitionImageAspectLayout(layer_data *device_data, GLOBAL_CB_NODE *pCB, const VkImageMemoryBarrier *mem_barrier,
-                                 uint32_t level, uint32_t layer, VkImageAspectFlags aspect) {
-    if (!(mem_barrier->subresourceRange.aspectMask & aspect)) {
-        return;
-    }
-    VkImageSubresource sub = {aspect, level, layer};
-    IMAGE_CMD_BUF_LAYOUT_NODE node;
-    if (!FindCmdBufLayout(device_data, pCB, mem_barrier->image, sub, node)) {
-        SetLayout(device_data, pCB, mem_barrier->image, sub,
-                  IMAGE_CMD_BUF_LAYOUT_NODE(mem_barrier->oldLayout, mem_barrier->newLayout));
-        return;
-    }
-    if (mem_barrier->oldLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
-        // TODO: Set memory invalid
-    }
-    SetLayout(device_data, pCB, mem_barrier->image, sub, mem_barrier->newLayout);
-}
-
 bool VerifyAspectsPresent(VkImageAspectFlags aspect_mask, VkFormat format) {
     if ((aspect_mask & VK_IMAGE_ASPECT_COLOR_BIT) != 0) {
         if (!FormatIsColor(format)) return false;
@@ -522,19 +403,7 @@ bool ValidateBarriersToImages(layer_data *device_data, VkCommandBuffer cmdBuffer
                             aspect_mask, validation_error_map[VALIDATION_ERROR_0a00096e]);
             }
         }
-        uint32_t level_count = ResolveRemainingLevels(&img_barrier->subresourceRange, image_create_info->mipLevels);
-        uint32_t layer_count = ResolveRemainingLayers(&img_barrier->subresourceRange, image_create_info->arrayLayers);
-
-        for (uint32_t j = 0; j < level_count; j++) {
-            uint32_t level = img_barrier->subresourceRange.baseMipLevel + j;
-            for (uint32_t k = 0; k < layer_count; k++) {
-                uint32_t layer = img_barrier->subresourceRange.baseArrayLayer + k;
-                skip |= ValidateImageAspectLayout(device_data, pCB, img_barrier, level, layer, VK_IMAGE_ASPECT_COLOR_BIT);
-                skip |= ValidateImageAspectLayout(device_data, pCB, img_barrier, level, layer, VK_IMAGE_ASPECT_DEPTH_BIT);
-                skip |= ValidateImageAspectLayout(device_data, pCB, img_barrier, level, layer, VK_IMAGE_ASPECT_STENCIL_BIT);
-                skip |= ValidateImageAspectLayout(device_data, pCB, img_barrier, level, layer, VK_IMAGE_ASPECT_METADATA_BIT);
-            }
-        }
+        skip |= ValidateImageBarrierLayout(device_data, pCB, img_barrier);
     }
     return skip;
 }
@@ -547,20 +416,16 @@ void TransitionImageLayouts(layer_data *device_data, VkCommandBuffer cmdBuffer,
         auto mem_barrier = &pImgMemBarriers[i];
         if (!mem_barrier) continue;
 
-        VkImageCreateInfo *image_create_info = &(GetImageState(device_data, mem_barrier->image)->createInfo);
-        uint32_t level_count = ResolveRemainingLevels(&mem_barrier->subresourceRange, image_create_info->mipLevels);
-        uint32_t layer_count = ResolveRemainingLayers(&mem_barrier->subresourceRange, image_create_info->arrayLayers);
-
-        for (uint32_t j = 0; j < level_count; j++) {
-            uint32_t level = mem_barrier->subresourceRange.baseMipLevel + j;
-            for (uint32_t k = 0; k < layer_count; k++) {
-                uint32_t layer = mem_barrier->subresourceRange.baseArrayLayer + k;
-                TransitionImageAspectLayout(device_data, pCB, mem_barrier, level, layer, VK_IMAGE_ASPECT_COLOR_BIT);
-                TransitionImageAspectLayout(device_data, pCB, mem_barrier, level, layer, VK_IMAGE_ASPECT_DEPTH_BIT);
-                TransitionImageAspectLayout(device_data, pCB, mem_barrier, level, layer, VK_IMAGE_ASPECT_STENCIL_BIT);
-                TransitionImageAspectLayout(device_data, pCB, mem_barrier, level, layer, VK_IMAGE_ASPECT_METADATA_BIT);
-            }
-        }
+        auto image_state = GetImageState(device_data, mem_barrier->image);
+        if (!image_state) continue;
+        auto &layout_map = GetCmdBufLayoutMap(pCB, mem_barrier->image, image_state->subresource_encoder);
+        layout_map.encoder.ForEachRun(mem_barrier->subresourceRange, [&layout_map, mem_barrier](uint64_t begin, uint64_t end) {
+            layout_map.layouts.update(begin, end, [mem_barrier](const IMAGE_CMD_BUF_LAYOUT_NODE *node) {
+                // Subresources this command buffer has not used yet are expected to be in oldLayout when it executes
+                // TODO: Set memory invalid if oldLayout is VK_IMAGE_LAYOUT_UNDEFINED
+                return IMAGE_CMD_BUF_LAYOUT_NODE(node ? node->initialLayout : mem_barrier->oldLayout, mem_barrier->newLayout);
+            });
+        });
     }
 }
 
@@ -807,13 +672,7 @@ bool PreCallValidateCreateImage(layer_data *device_data, const VkImageCreateInfo
 }
 
 void PostCallRecordCreateImage(layer_data *device_data, const VkImageCreateInfo *pCreateInfo, VkImage *pImage) {
-    IMAGE_LAYOUT_NODE image_state;
-    image_state.layout = pCreateInfo->initialLayout;
-    image_state.format = pCreateInfo->format;
     GetImageMap(device_data)->insert(std::make_pair(*pImage, std::unique_ptr<IMAGE_STATE>(new IMAGE_STATE(*pImage, pCreateInfo))));
-    ImageSubresourcePair subpair{*pImage, false, VkImageSubresource()};
-    (*core_validation::GetImageSubresourceMap(device_data))[*pImage].push_back(subpair);
-    (*core_validation::GetImageLayoutMap(device_data))[subpair] = image_state;
 }
 
 bool PreCallValidateDestroyImage(layer_data *device_data, VkImage image, IMAGE_STATE **image_state, VK_OBJECT *obj_struct) {
@@ -838,18 +697,8 @@ void PostCallRecordDestroyImage(layer_data *device_data, VkImage image, IMAGE_ST
         }
     }
     core_validation::ClearMemoryObjectBindings(device_data, obj_struct.handle, kVulkanObjectTypeImage);
-    // Remove image from imageMap
+    // Remove image from imageMap, which also releases its layout state
     core_validation::GetImageMap(device_data)->erase(image);
-    std::unordered_map<VkImage, std::vector<ImageSubresourcePair>> *imageSubresourceMap =
-        core_validation::GetImageSubresourceMap(device_data);
-
-    const auto &sub_entry = imageSubresourceMap->find(image);
-    if (sub_entry != imageSubresourceMap->end()) {
-        for (const auto &pair : sub_entry->second) {
-            core_validation::GetImageLayoutMap(device_data)->erase(pair);
-        }
-        imageSubresourceMap->erase(sub_entry);
-    }
 }
 
 bool ValidateImageAttributes(layer_data *device_data, IMAGE_STATE *image_state, VkImageSubresourceRange range) {
@@ -979,21 +828,14 @@ bool VerifyClearImageLayout(layer_data *device_data, GLOBAL_CB_NODE *cb_node, IM
 
 void RecordClearImageLayout(layer_data *device_data, GLOBAL_CB_NODE *cb_node, VkImage image, VkImageSubresourceRange range,
                             VkImageLayout dest_image_layout) {
-    VkImageCreateInfo *image_create_info = &(GetImageState(device_data, image)->createInfo);
-    uint32_t level_count = ResolveRemainingLevels(&range, image_create_info->mipLevels);
-    uint32_t layer_count = ResolveRemainingLayers(&range, image_create_info->arrayLayers);
-
-    for (uint32_t level_index = 0; level_index < level_count; ++level_index) {
-        uint32_t level = level_index + range.baseMipLevel;
-        for (uint32_t layer_index = 0; layer_index < layer_count; ++layer_index) {
-            uint32_t layer = layer_index + range.baseArrayLayer;
-            VkImageSubresource sub = {range.aspectMask, level, layer};
-            IMAGE_CMD_BUF_LAYOUT_NODE node;
-            if (!FindCmdBufLayout(device_data, cb_node, image, sub, node)) {
-                SetLayout(device_data, cb_node, image, sub, IMAGE_CMD_BUF_LAYOUT_NODE(dest_image_layout, dest_image_layout));
-            }
-        }
-    }
+    auto image_state = GetImageState(device_data, image);
+    auto &layout_map = GetCmdBufLayoutMap(cb_node, image, image_state->subresource_encoder);
+    // Only subresources this command buffer has not used yet pick up the clear layout
+    layout_map.encoder.ForEachRun(range, [&layout_map, dest_image_layout](uint64_t begin, uint64_t end) {
+        layout_map.layouts.update(begin, end, [dest_image_layout](const IMAGE_CMD_BUF_LAYOUT_NODE *node) {
+            return node ? *node : IMAGE_CMD_BUF_LAYOUT_NODE(dest_image_layout, dest_image_layout);
+        });
+    });
 }
 
 bool PreCallValidateCmdClearColorImage(layer_data *dev_data, VkCommandBuffer commandBuffer, VkImage image,
@@ -2373,46 +2215,53 @@ void PreCallRecordCmdBlitImage(layer_data *device_data, GLOBAL_CB_NODE *cb_node,
 // the IMAGE is the same
 // as the global IMAGE layout
 bool ValidateCmdBufImageLayouts(layer_data *device_data, GLOBAL_CB_NODE *pCB,
-                                std::unordered_map<ImageSubresourcePair, IMAGE_LAYOUT_NODE> &imageLayoutMap) {
+                                std::unordered_map<VkImage, IMAGE_LAYOUT_MAP> &imageLayoutMap) {
     bool skip = false;
     const debug_report_data *report_data = core_validation::GetReportData(device_data);
-    for (auto cb_image_data : pCB->imageLayoutMap) {
-        VkImageLayout imageLayout;
-
-        if (FindLayout(imageLayoutMap, cb_image_data.first, imageLayout)) {
-            if (cb_image_data.second.initialLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
+    for (const auto &cb_image_data : pCB->imageLayoutMap) {
+        const VkImage image = cb_image_data.first;
+        auto image_layouts = imageLayoutMap.find(image);
+        if (image_layouts == imageLayoutMap.end()) {
+            // First use of this image in the submission, start from its current global layouts
+            auto image_state = GetImageState(device_data, image);
+            if (!image_state) continue;
+            image_layouts = imageLayoutMap.emplace(image, image_state->layout_map).first;
+        }
+        IMAGE_LAYOUT_MAP &global_layouts = image_layouts->second;
+        const auto &encoder = cb_image_data.second.encoder;
+
+        for (const auto &cb_range : cb_image_data.second.layouts) {
+            const IMAGE_CMD_BUF_LAYOUT_NODE &cb_layout = cb_range.second.value;
+            if (cb_layout.initialLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
                 // TODO: Set memory invalid which is in mem_tracker currently
-            } else if (imageLayout != cb_image_data.second.initialLayout) {
-                if (cb_image_data.first.hasSubresource) {
-                    skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                                    HandleToUint64(pCB->commandBuffer), __LINE__, DRAWSTATE_INVALID_IMAGE_LAYOUT, "DS",
-                                    "Cannot submit cmd buffer using image (0x%" PRIx64
-                                    ") [sub-resource: aspectMask 0x%X array layer %u, mip level %u], "
-                                    "with layout %s when first use is %s.",
-                                    HandleToUint64(cb_image_data.first.image), cb_image_data.first.subresource.aspectMask,
-                                    cb_image_data.first.subresource.arrayLayer, cb_image_data.first.subresource.mipLevel,
-                                    string_VkImageLayout(imageLayout), string_VkImageLayout(cb_image_data.second.initialLayout));
-                } else {
-                    skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                                    HandleToUint64(pCB->commandBuffer), __LINE__, DRAWSTATE_INVALID_IMAGE_LAYOUT, "DS",
-                                    "Cannot submit cmd buffer using image (0x%" PRIx64
-                                    ") with layout %s when "
-                                    "first use is %s.",
-                                    HandleToUint64(cb_image_data.first.image), string_VkImageLayout(imageLayout),
-                                    string_VkImageLayout(cb_image_data.second.initialLayout));
-                }
+            } else {
+                global_layouts.layouts.for_each(
+                    cb_range.first, cb_range.second.end, [&](uint64_t begin, uint64_t, const VkImageLayout *layout) {
+                        VkImageLayout imageLayout = layout ? *layout : global_layouts.default_layout;
+                        if (imageLayout == cb_layout.initialLayout) return;
+                        const VkImageSubresource sub = encoder.Decode(begin);
+                        skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                        HandleToUint64(pCB->commandBuffer), __LINE__, DRAWSTATE_INVALID_IMAGE_LAYOUT, "DS",
+                                        "Cannot submit cmd buffer using image (0x%" PRIx64
+                                        ") [sub-resource: aspectMask 0x%X array layer %u, mip level %u], "
+                                        "with layout %s when first use is %s.",
+                                        HandleToUint64(image), sub.aspectMask, sub.arrayLayer, sub.mipLevel,
+                                        string_VkImageLayout(imageLayout), string_VkImageLayout(cb_layout.initialLayout));
+                    });
             }
-            SetLayout(imageLayoutMap, cb_image_data.first, cb_image_data.second.layout);
+            global_layouts.layouts.overwrite(cb_range.first, cb_range.second.end, cb_layout.layout);
         }
     }
     return skip;
 }
 
 void UpdateCmdBufImageLayouts(layer_data *device_data, GLOBAL_CB_NODE *pCB) {
-    for (auto cb_image_data : pCB->imageLayoutMap) {
-        VkImageLayout imageLayout;
-        FindGlobalLayout(device_data, cb_image_data.first, imageLayout);
-        SetGlobalLayout(device_data, cb_image_data.first, cb_image_data.second.layout);
+    for (const auto &cb_image_data : pCB->imageLayoutMap) {
+        auto image_state = GetImageState(device_data, cb_image_data.first);
+        if (!image_state) continue;
+        for (const auto &cb_range : cb_image_data.second.layouts) {
+            image_state->layout_map.layouts.overwrite(cb_range.first, cb_range.second.end, cb_range.second.value.layout);
+        }
     }
 }
 
@@ -2713,29 +2562,25 @@ bool ValidateMapImageLayouts(core_validation::layer_data *device_data, VkDevice
                              VkDeviceSize offset, VkDeviceSize end_offset) {
     const debug_report_data *report_data = core_validation::GetReportData(device_data);
     bool skip = false;
-    // Iterate over all bound image ranges and verify that for any that overlap the map ranges, the layouts are
+    // Find the bound image ranges that overlap the map range and verify that their layouts are
     // VK_IMAGE_LAYOUT_PREINITIALIZED or VK_IMAGE_LAYOUT_GENERAL
-    // TODO : This can be optimized if we store ranges based on starting address and early exit when we pass our range
-    for (auto image_handle : mem_info->bound_images) {
-        auto img_it = mem_info->bound_ranges.find(image_handle);
-        if (img_it != mem_info->bound_ranges.end()) {
-            if (rangesIntersect(device_data, &img_it->second, offset, end_offset)) {
-                std::vector<VkImageLayout> layouts;
-                if (FindLayouts(device_data, VkImage(image_handle), layouts)) {
-                    for (auto layout : layouts) {
-                        if (layout != VK_IMAGE_LAYOUT_PREINITIALIZED && layout != VK_IMAGE_LAYOUT_GENERAL) {
-                            skip |=
-                                log_msg(report_data, VK_DEBUG_REPORT_WARNING_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT,
-                                        HandleToUint64(mem_info->mem), __LINE__, DRAWSTATE_INVALID_IMAGE_LAYOUT, "DS",
-                                        "Mapping an image with layout %s can result in undefined behavior if this memory is "
-                                        "used by the device. Only GENERAL or PREINITIALIZED should be used.",
-                                        string_VkImageLayout(layout));
-                        }
-                    }
+    auto check_image_range = [&](VkDeviceSize, VkDeviceSize, MEMORY_RANGE *range) {
+        if (!range->image) return;
+        std::vector<VkImageLayout> layouts;
+        if (FindLayouts(device_data, VkImage(range->handle), layouts)) {
+            for (auto layout : layouts) {
+                if (layout != VK_IMAGE_LAYOUT_PREINITIALIZED && layout != VK_IMAGE_LAYOUT_GENERAL) {
+                    skip |= log_msg(report_data, VK_DEBUG_REPORT_WARNING_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT,
+                                    HandleToUint64(mem_info->mem), __LINE__, DRAWSTATE_INVALID_IMAGE_LAYOUT, "DS",
+                                    "Mapping an image with layout %s can result in undefined behavior if this memory is "
+                                    "used by the device. Only GENERAL or PREINITIALIZED should be used.",
+                                    string_VkImageLayout(layout));
                 }
             }
         }
-    }
+    };
+    mem_info->linear_ranges.for_each_overlap(offset, end_offset, check_image_range);
+    mem_info->non_linear_ranges.for_each_overlap(offset, end_offset, check_image_range);
     return skip;
 }
 
@@ -3092,7 +2937,7 @@ static bool validateIdleBuffer(layer_data *device_data, VkBuffer buffer) {
                         __LINE__, DRAWSTATE_DOUBLE_DESTROY, "DS",
                         "Cannot free buffer 0x%" PRIxLEAST64 " that has not been allocated.", HandleToUint64(buffer));
     } else {
-        if (buffer_state->in_use.load()) {
+        if (core_validation::IsObjectInUse(buffer_state, {HandleToUint64(buffer), kVulkanObjectTypeBuffer})) {
             skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT,
                             HandleToUint64(buffer), __LINE__, VALIDATION_ERROR_23c00734, "DS",
                             "Cannot free buffer 0x%" PRIxLEAST64 " that is in use by a command buffer. %s", HandleToUint64(buffer),
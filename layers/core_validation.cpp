@@ -67,6 +67,9 @@
 #include "vk_layer_data.h"
 #include "vk_layer_extension_utils.h"
 #include "vk_layer_utils.h"
+#include "vk_layer_thread_pool.h"
+#include "vk_layer_profiler.h"
+#include "vk_layer_trace.h"
 #include "spirv-tools/libspirv.h"
 
 #if defined __ANDROID__
@@ -144,32 +147,31 @@ struct layer_data {
     DeviceExtensions device_extensions = {};
     unordered_set<VkQueue> queues;  // All queues under given device
     // Layer specific data
-    unordered_map<VkSampler, unique_ptr<SAMPLER_STATE>> samplerMap;
-    unordered_map<VkImageView, unique_ptr<IMAGE_VIEW_STATE>> imageViewMap;
-    unordered_map<VkImage, unique_ptr<IMAGE_STATE>> imageMap;
-    unordered_map<VkBufferView, unique_ptr<BUFFER_VIEW_STATE>> bufferViewMap;
-    unordered_map<VkBuffer, unique_ptr<BUFFER_STATE>> bufferMap;
-    unordered_map<VkPipeline, PIPELINE_STATE *> pipelineMap;
-    unordered_map<VkCommandPool, COMMAND_POOL_NODE> commandPoolMap;
-    unordered_map<VkDescriptorPool, DESCRIPTOR_POOL_STATE *> descriptorPoolMap;
-    unordered_map<VkDescriptorSet, cvdescriptorset::DescriptorSet *> setMap;
-    unordered_map<VkDescriptorSetLayout, cvdescriptorset::DescriptorSetLayout *> descriptorSetLayoutMap;
-    unordered_map<VkPipelineLayout, PIPELINE_LAYOUT_NODE> pipelineLayoutMap;
-    unordered_map<VkDeviceMemory, unique_ptr<DEVICE_MEM_INFO>> memObjMap;
-    unordered_map<VkFence, FENCE_NODE> fenceMap;
-    unordered_map<VkQueue, QUEUE_STATE> queueMap;
-    unordered_map<VkEvent, EVENT_STATE> eventMap;
+    handle_map<VkSampler, unique_ptr<SAMPLER_STATE>> samplerMap;
+    handle_map<VkImageView, unique_ptr<IMAGE_VIEW_STATE>> imageViewMap;
+    handle_map<VkImage, unique_ptr<IMAGE_STATE>> imageMap;
+    handle_map<VkBufferView, unique_ptr<BUFFER_VIEW_STATE>> bufferViewMap;
+    handle_map<VkBuffer, unique_ptr<BUFFER_STATE>> bufferMap;
+    handle_map<VkPipeline, PIPELINE_STATE *> pipelineMap;
+    handle_map<VkCommandPool, COMMAND_POOL_NODE> commandPoolMap;
+    handle_map<VkDescriptorPool, DESCRIPTOR_POOL_STATE *> descriptorPoolMap;
+    handle_map<VkDescriptorSet, cvdescriptorset::DescriptorSet *> setMap;
+    handle_map<VkDescriptorSetLayout, cvdescriptorset::DescriptorSetLayout *> descriptorSetLayoutMap;
+    handle_map<VkPipelineLayout, PIPELINE_LAYOUT_NODE> pipelineLayoutMap;
+    handle_map<VkDeviceMemory, unique_ptr<DEVICE_MEM_INFO>> memObjMap;
+    handle_map<VkFence, FENCE_NODE> fenceMap;
+    handle_map<VkQueue, QUEUE_STATE> queueMap;
+    std::vector<QUEUE_STATE *> queue_states;  // Indexed by QUEUE_STATE::index
+    handle_map<VkEvent, EVENT_STATE> eventMap;
     unordered_map<QueryObject, bool> queryToStateMap;
-    unordered_map<VkQueryPool, QUERY_POOL_NODE> queryPoolMap;
-    unordered_map<VkSemaphore, SEMAPHORE_NODE> semaphoreMap;
-    unordered_map<VkCommandBuffer, GLOBAL_CB_NODE *> commandBufferMap;
-    unordered_map<VkFramebuffer, unique_ptr<FRAMEBUFFER_STATE>> frameBufferMap;
-    unordered_map<VkImage, vector<ImageSubresourcePair>> imageSubresourceMap;
-    unordered_map<ImageSubresourcePair, IMAGE_LAYOUT_NODE> imageLayoutMap;
-    unordered_map<VkRenderPass, unique_ptr<RENDER_PASS_STATE>> renderPassMap;
-    unordered_map<VkShaderModule, unique_ptr<shader_module>> shaderModuleMap;
-    unordered_map<VkDescriptorUpdateTemplateKHR, unique_ptr<TEMPLATE_STATE>> desc_template_map;
-    unordered_map<VkSwapchainKHR, std::unique_ptr<SWAPCHAIN_NODE>> swapchainMap;
+    handle_map<VkQueryPool, QUERY_POOL_NODE> queryPoolMap;
+    handle_map<VkSemaphore, SEMAPHORE_NODE> semaphoreMap;
+    handle_map<VkCommandBuffer, GLOBAL_CB_NODE *> commandBufferMap;
+    handle_map<VkFramebuffer, unique_ptr<FRAMEBUFFER_STATE>> frameBufferMap;
+    handle_map<VkRenderPass, unique_ptr<RENDER_PASS_STATE>> renderPassMap;
+    handle_map<VkShaderModule, unique_ptr<shader_module>> shaderModuleMap;
+    handle_map<VkDescriptorUpdateTemplateKHR, unique_ptr<TEMPLATE_STATE>> desc_template_map;
+    handle_map<VkSwapchainKHR, std::unique_ptr<SWAPCHAIN_NODE>> swapchainMap;
 
     VkDevice device = VK_NULL_HANDLE;
     VkPhysicalDevice physical_device = VK_NULL_HANDLE;
@@ -181,6 +183,25 @@ struct layer_data {
     PHYS_DEV_PROPERTIES_NODE phys_dev_properties = {};
     VkPhysicalDeviceMemoryProperties phys_dev_mem_props = {};
     VkPhysicalDeviceProperties phys_dev_props = {};
+    // Allocations made for recorded command buffer state since the last present, and how many reached the system heap
+    uint64_t cb_state_allocations = 0;
+    uint64_t cb_state_system_allocations = 0;
+    // Draws and dispatches in command buffers reset since the last present, and how many reused an earlier validation result
+    uint64_t draw_validations = 0;
+    uint64_t draw_validations_reused = 0;
+    uint64_t draw_validations_unsampled = 0;
+    // Command buffer recordings begun, and of those since the last present, how many were picked for full validation
+    uint64_t recordings_begun = 0;
+    uint64_t recordings_since_present = 0;
+    uint64_t recordings_sampled = 0;
+    // Bumped whenever a buffer, image, image view, memory object or descriptor set goes away, since any of those can change
+    // the outcome of draw-time checks without touching the command buffers that reference them
+    uint64_t resource_generation = 0;
+    // Layer settings, read from vk_layer_settings.txt when the device is created
+    bool parallel_submit_validation = false;
+    bool async_validation = false;
+    uint64_t validation_sample_rate = 1;
+    trace_event_writer *queue_trace = nullptr;  // Shared with other devices tracing to the same file
 };
 
 // TODO : Do we need to guard access to layer_data_map w/ lock?
@@ -255,21 +276,87 @@ struct spirv_inst_iter {
     spirv_inst_iter const &operator*() const { return *this; }
 };
 
+// Decorations applied to one id by OpDecorate. flags records which decorations are present; the value fields are only
+// meaningful when the matching bit is set.
+struct decoration_set {
+    enum {
+        location_bit = 1 << 0,
+        component_bit = 1 << 1,
+        builtin_bit = 1 << 2,
+        patch_bit = 1 << 3,
+        block_bit = 1 << 4,
+        buffer_block_bit = 1 << 5,
+        relaxed_precision_bit = 1 << 6,
+        input_attachment_index_bit = 1 << 7,
+        descriptor_set_bit = 1 << 8,
+        binding_bit = 1 << 9,
+    };
+    uint32_t flags;
+    uint32_t location;
+    uint32_t component;
+    uint32_t builtin;
+    uint32_t input_attachment_index;
+    uint32_t descriptor_set;
+    uint32_t binding;
+    // Range of shader_module::member_decorations holding the OpMemberDecorates of this id, if it is a struct type
+    uint32_t first_member_decoration;
+    uint32_t member_decoration_count;
+};
+
+// One OpMemberDecorate. value is the decoration's first operand, or 0 if it has none.
+struct member_decoration {
+    uint32_t struct_id;
+    uint32_t member_index;
+    uint32_t decoration;
+    uint32_t value;
+};
+
+// Everything build_def_index learns about a module, in a form that can be saved and restored by the shader cache
+struct shader_reflection {
+    vector<uint32_t> def_index;
+    vector<uint32_t> decoration_index;
+    vector<decoration_set> decorations;
+    vector<member_decoration> member_decorations;
+    vector<uint32_t> entry_points;
+    vector<uint32_t> capabilities;
+};
+
 struct shader_module {
     // The spirv image itself
     vector<uint32_t> words;
-    // A mapping of <id> to the first word of its def. this is useful because walking type
-    // trees, constant expressions, etc requires jumping all over the instruction stream.
-    unordered_map<unsigned, unsigned> def_index;
+    // Offset of the first word of each id's def, indexed by id, or 0 for ids without a def we track. This is useful because
+    // walking type trees, constant expressions, etc requires jumping all over the instruction stream. Ids are dense below
+    // the bound in the module header, so a flat array is both smaller and faster than a hash map.
+    vector<uint32_t> def_index;
+    // Index into decorations for each id; 0 (an empty set) for ids that are never decorated
+    vector<uint32_t> decoration_index;
+    vector<decoration_set> decorations;
+    // All OpMemberDecorates, grouped by struct id and in instruction order within each struct
+    vector<member_decoration> member_decorations;
+    // Offsets of the OpEntryPoint instructions, and the operands of the OpCapability instructions
+    vector<uint32_t> entry_points;
+    vector<uint32_t> capabilities;
     bool has_valid_spirv;
 
     shader_module(VkShaderModuleCreateInfo const *pCreateInfo)
         : words((uint32_t *)pCreateInfo->pCode, (uint32_t *)pCreateInfo->pCode + pCreateInfo->codeSize / sizeof(uint32_t)),
           def_index(),
+          decorations(1, decoration_set()),
           has_valid_spirv(true) {
         build_def_index(this);
     }
 
+    // Adopt reflection tables built for an identical module, e.g. by an earlier run of the application
+    shader_module(VkShaderModuleCreateInfo const *pCreateInfo, shader_reflection const &reflection)
+        : words((uint32_t *)pCreateInfo->pCode, (uint32_t *)pCreateInfo->pCode + pCreateInfo->codeSize / sizeof(uint32_t)),
+          def_index(reflection.def_index),
+          decoration_index(reflection.decoration_index),
+          decorations(reflection.decorations),
+          member_decorations(reflection.member_decorations),
+          entry_points(reflection.entry_points),
+          capabilities(reflection.capabilities),
+          has_valid_spirv(true) {}
+
     shader_module() : has_valid_spirv(false) {}
 
     // Expose begin() / end() to enable range-based for
@@ -280,16 +367,420 @@ struct shader_module {
 
     // Gets an iterator to the definition of an id
     spirv_inst_iter get_def(unsigned id) const {
-        auto it = def_index.find(id);
-        if (it == def_index.end()) {
+        if (id >= def_index.size() || def_index[id] == 0) {
             return end();
         }
-        return at(it->second);
+        return at(def_index[id]);
+    }
+
+    // Gets the OpDecorate decorations of an id
+    decoration_set const &get_decorations(unsigned id) const {
+        return decorations[id < decoration_index.size() ? decoration_index[id] : 0];
+    }
+
+    // Gets the OpMemberDecorates of a struct type, as a [first, last) pointer range
+    std::pair<member_decoration const *, member_decoration const *> get_member_decorations(unsigned struct_id) const {
+        auto const &decoration = get_decorations(struct_id);
+        auto first = member_decorations.data() + decoration.first_member_decoration;
+        return std::make_pair(first, first + decoration.member_decoration_count);
     }
 };
 
-// TODO : This can be much smarter, using separate locks for separate global data
-static std::mutex global_lock;
+// Persistent cache of shader_reflection, keyed by a hash of the SPIR-V, so that modules seen by an earlier run skip the
+// SPIRV-Tools validator and build_def_index. Enabled by setting lunarg_core_validation.shader_cache_file in
+// vk_layer_settings.txt; the file is read when the first device is created, rewritten at vkDestroyDevice when new
+// modules were added, and dropped from memory with the last device, so the next device reads the setting and file afresh.
+// A file that is truncated, fails its checksum, was written by a different cache version or refers past the end of its
+// module is ignored and replaced.
+//
+// Only modules that passed validation are stored, so a hit means the module is known to be valid SPIR-V.
+class shader_reflection_cache {
+   public:
+    struct key {
+        uint64_t size;
+        uint64_t hash;
+        uint64_t check;  // Independent second hash, to make a false match vanishingly unlikely
+    };
+
+    static key Hash(VkShaderModuleCreateInfo const *pCreateInfo) {
+        key k = {pCreateInfo->codeSize, 0xcbf29ce484222325ULL, 0x9E3779B97F4A7C15ULL};
+        const size_t count = pCreateInfo->codeSize / sizeof(uint32_t);
+        for (size_t i = 0; i < count; ++i) {
+            k.hash = (k.hash ^ pCreateInfo->pCode[i]) * 0x100000001b3ULL;
+            k.check = mix(k.check + pCreateInfo->pCode[i]);
+        }
+        return k;
+    }
+
+    bool Enabled() {
+        std::lock_guard<std::mutex> guard(lock_);
+        return !path_.empty();
+    }
+
+    // Called at each vkCreateDevice. The first live device reads the cache file named by the layer settings.
+    void Load(debug_report_data *report_data) {
+        std::lock_guard<std::mutex> guard(lock_);
+        if (devices_++ > 0) return;
+        const char *path = getLayerOption("lunarg_core_validation.shader_cache_file");
+        if (!path || !*path) return;
+        path_ = path;
+
+        FILE *file = fopen(path_.c_str(), "rb");
+        if (!file) return;  // No cache yet
+        std::vector<uint32_t> contents;
+        uint32_t chunk[4096];
+        size_t read;
+        while ((read = fread(chunk, sizeof(uint32_t), 4096, file)) > 0) contents.insert(contents.end(), chunk, chunk + read);
+        fclose(file);
+
+        if (!Parse(contents)) {
+            entries_.clear();
+            dirty_ = true;
+            log_msg(report_data, VK_DEBUG_REPORT_WARNING_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0, __LINE__,
+                    SHADER_CHECKER_NONE, "SC", "Shader cache file %s is corrupt or from a different layer version; ignoring it.",
+                    path_.c_str());
+        }
+    }
+
+    std::shared_ptr<const shader_reflection> Find(key const &k) {
+        std::lock_guard<std::mutex> guard(lock_);
+        auto it = entries_.find(k.hash);
+        if (it == entries_.end() || it->second.size != k.size || it->second.check != k.check) return nullptr;
+        return it->second.reflection;
+    }
+
+    void Insert(key const &k, shader_module const &module) {
+        auto reflection = std::make_shared<shader_reflection>();
+        reflection->def_index = module.def_index;
+        reflection->decoration_index = module.decoration_index;
+        reflection->decorations = module.decorations;
+        reflection->member_decorations = module.member_decorations;
+        reflection->entry_points = module.entry_points;
+        reflection->capabilities = module.capabilities;
+        std::lock_guard<std::mutex> guard(lock_);
+        entries_[k.hash] = entry{k.size, k.check, reflection};
+        dirty_ = true;
+    }
+
+    // Called at each vkDestroyDevice. Writes the cache back out if anything was added since it was read, and forgets it
+    // once no device is left.
+    void Save(debug_report_data *report_data) {
+        std::lock_guard<std::mutex> guard(lock_);
+        Write(report_data);
+        if (devices_ > 0 && --devices_ == 0) {
+            path_.clear();
+            entries_.clear();
+            dirty_ = false;
+        }
+    }
+
+   private:
+    // File layout, all little-endian 32-bit words: magic, version, 64-bit checksum of everything after it, entry count,
+    // then per entry the key followed by each shader_reflection table as a word count and the words themselves.
+    // Bump kVersion whenever shader_reflection or the layout of its tables changes.
+    static const uint32_t kMagic = 0x43535643;  // "CVSC"
+    static const uint32_t kVersion = 1;
+    static const size_t kHeaderWords = 4;
+
+    // Write the cache file if it has changed; lock_ must be held
+    void Write(debug_report_data *report_data) {
+        if (path_.empty() || !dirty_) return;
+
+        std::vector<uint32_t> contents = {kMagic, kVersion, 0, 0, static_cast<uint32_t>(entries_.size())};
+        for (auto const &it : entries_) {
+            put64(&contents, it.second.size);
+            put64(&contents, it.first);
+            put64(&contents, it.second.check);
+            auto const &reflection = *it.second.reflection;
+            put(&contents, reflection.def_index);
+            put(&contents, reflection.decoration_index);
+            put(&contents, reflection.decorations);
+            put(&contents, reflection.member_decorations);
+            put(&contents, reflection.entry_points);
+            put(&contents, reflection.capabilities);
+        }
+        uint64_t checksum = Checksum(contents);
+        contents[2] = static_cast<uint32_t>(checksum);
+        contents[3] = static_cast<uint32_t>(checksum >> 32);
+
+        // Write to a temporary file and then replace the cache, so a crash part way through never leaves a torn file
+        std::string temp_path = path_ + ".tmp";
+        FILE *file = fopen(temp_path.c_str(), "wb");
+        bool written = file && fwrite(contents.data(), sizeof(uint32_t), contents.size(), file) == contents.size();
+        if (file) written = (fclose(file) == 0) && written;
+        if (written) {
+#ifdef _WIN32
+            // rename() won't replace an existing file here
+            written = MoveFileExA(temp_path.c_str(), path_.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+            written = rename(temp_path.c_str(), path_.c_str()) == 0;
+#endif
+        }
+        if (!written) {
+            remove(temp_path.c_str());
+            log_msg(report_data, VK_DEBUG_REPORT_WARNING_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0, __LINE__,
+                    SHADER_CHECKER_NONE, "SC", "Unable to write shader cache file %s.", path_.c_str());
+            return;
+        }
+        dirty_ = false;
+    }
+
+    struct entry {
+        uint64_t size;
+        uint64_t check;
+        std::shared_ptr<const shader_reflection> reflection;
+    };
+
+    static uint64_t mix(uint64_t x) {
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    static uint64_t Checksum(std::vector<uint32_t> const &contents) {
+        uint64_t checksum = 0xcbf29ce484222325ULL;
+        for (size_t i = kHeaderWords; i < contents.size(); ++i) checksum = (checksum ^ contents[i]) * 0x100000001b3ULL;
+        return checksum;
+    }
+
+    static void put64(std::vector<uint32_t> *out, uint64_t value) {
+        out->push_back(static_cast<uint32_t>(value));
+        out->push_back(static_cast<uint32_t>(value >> 32));
+    }
+
+    template <typename T>
+    static void put(std::vector<uint32_t> *out, std::vector<T> const &table) {
+        static_assert(sizeof(T) % sizeof(uint32_t) == 0, "shader cache tables must be made of 32-bit words");
+        const size_t words = table.size() * sizeof(T) / sizeof(uint32_t);
+        out->push_back(static_cast<uint32_t>(words));
+        const size_t at = out->size();
+        out->resize(at + words);
+        if (words) memcpy(&(*out)[at], table.data(), words * sizeof(uint32_t));
+    }
+
+    // Reads from a word stream, failing (rather than reading past the end) on truncated input
+    class reader {
+       public:
+        reader(std::vector<uint32_t> const &contents, size_t at) : contents_(contents), at_(at) {}
+        bool get64(uint64_t *value) {
+            if (contents_.size() - at_ < 2) return false;
+            *value = contents_[at_] | (static_cast<uint64_t>(contents_[at_ + 1]) << 32);
+            at_ += 2;
+            return true;
+        }
+        template <typename T>
+        bool get(std::vector<T> *table) {
+            if (at_ >= contents_.size()) return false;
+            const size_t words = contents_[at_++];
+            if (words > contents_.size() - at_ || words % (sizeof(T) / sizeof(uint32_t))) return false;
+            table->resize(words * sizeof(uint32_t) / sizeof(T));
+            if (words) memcpy(table->data(), &contents_[at_], words * sizeof(uint32_t));
+            at_ += words;
+            return true;
+        }
+        bool done() const { return at_ == contents_.size(); }
+
+       private:
+        std::vector<uint32_t> const &contents_;
+        size_t at_;
+    };
+
+    bool Parse(std::vector<uint32_t> const &contents) {
+        if (contents.size() < kHeaderWords + 1 || contents[0] != kMagic || contents[1] != kVersion) return false;
+        uint64_t checksum = contents[2] | (static_cast<uint64_t>(contents[3]) << 32);
+        if (checksum != Checksum(contents)) return false;
+
+        reader in(contents, kHeaderWords + 1);
+        for (uint32_t i = 0; i < contents[kHeaderWords]; ++i) {
+            uint64_t size, hash, check;
+            auto reflection = std::make_shared<shader_reflection>();
+            if (!in.get64(&size) || !in.get64(&hash) || !in.get64(&check) || !in.get(&reflection->def_index) ||
+                !in.get(&reflection->decoration_index) || !in.get(&reflection->decorations) ||
+                !in.get(&reflection->member_decorations) || !in.get(&reflection->entry_points) ||
+                !in.get(&reflection->capabilities)) {
+                return false;
+            }
+            // Every table index and instruction offset must stay in bounds, so a damaged entry can never send get_def(),
+            // get_decorations() or find_entrypoint() outside the module or the tables. Offsets point past the 5 word
+            // module header; 0 in def_index means an id without a def.
+            if (size % sizeof(uint32_t) || size / sizeof(uint32_t) < 5) return false;
+            const uint64_t words = size / sizeof(uint32_t);
+            for (auto offset : reflection->def_index) {
+                if (offset != 0 && (offset < 5 || offset >= words)) return false;
+            }
+            for (auto offset : reflection->entry_points) {
+                if (offset < 5 || offset >= words) return false;
+            }
+            for (auto index : reflection->decoration_index) {
+                if (index >= reflection->decorations.size()) return false;
+            }
+            if (reflection->decorations.empty()) return false;
+            for (auto const &decoration : reflection->decorations) {
+                if (decoration.first_member_decoration > reflection->member_decorations.size() ||
+                    decoration.member_decoration_count > reflection->member_decorations.size() - decoration.first_member_decoration) {
+                    return false;
+                }
+            }
+            entries_[hash] = entry{size, check, reflection};
+        }
+        return in.done();
+    }
+
+    std::mutex lock_;
+    std::string path_;
+    uint32_t devices_ = 0;
+    bool dirty_ = false;
+    std::unordered_map<uint64_t, entry> entries_;
+};
+
+static shader_reflection_cache shader_cache;
+
+// global_lock guards all layer_data state. Entry points that only record into a command buffer take it shared
+//  (read_lock_guard): per-CB state is externally synchronized by the application, the object maps are only read,
+//  and cb_bindings on shared objects are updated through BASE_NODE::AddBoundCommandBuffer(). Everything that
+//  creates, destroys, resets or submits state takes it exclusively (std::unique_lock<rw_lock>).
+static rw_lock global_lock;
+
+// Worker threads shared by all devices for validation work that can be split up. The first live device starts them and the
+// last one to be destroyed joins them, so none is left running when the loader unloads the layer; joining them from a static
+// destructor instead can deadlock while the library is being unloaded.
+static std::mutex validation_thread_pool_lock;
+static uint32_t validation_thread_pool_devices = 0;
+static thread_pool *validation_thread_pool = nullptr;
+
+// Called at each vkCreateDevice
+static void AcquireValidationThreadPool() {
+    std::lock_guard<std::mutex> guard(validation_thread_pool_lock);
+    if (validation_thread_pool_devices++ == 0) {
+        validation_thread_pool = new thread_pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+    }
+}
+
+// Called at each vkDestroyDevice, without global_lock held, once nothing of the device can still be using the pool
+static void ReleaseValidationThreadPool() {
+    thread_pool *pool = nullptr;
+    {
+        std::lock_guard<std::mutex> guard(validation_thread_pool_lock);
+        if (validation_thread_pool_devices > 0 && --validation_thread_pool_devices == 0) {
+            pool = validation_thread_pool;
+            validation_thread_pool = nullptr;
+        }
+    }
+    delete pool;
+}
+
+// Only called from device-level entry points, while the device holds its reference to the pool
+static thread_pool &GetValidationThreadPool() { return *validation_thread_pool; }
+
+// True if a boolean layer setting is set to true
+static bool LayerOptionEnabled(const char *option) {
+    const char *value = getLayerOption(option);
+    return value && !strcmp(value, "true");
+}
+
+// When lunarg_core_validation.validation_sample_rate is set to N > 1 in the layer settings, only every Nth command buffer
+// recording of a device gets draw-time validation. Draws in the other recordings are only recorded.
+static uint64_t ReadValidationSampleRate() {
+    const char *option = getLayerOption("lunarg_core_validation.validation_sample_rate");
+    uint64_t value = option ? strtoull(option, nullptr, 10) : 0;
+    return value > 1 ? value : 1;
+}
+
+// Source of GLOBAL_CB_NODE::recording_epoch values, only touched with global_lock held exclusively
+static uint64_t recording_epochs = 0;
+
+// Background thread for deferred validation, shared by the devices that have async_validation set and torn down
+// together with the last of them, the same way as the validation thread pool
+static std::mutex async_validation_queue_lock;
+static uint32_t async_validation_queue_devices = 0;
+static task_queue *async_validation_queue = nullptr;
+
+// Deferred checks waiting beyond this many make draws validate synchronously again until the thread catches up
+static const size_t kAsyncValidationQueueCapacity = 4096;
+
+// Called at each vkCreateDevice of a device with async_validation set
+static void AcquireAsyncValidationQueue() {
+    std::lock_guard<std::mutex> guard(async_validation_queue_lock);
+    if (async_validation_queue_devices++ == 0) {
+        async_validation_queue = new task_queue(kAsyncValidationQueueCapacity);
+    }
+}
+
+// Called at each vkDestroyDevice of a device with async_validation set, without global_lock held, once the device's
+// deferred checks have been drained
+static void ReleaseAsyncValidationQueue() {
+    task_queue *queue = nullptr;
+    {
+        std::lock_guard<std::mutex> guard(async_validation_queue_lock);
+        if (async_validation_queue_devices > 0 && --async_validation_queue_devices == 0) {
+            queue = async_validation_queue;
+            async_validation_queue = nullptr;
+        }
+    }
+    delete queue;
+}
+
+// Only called for a device with async_validation set, while it holds its reference to the queue
+static task_queue &GetAsyncValidationQueue() { return *async_validation_queue; }
+
+// Traces of submissions, waits and retirement for chrome://tracing or Perfetto, by file name
+static shared_file_writer<trace_event_writer> queue_traces;
+
+// Called at each vkCreateDevice. The trace for the file named by lunarg_core_validation.trace_file in the layer settings,
+// or nullptr if that is not set or can't be opened.
+static trace_event_writer *AcquireQueueTrace() {
+    const char *file = getLayerOption("lunarg_core_validation.trace_file");
+    if (!file || !*file) return nullptr;
+    return queue_traces.acquire(file);
+}
+
+static trace_event_writer *GetQueueTrace(const layer_data *dev_data) { return dev_data->queue_trace; }
+
+// Builds the arguments of a trace event
+class trace_args {
+   public:
+    trace_args &Add(const char *key, int64_t value) { return AddJson(key, std::to_string(value)); }
+    trace_args &AddHandle(const char *key, uint64_t handle) { return AddJson(key, Handle(handle)); }
+    trace_args &AddJson(const char *key, const std::string &json) {
+        if (!json_.empty()) json_ += ',';
+        json_ += '"';
+        json_ += key;
+        json_ += "\":";
+        json_ += json;
+        return *this;
+    }
+    std::string const &str() const { return json_; }
+
+    // A handle as a JSON string, which keeps all 64 bits where a JSON number might not
+    static std::string Handle(uint64_t handle) {
+        char hex[32];
+        snprintf(hex, sizeof(hex), "\"0x%" PRIx64 "\"", handle);
+        return hex;
+    }
+
+   private:
+    std::string json_;
+};
+
+// Puts the enclosing API call in the queue trace, if there is one, with any arguments added before it returns
+class traced_call {
+   public:
+    traced_call(const layer_data *dev_data, const char *name)
+        : trace_(GetQueueTrace(dev_data)), name_(name), start_(trace_ ? trace_event_writer::now() : 0) {}
+    ~traced_call() {
+        if (trace_) trace_->complete(name_, start_, trace_event_writer::now(), args_.str());
+    }
+    traced_call(const traced_call &) = delete;
+    traced_call &operator=(const traced_call &) = delete;
+
+    trace_args &args() { return args_; }
+
+   private:
+    trace_event_writer *trace_;
+    const char *name_;
+    uint64_t start_;
+    trace_args args_;
+};
 
 // Return IMAGE_VIEW_STATE ptr for specified imageView or else NULL
 IMAGE_VIEW_STATE *GetImageViewState(const layer_data *dev_data, VkImageView image_view) {
@@ -497,7 +988,7 @@ void SetBufferMemoryValid(layer_data *dev_data, BUFFER_STATE *buffer_state, bool
 
 // Create binding link between given sampler and command buffer node
 void AddCommandBufferBindingSampler(GLOBAL_CB_NODE *cb_node, SAMPLER_STATE *sampler_state) {
-    sampler_state->cb_bindings.insert(cb_node);
+    sampler_state->AddBoundCommandBuffer(cb_node);
     cb_node->object_bindings.insert({HandleToUint64(sampler_state->sampler), kVulkanObjectTypeSampler});
 }
 
@@ -509,21 +1000,21 @@ void AddCommandBufferBindingImage(const layer_data *dev_data, GLOBAL_CB_NODE *cb
         for (auto mem_binding : image_state->GetBoundMemory()) {
             DEVICE_MEM_INFO *pMemInfo = GetMemObjInfo(dev_data, mem_binding);
             if (pMemInfo) {
-                pMemInfo->cb_bindings.insert(cb_node);
+                pMemInfo->AddBoundCommandBuffer(cb_node);
                 // Now update CBInfo's Mem reference list
                 cb_node->memObjs.insert(mem_binding);
             }
         }
         // Now update cb binding for image
         cb_node->object_bindings.insert({HandleToUint64(image_state->image), kVulkanObjectTypeImage});
-        image_state->cb_bindings.insert(cb_node);
+        image_state->AddBoundCommandBuffer(cb_node);
     }
 }
 
 // Create binding link between given image view node and its image with command buffer node
 void AddCommandBufferBindingImageView(const layer_data *dev_data, GLOBAL_CB_NODE *cb_node, IMAGE_VIEW_STATE *view_state) {
     // First add bindings for imageView
-    view_state->cb_bindings.insert(cb_node);
+    view_state->AddBoundCommandBuffer(cb_node);
     cb_node->object_bindings.insert({HandleToUint64(view_state->image_view), kVulkanObjectTypeImageView});
     auto image_state = GetImageState(dev_data, view_state->create_info.image);
     // Add bindings for image within imageView
@@ -538,20 +1029,20 @@ void AddCommandBufferBindingBuffer(const layer_data *dev_data, GLOBAL_CB_NODE *c
     for (auto mem_binding : buffer_state->GetBoundMemory()) {
         DEVICE_MEM_INFO *pMemInfo = GetMemObjInfo(dev_data, mem_binding);
         if (pMemInfo) {
-            pMemInfo->cb_bindings.insert(cb_node);
+            pMemInfo->AddBoundCommandBuffer(cb_node);
             // Now update CBInfo's Mem reference list
             cb_node->memObjs.insert(mem_binding);
         }
     }
     // Now update cb binding for buffer
     cb_node->object_bindings.insert({HandleToUint64(buffer_state->buffer), kVulkanObjectTypeBuffer});
-    buffer_state->cb_bindings.insert(cb_node);
+    buffer_state->AddBoundCommandBuffer(cb_node);
 }
 
 // Create binding link between given buffer view node and its buffer with command buffer node
 void AddCommandBufferBindingBufferView(const layer_data *dev_data, GLOBAL_CB_NODE *cb_node, BUFFER_VIEW_STATE *view_state) {
     // First add bindings for bufferView
-    view_state->cb_bindings.insert(cb_node);
+    view_state->AddBoundCommandBuffer(cb_node);
     cb_node->object_bindings.insert({HandleToUint64(view_state->buffer_view), kVulkanObjectTypeBufferView});
     auto buffer_state = GetBufferState(dev_data, view_state->create_info.buffer);
     // Add bindings for buffer within bufferView
@@ -755,9 +1246,93 @@ static bool SetSparseMemBinding(layer_data *dev_data, MEM_BINDING binding, uint6
 }
 
 // SPIRV utility functions
+static void index_def(shader_module *module, uint32_t id, uint32_t offset) {
+    if (id >= module->def_index.size()) module->def_index.resize(id + 1, 0);
+    module->def_index[id] = offset;
+}
+
+static decoration_set &decorations_for_update(shader_module *module, uint32_t id) {
+    if (id >= module->decoration_index.size()) module->decoration_index.resize(id + 1, 0);
+    if (module->decoration_index[id] == 0) {
+        module->decoration_index[id] = static_cast<uint32_t>(module->decorations.size());
+        module->decorations.push_back(decoration_set());
+    }
+    return module->decorations[module->decoration_index[id]];
+}
+
+static void record_decoration(shader_module *module, spirv_inst_iter insn) {
+    auto &decoration = decorations_for_update(module, insn.word(1));
+    uint32_t value = insn.len() > 3 ? insn.word(3) : 0;
+    switch (insn.word(2)) {
+        case spv::DecorationLocation:
+            decoration.flags |= decoration_set::location_bit;
+            decoration.location = value;
+            break;
+        case spv::DecorationComponent:
+            decoration.flags |= decoration_set::component_bit;
+            decoration.component = value;
+            break;
+        case spv::DecorationBuiltIn:
+            decoration.flags |= decoration_set::builtin_bit;
+            decoration.builtin = value;
+            break;
+        case spv::DecorationPatch:
+            decoration.flags |= decoration_set::patch_bit;
+            break;
+        case spv::DecorationBlock:
+            decoration.flags |= decoration_set::block_bit;
+            break;
+        case spv::DecorationBufferBlock:
+            decoration.flags |= decoration_set::buffer_block_bit;
+            break;
+        case spv::DecorationRelaxedPrecision:
+            decoration.flags |= decoration_set::relaxed_precision_bit;
+            break;
+        case spv::DecorationInputAttachmentIndex:
+            decoration.flags |= decoration_set::input_attachment_index_bit;
+            decoration.input_attachment_index = value;
+            break;
+        case spv::DecorationDescriptorSet:
+            decoration.flags |= decoration_set::descriptor_set_bit;
+            decoration.descriptor_set = value;
+            break;
+        case spv::DecorationBinding:
+            decoration.flags |= decoration_set::binding_bit;
+            decoration.binding = value;
+            break;
+        default:
+            // Nothing else is consulted by validation
+            break;
+    }
+}
+
+// Build the def index and the decoration tables in one pass over the module, so later validation never rescans it
 static void build_def_index(shader_module *module) {
+    if (module->words.size() > 3) {
+        // Word 3 of the header is the bound: every id in the module is less than it
+        module->def_index.assign(module->words[3], 0);
+    }
+
     for (auto insn : *module) {
         switch (insn.opcode()) {
+            case spv::OpCapability:
+                module->capabilities.push_back(insn.word(1));
+                break;
+
+            case spv::OpEntryPoint:
+                module->entry_points.push_back(insn.offset());
+                break;
+
+            // Decorations
+            case spv::OpDecorate:
+                record_decoration(module, insn);
+                break;
+
+            case spv::OpMemberDecorate:
+                module->member_decorations.push_back(
+                    member_decoration{insn.word(1), insn.word(2), insn.word(3), insn.len() > 4 ? insn.word(4) : 0});
+                break;
+
             // Types
             case spv::OpTypeVoid:
             case spv::OpTypeBool:
@@ -779,7 +1354,7 @@ static void build_def_index(shader_module *module) {
             case spv::OpTypeReserveId:
             case spv::OpTypeQueue:
             case spv::OpTypePipe:
-                module->def_index[insn.word(1)] = insn.offset();
+                index_def(module, insn.word(1), insn.offset());
                 break;
 
             // Fixed constants
@@ -789,7 +1364,7 @@ static void build_def_index(shader_module *module) {
             case spv::OpConstantComposite:
             case spv::OpConstantSampler:
             case spv::OpConstantNull:
-                module->def_index[insn.word(2)] = insn.offset();
+                index_def(module, insn.word(2), insn.offset());
                 break;
 
             // Specialization constants
@@ -798,17 +1373,17 @@ static void build_def_index(shader_module *module) {
             case spv::OpSpecConstant:
             case spv::OpSpecConstantComposite:
             case spv::OpSpecConstantOp:
-                module->def_index[insn.word(2)] = insn.offset();
+                index_def(module, insn.word(2), insn.offset());
                 break;
 
             // Variables
             case spv::OpVariable:
-                module->def_index[insn.word(2)] = insn.offset();
+                index_def(module, insn.word(2), insn.offset());
                 break;
 
             // Functions
             case spv::OpFunction:
-                module->def_index[insn.word(2)] = insn.offset();
+                index_def(module, insn.word(2), insn.offset());
                 break;
 
             default:
@@ -816,17 +1391,29 @@ static void build_def_index(shader_module *module) {
                 break;
         }
     }
+
+    // Group the member decorations by struct, keeping instruction order within each struct, and point each struct's
+    // decoration set at its range
+    auto &members = module->member_decorations;
+    std::stable_sort(members.begin(), members.end(),
+                     [](member_decoration const &a, member_decoration const &b) { return a.struct_id < b.struct_id; });
+    for (uint32_t i = 0; i < members.size();) {
+        uint32_t first = i;
+        while (i < members.size() && members[i].struct_id == members[first].struct_id) ++i;
+        auto &decoration = decorations_for_update(module, members[first].struct_id);
+        decoration.first_member_decoration = first;
+        decoration.member_decoration_count = i - first;
+    }
 }
 
 static spirv_inst_iter find_entrypoint(shader_module *src, char const *name, VkShaderStageFlagBits stageBits) {
-    for (auto insn : *src) {
-        if (insn.opcode() == spv::OpEntryPoint) {
-            auto entrypointName = (char const *)&insn.word(3);
-            auto entrypointStageBits = 1u << insn.word(1);
+    for (auto offset : src->entry_points) {
+        auto insn = src->at(offset);
+        auto entrypointName = (char const *)&insn.word(3);
+        auto entrypointStageBits = 1u << insn.word(1);
 
-            if (!strcmp(entrypointName, name) && (entrypointStageBits & stageBits)) {
-                return insn;
-            }
+        if (!strcmp(entrypointName, name) && (entrypointStageBits & stageBits)) {
+            return insn;
         }
     }
 
@@ -1029,14 +1616,6 @@ static bool types_match(shader_module const *a, shader_module const *b, unsigned
     }
 }
 
-static unsigned value_or_default(std::unordered_map<unsigned, unsigned> const &map, unsigned id, unsigned def) {
-    auto it = map.find(id);
-    if (it == map.end())
-        return def;
-    else
-        return it->second;
-}
-
 static unsigned get_locations_consumed_by_type(shader_module const *src, unsigned type, bool strip_array_level) {
     auto insn = src->get_def(type);
     assert(insn != src->end());
@@ -1125,58 +1704,50 @@ static spirv_inst_iter get_struct_type(shader_module const *src, spirv_inst_iter
 }
 
 static void collect_interface_block_members(shader_module const *src, std::map<location_t, interface_var> *out,
-                                            std::unordered_map<unsigned, unsigned> const &blocks, bool is_array_of_verts,
-                                            uint32_t id, uint32_t type_id, bool is_patch) {
+                                            bool is_array_of_verts, uint32_t id, uint32_t type_id, bool is_patch) {
     // Walk down the type_id presented, trying to determine whether it's actually an interface block.
     auto type = get_struct_type(src, src->get_def(type_id), is_array_of_verts && !is_patch);
-    if (type == src->end() || blocks.find(type.word(1)) == blocks.end()) {
+    if (type == src->end() || !(src->get_decorations(type.word(1)).flags & decoration_set::block_bit)) {
         // This isn't an interface block.
         return;
     }
 
     std::unordered_map<unsigned, unsigned> member_components;
-    std::unordered_map<unsigned, unsigned> member_relaxed_precision;
+    std::unordered_set<unsigned> member_relaxed_precision;
+    auto members = src->get_member_decorations(type.word(1));
 
     // Walk all the OpMemberDecorate for type's result id -- first pass, collect components.
-    for (auto insn : *src) {
-        if (insn.opcode() == spv::OpMemberDecorate && insn.word(1) == type.word(1)) {
-            unsigned member_index = insn.word(2);
-
-            if (insn.word(3) == spv::DecorationComponent) {
-                unsigned component = insn.word(4);
-                member_components[member_index] = component;
-            }
+    for (auto member = members.first; member != members.second; ++member) {
+        if (member->decoration == spv::DecorationComponent) {
+            member_components[member->member_index] = member->value;
+        }
 
-            if (insn.word(3) == spv::DecorationRelaxedPrecision) {
-                member_relaxed_precision[member_index] = 1;
-            }
+        if (member->decoration == spv::DecorationRelaxedPrecision) {
+            member_relaxed_precision.insert(member->member_index);
         }
     }
 
     // Second pass -- produce the output, from Location decorations
-    for (auto insn : *src) {
-        if (insn.opcode() == spv::OpMemberDecorate && insn.word(1) == type.word(1)) {
-            unsigned member_index = insn.word(2);
+    for (auto member = members.first; member != members.second; ++member) {
+        if (member->decoration == spv::DecorationLocation) {
+            unsigned member_index = member->member_index;
             unsigned member_type_id = type.word(2 + member_index);
+            unsigned location = member->value;
+            unsigned num_locations = get_locations_consumed_by_type(src, member_type_id, false);
+            auto component_it = member_components.find(member_index);
+            unsigned component = component_it == member_components.end() ? 0 : component_it->second;
+            bool is_relaxed_precision = member_relaxed_precision.count(member_index) != 0;
 
-            if (insn.word(3) == spv::DecorationLocation) {
-                unsigned location = insn.word(4);
-                unsigned num_locations = get_locations_consumed_by_type(src, member_type_id, false);
-                auto component_it = member_components.find(member_index);
-                unsigned component = component_it == member_components.end() ? 0 : component_it->second;
-                bool is_relaxed_precision = member_relaxed_precision.find(member_index) != member_relaxed_precision.end();
-
-                for (unsigned int offset = 0; offset < num_locations; offset++) {
-                    interface_var v = {};
-                    v.id = id;
-                    // TODO: member index in interface_var too?
-                    v.type_id = member_type_id;
-                    v.offset = offset;
-                    v.is_patch = is_patch;
-                    v.is_block_member = true;
-                    v.is_relaxed_precision = is_relaxed_precision;
-                    (*out)[std::make_pair(location + offset, component)] = v;
-                }
+            for (unsigned int offset = 0; offset < num_locations; offset++) {
+                interface_var v = {};
+                v.id = id;
+                // TODO: member index in interface_var too?
+                v.type_id = member_type_id;
+                v.offset = offset;
+                v.is_patch = is_patch;
+                v.is_block_member = true;
+                v.is_relaxed_precision = is_relaxed_precision;
+                (*out)[std::make_pair(location + offset, component)] = v;
             }
         }
     }
@@ -1184,42 +1755,9 @@ static void collect_interface_block_members(shader_module const *src, std::map<l
 
 static std::map<location_t, interface_var> collect_interface_by_location(shader_module const *src, spirv_inst_iter entrypoint,
                                                                          spv::StorageClass sinterface, bool is_array_of_verts) {
-    std::unordered_map<unsigned, unsigned> var_locations;
-    std::unordered_map<unsigned, unsigned> var_builtins;
-    std::unordered_map<unsigned, unsigned> var_components;
-    std::unordered_map<unsigned, unsigned> blocks;
-    std::unordered_map<unsigned, unsigned> var_patch;
-    std::unordered_map<unsigned, unsigned> var_relaxed_precision;
-
-    for (auto insn : *src) {
-        // We consider two interface models: SSO rendezvous-by-location, and builtins. Complain about anything that
-        // fits neither model.
-        if (insn.opcode() == spv::OpDecorate) {
-            if (insn.word(2) == spv::DecorationLocation) {
-                var_locations[insn.word(1)] = insn.word(3);
-            }
-
-            if (insn.word(2) == spv::DecorationBuiltIn) {
-                var_builtins[insn.word(1)] = insn.word(3);
-            }
-
-            if (insn.word(2) == spv::DecorationComponent) {
-                var_components[insn.word(1)] = insn.word(3);
-            }
-
-            if (insn.word(2) == spv::DecorationBlock) {
-                blocks[insn.word(1)] = 1;
-            }
-
-            if (insn.word(2) == spv::DecorationPatch) {
-                var_patch[insn.word(1)] = 1;
-            }
-
-            if (insn.word(2) == spv::DecorationRelaxedPrecision) {
-                var_relaxed_precision[insn.word(1)] = 1;
-            }
-        }
-    }
+    // We consider two interface models: SSO rendezvous-by-location, and builtins. Complain about anything that
+    // fits neither model. The Location, BuiltIn, Component, Patch and RelaxedPrecision decorations of each variable were
+    // collected when the module was created.
 
     // TODO: handle grouped decorations
     // TODO: handle index=1 dual source outputs from FS -- two vars will have the same location, and we DON'T want to clobber.
@@ -1243,11 +1781,12 @@ static std::map<location_t, interface_var> collect_interface_by_location(shader_
             unsigned id = insn.word(2);
             unsigned type = insn.word(1);
 
-            int location = value_or_default(var_locations, id, -1);
-            int builtin = value_or_default(var_builtins, id, -1);
-            unsigned component = value_or_default(var_components, id, 0);  // Unspecified is OK, is 0
-            bool is_patch = var_patch.find(id) != var_patch.end();
-            bool is_relaxed_precision = var_relaxed_precision.find(id) != var_relaxed_precision.end();
+            auto const &decorations = src->get_decorations(id);
+            int location = (decorations.flags & decoration_set::location_bit) ? decorations.location : -1;
+            int builtin = (decorations.flags & decoration_set::builtin_bit) ? decorations.builtin : -1;
+            unsigned component = decorations.component;  // Unspecified is OK, is 0
+            bool is_patch = (decorations.flags & decoration_set::patch_bit) != 0;
+            bool is_relaxed_precision = (decorations.flags & decoration_set::relaxed_precision_bit) != 0;
 
             // All variables and interface block members in the Input or Output storage classes must be decorated with either
             // a builtin or an explicit location.
@@ -1271,7 +1810,7 @@ static std::map<location_t, interface_var> collect_interface_by_location(shader_
                 }
             } else if (builtin == -1) {
                 // An interface block instance
-                collect_interface_block_members(src, &out, blocks, is_array_of_verts, id, type, is_patch);
+                collect_interface_block_members(src, &out, is_array_of_verts, id, type, is_patch);
             }
         }
     }
@@ -1283,53 +1822,39 @@ static vector<std::pair<uint32_t, interface_var>> collect_interface_by_input_att
     shader_module const *src, std::unordered_set<uint32_t> const &accessible_ids) {
     std::vector<std::pair<uint32_t, interface_var>> out;
 
-    for (auto insn : *src) {
-        if (insn.opcode() == spv::OpDecorate) {
-            if (insn.word(2) == spv::DecorationInputAttachmentIndex) {
-                auto attachment_index = insn.word(3);
-                auto id = insn.word(1);
-
-                if (accessible_ids.count(id)) {
-                    auto def = src->get_def(id);
-                    assert(def != src->end());
-
-                    if (def.opcode() == spv::OpVariable && insn.word(3) == spv::StorageClassUniformConstant) {
-                        auto num_locations = get_locations_consumed_by_type(src, def.word(1), false);
-                        for (unsigned int offset = 0; offset < num_locations; offset++) {
-                            interface_var v = {};
-                            v.id = id;
-                            v.type_id = def.word(1);
-                            v.offset = offset;
-                            out.emplace_back(attachment_index + offset, v);
-                        }
-                    }
+    for (auto id : accessible_ids) {
+        auto const &decorations = src->get_decorations(id);
+        if (decorations.flags & decoration_set::input_attachment_index_bit) {
+            auto attachment_index = decorations.input_attachment_index;
+            auto def = src->get_def(id);
+            assert(def != src->end());
+
+            if (def.opcode() == spv::OpVariable && attachment_index == spv::StorageClassUniformConstant) {
+                auto num_locations = get_locations_consumed_by_type(src, def.word(1), false);
+                for (unsigned int offset = 0; offset < num_locations; offset++) {
+                    interface_var v = {};
+                    v.id = id;
+                    v.type_id = def.word(1);
+                    v.offset = offset;
+                    out.emplace_back(attachment_index + offset, v);
                 }
             }
         }
     }
 
+    // accessible_ids has no stable order; sort so the interface, and any errors reported from it, are the same every run
+    std::sort(out.begin(), out.end(),
+              [](std::pair<uint32_t, interface_var> const &a, std::pair<uint32_t, interface_var> const &b) {
+                  if (a.first != b.first) return a.first < b.first;
+                  return a.second.id < b.second.id;
+              });
     return out;
 }
 
 static std::vector<std::pair<descriptor_slot_t, interface_var>> collect_interface_by_descriptor_slot(
     debug_report_data *report_data, shader_module const *src, std::unordered_set<uint32_t> const &accessible_ids) {
-    std::unordered_map<unsigned, unsigned> var_sets;
-    std::unordered_map<unsigned, unsigned> var_bindings;
-
-    for (auto insn : *src) {
-        // All variables in the Uniform or UniformConstant storage classes are required to be decorated with both
-        // DecorationDescriptorSet and DecorationBinding.
-        if (insn.opcode() == spv::OpDecorate) {
-            if (insn.word(2) == spv::DecorationDescriptorSet) {
-                var_sets[insn.word(1)] = insn.word(3);
-            }
-
-            if (insn.word(2) == spv::DecorationBinding) {
-                var_bindings[insn.word(1)] = insn.word(3);
-            }
-        }
-    }
-
+    // All variables in the Uniform or UniformConstant storage classes are required to be decorated with both
+    // DecorationDescriptorSet and DecorationBinding.
     std::vector<std::pair<descriptor_slot_t, interface_var>> out;
 
     for (auto id : accessible_ids) {
@@ -1338,8 +1863,9 @@ static std::vector<std::pair<descriptor_slot_t, interface_var>> collect_interfac
 
         if (insn.opcode() == spv::OpVariable &&
             (insn.word(3) == spv::StorageClassUniform || insn.word(3) == spv::StorageClassUniformConstant)) {
-            unsigned set = value_or_default(var_sets, insn.word(2), 0);
-            unsigned binding = value_or_default(var_bindings, insn.word(2), 0);
+            auto const &decorations = src->get_decorations(insn.word(2));
+            unsigned set = decorations.descriptor_set;
+            unsigned binding = decorations.binding;
 
             interface_var v = {};
             v.id = insn.word(2);
@@ -1352,16 +1878,12 @@ static std::vector<std::pair<descriptor_slot_t, interface_var>> collect_interfac
 }
 
 static bool validate_interface_between_stages(debug_report_data *report_data, shader_module const *producer,
-                                              spirv_inst_iter producer_entrypoint, shader_stage_attributes const *producer_stage,
-                                              shader_module const *consumer, spirv_inst_iter consumer_entrypoint,
+                                              std::map<location_t, interface_var> const &outputs,
+                                              shader_stage_attributes const *producer_stage, shader_module const *consumer,
+                                              std::map<location_t, interface_var> const &inputs,
                                               shader_stage_attributes const *consumer_stage) {
     bool skip = false;
 
-    auto outputs =
-        collect_interface_by_location(producer, producer_entrypoint, spv::StorageClassOutput, producer_stage->arrayed_output);
-    auto inputs =
-        collect_interface_by_location(consumer, consumer_entrypoint, spv::StorageClassInput, consumer_stage->arrayed_input);
-
     auto a_it = outputs.begin();
     auto b_it = inputs.begin();
 
@@ -1491,11 +2013,9 @@ static bool validate_vi_consistency(debug_report_data *report_data, VkPipelineVe
 }
 
 static bool validate_vi_against_vs_inputs(debug_report_data *report_data, VkPipelineVertexInputStateCreateInfo const *vi,
-                                          shader_module const *vs, spirv_inst_iter entrypoint) {
+                                          shader_module const *vs, std::map<location_t, interface_var> const &inputs) {
     bool skip = false;
 
-    auto inputs = collect_interface_by_location(vs, entrypoint, spv::StorageClassInput, false);
-
     // Build index by location
     std::map<uint32_t, VkVertexInputAttributeDescription const *> attribs;
     if (vi) {
@@ -1551,8 +2071,8 @@ static bool validate_vi_against_vs_inputs(debug_report_data *report_data, VkPipe
 }
 
 static bool validate_fs_outputs_against_render_pass(debug_report_data *report_data, shader_module const *fs,
-                                                    spirv_inst_iter entrypoint, VkRenderPassCreateInfo const *rpci,
-                                                    uint32_t subpass_index) {
+                                                    std::map<location_t, interface_var> const &outputs,
+                                                    VkRenderPassCreateInfo const *rpci, uint32_t subpass_index) {
     std::map<uint32_t, VkFormat> color_attachments;
     auto subpass = rpci->pSubpasses[subpass_index];
     for (auto i = 0u; i < subpass.colorAttachmentCount; ++i) {
@@ -1567,8 +2087,6 @@ static bool validate_fs_outputs_against_render_pass(debug_report_data *report_da
 
     // TODO: dual source blend index (spv::DecIndex, zero if not provided)
 
-    auto outputs = collect_interface_by_location(fs, entrypoint, spv::StorageClassOutput, false);
-
     auto it_a = outputs.begin();
     auto it_b = color_attachments.begin();
 
@@ -1738,37 +2256,36 @@ static bool validate_push_constant_block_against_pipeline(debug_report_data *rep
 
     // Validate directly off the offsets. this isn't quite correct for arrays and matrices, but is a good first step.
     // TODO: arrays, matrices, weird sizes
-    for (auto insn : *src) {
-        if (insn.opcode() == spv::OpMemberDecorate && insn.word(1) == type.word(1)) {
-            if (insn.word(3) == spv::DecorationOffset) {
-                unsigned offset = insn.word(4);
-                auto size = 4;  // Bytes; TODO: calculate this based on the type
-
-                bool found_range = false;
-                for (auto const &range : *push_constant_ranges) {
-                    if (range.offset <= offset && range.offset + range.size >= offset + size) {
-                        found_range = true;
-
-                        if ((range.stageFlags & stage) == 0) {
-                            skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                                            __LINE__, SHADER_CHECKER_PUSH_CONSTANT_NOT_ACCESSIBLE_FROM_STAGE, "SC",
-                                            "Push constant range covering variable starting at "
-                                            "offset %u not accessible from stage %s",
-                                            offset, string_VkShaderStageFlagBits(stage));
-                        }
-
-                        break;
+    auto members = src->get_member_decorations(type.word(1));
+    for (auto member = members.first; member != members.second; ++member) {
+        if (member->decoration == spv::DecorationOffset) {
+            unsigned offset = member->value;
+            auto size = 4;  // Bytes; TODO: calculate this based on the type
+
+            bool found_range = false;
+            for (auto const &range : *push_constant_ranges) {
+                if (range.offset <= offset && range.offset + range.size >= offset + size) {
+                    found_range = true;
+
+                    if ((range.stageFlags & stage) == 0) {
+                        skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
+                                        __LINE__, SHADER_CHECKER_PUSH_CONSTANT_NOT_ACCESSIBLE_FROM_STAGE, "SC",
+                                        "Push constant range covering variable starting at "
+                                        "offset %u not accessible from stage %s",
+                                        offset, string_VkShaderStageFlagBits(stage));
                     }
-                }
 
-                if (!found_range) {
-                    skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                                    __LINE__, SHADER_CHECKER_PUSH_CONSTANT_OUT_OF_RANGE, "SC",
-                                    "Push constant range covering variable starting at "
-                                    "offset %u not declared in layout",
-                                    offset);
+                    break;
                 }
             }
+
+            if (!found_range) {
+                skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
+                                __LINE__, SHADER_CHECKER_PUSH_CONSTANT_OUT_OF_RANGE, "SC",
+                                "Push constant range covering variable starting at "
+                                "offset %u not declared in layout",
+                                offset);
+            }
         }
     }
 
@@ -2066,16 +2583,13 @@ static bool descriptor_type_match(shader_module const *module, uint32_t type_id,
 
     switch (type.opcode()) {
         case spv::OpTypeStruct: {
-            for (auto insn : *module) {
-                if (insn.opcode() == spv::OpDecorate && insn.word(1) == type.word(1)) {
-                    if (insn.word(2) == spv::DecorationBlock) {
-                        return descriptor_type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER ||
-                               descriptor_type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-                    } else if (insn.word(2) == spv::DecorationBufferBlock) {
-                        return descriptor_type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER ||
-                               descriptor_type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
-                    }
-                }
+            auto const &decorations = module->get_decorations(type.word(1));
+            if (decorations.flags & decoration_set::block_bit) {
+                return descriptor_type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER ||
+                       descriptor_type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+            } else if (decorations.flags & decoration_set::buffer_block_bit) {
+                return descriptor_type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER ||
+                       descriptor_type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
             }
 
             // Invalid
@@ -2219,16 +2733,14 @@ static bool validate_shader_capabilities(layer_data *dev_data, shader_module con
     };
     // clang-format on
 
-    for (auto insn : *src) {
-        if (insn.opcode() == spv::OpCapability) {
-            auto it = capabilities.find(insn.word(1));
-            if (it != capabilities.end()) {
-                if (it->second.feature) {
-                    skip |= require_feature(report_data, enabledFeatures.*(it->second.feature), it->second.name);
-                }
-                if (it->second.extension) {
-                    skip |= require_extension(report_data, dev_data->device_extensions.*(it->second.extension), it->second.name);
-                }
+    for (auto capability : src->capabilities) {
+        auto it = capabilities.find(capability);
+        if (it != capabilities.end()) {
+            if (it->second.feature) {
+                skip |= require_feature(report_data, enabledFeatures.*(it->second.feature), it->second.name);
+            }
+            if (it->second.extension) {
+                skip |= require_extension(report_data, dev_data->device_extensions.*(it->second.extension), it->second.name);
             }
         }
     }
@@ -2275,18 +2787,51 @@ static uint32_t descriptor_type_to_reqs(shader_module const *module, uint32_t ty
     }
 }
 
-static bool validate_pipeline_shader_stage(
-    layer_data *dev_data, VkPipelineShaderStageCreateInfo const *pStage, PIPELINE_STATE *pipeline,
-    shader_module **out_module, spirv_inst_iter *out_entrypoint) {
-    bool skip = false;
+// Everything pipeline validation needs to know about one shader stage that comes from walking its SPIR-V. It depends only
+// on the shader module and the stage create info, so the stages of a whole batch of pipelines can be analyzed in parallel
+// before the validation proper, which reports errors and so runs serially in array order.
+struct shader_stage_analysis {
+    shader_module *module = nullptr;
+    spirv_inst_iter entrypoint;
+    std::unordered_set<uint32_t> accessible_ids;
+    std::vector<std::pair<descriptor_slot_t, interface_var>> descriptor_uses;
+    std::vector<std::pair<uint32_t, interface_var>> input_attachment_uses;
+    std::map<location_t, interface_var> inputs;
+    std::map<location_t, interface_var> outputs;
+};
+
+// Does not log, and only reads layer state, so may run on any thread while the caller holds global_lock
+static void analyze_shader_stage(layer_data const *dev_data, VkPipelineShaderStageCreateInfo const *pStage,
+                                 shader_stage_analysis *analysis) {
     auto module_it = dev_data->shaderModuleMap.find(pStage->module);
-    auto module = *out_module = module_it->second.get();
+    auto module = analysis->module = module_it->second.get();
+    if (!module->has_valid_spirv) return;
+
+    auto entrypoint = analysis->entrypoint = find_entrypoint(module, pStage->pName, pStage->stage);
+    if (entrypoint == module->end()) return;
+
+    analysis->accessible_ids = mark_accessible_ids(module, entrypoint);
+    analysis->descriptor_uses = collect_interface_by_descriptor_slot(dev_data->report_data, module, analysis->accessible_ids);
+    if (pStage->stage == VK_SHADER_STAGE_FRAGMENT_BIT) {
+        analysis->input_attachment_uses = collect_interface_by_input_attachment_index(module, analysis->accessible_ids);
+    }
+    if (pStage->stage & VK_SHADER_STAGE_ALL_GRAPHICS) {
+        auto const &attribs = shader_stage_attribs[get_shader_stage_id(pStage->stage)];
+        analysis->inputs = collect_interface_by_location(module, entrypoint, spv::StorageClassInput, attribs.arrayed_input);
+        analysis->outputs = collect_interface_by_location(module, entrypoint, spv::StorageClassOutput, attribs.arrayed_output);
+    }
+}
+
+static bool validate_pipeline_shader_stage(layer_data *dev_data, VkPipelineShaderStageCreateInfo const *pStage,
+                                           PIPELINE_STATE *pipeline, shader_stage_analysis const &analysis) {
+    bool skip = false;
+    auto module = analysis.module;
     auto report_data = dev_data->report_data;
 
     if (!module->has_valid_spirv) return false;
 
     // Find the entrypoint
-    auto entrypoint = *out_entrypoint = find_entrypoint(module, pStage->pName, pStage->stage);
+    auto entrypoint = analysis.entrypoint;
     if (entrypoint == module->end()) {
         if (log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0, __LINE__,
                     VALIDATION_ERROR_10600586, "SC", "No entrypoint found named `%s` for stage %s. %s.", pStage->pName,
@@ -2298,11 +2843,11 @@ static bool validate_pipeline_shader_stage(
     // Validate shader capabilities against enabled device features
     skip |= validate_shader_capabilities(dev_data, module);
 
-    // Mark accessible ids
-    auto accessible_ids = mark_accessible_ids(module, entrypoint);
+    // Ids accessible from the entrypoint
+    auto const &accessible_ids = analysis.accessible_ids;
 
     // Validate descriptor set layout against what the entrypoint actually uses
-    auto descriptor_uses = collect_interface_by_descriptor_slot(report_data, module, accessible_ids);
+    auto const &descriptor_uses = analysis.descriptor_uses;
 
     auto pipelineLayout = pipeline->pipeline_layout;
 
@@ -2351,7 +2896,7 @@ static bool validate_pipeline_shader_stage(
 
     // Validate use of input attachments against subpass structure
     if (pStage->stage == VK_SHADER_STAGE_FRAGMENT_BIT) {
-        auto input_attachment_uses = collect_interface_by_input_attachment_index(module, accessible_ids);
+        auto const &input_attachment_uses = analysis.input_attachment_uses;
 
         auto rpci = pipeline->render_pass_ci.ptr();
         auto subpass = pipeline->graphicsPipelineCI.subpass;
@@ -2381,21 +2926,25 @@ static bool validate_pipeline_shader_stage(
 
 // Validate that the shaders used by the given pipeline and store the active_slots
 //  that are actually used by the pipeline into pPipeline->active_slots
-static bool validate_and_capture_pipeline_shader_state(layer_data *dev_data, PIPELINE_STATE *pPipeline) {
+//  stages holds the analysis of each element of pStages, in the same order
+static bool validate_and_capture_pipeline_shader_state(layer_data *dev_data, PIPELINE_STATE *pPipeline,
+                                                       std::vector<shader_stage_analysis> const &stages) {
     auto pCreateInfo = pPipeline->graphicsPipelineCI.ptr();
     int vertex_stage = get_shader_stage_id(VK_SHADER_STAGE_VERTEX_BIT);
     int fragment_stage = get_shader_stage_id(VK_SHADER_STAGE_FRAGMENT_BIT);
 
     shader_module *shaders[5];
     memset(shaders, 0, sizeof(shaders));
-    spirv_inst_iter entrypoints[5];
-    memset(entrypoints, 0, sizeof(entrypoints));
+    shader_stage_analysis const *analyses[5];
+    memset(analyses, 0, sizeof(analyses));
     bool skip = false;
 
     for (uint32_t i = 0; i < pCreateInfo->stageCount; i++) {
         auto pStage = &pCreateInfo->pStages[i];
         auto stage_id = get_shader_stage_id(pStage->stage);
-        skip |= validate_pipeline_shader_stage(dev_data, pStage, pPipeline, &shaders[stage_id], &entrypoints[stage_id]);
+        shaders[stage_id] = stages[i].module;
+        analyses[stage_id] = &stages[i];
+        skip |= validate_pipeline_shader_stage(dev_data, pStage, pPipeline, stages[i]);
     }
 
     // if the shader stages are no good individually, cross-stage validation is pointless.
@@ -2408,7 +2957,7 @@ static bool validate_and_capture_pipeline_shader_state(layer_data *dev_data, PIP
     }
 
     if (shaders[vertex_stage] && shaders[vertex_stage]->has_valid_spirv) {
-        skip |= validate_vi_against_vs_inputs(dev_data->report_data, vi, shaders[vertex_stage], entrypoints[vertex_stage]);
+        skip |= validate_vi_against_vs_inputs(dev_data->report_data, vi, shaders[vertex_stage], analyses[vertex_stage]->inputs);
     }
 
     int producer = get_shader_stage_id(VK_SHADER_STAGE_VERTEX_BIT);
@@ -2422,8 +2971,8 @@ static bool validate_and_capture_pipeline_shader_state(layer_data *dev_data, PIP
     for (; producer != fragment_stage && consumer <= fragment_stage; consumer++) {
         assert(shaders[producer]);
         if (shaders[consumer] && shaders[consumer]->has_valid_spirv && shaders[producer]->has_valid_spirv) {
-            skip |= validate_interface_between_stages(dev_data->report_data, shaders[producer], entrypoints[producer],
-                                                      &shader_stage_attribs[producer], shaders[consumer], entrypoints[consumer],
+            skip |= validate_interface_between_stages(dev_data->report_data, shaders[producer], analyses[producer]->outputs,
+                                                      &shader_stage_attribs[producer], shaders[consumer], analyses[consumer]->inputs,
                                                       &shader_stage_attribs[consumer]);
 
             producer = consumer;
@@ -2431,20 +2980,18 @@ static bool validate_and_capture_pipeline_shader_state(layer_data *dev_data, PIP
     }
 
     if (shaders[fragment_stage] && shaders[fragment_stage]->has_valid_spirv) {
-        skip |= validate_fs_outputs_against_render_pass(dev_data->report_data, shaders[fragment_stage], entrypoints[fragment_stage],
-                                                        pPipeline->render_pass_ci.ptr(), pCreateInfo->subpass);
+        skip |= validate_fs_outputs_against_render_pass(dev_data->report_data, shaders[fragment_stage],
+                                                        analyses[fragment_stage]->outputs, pPipeline->render_pass_ci.ptr(),
+                                                        pCreateInfo->subpass);
     }
 
     return skip;
 }
 
-static bool validate_compute_pipeline(layer_data *dev_data, PIPELINE_STATE *pPipeline) {
+static bool validate_compute_pipeline(layer_data *dev_data, PIPELINE_STATE *pPipeline, shader_stage_analysis const &analysis) {
     auto pCreateInfo = pPipeline->computePipelineCI.ptr();
 
-    shader_module *module;
-    spirv_inst_iter entrypoint;
-
-    return validate_pipeline_shader_stage(dev_data, &pCreateInfo->stage, pPipeline, &module, &entrypoint);
+    return validate_pipeline_shader_stage(dev_data, &pCreateInfo->stage, pPipeline, analysis);
 }
 // Return Set node ptr for specified set or else NULL
 cvdescriptorset::DescriptorSet *GetSetNode(const layer_data *dev_data, VkDescriptorSet set) {
@@ -2608,6 +3155,56 @@ static bool ValidatePipelineDrawtimeState(layer_data const *dev_data, LAST_BOUND
     return skip;
 }
 
+// Check the image layouts of a descriptor set used by a draw right away, as they depend on the layouts cb_node has recorded
+// so far, and post the remaining draw-time checks of the set to the background validation thread. The deferred checks run
+// against the set and the resources it refers to as they are then, so they are dropped if the command buffer has been
+// reset or invalidated, the set updated or freed, or a resource destroyed in the meantime. If the thread is too far
+// behind to take them, all checks of the set run right away instead. function must be a literal.
+static bool ValidateDrawStateDeferred(layer_data *dev_data, GLOBAL_CB_NODE *cb_node, PIPELINE_STATE const *pipeline,
+                                      uint32_t set_index, cvdescriptorset::DescriptorSet *descriptor_set,
+                                      const std::vector<uint32_t> &dynamic_offsets, const char *function) {
+    bool skip = false;
+    auto set = descriptor_set->GetSet();
+    auto const &bindings = pipeline->active_slots.find(set_index)->second;
+
+    VkCommandBuffer command_buffer = cb_node->commandBuffer;
+    uint64_t recording_epoch = cb_node->recording_epoch;
+    uint64_t change_count = descriptor_set->GetChangeCount();
+    uint64_t resource_generation = dev_data->resource_generation;
+    // The pipeline is looked up again by the task rather than copying its bindings for every draw: destroying it
+    //  invalidates the command buffer it is bound to, which the epoch check below catches before pipeline is touched
+    bool posted = GetAsyncValidationQueue().post([=]() {
+        // Shared like the Cmd* entry points: descriptor sets and the objects they refer to only change with the lock held
+        //  exclusively, and nothing below reads command buffer state that is still being recorded
+        read_lock_guard lock(global_lock);
+        auto cb_state = GetCBNode(dev_data, command_buffer);
+        auto set_state = GetSetNode(dev_data, set);
+        if (!cb_state || cb_state->recording_epoch != recording_epoch || set_state != descriptor_set ||
+            set_state->GetChangeCount() != change_count || dev_data->resource_generation != resource_generation) {
+            return;
+        }
+        std::string error;
+        if (!set_state->ValidateDrawState(pipeline->active_slots.find(set_index)->second, dynamic_offsets, nullptr, function,
+                                          &error)) {
+            log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT,
+                    HandleToUint64(set), __LINE__, DRAWSTATE_DESCRIPTOR_SET_NOT_UPDATED, "DS",
+                    "Descriptor set 0x%" PRIxLEAST64
+                    " encountered the following validation error at %s time in command buffer 0x%p: %s",
+                    HandleToUint64(set), function, command_buffer, error.c_str());
+        }
+    });
+
+    std::string err_str;
+    if (posted ? !descriptor_set->ValidateDrawStateImageLayouts(bindings, cb_node, function, &err_str)
+               : !descriptor_set->ValidateDrawState(bindings, dynamic_offsets, cb_node, function, &err_str)) {
+        skip |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT,
+                        HandleToUint64(set), __LINE__, DRAWSTATE_DESCRIPTOR_SET_NOT_UPDATED, "DS",
+                        "Descriptor set 0x%" PRIxLEAST64 " encountered the following validation error at %s time: %s",
+                        HandleToUint64(set), function, err_str.c_str());
+    }
+    return skip;
+}
+
 // Validate overall state at the time of a draw call
 static bool ValidateDrawState(layer_data *dev_data, GLOBAL_CB_NODE *cb_node, const bool indexed,
                               const VkPipelineBindPoint bind_point, const char *function,
@@ -2654,6 +3251,11 @@ static bool ValidateDrawState(layer_data *dev_data, GLOBAL_CB_NODE *cb_node, con
             } else {  // Valid set is bound and layout compatible, validate that it's updated
                 // Pull the set node
                 cvdescriptorset::DescriptorSet *descriptor_set = state.boundDescriptorSets[setIndex];
+                if (dev_data->async_validation) {
+                    result |= ValidateDrawStateDeferred(dev_data, cb_node, pPipe, setIndex, descriptor_set,
+                                                        state.dynamicOffsets[setIndex], function);
+                    continue;
+                }
                 // Validate the draw-time state for this descriptor set
                 std::string err_str;
                 if (!descriptor_set->ValidateDrawState(set_binding_pair.second, state.dynamicOffsets[setIndex], cb_node, function,
@@ -2675,9 +3277,93 @@ static bool ValidateDrawState(layer_data *dev_data, GLOBAL_CB_NODE *cb_node, con
     return result;
 }
 
+// Return true if memo was captured from exactly the draw state cb_node now holds at bind_point
+static bool DrawStateMatchesMemo(layer_data const *dev_data, GLOBAL_CB_NODE const *cb_node, const bool indexed,
+                                 const VkPipelineBindPoint bind_point, DRAW_STATE_MEMO const &memo) {
+    auto const &state = cb_node->lastBound[bind_point];
+    if (!memo.valid || memo.indexed != indexed || memo.bound_generation != state.generation ||
+        memo.cb_generation != cb_node->draw_state_generation || memo.resource_generation != dev_data->resource_generation ||
+        memo.status != cb_node->status || memo.viewportMask != cb_node->viewportMask || memo.scissorMask != cb_node->scissorMask ||
+        memo.vertex_buffer_used != cb_node->vertex_buffer_used) {
+        return false;
+    }
+    // Same bindings and no set freed since, so the recorded sets are still the bound ones; make sure none was updated
+    for (auto const &set_change : memo.sets) {
+        if (set_change.first->GetChangeCount() != set_change.second) return false;
+    }
+    return true;
+}
+
+// Record the draw state cb_node now holds at bind_point into memo. Leaves memo invalid if a set the pipeline uses is not
+// bound, as the draw-time checks never pass then.
+static void CaptureDrawStateMemo(layer_data const *dev_data, GLOBAL_CB_NODE const *cb_node, const bool indexed,
+                                 const VkPipelineBindPoint bind_point, DRAW_STATE_MEMO *memo) {
+    auto const &state = cb_node->lastBound[bind_point];
+    memo->valid = false;
+    memo->sets.clear();
+    if (!state.pipeline_state) return;
+    if (VK_NULL_HANDLE != state.pipeline_layout.layout) {
+        for (const auto &set_binding_pair : state.pipeline_state->active_slots) {
+            uint32_t set_index = set_binding_pair.first;
+            if (state.boundDescriptorSets.size() <= set_index || !state.boundDescriptorSets[set_index]) return;
+            auto descriptor_set = state.boundDescriptorSets[set_index];
+            memo->sets.emplace_back(descriptor_set, descriptor_set->GetChangeCount());
+        }
+    }
+    memo->indexed = indexed;
+    memo->bound_generation = state.generation;
+    memo->cb_generation = cb_node->draw_state_generation;
+    memo->resource_generation = dev_data->resource_generation;
+    memo->status = cb_node->status;
+    memo->viewportMask = cb_node->viewportMask;
+    memo->scissorMask = cb_node->scissorMask;
+    memo->vertex_buffer_used = cb_node->vertex_buffer_used;
+    memo->valid = true;
+}
+
+// Return true if UpdateDrawState can record a draw with the state cb_node now holds at bind_point, i.e. a pipeline and
+// every set it uses are bound. Draws in recordings left out by validation sampling are still validated in full otherwise.
+static bool DrawStateIsRecordable(GLOBAL_CB_NODE const *cb_node, const VkPipelineBindPoint bind_point) {
+    auto const &state = cb_node->lastBound[bind_point];
+    if (!state.pipeline_state) return false;
+    if (VK_NULL_HANDLE == state.pipeline_layout.layout) return true;
+    for (const auto &set_binding_pair : state.pipeline_state->active_slots) {
+        uint32_t set_index = set_binding_pair.first;
+        if (state.boundDescriptorSets.size() <= set_index || !state.boundDescriptorSets[set_index]) return false;
+    }
+    return true;
+}
+
+// Run ValidateDrawState unless the draw state is unchanged since it last ran for this bind point and reported nothing
+static bool ValidateDrawStateIfChanged(layer_data *dev_data, GLOBAL_CB_NODE *cb_node, const bool indexed,
+                                       const VkPipelineBindPoint bind_point, const char *function,
+                                       UNIQUE_VALIDATION_ERROR_CODE const msg_code) {
+    auto &memo = cb_node->validated_draw_state[bind_point];
+    ++cb_node->draw_validations;
+    if (!cb_node->validation_sampled && DrawStateIsRecordable(cb_node, bind_point)) {
+        ++cb_node->draw_validations_unsampled;
+        return false;
+    }
+    if (DrawStateMatchesMemo(dev_data, cb_node, indexed, bind_point, memo)) {
+        ++cb_node->draw_validations_reused;
+        return false;
+    }
+    const uint64_t messages_before = log_msg_count();
+    bool skip = ValidateDrawState(dev_data, cb_node, indexed, bind_point, function, msg_code);
+    if (log_msg_count() == messages_before) {
+        CaptureDrawStateMemo(dev_data, cb_node, indexed, bind_point, &memo);
+    } else {
+        memo.valid = false;
+    }
+    return skip;
+}
+
 static void UpdateDrawState(layer_data *dev_data, GLOBAL_CB_NODE *cb_state, const VkPipelineBindPoint bind_point) {
     auto const &state = cb_state->lastBound[bind_point];
     PIPELINE_STATE *pPipe = state.pipeline_state;
+    // Binding the same sets to the CB again would change nothing. indexed plays no part here, so it is always recorded false.
+    auto &memo = cb_state->recorded_draw_state[bind_point];
+    if (DrawStateMatchesMemo(dev_data, cb_state, false, bind_point, memo)) return;
     if (VK_NULL_HANDLE != state.pipeline_layout.layout) {
         for (const auto &set_binding_pair : pPipe->active_slots) {
             uint32_t setIndex = set_binding_pair.first;
@@ -2692,6 +3378,7 @@ static void UpdateDrawState(layer_data *dev_data, GLOBAL_CB_NODE *cb_state, cons
     if (pPipe->vertexBindingDescriptions.size() > 0) {
         cb_state->vertex_buffer_used = true;
     }
+    CaptureDrawStateMemo(dev_data, cb_state, false, bind_point, &memo);
 }
 
 // Validate HW line width capabilities prior to setting requested line width.
@@ -2723,7 +3410,8 @@ static bool verifyLineWidth(layer_data *dev_data, DRAW_STATE_ERROR dsError, Vulk
 }
 
 // Verify that create state for a pipeline is valid
-static bool verifyPipelineCreateState(layer_data *dev_data, std::vector<PIPELINE_STATE *> pPipelines, int pipelineIndex) {
+static bool verifyPipelineCreateState(layer_data *dev_data, std::vector<PIPELINE_STATE *> const &pPipelines, int pipelineIndex,
+                                      std::vector<shader_stage_analysis> const &stages) {
     bool skip = false;
 
     PIPELINE_STATE *pPipeline = pPipelines[pipelineIndex];
@@ -2816,7 +3504,7 @@ static bool verifyPipelineCreateState(layer_data *dev_data, std::vector<PIPELINE
                         validation_error_map[VALIDATION_ERROR_096005ee]);
     }
 
-    if (!GetDisables(dev_data)->shader_validation && validate_and_capture_pipeline_shader_state(dev_data, pPipeline)) {
+    if (!GetDisables(dev_data)->shader_validation && validate_and_capture_pipeline_shader_state(dev_data, pPipeline, stages)) {
         skip = true;
     }
     // Each shader's stage must be unique
@@ -3001,7 +3689,7 @@ static bool validateIdleDescriptorSet(const layer_data *dev_data, VkDescriptorSe
                         HandleToUint64(set));
     } else {
         // TODO : This covers various error cases so should pass error enum into this function and use passed in enum here
-        if (set_node->second->in_use.load()) {
+        if (IsObjectInUse(set_node->second, {HandleToUint64(set), kVulkanObjectTypeDescriptorSet})) {
             skip |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT,
                             HandleToUint64(set), __LINE__, VALIDATION_ERROR_2860026a, "DS",
                             "Cannot call %s() on descriptor set 0x%" PRIxLEAST64 " that is in use by a command buffer. %s",
@@ -3015,6 +3703,7 @@ static bool validateIdleDescriptorSet(const layer_data *dev_data, VkDescriptorSe
 static void freeDescriptorSet(layer_data *dev_data, cvdescriptorset::DescriptorSet *descriptor_set) {
     dev_data->setMap.erase(descriptor_set->GetSet());
     delete descriptor_set;
+    ++dev_data->resource_generation;
 }
 // Free all DS Pools including their Sets & related sub-structs
 // NOTE : Calls to this function should be wrapped in mutex
@@ -3026,6 +3715,7 @@ static void deletePools(layer_data *dev_data) {
             freeDescriptorSet(dev_data, ds);
         }
         (*ii).second->sets.clear();
+        delete (*ii).second;
     }
     dev_data->descriptorPoolMap.clear();
 }
@@ -3210,8 +3900,8 @@ BASE_NODE *GetStateStructPtrFromObject(layer_data *dev_data, VK_OBJECT object_st
 // Tie the VK_OBJECT to the cmd buffer which includes:
 //  Add object_binding to cmd buffer
 //  Add cb_binding to object
-static void addCommandBufferBinding(std::unordered_set<GLOBAL_CB_NODE *> *cb_bindings, VK_OBJECT obj, GLOBAL_CB_NODE *cb_node) {
-    cb_bindings->insert(cb_node);
+static void addCommandBufferBinding(BASE_NODE *base_obj, VK_OBJECT obj, GLOBAL_CB_NODE *cb_node) {
+    base_obj->AddBoundCommandBuffer(cb_node);
     cb_node->object_bindings.insert(obj);
 }
 // For a given object, if cb_node is in that objects cb_bindings, remove cb_node
@@ -3225,6 +3915,7 @@ static void resetCB(layer_data *dev_data, const VkCommandBuffer cb) {
     GLOBAL_CB_NODE *pCB = dev_data->commandBufferMap[cb];
     if (pCB) {
         pCB->in_use.store(0);
+        pCB->recording_epoch = ++recording_epochs;
         pCB->last_cmd = CMD_NONE;
         // Reset CB state (note that createInfo is not cleared)
         pCB->commandBuffer = cb;
@@ -3246,15 +3937,9 @@ static void resetCB(layer_data *dev_data, const VkCommandBuffer cb) {
         pCB->activeSubpassContents = VK_SUBPASS_CONTENTS_INLINE;
         pCB->activeSubpass = 0;
         pCB->broken_bindings.clear();
-        pCB->waitedEvents.clear();
         pCB->events.clear();
         pCB->writeEventsBeforeWait.clear();
         pCB->waitedEventsBeforeQueryReset.clear();
-        pCB->queryToStateMap.clear();
-        pCB->activeQueries.clear();
-        pCB->startedQueries.clear();
-        pCB->imageLayoutMap.clear();
-        pCB->eventToStageMap.clear();
         pCB->drawData.clear();
         pCB->currentDrawData.buffers.clear();
         pCB->vertex_buffer_used = false;
@@ -3271,8 +3956,6 @@ static void resetCB(layer_data *dev_data, const VkCommandBuffer cb) {
             pSubCB->linkedCommandBuffers.erase(pCB);
         }
         pCB->linkedCommandBuffers.clear();
-        pCB->updateImages.clear();
-        pCB->updateBuffers.clear();
         clear_cmd_buf_and_mem_references(dev_data, pCB);
         pCB->eventUpdates.clear();
         pCB->queryUpdates.clear();
@@ -3281,14 +3964,27 @@ static void resetCB(layer_data *dev_data, const VkCommandBuffer cb) {
         for (auto obj : pCB->object_bindings) {
             removeCommandBufferBinding(dev_data, &obj, pCB);
         }
-        pCB->object_bindings.clear();
         // Remove this cmdBuffer's reference from each FrameBuffer's CB ref list
         for (auto framebuffer : pCB->framebuffers) {
             auto fb_state = GetFramebufferState(dev_data, framebuffer);
             if (fb_state) fb_state->cb_bindings.erase(pCB);
         }
-        pCB->framebuffers.clear();
         pCB->activeFramebuffer = VK_NULL_HANDLE;
+        // Rather than freeing the recorded sets and maps node by node, discard them with the arena that backs them
+        dev_data->cb_state_allocations += pCB->recording_arena.allocations();
+        dev_data->cb_state_system_allocations += pCB->recording_arena.system_allocations();
+        pCB->RewindArena();
+        dev_data->draw_validations += pCB->draw_validations;
+        dev_data->draw_validations_reused += pCB->draw_validations_reused;
+        dev_data->draw_validations_unsampled += pCB->draw_validations_unsampled;
+        pCB->draw_validations = 0;
+        pCB->draw_validations_reused = 0;
+        pCB->draw_validations_unsampled = 0;
+        ++pCB->draw_state_generation;
+        for (uint32_t i = 0; i < VK_PIPELINE_BIND_POINT_RANGE_SIZE; ++i) {
+            pCB->validated_draw_state[i].valid = false;
+            pCB->recorded_draw_state[i].valid = false;
+        }
     }
 }
 
@@ -3428,7 +4124,10 @@ VKAPI_ATTR void VKAPI_CALL DestroyInstance(VkInstance instance, const VkAllocati
     instance_layer_data *instance_data = GetLayerDataPtr(key, instance_layer_data_map);
     instance_data->dispatch_table.DestroyInstance(instance, pAllocator);
 
-    std::lock_guard<std::mutex> lock(global_lock);
+    std::lock_guard<rw_lock> lock(global_lock);
+    // Counts of held back messages go to the layer's own callbacks too, so report them first
+    report_suppressed_log_msgs(instance_data->report_data);
+
     // Clean up logging callback, if any
     while (instance_data->logging_callback.size() > 0) {
         VkDebugReportCallbackEXT callback = instance_data->logging_callback.back();
@@ -3436,6 +4135,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyInstance(VkInstance instance, const VkAllocati
         instance_data->logging_callback.pop_back();
     }
 
+    layer_flush_async_logs();
     layer_debug_report_destroy_instance(instance_data->report_data);
     layer_data_map.erase(key);
 }
@@ -3551,7 +4251,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateDevice(VkPhysicalDevice gpu, const VkDevice
     bool skip = false;
     instance_layer_data *instance_data = GetLayerDataPtr(get_dispatch_key(gpu), instance_layer_data_map);
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     auto pd_state = GetPhysicalDeviceState(instance_data, gpu);
 
     // TODO: object_tracker should perhaps do this instead
@@ -3597,6 +4297,8 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateDevice(VkPhysicalDevice gpu, const VkDevice
     device_data->instance_data = instance_data;
     // Setup device dispatch table
     layer_init_device_dispatch_table(*pDevice, &device_data->dispatch_table, fpGetDeviceProcAddr);
+    layer_profiler::get().configure("lunarg_core_validation");
+    layer_profiler::get().wrap_dispatch_table(*pDevice, &device_data->dispatch_table);
     device_data->device = *pDevice;
     // Save PhysicalDevice handle
     device_data->physical_device = gpu;
@@ -3619,8 +4321,19 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateDevice(VkPhysicalDevice gpu, const VkDevice
     // Store physical device properties and physical device mem limits into device layer_data structs
     instance_data->dispatch_table.GetPhysicalDeviceMemoryProperties(gpu, &device_data->phys_dev_mem_props);
     instance_data->dispatch_table.GetPhysicalDeviceProperties(gpu, &device_data->phys_dev_props);
+    // vkQueueSubmit checks the command buffers of a submission on the validation worker threads when
+    // lunarg_core_validation.parallel_submit_validation is set to true
+    device_data->parallel_submit_validation = LayerOptionEnabled("lunarg_core_validation.parallel_submit_validation");
+    // Draw-time descriptor set checks that don't depend on the command buffer's recorded state are handed to a background
+    // thread when lunarg_core_validation.async_validation is set to true
+    device_data->async_validation = LayerOptionEnabled("lunarg_core_validation.async_validation");
+    device_data->validation_sample_rate = ReadValidationSampleRate();
     lock.unlock();
 
+    shader_cache.Load(device_data->report_data);
+    AcquireValidationThreadPool();
+    if (device_data->async_validation) AcquireAsyncValidationQueue();
+    device_data->queue_trace = AcquireQueueTrace();
     ValidateLayerOrdering(*pCreateInfo);
 
     return result;
@@ -3632,8 +4345,10 @@ VKAPI_ATTR void VKAPI_CALL DestroyDevice(VkDevice device, const VkAllocationCall
     bool skip = false;
     dispatch_key key = get_dispatch_key(device);
     layer_data *dev_data = GetLayerDataPtr(key, layer_data_map);
+    // Deferred checks take global_lock and refer to this device's state, so let them finish first
+    if (dev_data->async_validation) GetAsyncValidationQueue().drain();
     // Free all the memory
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     deletePipelines(dev_data);
     dev_data->renderPassMap.clear();
     for (auto ii = dev_data->commandBufferMap.begin(); ii != dev_data->commandBufferMap.end(); ++ii) {
@@ -3650,21 +4365,26 @@ VKAPI_ATTR void VKAPI_CALL DestroyDevice(VkDevice device, const VkAllocationCall
     dev_data->descriptorSetLayoutMap.clear();
     dev_data->imageViewMap.clear();
     dev_data->imageMap.clear();
-    dev_data->imageSubresourceMap.clear();
-    dev_data->imageLayoutMap.clear();
     dev_data->bufferViewMap.clear();
     dev_data->bufferMap.clear();
     // Queues persist until device is destroyed
+    dev_data->queue_states.clear();
     dev_data->queueMap.clear();
+    shader_cache.Save(dev_data->report_data);
     // Report any memory leaks
     layer_debug_report_destroy_device(device);
     lock.unlock();
+    ReleaseValidationThreadPool();
+    if (dev_data->async_validation) ReleaseAsyncValidationQueue();
+    queue_traces.release(dev_data->queue_trace);
+    dev_data->queue_trace = nullptr;
 
 #if DISPATCH_MAP_DEBUG
     fprintf(stderr, "Device: 0x%p, key: 0x%p\n", device, key);
 #endif
     if (!skip) {
         dev_data->dispatch_table.DestroyDevice(device, pAllocator);
+        layer_profiler::get().device_destroyed(device);
         layer_data_map.erase(key);
     }
 }
@@ -3695,105 +4415,121 @@ static bool ValidateStageMaskGsTsEnables(layer_data *dev_data, VkPipelineStageFl
     return skip;
 }
 
-// Loop through bound objects and increment their in_use counts.
-static void IncrementBoundObjects(layer_data *dev_data, GLOBAL_CB_NODE const *cb_node) {
-    for (auto obj : cb_node->object_bindings) {
-        auto base_obj = GetStateStructPtrFromObject(dev_data, obj);
-        if (base_obj) {
-            base_obj->in_use.fetch_add(1);
-        }
-    }
-}
-// Track which resources are in-flight by atomically incrementing their "in_use" count
+// Track which resources are in-flight by incrementing the command buffer's "in_use" count. Objects bound to the command
+// buffer are not touched; IsObjectInUse() finds them through their cb_bindings, so submit costs the same no matter how
+// many objects the command buffer references.
 static void incrementResources(layer_data *dev_data, GLOBAL_CB_NODE *cb_node) {
     cb_node->submitCount++;
     cb_node->in_use.fetch_add(1);
 
-    // First Increment for all "generic" objects bound to cmd buffer, followed by special-case objects below
-    IncrementBoundObjects(dev_data, cb_node);
-    // TODO : We should be able to remove the NULL look-up checks from the code below as long as
-    //  all the corresponding cases are verified to cause CB_INVALID state and the CB_INVALID state
-    //  should then be flagged prior to calling this function
-    for (auto drawDataElement : cb_node->drawData) {
-        for (auto buffer : drawDataElement.buffers) {
-            auto buffer_state = GetBufferState(dev_data, buffer);
-            if (buffer_state) {
-                buffer_state->in_use.fetch_add(1);
-            }
-        }
-    }
     for (auto event : cb_node->writeEventsBeforeWait) {
         auto event_state = GetEventNode(dev_data, event);
         if (event_state) event_state->write_in_use++;
     }
 }
 
-// Note: This function assumes that the global lock is held by the calling thread.
-// For the given queue, verify the queue state up to the given seq number.
+// Submission on pQueue that completes at seq, or nullptr if it has already been retired
+static CB_SUBMISSION *GetSubmission(QUEUE_STATE *pQueue, uint64_t seq) {
+    if (seq <= pQueue->seq || seq > pQueue->seq + pQueue->submissions.size()) return nullptr;
+    return &pQueue->submissions[seq - pQueue->seq - 1];
+}
+
+// Append a submission to pQueue and stamp its vector clock: this queue's new seq, merged with the clocks of the previous
+// submission on this queue and of every submission that signals a semaphore waited on here. Dependencies are resolved
+// once, at submit time, so later waits never have to chase semaphores from queue to queue.
+static void RecordSubmission(layer_data *dev_data, QUEUE_STATE *pQueue, std::vector<VkCommandBuffer> const &cbs,
+                             std::vector<SEMAPHORE_WAIT> const &waitSemaphores, std::vector<VkSemaphore> const &signalSemaphores,
+                             VkFence fence) {
+    std::vector<uint64_t> clock(dev_data->queue_states.size(), 0);
+    auto merge = [&clock](std::vector<uint64_t> const &other) {
+        for (size_t i = 0; i < other.size(); ++i) clock[i] = std::max(clock[i], other[i]);
+    };
+
+    if (!pQueue->submissions.empty()) merge(pQueue->submissions.back().clock);
+    for (auto &wait : waitSemaphores) {
+        auto other_queue = GetQueueState(dev_data, wait.queue);
+        if (!other_queue) continue;
+        clock[other_queue->index] = std::max(clock[other_queue->index], wait.seq);
+        auto signaler = GetSubmission(other_queue, wait.seq);
+        if (signaler) merge(signaler->clock);
+    }
+
+    pQueue->submissions.emplace_back(cbs, waitSemaphores, signalSemaphores, fence);
+    const uint64_t seq = pQueue->seq + pQueue->submissions.size();
+    clock[pQueue->index] = seq;
+    pQueue->submissions.back().clock = std::move(clock);
+
+    auto trace = GetQueueTrace(dev_data);
+    if (trace) {
+        // The submission's span on its queue lasts until the layer learns that it has completed
+        std::string waits, signals;
+        for (auto &wait : waitSemaphores) {
+            trace_args wait_args;
+            wait_args.AddHandle("semaphore", HandleToUint64(wait.semaphore))
+                .AddHandle("signaled_on", HandleToUint64(wait.queue))
+                .Add("signal_seq", wait.seq);
+            waits += (waits.empty() ? "{" : ",{") + wait_args.str() + "}";
+        }
+        for (auto semaphore : signalSemaphores) {
+            trace_args signal_args;
+            signal_args.AddHandle("semaphore", HandleToUint64(semaphore));
+            signals += (signals.empty() ? "{" : ",{") + signal_args.str() + "}";
+        }
+        trace_args args;
+        args.Add("seq", seq)
+            .Add("command_buffers", cbs.size())
+            .AddJson("waits", "[" + waits + "]")
+            .AddJson("signals", "[" + signals + "]")
+            .AddHandle("fence", HandleToUint64(fence));
+        trace->begin_span(pQueue->queue, "submission", seq, args.str());
+    }
+}
+
+// Verify the not yet retired submissions on a single queue, up to the given seq number.
 // Currently the only check is to make sure that if there are events to be waited on prior to
 //  a QueryReset, make sure that all such events have been signalled.
-static bool VerifyQueueStateToSeq(layer_data *dev_data, QUEUE_STATE *initial_queue, uint64_t initial_seq) {
+static bool VerifyQueueSubmissions(layer_data *dev_data, QUEUE_STATE *queue, uint64_t target_seq) {
     bool skip = false;
+    auto seq = queue->seq;
+    auto sub_it = queue->submissions.begin();
 
-    // sequence number we want to validate up to, per queue
-    std::unordered_map<QUEUE_STATE *, uint64_t> target_seqs { { initial_queue, initial_seq } };
-    // sequence number we've completed validation for, per queue
-    std::unordered_map<QUEUE_STATE *, uint64_t> done_seqs;
-    std::vector<QUEUE_STATE *> worklist { initial_queue };
-
-    while (worklist.size()) {
-        auto queue = worklist.back();
-        worklist.pop_back();
-
-        auto target_seq = target_seqs[queue];
-        auto seq = std::max(done_seqs[queue], queue->seq);
-        auto sub_it = queue->submissions.begin() + int(seq - queue->seq);  // seq >= queue->seq
-
-        for (; seq < target_seq; ++sub_it, ++seq) {
-            for (auto &wait : sub_it->waitSemaphores) {
-                auto other_queue = GetQueueState(dev_data, wait.queue);
-
-                if (other_queue == queue)
-                    continue;   // semaphores /always/ point backwards, so no point here.
-
-                auto other_target_seq = std::max(target_seqs[other_queue], wait.seq);
-                auto other_done_seq = std::max(done_seqs[other_queue], other_queue->seq);
-
-                // if this wait is for another queue, and covers new sequence
-                // numbers beyond what we've already validated, mark the new
-                // target seq and (possibly-re)add the queue to the worklist.
-                if (other_done_seq < other_target_seq) {
-                    target_seqs[other_queue] = other_target_seq;
-                    worklist.push_back(other_queue);
-                }
-            }
-
-            for (auto cb : sub_it->cbs) {
-                auto cb_node = GetCBNode(dev_data, cb);
-                if (cb_node) {
-                    for (auto queryEventsPair : cb_node->waitedEventsBeforeQueryReset) {
-                        for (auto event : queryEventsPair.second) {
-                            if (dev_data->eventMap[event].needsSignaled) {
-                                skip |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
-                                                VK_DEBUG_REPORT_OBJECT_TYPE_QUERY_POOL_EXT, 0, 0, DRAWSTATE_INVALID_QUERY, "DS",
-                                                "Cannot get query results on queryPool 0x%" PRIx64
-                                                " with index %d which was guarded by unsignaled event 0x%" PRIx64 ".",
-                                                HandleToUint64(queryEventsPair.first.pool), queryEventsPair.first.index,
-                                                HandleToUint64(event));
-                            }
+    for (; seq < target_seq; ++sub_it, ++seq) {
+        for (auto cb : sub_it->cbs) {
+            auto cb_node = GetCBNode(dev_data, cb);
+            if (cb_node) {
+                for (auto queryEventsPair : cb_node->waitedEventsBeforeQueryReset) {
+                    for (auto event : queryEventsPair.second) {
+                        if (dev_data->eventMap[event].needsSignaled) {
+                            skip |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                                            VK_DEBUG_REPORT_OBJECT_TYPE_QUERY_POOL_EXT, 0, 0, DRAWSTATE_INVALID_QUERY, "DS",
+                                            "Cannot get query results on queryPool 0x%" PRIx64
+                                            " with index %d which was guarded by unsignaled event 0x%" PRIx64 ".",
+                                            HandleToUint64(queryEventsPair.first.pool), queryEventsPair.first.index,
+                                            HandleToUint64(event));
                         }
                     }
                 }
             }
         }
-
-        // finally mark the point we've now validated this queue to.
-        done_seqs[queue] = seq;
     }
 
     return skip;
 }
 
+// Note: This function assumes that the global lock is held by the calling thread.
+// For the given queue, verify the queue state up to the given seq number, along with everything on other queues that
+// those submissions wait on. The target submission's vector clock names exactly how far to go on each queue.
+static bool VerifyQueueStateToSeq(layer_data *dev_data, QUEUE_STATE *queue, uint64_t seq) {
+    auto target = GetSubmission(queue, std::min<uint64_t>(seq, queue->seq + queue->submissions.size()));
+    if (!target) return false;
+
+    bool skip = false;
+    for (size_t i = 0; i < target->clock.size(); ++i) {
+        skip |= VerifyQueueSubmissions(dev_data, dev_data->queue_states[i], target->clock[i]);
+    }
+    return skip;
+}
+
 // When the given fence is retired, verify outstanding queue operations through the point of the fence
 static bool VerifyQueueStateToFence(layer_data *dev_data, VkFence fence) {
     auto fence_state = GetFenceNode(dev_data, fence);
@@ -3803,21 +4539,8 @@ static bool VerifyQueueStateToFence(layer_data *dev_data, VkFence fence) {
     return false;
 }
 
-// Decrement in-use count for objects bound to command buffer
-static void DecrementBoundResources(layer_data *dev_data, GLOBAL_CB_NODE const *cb_node) {
-    BASE_NODE *base_obj = nullptr;
-    for (auto obj : cb_node->object_bindings) {
-        base_obj = GetStateStructPtrFromObject(dev_data, obj);
-        if (base_obj) {
-            base_obj->in_use.fetch_sub(1);
-        }
-    }
-}
-
-static void RetireWorkOnQueue(layer_data *dev_data, QUEUE_STATE *pQueue, uint64_t seq) {
-    std::unordered_map<VkQueue, uint64_t> otherQueueSeqs;
-
-    // Roll this queue forward, one submission at a time.
+// Roll a single queue forward to seq, one submission at a time.
+static void RetireSubmissionsOnQueue(layer_data *dev_data, QUEUE_STATE *pQueue, uint64_t seq) {
     while (pQueue->seq < seq) {
         auto &submission = pQueue->submissions.front();
 
@@ -3826,8 +4549,6 @@ static void RetireWorkOnQueue(layer_data *dev_data, QUEUE_STATE *pQueue, uint64_
             if (pSemaphore) {
                 pSemaphore->in_use.fetch_sub(1);
             }
-            auto &lastSeq = otherQueueSeqs[wait.queue];
-            lastSeq = std::max(lastSeq, wait.seq);
         }
 
         for (auto &semaphore : submission.signalSemaphores) {
@@ -3842,16 +4563,6 @@ static void RetireWorkOnQueue(layer_data *dev_data, QUEUE_STATE *pQueue, uint64_
             if (!cb_node) {
                 continue;
             }
-            // First perform decrement on general case bound objects
-            DecrementBoundResources(dev_data, cb_node);
-            for (auto drawDataElement : cb_node->drawData) {
-                for (auto buffer : drawDataElement.buffers) {
-                    auto buffer_state = GetBufferState(dev_data, buffer);
-                    if (buffer_state) {
-                        buffer_state->in_use.fetch_sub(1);
-                    }
-                }
-            }
             for (auto event : cb_node->writeEventsBeforeWait) {
                 auto eventNode = dev_data->eventMap.find(event);
                 if (eventNode != dev_data->eventMap.end()) {
@@ -3873,13 +4584,24 @@ static void RetireWorkOnQueue(layer_data *dev_data, QUEUE_STATE *pQueue, uint64_
             pFence->state = FENCE_RETIRED;
         }
 
+        auto trace = GetQueueTrace(dev_data);
+        if (trace) trace->end_span(pQueue->queue, "submission", pQueue->seq + 1, "");
+
         pQueue->submissions.pop_front();
         pQueue->seq++;
     }
+}
+
+// Retire the work on pQueue through seq, and on every other queue whatever that work waited on, in a single pass over
+// the vector clock of the submission completing at seq.
+static void RetireWorkOnQueue(layer_data *dev_data, QUEUE_STATE *pQueue, uint64_t seq) {
+    auto target = GetSubmission(pQueue, std::min<uint64_t>(seq, pQueue->seq + pQueue->submissions.size()));
+    if (!target) return;
 
-    // Roll other queues forward to the highest seq we saw a wait for
-    for (auto qs : otherQueueSeqs) {
-        RetireWorkOnQueue(dev_data, GetQueueState(dev_data, qs.first), qs.second);
+    // The target is popped off its queue as it retires, so take its clock first
+    std::vector<uint64_t> clock = std::move(target->clock);
+    for (size_t i = 0; i < clock.size(); ++i) {
+        RetireSubmissionsOnQueue(dev_data, dev_data->queue_states[i], clock[i]);
     }
 }
 
@@ -4123,17 +4845,53 @@ static void PostCallRecordQueueSubmit(layer_data *dev_data, VkQueue queue, uint3
                 }
             }
         }
-        pQueue->submissions.emplace_back(cbs, semaphore_waits, semaphore_signals,
-                                         submit_idx == submitCount - 1 ? fence : VK_NULL_HANDLE);
+        RecordSubmission(dev_data, pQueue, cbs, semaphore_waits, semaphore_signals,
+                         submit_idx == submitCount - 1 ? fence : VK_NULL_HANDLE);
     }
 
     if (pFence && !submitCount) {
         // If no submissions, but just dropping a fence on the end of the queue,
         // record an empty submission with just the fence, so we can determine
         // its completion.
-        pQueue->submissions.emplace_back(std::vector<VkCommandBuffer>(), std::vector<SEMAPHORE_WAIT>(), std::vector<VkSemaphore>(),
-                                         fence);
+        RecordSubmission(dev_data, pQueue, std::vector<VkCommandBuffer>(), std::vector<SEMAPHORE_WAIT>(),
+                         std::vector<VkSemaphore>(), fence);
+    }
+}
+
+// Checks of one submitted primary command buffer that only read layer state, so that vkQueueSubmit can run them for
+// several command buffers at once
+static bool ValidateSubmittedCommandBuffer(layer_data *dev_data, GLOBAL_CB_NODE *cb_node, int current_submit_count,
+                                           VkQueue queue) {
+    bool skip = validatePrimaryCommandBufferState(dev_data, cb_node, current_submit_count);
+    skip |= validateQueueFamilyIndices(dev_data, cb_node, queue);
+    return skip;
+}
+
+// Run ValidateSubmittedCommandBuffer for every command buffer of a submission on the validation worker threads.
+// deferred[i] receives the messages for the i-th command buffer, in submission order.
+static void ValidateSubmittedCommandBuffersInParallel(layer_data *dev_data, VkQueue queue, uint32_t submitCount,
+                                                      const VkSubmitInfo *pSubmits,
+                                                      vector<vector<deferred_log_msg>> *deferred) {
+    vector<std::pair<GLOBAL_CB_NODE *, int>> cb_nodes;
+    vector<VkCommandBuffer> current_cmds;
+    for (uint32_t submit_idx = 0; submit_idx < submitCount; submit_idx++) {
+        const VkSubmitInfo *submit = &pSubmits[submit_idx];
+        for (uint32_t i = 0; i < submit->commandBufferCount; i++) {
+            auto cb_node = GetCBNode(dev_data, submit->pCommandBuffers[i]);
+            if (cb_node) {
+                current_cmds.push_back(submit->pCommandBuffers[i]);
+                cb_nodes.emplace_back(cb_node,
+                                      (int)std::count(current_cmds.begin(), current_cmds.end(), submit->pCommandBuffers[i]));
+            }
+        }
     }
+
+    deferred->resize(cb_nodes.size());
+    GetValidationThreadPool().parallel_for(cb_nodes.size(), [dev_data, queue, &cb_nodes, deferred](size_t i) {
+        deferred_log_msgs() = &(*deferred)[i];
+        ValidateSubmittedCommandBuffer(dev_data, cb_nodes[i].first, cb_nodes[i].second, queue);
+        deferred_log_msgs() = nullptr;
+    });
 }
 
 static bool PreCallValidateQueueSubmit(layer_data *dev_data, VkQueue queue, uint32_t submitCount, const VkSubmitInfo *pSubmits,
@@ -4144,10 +4902,21 @@ static bool PreCallValidateQueueSubmit(layer_data *dev_data, VkQueue queue, uint
         return true;
     }
 
+    // The read-only checks of each command buffer may run up front on the worker threads. Their messages are held back
+    // and reported below, at the point where each command buffer would have been checked, so the output and the early
+    // exit behave as when the checks run inline. Image layouts, the submit-time functions and the event and query updates
+    // change state that later command buffers in the submission depend on, so they always run here, in order.
+    vector<vector<deferred_log_msg>> deferred;
+    if (dev_data->parallel_submit_validation) {
+        ValidateSubmittedCommandBuffersInParallel(dev_data, queue, submitCount, pSubmits, &deferred);
+    }
+    size_t cb_index = 0;
+
     unordered_set<VkSemaphore> signaled_semaphores;
     unordered_set<VkSemaphore> unsignaled_semaphores;
     vector<VkCommandBuffer> current_cmds;
-    unordered_map<ImageSubresourcePair, IMAGE_LAYOUT_NODE> localImageLayoutMap = dev_data->imageLayoutMap;
+    // Layouts as they will be after the command buffers validated so far, for the images this submission uses
+    unordered_map<VkImage, IMAGE_LAYOUT_MAP> localImageLayoutMap;
     // Now verify each individual submit
     for (uint32_t submit_idx = 0; submit_idx < submitCount; submit_idx++) {
         const VkSubmitInfo *submit = &pSubmits[submit_idx];
@@ -4190,9 +4959,13 @@ static bool PreCallValidateQueueSubmit(layer_data *dev_data, VkQueue queue, uint
             if (cb_node) {
                 skip |= ValidateCmdBufImageLayouts(dev_data, cb_node, localImageLayoutMap);
                 current_cmds.push_back(submit->pCommandBuffers[i]);
-                skip |= validatePrimaryCommandBufferState(
-                    dev_data, cb_node, (int)std::count(current_cmds.begin(), current_cmds.end(), submit->pCommandBuffers[i]));
-                skip |= validateQueueFamilyIndices(dev_data, cb_node, queue);
+                if (deferred.empty()) {
+                    skip |= ValidateSubmittedCommandBuffer(
+                        dev_data, cb_node, (int)std::count(current_cmds.begin(), current_cmds.end(), submit->pCommandBuffers[i]),
+                        queue);
+                } else {
+                    skip |= report_deferred_log_msgs(deferred[cb_index++]);
+                }
 
                 // Potential early exit here as bad object state may crash in delayed function calls
                 if (skip) {
@@ -4217,7 +4990,11 @@ static bool PreCallValidateQueueSubmit(layer_data *dev_data, VkQueue queue, uint
 
 VKAPI_ATTR VkResult VKAPI_CALL QueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo *pSubmits, VkFence fence) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(queue), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    traced_call trace(dev_data, "vkQueueSubmit");
+    trace.args().AddHandle("queue", HandleToUint64(queue)).Add("submitCount", submitCount).AddHandle("fence", HandleToUint64(fence));
+    // Report the deferred draw-time checks of the command buffers before they are submitted
+    if (dev_data->async_validation) GetAsyncValidationQueue().drain();
+    std::unique_lock<rw_lock> lock(global_lock);
 
     bool skip = PreCallValidateQueueSubmit(dev_data, queue, submitCount, pSubmits, fence);
     lock.unlock();
@@ -4225,6 +5002,7 @@ VKAPI_ATTR VkResult VKAPI_CALL QueueSubmit(VkQueue queue, uint32_t submitCount,
     if (skip) return VK_ERROR_VALIDATION_FAILED_EXT;
 
     VkResult result = dev_data->dispatch_table.QueueSubmit(queue, submitCount, pSubmits, fence);
+    trace.args().Add("result", result);
 
     lock.lock();
     PostCallRecordQueueSubmit(dev_data, queue, submitCount, pSubmits, fence);
@@ -4253,7 +5031,7 @@ VKAPI_ATTR VkResult VKAPI_CALL AllocateMemory(VkDevice device, const VkMemoryAll
                                               const VkAllocationCallbacks *pAllocator, VkDeviceMemory *pMemory) {
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateAllocateMemory(dev_data);
     if (!skip) {
         lock.unlock();
@@ -4266,12 +5044,24 @@ VKAPI_ATTR VkResult VKAPI_CALL AllocateMemory(VkDevice device, const VkMemoryAll
     return result;
 }
 
+// An object is in use while it is referenced by a pending submission: either directly, as semaphores are, or through a
+// command buffer it is bound to that is in flight. Only command buffers are counted at submit and retire, so bound objects
+// are checked here by walking their cb_bindings. Memory objects also carry cb_bindings but have never been part of a command
+// buffer's object_bindings, so the bound command buffer must list the object itself.
+bool IsObjectInUse(BASE_NODE const *obj_node, VK_OBJECT obj_struct) {
+    if (obj_node->in_use.load()) return true;
+    for (auto cb_node : obj_node->cb_bindings) {
+        if (cb_node->in_use.load() && cb_node->object_bindings.count(obj_struct)) return true;
+    }
+    return false;
+}
+
 // For given obj node, if it is use, flag a validation error and return callback result, else return false
 bool ValidateObjectNotInUse(const layer_data *dev_data, BASE_NODE *obj_node, VK_OBJECT obj_struct,
                             UNIQUE_VALIDATION_ERROR_CODE error_code) {
     if (dev_data->instance_data->disabled.object_in_use) return false;
     bool skip = false;
-    if (obj_node->in_use.load()) {
+    if (IsObjectInUse(obj_node, obj_struct)) {
         skip |=
             log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, get_debug_report_enum[obj_struct.type], obj_struct.handle,
                     __LINE__, error_code, "DS", "Cannot delete %s 0x%" PRIx64 " that is currently in use by a command buffer. %s",
@@ -4318,13 +5108,14 @@ static void PostCallRecordFreeMemory(layer_data *dev_data, VkDeviceMemory mem, D
     // Any bound cmd buffers are now invalid
     invalidateCommandBuffers(dev_data, mem_info->cb_bindings, obj_struct);
     dev_data->memObjMap.erase(mem);
+    ++dev_data->resource_generation;
 }
 
 VKAPI_ATTR void VKAPI_CALL FreeMemory(VkDevice device, VkDeviceMemory mem, const VkAllocationCallbacks *pAllocator) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     DEVICE_MEM_INFO *mem_info = nullptr;
     VK_OBJECT obj_struct;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateFreeMemory(dev_data, mem, &mem_info, &obj_struct);
     if (!skip) {
         lock.unlock();
@@ -4508,13 +5299,22 @@ static void PostCallRecordWaitForFences(layer_data *dev_data, uint32_t fence_cou
 VKAPI_ATTR VkResult VKAPI_CALL WaitForFences(VkDevice device, uint32_t fenceCount, const VkFence *pFences, VkBool32 waitAll,
                                              uint64_t timeout) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
+    traced_call trace(dev_data, "vkWaitForFences");
+    if (GetQueueTrace(dev_data)) {
+        std::string fences;
+        for (uint32_t i = 0; i < fenceCount; ++i) {
+            fences += (i ? "," : "") + trace_args::Handle(HandleToUint64(pFences[i]));
+        }
+        trace.args().AddJson("fences", "[" + fences + "]").Add("waitAll", waitAll);
+    }
     // Verify fence status of submitted fences
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateWaitForFences(dev_data, fenceCount, pFences);
     lock.unlock();
     if (skip) return VK_ERROR_VALIDATION_FAILED_EXT;
 
     VkResult result = dev_data->dispatch_table.WaitForFences(device, fenceCount, pFences, waitAll, timeout);
+    trace.args().Add("result", result);
 
     if (result == VK_SUCCESS) {
         lock.lock();
@@ -4533,7 +5333,7 @@ static void PostCallRecordGetFenceStatus(layer_data *dev_data, VkFence fence) {
 
 VKAPI_ATTR VkResult VKAPI_CALL GetFenceStatus(VkDevice device, VkFence fence) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateGetFenceStatus(dev_data, fence);
     lock.unlock();
     if (skip) return VK_ERROR_VALIDATION_FAILED_EXT;
@@ -4554,14 +5354,22 @@ static void PostCallRecordGetDeviceQueue(layer_data *dev_data, uint32_t q_family
         QUEUE_STATE *queue_state = &dev_data->queueMap[queue];
         queue_state->queue = queue;
         queue_state->queueFamilyIndex = q_family_index;
+        queue_state->index = static_cast<uint32_t>(dev_data->queue_states.size());
         queue_state->seq = 0;
+        dev_data->queue_states.push_back(queue_state);
+        auto trace = GetQueueTrace(dev_data);
+        if (trace) {
+            std::ostringstream name;
+            name << "VkQueue 0x" << std::hex << HandleToUint64(queue) << std::dec << " (family " << q_family_index << ")";
+            trace->name_track(queue, name.str());
+        }
     }
 }
 
 VKAPI_ATTR void VKAPI_CALL GetDeviceQueue(VkDevice device, uint32_t queueFamilyIndex, uint32_t queueIndex, VkQueue *pQueue) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     dev_data->dispatch_table.GetDeviceQueue(device, queueFamilyIndex, queueIndex, pQueue);
-    std::lock_guard<std::mutex> lock(global_lock);
+    std::lock_guard<rw_lock> lock(global_lock);
 
     PostCallRecordGetDeviceQueue(dev_data, queueFamilyIndex, *pQueue);
 }
@@ -4578,12 +5386,15 @@ static void PostCallRecordQueueWaitIdle(layer_data *dev_data, QUEUE_STATE *queue
 
 VKAPI_ATTR VkResult VKAPI_CALL QueueWaitIdle(VkQueue queue) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(queue), layer_data_map);
+    traced_call trace(dev_data, "vkQueueWaitIdle");
+    trace.args().AddHandle("queue", HandleToUint64(queue));
     QUEUE_STATE *queue_state = nullptr;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateQueueWaitIdle(dev_data, queue, &queue_state);
     lock.unlock();
     if (skip) return VK_ERROR_VALIDATION_FAILED_EXT;
     VkResult result = dev_data->dispatch_table.QueueWaitIdle(queue);
+    trace.args().Add("result", result);
     if (VK_SUCCESS == result) {
         lock.lock();
         PostCallRecordQueueWaitIdle(dev_data, queue_state);
@@ -4609,11 +5420,13 @@ static void PostCallRecordDeviceWaitIdle(layer_data *dev_data) {
 
 VKAPI_ATTR VkResult VKAPI_CALL DeviceWaitIdle(VkDevice device) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    traced_call trace(dev_data, "vkDeviceWaitIdle");
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateDeviceWaitIdle(dev_data);
     lock.unlock();
     if (skip) return VK_ERROR_VALIDATION_FAILED_EXT;
     VkResult result = dev_data->dispatch_table.DeviceWaitIdle(device);
+    trace.args().Add("result", result);
     if (VK_SUCCESS == result) {
         lock.lock();
         PostCallRecordDeviceWaitIdle(dev_data);
@@ -4644,7 +5457,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyFence(VkDevice device, VkFence fence, const Vk
     // Common data objects used pre & post call
     FENCE_NODE *fence_node = nullptr;
     VK_OBJECT obj_struct;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateDestroyFence(dev_data, fence, &fence_node, &obj_struct);
 
     if (!skip) {
@@ -4673,7 +5486,7 @@ VKAPI_ATTR void VKAPI_CALL DestroySemaphore(VkDevice device, VkSemaphore semapho
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     SEMAPHORE_NODE *sema_node;
     VK_OBJECT obj_struct;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateDestroySemaphore(dev_data, semaphore, &sema_node, &obj_struct);
     if (!skip) {
         lock.unlock();
@@ -4703,7 +5516,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyEvent(VkDevice device, VkEvent event, const Vk
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     EVENT_STATE *event_state = nullptr;
     VK_OBJECT obj_struct;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateDestroyEvent(dev_data, event, &event_state, &obj_struct);
     if (!skip) {
         lock.unlock();
@@ -4737,7 +5550,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyQueryPool(VkDevice device, VkQueryPool queryPo
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     QUERY_POOL_NODE *qp_state = nullptr;
     VK_OBJECT obj_struct;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateDestroyQueryPool(dev_data, queryPool, &qp_state, &obj_struct);
     if (!skip) {
         lock.unlock();
@@ -4843,7 +5656,7 @@ VKAPI_ATTR VkResult VKAPI_CALL GetQueryPoolResults(VkDevice device, VkQueryPool
                                                    size_t dataSize, void *pData, VkDeviceSize stride, VkQueryResultFlags flags) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     unordered_map<QueryObject, vector<VkCommandBuffer>> queries_in_flight;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateGetQueryPoolResults(dev_data, queryPool, firstQuery, queryCount, flags, &queries_in_flight);
     lock.unlock();
     if (skip) return VK_ERROR_VALIDATION_FAILED_EXT;
@@ -4905,20 +5718,30 @@ bool rangesIntersect(layer_data const *dev_data, MEMORY_RANGE const *range1, VkD
     bool tmp_bool;
     return rangesIntersect(dev_data, range1, &range_wrap, &tmp_bool, true);
 }
+// Call f(MEMORY_RANGE *) for each range bound to mem_info that rangesIntersect() would report as intersecting a range
+// [start, end] of the given linearity. Ranges of the same linearity are compared exactly; ranges of the other linearity
+// are compared at bufferImageGranularity, so [start, end] is widened to whole granules for them.
+template <typename F>
+static void ForEachIntersectingRange(layer_data const *dev_data, DEVICE_MEM_INFO *mem_info, VkDeviceSize start, VkDeviceSize end,
+                                     bool linear, F f) {
+    auto visit = [&f](VkDeviceSize, VkDeviceSize, MEMORY_RANGE *range) { f(range); };
+    const VkDeviceSize pad_align = dev_data->phys_dev_properties.properties.limits.bufferImageGranularity;
+    const VkDeviceSize padded_start = start & ~(pad_align - 1);
+    const VkDeviceSize padded_end = end | (pad_align - 1);
+    if (linear) {
+        mem_info->linear_ranges.for_each_overlap(start, end, visit);
+        mem_info->non_linear_ranges.for_each_overlap(padded_start, padded_end, visit);
+    } else {
+        mem_info->linear_ranges.for_each_overlap(padded_start, padded_end, visit);
+        mem_info->non_linear_ranges.for_each_overlap(start, end, visit);
+    }
+}
+
 // For given mem_info, set all ranges valid that intersect [offset-end] range
 // TODO : For ranges where there is no alias, we may want to create new buffer ranges that are valid
 static void SetMemRangesValid(layer_data const *dev_data, DEVICE_MEM_INFO *mem_info, VkDeviceSize offset, VkDeviceSize end) {
-    bool tmp_bool = false;
-    MEMORY_RANGE map_range = {};
-    map_range.linear = true;
-    map_range.start = offset;
-    map_range.end = end;
-    for (auto &handle_range_pair : mem_info->bound_ranges) {
-        if (rangesIntersect(dev_data, &handle_range_pair.second, &map_range, &tmp_bool, false)) {
-            // TODO : WARN here if tmp_bool true?
-            handle_range_pair.second.valid = true;
-        }
-    }
+    // TODO : WARN here if a non-linear range only intersects once padded?
+    ForEachIntersectingRange(dev_data, mem_info, offset, end, true, [](MEMORY_RANGE *range) { range->valid = true; });
 }
 
 static bool ValidateInsertMemoryRange(layer_data const *dev_data, uint64_t handle, DEVICE_MEM_INFO *mem_info,
@@ -4935,17 +5758,17 @@ static bool ValidateInsertMemoryRange(layer_data const *dev_data, uint64_t handl
     range.start = memoryOffset;
     range.size = memRequirements.size;
     range.end = memoryOffset + memRequirements.size - 1;
-    range.aliases.clear();
 
-    // Check for aliasing problems.
-    for (auto &obj_range_pair : mem_info->bound_ranges) {
-        auto check_range = &obj_range_pair.second;
-        bool intersection_error = false;
-        if (rangesIntersect(dev_data, &range, check_range, &intersection_error, false)) {
-            skip |= intersection_error;
-            range.aliases.insert(check_range);
-        }
-    }
+    // Check for aliasing problems. Only linear vs. non-linear aliasing is reported, so same-linearity ranges are not visited.
+    const VkDeviceSize pad_align = dev_data->phys_dev_properties.properties.limits.bufferImageGranularity;
+    auto &other_ranges = is_linear ? mem_info->non_linear_ranges : mem_info->linear_ranges;
+    other_ranges.for_each_overlap(range.start & ~(pad_align - 1), range.end | (pad_align - 1),
+                                  [&](VkDeviceSize, VkDeviceSize, MEMORY_RANGE *check_range) {
+                                      bool intersection_error = false;
+                                      if (rangesIntersect(dev_data, &range, check_range, &intersection_error, false)) {
+                                          skip |= intersection_error;
+                                      }
+                                  });
 
     if (memoryOffset >= mem_info->alloc_info.allocationSize) {
         UNIQUE_VALIDATION_ERROR_CODE error_code = is_image ? VALIDATION_ERROR_1740082c : VALIDATION_ERROR_1700080e;
@@ -4960,17 +5783,24 @@ static bool ValidateInsertMemoryRange(layer_data const *dev_data, uint64_t handl
     return skip;
 }
 
+// Remove range from whichever of the interval trees of mem_info indexes it
+static void UnindexMemoryRange(DEVICE_MEM_INFO *mem_info, MEMORY_RANGE *range) {
+    auto &ranges = range->linear ? mem_info->linear_ranges : mem_info->non_linear_ranges;
+    ranges.erase(range->start, range);
+}
+
 // Object with given handle is being bound to memory w/ given mem_info struct.
 //  Track the newly bound memory range with given memoryOffset
-//  Also scan any previous ranges, track aliased ranges with new range, and flag an error if a linear
-//  and non-linear range incorrectly overlap.
-// Return true if an error is flagged and the user callback returns "true", otherwise false
+//  Aliasing between ranges is not stored; it is found on demand by querying the interval trees of mem_info.
 // is_image indicates an image object, otherwise handle is for a buffer
 // is_linear indicates a buffer or linear image
 static void InsertMemoryRange(layer_data const *dev_data, uint64_t handle, DEVICE_MEM_INFO *mem_info, VkDeviceSize memoryOffset,
                               VkMemoryRequirements memRequirements, bool is_image, bool is_linear) {
-    MEMORY_RANGE range;
-
+    auto existing = mem_info->bound_ranges.find(handle);
+    if (existing != mem_info->bound_ranges.end()) {
+        UnindexMemoryRange(mem_info, &existing->second);
+    }
+    MEMORY_RANGE &range = mem_info->bound_ranges[handle];
     range.image = is_image;
     range.handle = handle;
     range.linear = is_linear;
@@ -4979,27 +5809,8 @@ static void InsertMemoryRange(layer_data const *dev_data, uint64_t handle, DEVIC
     range.start = memoryOffset;
     range.size = memRequirements.size;
     range.end = memoryOffset + memRequirements.size - 1;
-    range.aliases.clear();
-    // Update Memory aliasing
-    // Save aliased ranges so we can copy into final map entry below. Can't do it in loop b/c we don't yet have final ptr. If we
-    // inserted into map before loop to get the final ptr, then we may enter loop when not needed & we check range against itself
-    std::unordered_set<MEMORY_RANGE *> tmp_alias_ranges;
-    for (auto &obj_range_pair : mem_info->bound_ranges) {
-        auto check_range = &obj_range_pair.second;
-        bool intersection_error = false;
-        if (rangesIntersect(dev_data, &range, check_range, &intersection_error, true)) {
-            range.aliases.insert(check_range);
-            tmp_alias_ranges.insert(check_range);
-        }
-    }
-    mem_info->bound_ranges[handle] = std::move(range);
-    for (auto tmp_range : tmp_alias_ranges) {
-        tmp_range->aliases.insert(&mem_info->bound_ranges[handle]);
-    }
-    if (is_image)
-        mem_info->bound_images.insert(handle);
-    else
-        mem_info->bound_buffers.insert(handle);
+    auto &ranges = is_linear ? mem_info->linear_ranges : mem_info->non_linear_ranges;
+    ranges.insert(range.start, range.end, &range);
 }
 
 static bool ValidateInsertImageMemoryRange(layer_data const *dev_data, VkImage image, DEVICE_MEM_INFO *mem_info,
@@ -5023,20 +5834,12 @@ static void InsertBufferMemoryRange(layer_data const *dev_data, VkBuffer buffer,
 
 // Remove MEMORY_RANGE struct for give handle from bound_ranges of mem_info
 //  is_image indicates if handle is for image or buffer
-//  This function will also remove the handle-to-index mapping from the appropriate
-//  map and clean up any aliases for range being removed.
+//  This function will also remove the range from the interval tree that indexes it.
 static void RemoveMemoryRange(uint64_t handle, DEVICE_MEM_INFO *mem_info, bool is_image) {
-    auto erase_range = &mem_info->bound_ranges[handle];
-    for (auto alias_range : erase_range->aliases) {
-        alias_range->aliases.erase(erase_range);
-    }
-    erase_range->aliases.clear();
-    mem_info->bound_ranges.erase(handle);
-    if (is_image) {
-        mem_info->bound_images.erase(handle);
-    } else {
-        mem_info->bound_buffers.erase(handle);
-    }
+    auto erase_range = mem_info->bound_ranges.find(handle);
+    if (erase_range == mem_info->bound_ranges.end()) return;
+    UnindexMemoryRange(mem_info, &erase_range->second);
+    mem_info->bound_ranges.erase(erase_range);
 }
 
 void RemoveBufferMemoryRange(uint64_t handle, DEVICE_MEM_INFO *mem_info) { RemoveMemoryRange(handle, mem_info, false); }
@@ -5047,7 +5850,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyBuffer(VkDevice device, VkBuffer buffer, const
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     BUFFER_STATE *buffer_state = nullptr;
     VK_OBJECT obj_struct;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateDestroyBuffer(dev_data, buffer, &buffer_state, &obj_struct);
     if (!skip) {
         lock.unlock();
@@ -5055,6 +5858,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyBuffer(VkDevice device, VkBuffer buffer, const
         lock.lock();
         if (buffer != VK_NULL_HANDLE) {
             PostCallRecordDestroyBuffer(dev_data, buffer, buffer_state, obj_struct);
+            ++dev_data->resource_generation;
         }
     }
 }
@@ -5064,7 +5868,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyBufferView(VkDevice device, VkBufferView buffe
     // Common data objects used pre & post call
     BUFFER_VIEW_STATE *buffer_view_state = nullptr;
     VK_OBJECT obj_struct;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     // Validate state before calling down chain, update common data if we'll be calling down chain
     bool skip = PreCallValidateDestroyBufferView(dev_data, bufferView, &buffer_view_state, &obj_struct);
     if (!skip) {
@@ -5081,7 +5885,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyImage(VkDevice device, VkImage image, const Vk
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     IMAGE_STATE *image_state = nullptr;
     VK_OBJECT obj_struct;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateDestroyImage(dev_data, image, &image_state, &obj_struct);
     if (!skip) {
         lock.unlock();
@@ -5089,6 +5893,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyImage(VkDevice device, VkImage image, const Vk
         lock.lock();
         if (image != VK_NULL_HANDLE) {
             PostCallRecordDestroyImage(dev_data, image, image_state, obj_struct);
+            ++dev_data->resource_generation;
         }
     }
 }
@@ -5111,7 +5916,7 @@ static bool PreCallValidateBindBufferMemory(layer_data *dev_data, VkBuffer buffe
                                             VkDeviceSize memoryOffset) {
     bool skip = false;
     if (buffer_state) {
-        std::unique_lock<std::mutex> lock(global_lock);
+        std::unique_lock<rw_lock> lock(global_lock);
         // Track objects tied to memory
         uint64_t buffer_handle = HandleToUint64(buffer);
         skip = ValidateSetMemBinding(dev_data, mem, buffer_handle, kVulkanObjectTypeBuffer, "vkBindBufferMemory()");
@@ -5202,7 +6007,7 @@ static bool PreCallValidateBindBufferMemory(layer_data *dev_data, VkBuffer buffe
 static void PostCallRecordBindBufferMemory(layer_data *dev_data, VkBuffer buffer, BUFFER_STATE *buffer_state, VkDeviceMemory mem,
                                            VkDeviceSize memoryOffset) {
     if (buffer_state) {
-        std::unique_lock<std::mutex> lock(global_lock);
+        std::unique_lock<rw_lock> lock(global_lock);
         // Track bound memory range information
         auto mem_info = GetMemObjInfo(dev_data, mem);
         if (mem_info) {
@@ -5259,7 +6064,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyImageView(VkDevice device, VkImageView imageVi
     // Common data objects used pre & post call
     IMAGE_VIEW_STATE *image_view_state = nullptr;
     VK_OBJECT obj_struct;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateDestroyImageView(dev_data, imageView, &image_view_state, &obj_struct);
     if (!skip) {
         lock.unlock();
@@ -5267,6 +6072,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyImageView(VkDevice device, VkImageView imageVi
         lock.lock();
         if (imageView != VK_NULL_HANDLE) {
             PostCallRecordDestroyImageView(dev_data, imageView, image_view_state, obj_struct);
+            ++dev_data->resource_generation;
         }
     }
 }
@@ -5275,7 +6081,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyShaderModule(VkDevice device, VkShaderModule s
                                                const VkAllocationCallbacks *pAllocator) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     dev_data->shaderModuleMap.erase(shaderModule);
     lock.unlock();
 
@@ -5305,7 +6111,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyPipeline(VkDevice device, VkPipeline pipeline,
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     PIPELINE_STATE *pipeline_state = nullptr;
     VK_OBJECT obj_struct;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateDestroyPipeline(dev_data, pipeline, &pipeline_state, &obj_struct);
     if (!skip) {
         lock.unlock();
@@ -5320,7 +6126,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyPipeline(VkDevice device, VkPipeline pipeline,
 VKAPI_ATTR void VKAPI_CALL DestroyPipelineLayout(VkDevice device, VkPipelineLayout pipelineLayout,
                                                  const VkAllocationCallbacks *pAllocator) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     dev_data->pipelineLayoutMap.erase(pipelineLayout);
     lock.unlock();
 
@@ -5350,7 +6156,7 @@ VKAPI_ATTR void VKAPI_CALL DestroySampler(VkDevice device, VkSampler sampler, co
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     SAMPLER_STATE *sampler_state = nullptr;
     VK_OBJECT obj_struct;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateDestroySampler(dev_data, sampler, &sampler_state, &obj_struct);
     if (!skip) {
         lock.unlock();
@@ -5370,7 +6176,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyDescriptorSetLayout(VkDevice device, VkDescrip
                                                       const VkAllocationCallbacks *pAllocator) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     dev_data->dispatch_table.DestroyDescriptorSetLayout(device, descriptorSetLayout, pAllocator);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     PostCallRecordDestroyDescriptorSetLayout(dev_data, descriptorSetLayout);
 }
 
@@ -5395,6 +6201,8 @@ static void PostCallRecordDestroyDescriptorPool(layer_data *dev_data, VkDescript
         freeDescriptorSet(dev_data, ds);
     }
     dev_data->descriptorPoolMap.erase(descriptorPool);
+    // The pool owns the memory its sets' descriptors lived in, so it can only go once they are all gone
+    delete desc_pool_state;
 }
 
 VKAPI_ATTR void VKAPI_CALL DestroyDescriptorPool(VkDevice device, VkDescriptorPool descriptorPool,
@@ -5402,7 +6210,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyDescriptorPool(VkDevice device, VkDescriptorPo
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     DESCRIPTOR_POOL_STATE *desc_pool_state = nullptr;
     VK_OBJECT obj_struct;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateDestroyDescriptorPool(dev_data, descriptorPool, &desc_pool_state, &obj_struct);
     if (!skip) {
         lock.unlock();
@@ -5443,7 +6251,7 @@ VKAPI_ATTR void VKAPI_CALL FreeCommandBuffers(VkDevice device, VkCommandPool com
                                               const VkCommandBuffer *pCommandBuffers) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     bool skip = false;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
 
     for (uint32_t i = 0; i < commandBufferCount; i++) {
         auto cb_node = GetCBNode(dev_data, pCommandBuffers[i]);
@@ -5482,7 +6290,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateCommandPool(VkDevice device, const VkComman
     VkResult result = dev_data->dispatch_table.CreateCommandPool(device, pCreateInfo, pAllocator, pCommandPool);
 
     if (VK_SUCCESS == result) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         dev_data->commandPoolMap[*pCommandPool].createFlags = pCreateInfo->flags;
         dev_data->commandPoolMap[*pCommandPool].queueFamilyIndex = pCreateInfo->queueFamilyIndex;
     }
@@ -5508,7 +6316,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateQueryPool(VkDevice device, const VkQueryPoo
         result = dev_data->dispatch_table.CreateQueryPool(device, pCreateInfo, pAllocator, pQueryPool);
     }
     if (result == VK_SUCCESS) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         QUERY_POOL_NODE *qp_node = &dev_data->queryPoolMap[*pQueryPool];
         qp_node->createInfo = *pCreateInfo;
     }
@@ -5550,7 +6358,7 @@ static void PostCallRecordDestroyCommandPool(layer_data *dev_data, VkCommandPool
 VKAPI_ATTR void VKAPI_CALL DestroyCommandPool(VkDevice device, VkCommandPool commandPool, const VkAllocationCallbacks *pAllocator) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     COMMAND_POOL_NODE *cp_state = nullptr;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateDestroyCommandPool(dev_data, commandPool, &cp_state);
     if (!skip) {
         lock.unlock();
@@ -5566,7 +6374,7 @@ VKAPI_ATTR VkResult VKAPI_CALL ResetCommandPool(VkDevice device, VkCommandPool c
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     bool skip = false;
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     auto pPool = GetCommandPoolNode(dev_data, commandPool);
     skip |= checkCommandBuffersInFlight(dev_data, pPool, "reset command pool with", VALIDATION_ERROR_32800050);
     lock.unlock();
@@ -5589,7 +6397,7 @@ VKAPI_ATTR VkResult VKAPI_CALL ResetCommandPool(VkDevice device, VkCommandPool c
 VKAPI_ATTR VkResult VKAPI_CALL ResetFences(VkDevice device, uint32_t fenceCount, const VkFence *pFences) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     bool skip = false;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     for (uint32_t i = 0; i < fenceCount; ++i) {
         auto pFence = GetFenceNode(dev_data, pFences[i]);
         if (pFence && pFence->state == FENCE_INFLIGHT) {
@@ -5628,6 +6436,7 @@ void invalidateCommandBuffers(const layer_data *dev_data, std::unordered_set<GLO
                     "Invalidating a command buffer that's currently being recorded: 0x%p.", cb_node->commandBuffer);
         }
         cb_node->state = CB_INVALID;
+        cb_node->recording_epoch = ++recording_epochs;
         cb_node->broken_bindings.push_back(obj);
 
         // if secondary, then propagate the invalidation to the primaries that will call us.
@@ -5659,7 +6468,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyFramebuffer(VkDevice device, VkFramebuffer fra
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     FRAMEBUFFER_STATE *framebuffer_state = nullptr;
     VK_OBJECT obj_struct;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateDestroyFramebuffer(dev_data, framebuffer, &framebuffer_state, &obj_struct);
     if (!skip) {
         lock.unlock();
@@ -5693,7 +6502,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyRenderPass(VkDevice device, VkRenderPass rende
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     RENDER_PASS_STATE *rp_state = nullptr;
     VK_OBJECT obj_struct;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateDestroyRenderPass(dev_data, renderPass, &rp_state, &obj_struct);
     if (!skip) {
         lock.unlock();
@@ -5708,7 +6517,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyRenderPass(VkDevice device, VkRenderPass rende
 VKAPI_ATTR VkResult VKAPI_CALL CreateBuffer(VkDevice device, const VkBufferCreateInfo *pCreateInfo,
                                             const VkAllocationCallbacks *pAllocator, VkBuffer *pBuffer) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateCreateBuffer(dev_data, pCreateInfo);
     lock.unlock();
 
@@ -5726,7 +6535,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateBuffer(VkDevice device, const VkBufferCreat
 VKAPI_ATTR VkResult VKAPI_CALL CreateBufferView(VkDevice device, const VkBufferViewCreateInfo *pCreateInfo,
                                                 const VkAllocationCallbacks *pAllocator, VkBufferView *pView) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateCreateBufferView(dev_data, pCreateInfo);
     lock.unlock();
     if (skip) return VK_ERROR_VALIDATION_FAILED_EXT;
@@ -5767,31 +6576,19 @@ const VkPhysicalDeviceProperties *GetPhysicalDeviceProperties(core_validation::l
 
 const CHECK_DISABLED *GetDisables(core_validation::layer_data *device_data) { return &device_data->instance_data->disabled; }
 
-std::unordered_map<VkImage, std::unique_ptr<IMAGE_STATE>> *GetImageMap(core_validation::layer_data *device_data) {
+handle_map<VkImage, std::unique_ptr<IMAGE_STATE>> *GetImageMap(core_validation::layer_data *device_data) {
     return &device_data->imageMap;
 }
 
-std::unordered_map<VkImage, std::vector<ImageSubresourcePair>> *GetImageSubresourceMap(core_validation::layer_data *device_data) {
-    return &device_data->imageSubresourceMap;
-}
-
-std::unordered_map<ImageSubresourcePair, IMAGE_LAYOUT_NODE> *GetImageLayoutMap(layer_data *device_data) {
-    return &device_data->imageLayoutMap;
-}
-
-std::unordered_map<ImageSubresourcePair, IMAGE_LAYOUT_NODE> const *GetImageLayoutMap(layer_data const *device_data) {
-    return &device_data->imageLayoutMap;
-}
-
-std::unordered_map<VkBuffer, std::unique_ptr<BUFFER_STATE>> *GetBufferMap(layer_data *device_data) {
+handle_map<VkBuffer, std::unique_ptr<BUFFER_STATE>> *GetBufferMap(layer_data *device_data) {
     return &device_data->bufferMap;
 }
 
-std::unordered_map<VkBufferView, std::unique_ptr<BUFFER_VIEW_STATE>> *GetBufferViewMap(layer_data *device_data) {
+handle_map<VkBufferView, std::unique_ptr<BUFFER_VIEW_STATE>> *GetBufferViewMap(layer_data *device_data) {
     return &device_data->bufferViewMap;
 }
 
-std::unordered_map<VkImageView, std::unique_ptr<IMAGE_VIEW_STATE>> *GetImageViewMap(layer_data *device_data) {
+handle_map<VkImageView, std::unique_ptr<IMAGE_VIEW_STATE>> *GetImageViewMap(layer_data *device_data) {
     return &device_data->imageViewMap;
 }
 
@@ -5814,7 +6611,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateImage(VkDevice device, const VkImageCreateI
         result = dev_data->dispatch_table.CreateImage(device, pCreateInfo, pAllocator, pImage);
     }
     if (VK_SUCCESS == result) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         PostCallRecordCreateImage(dev_data, pCreateInfo, pImage);
     }
     return result;
@@ -5823,7 +6620,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateImage(VkDevice device, const VkImageCreateI
 VKAPI_ATTR VkResult VKAPI_CALL CreateImageView(VkDevice device, const VkImageViewCreateInfo *pCreateInfo,
                                                const VkAllocationCallbacks *pAllocator, VkImageView *pView) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateCreateImageView(dev_data, pCreateInfo);
     lock.unlock();
     if (skip) return VK_ERROR_VALIDATION_FAILED_EXT;
@@ -5842,7 +6639,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateFence(VkDevice device, const VkFenceCreateI
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->dispatch_table.CreateFence(device, pCreateInfo, pAllocator, pFence);
     if (VK_SUCCESS == result) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         auto &fence_node = dev_data->fenceMap[*pFence];
         fence_node.fence = *pFence;
         fence_node.createInfo = *pCreateInfo;
@@ -5880,6 +6677,7 @@ VKAPI_ATTR VkResult VKAPI_CALL MergePipelineCaches(VkDevice device, VkPipelineCa
 }
 
 // utility function to set collective state for pipeline
+//  Called once at pipeline creation so that bound pipelines are never written while command buffers are being recorded
 void set_pipeline_state(PIPELINE_STATE *pPipe) {
     // If any attachment used by this pipeline has blendEnable, set top-level blendEnable
     if (pPipe->graphicsPipelineCI.pColorBlendState) {
@@ -5926,14 +6724,38 @@ bool validate_dual_src_blend_feature(layer_data *device_data, PIPELINE_STATE *pi
     return skip;
 }
 
+// Walk the SPIR-V of every shader stage in a batch of pipelines ahead of validating them, spreading the pipelines across
+// the validation worker threads. analyses[i][j] receives the analysis of stage j of pipe_state[i].
+static void AnalyzeGraphicsPipelineShaders(layer_data const *device_data, vector<PIPELINE_STATE *> const &pipe_state,
+                                           vector<vector<shader_stage_analysis>> *analyses) {
+    analyses->resize(pipe_state.size());
+    GetValidationThreadPool().parallel_for(pipe_state.size(), [device_data, &pipe_state, analyses](size_t i) {
+        auto create_info = pipe_state[i]->graphicsPipelineCI.ptr();
+        auto &stages = (*analyses)[i];
+        stages.resize(create_info->stageCount);
+        for (uint32_t j = 0; j < create_info->stageCount; j++) {
+            analyze_shader_stage(device_data, &create_info->pStages[j], &stages[j]);
+        }
+    });
+}
+
 static bool PreCallCreateGraphicsPipelines(layer_data *device_data, uint32_t count,
                                            const VkGraphicsPipelineCreateInfo *create_infos, vector<PIPELINE_STATE *> &pipe_state) {
     bool skip = false;
     instance_layer_data *instance_data =
         GetLayerDataPtr(get_dispatch_key(device_data->instance_data->instance), instance_layer_data_map);
 
+    // The SPIR-V walks are independent per pipeline and are done up front in parallel. Everything that reports an error
+    // runs below, one pipeline at a time in array order, so messages come out exactly as they would serially.
+    vector<vector<shader_stage_analysis>> analyses;
+    if (!GetDisables(device_data)->shader_validation) {
+        AnalyzeGraphicsPipelineShaders(device_data, pipe_state, &analyses);
+    } else {
+        analyses.resize(count);
+    }
+
     for (uint32_t i = 0; i < count; i++) {
-        skip |= verifyPipelineCreateState(device_data, pipe_state, i);
+        skip |= verifyPipelineCreateState(device_data, pipe_state, i, analyses[i]);
         if (create_infos[i].pVertexInputState != NULL) {
             for (uint32_t j = 0; j < create_infos[i].pVertexInputState->vertexAttributeDescriptionCount; j++) {
                 VkFormat format = create_infos[i].pVertexInputState->pVertexAttributeDescriptions[j].format;
@@ -5968,11 +6790,12 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateGraphicsPipelines(VkDevice device, VkPipeli
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
 
     uint32_t i = 0;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
 
     for (i = 0; i < count; i++) {
         pipe_state[i] = new PIPELINE_STATE;
         pipe_state[i]->initGraphicsPipeline(&pCreateInfos[i]);
+        set_pipeline_state(pipe_state[i]);
         pipe_state[i]->render_pass_ci.initialize(GetRenderPassState(dev_data, pCreateInfos[i].renderPass)->createInfo.ptr());
         pipe_state[i]->pipeline_layout = *getPipelineLayout(dev_data, pCreateInfos[i].layout);
     }
@@ -6012,7 +6835,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateComputePipelines(VkDevice device, VkPipelin
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
 
     uint32_t i = 0;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     for (i = 0; i < count; i++) {
         // TODO: Verify compute stage bits
 
@@ -6020,9 +6843,16 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateComputePipelines(VkDevice device, VkPipelin
         pPipeState[i] = new PIPELINE_STATE;
         pPipeState[i]->initComputePipeline(&pCreateInfos[i]);
         pPipeState[i]->pipeline_layout = *getPipelineLayout(dev_data, pCreateInfos[i].layout);
+    }
 
+    // Analyze the shaders in parallel, then validate in array order so messages are reported deterministically
+    vector<shader_stage_analysis> analyses(count);
+    GetValidationThreadPool().parallel_for(count, [dev_data, &pPipeState, &analyses](size_t i) {
+        analyze_shader_stage(dev_data, &pPipeState[i]->computePipelineCI.ptr()->stage, &analyses[i]);
+    });
+    for (i = 0; i < count; i++) {
         // TODO: Add Compute Pipeline Verification
-        skip |= validate_compute_pipeline(dev_data, pPipeState[i]);
+        skip |= validate_compute_pipeline(dev_data, pPipeState[i], analyses[i]);
         // skip |= verifyPipelineCreateState(dev_data, pPipeState[i]);
     }
 
@@ -6056,7 +6886,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateSampler(VkDevice device, const VkSamplerCre
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->dispatch_table.CreateSampler(device, pCreateInfo, pAllocator, pSampler);
     if (VK_SUCCESS == result) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         dev_data->samplerMap[*pSampler] = unique_ptr<SAMPLER_STATE>(new SAMPLER_STATE(pSampler, pCreateInfo));
     }
     return result;
@@ -6078,7 +6908,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateDescriptorSetLayout(VkDevice device, const
                                                          VkDescriptorSetLayout *pSetLayout) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateCreateDescriptorSetLayout(dev_data, pCreateInfo);
     if (!skip) {
         lock.unlock();
@@ -6230,7 +7060,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreatePipelineLayout(VkDevice device, const VkPip
 
     VkResult result = dev_data->dispatch_table.CreatePipelineLayout(device, pCreateInfo, pAllocator, pPipelineLayout);
     if (VK_SUCCESS == result) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         PIPELINE_LAYOUT_NODE &plNode = dev_data->pipelineLayoutMap[*pPipelineLayout];
         plNode.layout = *pPipelineLayout;
         plNode.set_layouts.resize(pCreateInfo->setLayoutCount);
@@ -6257,7 +7087,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateDescriptorPool(VkDevice device, const VkDes
                         "Out of memory while attempting to allocate DESCRIPTOR_POOL_STATE in vkCreateDescriptorPool()"))
                 return VK_ERROR_VALIDATION_FAILED_EXT;
         } else {
-            std::lock_guard<std::mutex> lock(global_lock);
+            std::lock_guard<rw_lock> lock(global_lock);
             dev_data->descriptorPoolMap[*pDescriptorPool] = pNewNode;
         }
     } else {
@@ -6272,7 +7102,7 @@ VKAPI_ATTR VkResult VKAPI_CALL ResetDescriptorPool(VkDevice device, VkDescriptor
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->dispatch_table.ResetDescriptorPool(device, descriptorPool, flags);
     if (VK_SUCCESS == result) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         clearDescriptorPool(dev_data, device, descriptorPool, flags);
     }
     return result;
@@ -6300,7 +7130,7 @@ static void PostCallRecordAllocateDescriptorSets(layer_data *dev_data, const VkD
 VKAPI_ATTR VkResult VKAPI_CALL AllocateDescriptorSets(VkDevice device, const VkDescriptorSetAllocateInfo *pAllocateInfo,
                                                       VkDescriptorSet *pDescriptorSets) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     cvdescriptorset::AllocateDescriptorSetsData common_data(pAllocateInfo->descriptorSetCount);
     bool skip = PreCallValidateAllocateDescriptorSets(dev_data, pAllocateInfo, &common_data);
     lock.unlock();
@@ -6366,7 +7196,7 @@ VKAPI_ATTR VkResult VKAPI_CALL FreeDescriptorSets(VkDevice device, VkDescriptorP
                                                   const VkDescriptorSet *pDescriptorSets) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     // Make sure that no sets being destroyed are in-flight
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateFreeDescriptorSets(dev_data, descriptorPool, count, pDescriptorSets);
     lock.unlock();
 
@@ -6410,7 +7240,7 @@ VKAPI_ATTR void VKAPI_CALL UpdateDescriptorSets(VkDevice device, uint32_t descri
                                                 const VkCopyDescriptorSet *pDescriptorCopies) {
     // Only map look-up at top level is for device-level layer_data
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateUpdateDescriptorSets(dev_data, descriptorWriteCount, pDescriptorWrites, descriptorCopyCount,
                                                     pDescriptorCopies);
     lock.unlock();
@@ -6429,7 +7259,7 @@ VKAPI_ATTR VkResult VKAPI_CALL AllocateCommandBuffers(VkDevice device, const VkC
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->dispatch_table.AllocateCommandBuffers(device, pCreateInfo, pCommandBuffer);
     if (VK_SUCCESS == result) {
-        std::unique_lock<std::mutex> lock(global_lock);
+        std::unique_lock<rw_lock> lock(global_lock);
         auto pPool = GetCommandPoolNode(dev_data, pCreateInfo->commandPool);
 
         if (pPool) {
@@ -6451,7 +7281,7 @@ VKAPI_ATTR VkResult VKAPI_CALL AllocateCommandBuffers(VkDevice device, const VkC
 
 // Add bindings between the given cmd buffer & framebuffer and the framebuffer's children
 static void AddFramebufferBinding(layer_data *dev_data, GLOBAL_CB_NODE *cb_state, FRAMEBUFFER_STATE *fb_state) {
-    addCommandBufferBinding(&fb_state->cb_bindings, {HandleToUint64(fb_state->framebuffer), kVulkanObjectTypeFramebuffer},
+    addCommandBufferBinding(fb_state, {HandleToUint64(fb_state->framebuffer), kVulkanObjectTypeFramebuffer},
                             cb_state);
     for (auto attachment : fb_state->attachments) {
         auto view_state = attachment.view_state;
@@ -6460,7 +7290,7 @@ static void AddFramebufferBinding(layer_data *dev_data, GLOBAL_CB_NODE *cb_state
         }
         auto rp_state = GetRenderPassState(dev_data, fb_state->createInfo.renderPass);
         if (rp_state) {
-            addCommandBufferBinding(&rp_state->cb_bindings, {HandleToUint64(rp_state->renderPass), kVulkanObjectTypeRenderPass},
+            addCommandBufferBinding(rp_state, {HandleToUint64(rp_state->renderPass), kVulkanObjectTypeRenderPass},
                                     cb_state);
         }
     }
@@ -6469,7 +7299,7 @@ static void AddFramebufferBinding(layer_data *dev_data, GLOBAL_CB_NODE *cb_state
 VKAPI_ATTR VkResult VKAPI_CALL BeginCommandBuffer(VkCommandBuffer commandBuffer, const VkCommandBufferBeginInfo *pBeginInfo) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     // Validate command buffer level
     GLOBAL_CB_NODE *cb_node = GetCBNode(dev_data, commandBuffer);
     if (cb_node) {
@@ -6566,6 +7396,10 @@ VKAPI_ATTR VkResult VKAPI_CALL BeginCommandBuffer(VkCommandBuffer commandBuffer,
         // Set updated state here in case implicit reset occurs above
         cb_node->state = CB_RECORDING;
         cb_node->beginInfo = *pBeginInfo;
+        ++cb_node->draw_state_generation;
+        cb_node->validation_sampled = (dev_data->recordings_begun++ % dev_data->validation_sample_rate) == 0;
+        ++dev_data->recordings_since_present;
+        if (cb_node->validation_sampled) ++dev_data->recordings_sampled;
         if (cb_node->beginInfo.pInheritanceInfo) {
             cb_node->inheritanceInfo = *(cb_node->beginInfo.pInheritanceInfo);
             cb_node->beginInfo.pInheritanceInfo = &cb_node->inheritanceInfo;
@@ -6591,7 +7425,7 @@ VKAPI_ATTR VkResult VKAPI_CALL BeginCommandBuffer(VkCommandBuffer commandBuffer,
 VKAPI_ATTR VkResult VKAPI_CALL EndCommandBuffer(VkCommandBuffer commandBuffer) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     GLOBAL_CB_NODE *pCB = GetCBNode(dev_data, commandBuffer);
     if (pCB) {
         if ((VK_COMMAND_BUFFER_LEVEL_PRIMARY == pCB->createInfo.level) ||
@@ -6625,7 +7459,7 @@ VKAPI_ATTR VkResult VKAPI_CALL EndCommandBuffer(VkCommandBuffer commandBuffer) {
 VKAPI_ATTR VkResult VKAPI_CALL ResetCommandBuffer(VkCommandBuffer commandBuffer, VkCommandBufferResetFlags flags) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = GetCBNode(dev_data, commandBuffer);
     VkCommandPool cmdPool = pCB->createInfo.commandPool;
     auto pPool = GetCommandPoolNode(dev_data, cmdPool);
@@ -6652,7 +7486,7 @@ VKAPI_ATTR void VKAPI_CALL CmdBindPipeline(VkCommandBuffer commandBuffer, VkPipe
                                            VkPipeline pipeline) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     GLOBAL_CB_NODE *cb_state = GetCBNode(dev_data, commandBuffer);
     if (cb_state) {
         skip |= ValidateCmdQueueFlags(dev_data, cb_state, "vkCmdBindPipeline()", VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT,
@@ -6671,8 +7505,8 @@ VKAPI_ATTR void VKAPI_CALL CmdBindPipeline(VkCommandBuffer commandBuffer, VkPipe
         PIPELINE_STATE *pipe_state = getPipelineState(dev_data, pipeline);
         if (pipe_state) {
             cb_state->lastBound[pipelineBindPoint].pipeline_state = pipe_state;
+            ++cb_state->lastBound[pipelineBindPoint].generation;
             set_cb_pso_status(cb_state, pipe_state);
-            set_pipeline_state(pipe_state);
             skip |= validate_dual_src_blend_feature(dev_data, pipe_state);
         } else {
             skip |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_PIPELINE_EXT,
@@ -6680,12 +7514,12 @@ VKAPI_ATTR void VKAPI_CALL CmdBindPipeline(VkCommandBuffer commandBuffer, VkPipe
                             "Attempt to bind Pipeline 0x%" PRIxLEAST64 " that doesn't exist! %s", HandleToUint64(pipeline),
                             validation_error_map[VALIDATION_ERROR_18027e01]);
         }
-        addCommandBufferBinding(&pipe_state->cb_bindings, {HandleToUint64(pipeline), kVulkanObjectTypePipeline}, cb_state);
+        addCommandBufferBinding(pipe_state, {HandleToUint64(pipeline), kVulkanObjectTypePipeline}, cb_state);
         if (VK_PIPELINE_BIND_POINT_GRAPHICS == pipelineBindPoint) {
             // Add binding for child renderpass
             auto rp_state = GetRenderPassState(dev_data, pipe_state->graphicsPipelineCI.renderPass);
             if (rp_state) {
-                addCommandBufferBinding(&rp_state->cb_bindings, {HandleToUint64(rp_state->renderPass), kVulkanObjectTypeRenderPass},
+                addCommandBufferBinding(rp_state, {HandleToUint64(rp_state->renderPass), kVulkanObjectTypeRenderPass},
                                         cb_state);
             }
         }
@@ -6698,7 +7532,7 @@ VKAPI_ATTR void VKAPI_CALL CmdSetViewport(VkCommandBuffer commandBuffer, uint32_
                                           const VkViewport *pViewports) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     GLOBAL_CB_NODE *pCB = GetCBNode(dev_data, commandBuffer);
     if (pCB) {
         skip |= ValidateCmdQueueFlags(dev_data, pCB, "vkCmdSetViewport()", VK_QUEUE_GRAPHICS_BIT, VALIDATION_ERROR_1e002415);
@@ -6714,7 +7548,7 @@ VKAPI_ATTR void VKAPI_CALL CmdSetScissor(VkCommandBuffer commandBuffer, uint32_t
                                          const VkRect2D *pScissors) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     GLOBAL_CB_NODE *pCB = GetCBNode(dev_data, commandBuffer);
     if (pCB) {
         skip |= ValidateCmdQueueFlags(dev_data, pCB, "vkCmdSetScissor()", VK_QUEUE_GRAPHICS_BIT, VALIDATION_ERROR_1d802415);
@@ -6729,7 +7563,7 @@ VKAPI_ATTR void VKAPI_CALL CmdSetScissor(VkCommandBuffer commandBuffer, uint32_t
 VKAPI_ATTR void VKAPI_CALL CmdSetLineWidth(VkCommandBuffer commandBuffer, float lineWidth) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     GLOBAL_CB_NODE *pCB = GetCBNode(dev_data, commandBuffer);
     if (pCB) {
         skip |= ValidateCmdQueueFlags(dev_data, pCB, "vkCmdSetLineWidth()", VK_QUEUE_GRAPHICS_BIT, VALIDATION_ERROR_1d602415);
@@ -6757,7 +7591,7 @@ VKAPI_ATTR void VKAPI_CALL CmdSetDepthBias(VkCommandBuffer commandBuffer, float
                                            float depthBiasSlopeFactor) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     GLOBAL_CB_NODE *pCB = GetCBNode(dev_data, commandBuffer);
     if (pCB) {
         skip |= ValidateCmdQueueFlags(dev_data, pCB, "vkCmdSetDepthBias()", VK_QUEUE_GRAPHICS_BIT, VALIDATION_ERROR_1cc02415);
@@ -6782,7 +7616,7 @@ VKAPI_ATTR void VKAPI_CALL CmdSetDepthBias(VkCommandBuffer commandBuffer, float
 VKAPI_ATTR void VKAPI_CALL CmdSetBlendConstants(VkCommandBuffer commandBuffer, const float blendConstants[4]) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     GLOBAL_CB_NODE *pCB = GetCBNode(dev_data, commandBuffer);
     if (pCB) {
         skip |= ValidateCmdQueueFlags(dev_data, pCB, "vkCmdSetBlendConstants()", VK_QUEUE_GRAPHICS_BIT, VALIDATION_ERROR_1ca02415);
@@ -6797,7 +7631,7 @@ VKAPI_ATTR void VKAPI_CALL CmdSetBlendConstants(VkCommandBuffer commandBuffer, c
 VKAPI_ATTR void VKAPI_CALL CmdSetDepthBounds(VkCommandBuffer commandBuffer, float minDepthBounds, float maxDepthBounds) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     GLOBAL_CB_NODE *pCB = GetCBNode(dev_data, commandBuffer);
     if (pCB) {
         skip |= ValidateCmdQueueFlags(dev_data, pCB, "vkCmdSetDepthBounds()", VK_QUEUE_GRAPHICS_BIT, VALIDATION_ERROR_1ce02415);
@@ -6813,7 +7647,7 @@ VKAPI_ATTR void VKAPI_CALL CmdSetStencilCompareMask(VkCommandBuffer commandBuffe
                                                     uint32_t compareMask) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     GLOBAL_CB_NODE *pCB = GetCBNode(dev_data, commandBuffer);
     if (pCB) {
         skip |=
@@ -6829,7 +7663,7 @@ VKAPI_ATTR void VKAPI_CALL CmdSetStencilCompareMask(VkCommandBuffer commandBuffe
 VKAPI_ATTR void VKAPI_CALL CmdSetStencilWriteMask(VkCommandBuffer commandBuffer, VkStencilFaceFlags faceMask, uint32_t writeMask) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     GLOBAL_CB_NODE *pCB = GetCBNode(dev_data, commandBuffer);
     if (pCB) {
         skip |=
@@ -6845,7 +7679,7 @@ VKAPI_ATTR void VKAPI_CALL CmdSetStencilWriteMask(VkCommandBuffer commandBuffer,
 VKAPI_ATTR void VKAPI_CALL CmdSetStencilReference(VkCommandBuffer commandBuffer, VkStencilFaceFlags faceMask, uint32_t reference) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     GLOBAL_CB_NODE *pCB = GetCBNode(dev_data, commandBuffer);
     if (pCB) {
         skip |=
@@ -6864,12 +7698,13 @@ VKAPI_ATTR void VKAPI_CALL CmdBindDescriptorSets(VkCommandBuffer commandBuffer,
                                                  const uint32_t *pDynamicOffsets) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     GLOBAL_CB_NODE *cb_state = GetCBNode(dev_data, commandBuffer);
     if (cb_state) {
         skip |= ValidateCmdQueueFlags(dev_data, cb_state, "vkCmdBindDescriptorSets()", VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT,
                                       VALIDATION_ERROR_17c02415);
         skip |= ValidateCmd(dev_data, cb_state, CMD_BINDDESCRIPTORSETS, "vkCmdBindDescriptorSets()");
+        ++cb_state->lastBound[pipelineBindPoint].generation;
         // Track total count of dynamic descriptor types to make sure we have an offset for each one
         uint32_t total_dynamic_descriptors = 0;
         string error_string = "";
@@ -7032,7 +7867,7 @@ VKAPI_ATTR void VKAPI_CALL CmdBindIndexBuffer(VkCommandBuffer commandBuffer, VkB
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
     // TODO : Somewhere need to verify that IBs have correct usage state flagged
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
 
     auto buffer_state = GetBufferState(dev_data, buffer);
     auto cb_node = GetCBNode(dev_data, commandBuffer);
@@ -7074,6 +7909,7 @@ VKAPI_ATTR void VKAPI_CALL CmdBindIndexBuffer(VkCommandBuffer commandBuffer, VkB
 
 void updateResourceTracking(GLOBAL_CB_NODE *pCB, uint32_t firstBinding, uint32_t bindingCount, const VkBuffer *pBuffers) {
     uint32_t end = firstBinding + bindingCount;
+    ++pCB->draw_state_generation;
     if (pCB->currentDrawData.buffers.size() < end) {
         pCB->currentDrawData.buffers.resize(end);
     }
@@ -7082,14 +7918,24 @@ void updateResourceTracking(GLOBAL_CB_NODE *pCB, uint32_t firstBinding, uint32_t
     }
 }
 
-static inline void updateResourceTrackingOnDraw(GLOBAL_CB_NODE *pCB) { pCB->drawData.push_back(pCB->currentDrawData); }
+// Record the vertex buffers a draw uses. Buffers are bound to the command buffer the first time a draw uses a new set of
+// vertex buffer bindings, so they count as in use while the command buffer is in flight.
+static inline void updateResourceTrackingOnDraw(layer_data *dev_data, GLOBAL_CB_NODE *pCB) {
+    if (pCB->drawData.empty() || pCB->drawData.back().buffers != pCB->currentDrawData.buffers) {
+        for (auto buffer : pCB->currentDrawData.buffers) {
+            auto buffer_state = GetBufferState(dev_data, buffer);
+            if (buffer_state) AddCommandBufferBindingBuffer(dev_data, pCB, buffer_state);
+        }
+    }
+    pCB->drawData.push_back(pCB->currentDrawData);
+}
 
 VKAPI_ATTR void VKAPI_CALL CmdBindVertexBuffers(VkCommandBuffer commandBuffer, uint32_t firstBinding, uint32_t bindingCount,
                                                 const VkBuffer *pBuffers, const VkDeviceSize *pOffsets) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
     // TODO : Somewhere need to verify that VBs have correct usage state flagged
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
 
     auto cb_node = GetCBNode(dev_data, commandBuffer);
     if (cb_node) {
@@ -7155,7 +8001,7 @@ static bool ValidateCmdDrawType(layer_data *dev_data, VkCommandBuffer cmd_buffer
     if (*cb_state) {
         skip |= ValidateCmdQueueFlags(dev_data, *cb_state, caller, queue_flags, queue_flag_code);
         skip |= ValidateCmd(dev_data, *cb_state, cmd_type, caller);
-        skip |= ValidateDrawState(dev_data, *cb_state, indexed, bind_point, caller, dynamic_state_msg_code);
+        skip |= ValidateDrawStateIfChanged(dev_data, *cb_state, indexed, bind_point, caller, dynamic_state_msg_code);
         skip |= (VK_PIPELINE_BIND_POINT_GRAPHICS == bind_point) ? outsideRenderPass(dev_data, *cb_state, caller, msg_code)
                                                                 : insideRenderPass(dev_data, *cb_state, caller, msg_code);
     }
@@ -7174,7 +8020,7 @@ static void UpdateStateCmdDrawDispatchType(layer_data *dev_data, GLOBAL_CB_NODE
 static void UpdateStateCmdDrawType(layer_data *dev_data, GLOBAL_CB_NODE *cb_state, VkPipelineBindPoint bind_point,
                                    CMD_TYPE cmd_type) {
     UpdateStateCmdDrawDispatchType(dev_data, cb_state, bind_point, cmd_type);
-    updateResourceTrackingOnDraw(cb_state);
+    updateResourceTrackingOnDraw(dev_data, cb_state);
     cb_state->hasDrawCmd = true;
 }
 
@@ -7192,7 +8038,7 @@ VKAPI_ATTR void VKAPI_CALL CmdDraw(VkCommandBuffer commandBuffer, uint32_t verte
                                    uint32_t firstVertex, uint32_t firstInstance) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
     GLOBAL_CB_NODE *cb_state = nullptr;
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     bool skip = PreCallValidateCmdDraw(dev_data, commandBuffer, false, VK_PIPELINE_BIND_POINT_GRAPHICS, &cb_state, "vkCmdDraw()");
     lock.unlock();
     if (!skip) {
@@ -7217,7 +8063,7 @@ VKAPI_ATTR void VKAPI_CALL CmdDrawIndexed(VkCommandBuffer commandBuffer, uint32_
                                           uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
     GLOBAL_CB_NODE *cb_state = nullptr;
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     bool skip = PreCallValidateCmdDrawIndexed(dev_data, commandBuffer, true, VK_PIPELINE_BIND_POINT_GRAPHICS, &cb_state,
                                               "vkCmdDrawIndexed()");
     lock.unlock();
@@ -7253,7 +8099,7 @@ VKAPI_ATTR void VKAPI_CALL CmdDrawIndirect(VkCommandBuffer commandBuffer, VkBuff
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
     GLOBAL_CB_NODE *cb_state = nullptr;
     BUFFER_STATE *buffer_state = nullptr;
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     bool skip = PreCallValidateCmdDrawIndirect(dev_data, commandBuffer, buffer, false, VK_PIPELINE_BIND_POINT_GRAPHICS, &cb_state,
                                                &buffer_state, "vkCmdDrawIndirect()");
     lock.unlock();
@@ -7290,7 +8136,7 @@ VKAPI_ATTR void VKAPI_CALL CmdDrawIndexedIndirect(VkCommandBuffer commandBuffer,
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
     GLOBAL_CB_NODE *cb_state = nullptr;
     BUFFER_STATE *buffer_state = nullptr;
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     bool skip = PreCallValidateCmdDrawIndexedIndirect(dev_data, commandBuffer, buffer, true, VK_PIPELINE_BIND_POINT_GRAPHICS,
                                                       &cb_state, &buffer_state, "vkCmdDrawIndexedIndirect()");
     lock.unlock();
@@ -7315,7 +8161,7 @@ static void PostCallRecordCmdDispatch(layer_data *dev_data, GLOBAL_CB_NODE *cb_s
 VKAPI_ATTR void VKAPI_CALL CmdDispatch(VkCommandBuffer commandBuffer, uint32_t x, uint32_t y, uint32_t z) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
     GLOBAL_CB_NODE *cb_state = nullptr;
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     bool skip =
         PreCallValidateCmdDispatch(dev_data, commandBuffer, false, VK_PIPELINE_BIND_POINT_COMPUTE, &cb_state, "vkCmdDispatch()");
     lock.unlock();
@@ -7348,7 +8194,7 @@ VKAPI_ATTR void VKAPI_CALL CmdDispatchIndirect(VkCommandBuffer commandBuffer, Vk
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
     GLOBAL_CB_NODE *cb_state = nullptr;
     BUFFER_STATE *buffer_state = nullptr;
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     bool skip = PreCallValidateCmdDispatchIndirect(dev_data, commandBuffer, buffer, false, VK_PIPELINE_BIND_POINT_COMPUTE,
                                                    &cb_state, &buffer_state, "vkCmdDispatchIndirect()");
     lock.unlock();
@@ -7363,7 +8209,7 @@ VKAPI_ATTR void VKAPI_CALL CmdDispatchIndirect(VkCommandBuffer commandBuffer, Vk
 VKAPI_ATTR void VKAPI_CALL CmdCopyBuffer(VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkBuffer dstBuffer,
                                          uint32_t regionCount, const VkBufferCopy *pRegions) {
     layer_data *device_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
 
     auto cb_node = GetCBNode(device_data, commandBuffer);
     auto src_buffer_state = GetBufferState(device_data, srcBuffer);
@@ -7387,7 +8233,7 @@ VKAPI_ATTR void VKAPI_CALL CmdCopyImage(VkCommandBuffer commandBuffer, VkImage s
                                         const VkImageCopy *pRegions) {
     bool skip = false;
     layer_data *device_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
 
     auto cb_node = GetCBNode(device_data, commandBuffer);
     auto src_image_state = GetImageState(device_data, srcImage);
@@ -7426,7 +8272,7 @@ VKAPI_ATTR void VKAPI_CALL CmdBlitImage(VkCommandBuffer commandBuffer, VkImage s
                                         VkImage dstImage, VkImageLayout dstImageLayout, uint32_t regionCount,
                                         const VkImageBlit *pRegions, VkFilter filter) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
 
     auto cb_node = GetCBNode(dev_data, commandBuffer);
     auto src_image_state = GetImageState(dev_data, srcImage);
@@ -7446,7 +8292,7 @@ VKAPI_ATTR void VKAPI_CALL CmdCopyBufferToImage(VkCommandBuffer commandBuffer, V
                                                 VkImageLayout dstImageLayout, uint32_t regionCount,
                                                 const VkBufferImageCopy *pRegions) {
     layer_data *device_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     bool skip = false;
     auto cb_node = GetCBNode(device_data, commandBuffer);
     auto src_buffer_state = GetBufferState(device_data, srcBuffer);
@@ -7471,7 +8317,7 @@ VKAPI_ATTR void VKAPI_CALL CmdCopyImageToBuffer(VkCommandBuffer commandBuffer, V
                                                 VkBuffer dstBuffer, uint32_t regionCount, const VkBufferImageCopy *pRegions) {
     bool skip = false;
     layer_data *device_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
 
     auto cb_node = GetCBNode(device_data, commandBuffer);
     auto src_image_state = GetImageState(device_data, srcImage);
@@ -7496,7 +8342,7 @@ VKAPI_ATTR void VKAPI_CALL CmdUpdateBuffer(VkCommandBuffer commandBuffer, VkBuff
                                            VkDeviceSize dataSize, const uint32_t *pData) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
 
     auto cb_node = GetCBNode(dev_data, commandBuffer);
     auto dst_buff_state = GetBufferState(dev_data, dstBuffer);
@@ -7529,7 +8375,7 @@ VKAPI_ATTR void VKAPI_CALL CmdUpdateBuffer(VkCommandBuffer commandBuffer, VkBuff
 VKAPI_ATTR void VKAPI_CALL CmdFillBuffer(VkCommandBuffer commandBuffer, VkBuffer dstBuffer, VkDeviceSize dstOffset,
                                          VkDeviceSize size, uint32_t data) {
     layer_data *device_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     auto cb_node = GetCBNode(device_data, commandBuffer);
     auto buffer_state = GetBufferState(device_data, dstBuffer);
 
@@ -7552,7 +8398,7 @@ VKAPI_ATTR void VKAPI_CALL CmdClearAttachments(VkCommandBuffer commandBuffer, ui
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
     {
-        std::lock_guard<std::mutex> lock(global_lock);
+        read_lock_guard lock(global_lock);
         skip = PreCallValidateCmdClearAttachments(dev_data, commandBuffer, attachmentCount, pAttachments, rectCount, pRects);
     }
     if (!skip) dev_data->dispatch_table.CmdClearAttachments(commandBuffer, attachmentCount, pAttachments, rectCount, pRects);
@@ -7562,7 +8408,7 @@ VKAPI_ATTR void VKAPI_CALL CmdClearColorImage(VkCommandBuffer commandBuffer, VkI
                                               const VkClearColorValue *pColor, uint32_t rangeCount,
                                               const VkImageSubresourceRange *pRanges) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
 
     bool skip = PreCallValidateCmdClearColorImage(dev_data, commandBuffer, image, imageLayout, rangeCount, pRanges);
     if (!skip) {
@@ -7576,7 +8422,7 @@ VKAPI_ATTR void VKAPI_CALL CmdClearDepthStencilImage(VkCommandBuffer commandBuff
                                                      const VkClearDepthStencilValue *pDepthStencil, uint32_t rangeCount,
                                                      const VkImageSubresourceRange *pRanges) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
 
     bool skip = PreCallValidateCmdClearDepthStencilImage(dev_data, commandBuffer, image, imageLayout, rangeCount, pRanges);
     if (!skip) {
@@ -7590,7 +8436,7 @@ VKAPI_ATTR void VKAPI_CALL CmdResolveImage(VkCommandBuffer commandBuffer, VkImag
                                            VkImage dstImage, VkImageLayout dstImageLayout, uint32_t regionCount,
                                            const VkImageResolve *pRegions) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
 
     auto cb_node = GetCBNode(dev_data, commandBuffer);
     auto src_image_state = GetImageState(dev_data, srcImage);
@@ -7632,7 +8478,7 @@ bool setEventStageMask(VkQueue queue, VkCommandBuffer commandBuffer, VkEvent eve
 VKAPI_ATTR void VKAPI_CALL CmdSetEvent(VkCommandBuffer commandBuffer, VkEvent event, VkPipelineStageFlags stageMask) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     GLOBAL_CB_NODE *pCB = GetCBNode(dev_data, commandBuffer);
     if (pCB) {
         skip |= ValidateCmdQueueFlags(dev_data, pCB, "vkCmdSetEvent()", VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT,
@@ -7644,8 +8490,7 @@ VKAPI_ATTR void VKAPI_CALL CmdSetEvent(VkCommandBuffer commandBuffer, VkEvent ev
                                              VALIDATION_ERROR_1d4008fe);
         auto event_state = GetEventNode(dev_data, event);
         if (event_state) {
-            addCommandBufferBinding(&event_state->cb_bindings, {HandleToUint64(event), kVulkanObjectTypeEvent}, pCB);
-            event_state->cb_bindings.insert(pCB);
+            addCommandBufferBinding(event_state, {HandleToUint64(event), kVulkanObjectTypeEvent}, pCB);
         }
         pCB->events.push_back(event);
         if (!pCB->waitedEvents.count(event)) {
@@ -7662,7 +8507,7 @@ VKAPI_ATTR void VKAPI_CALL CmdSetEvent(VkCommandBuffer commandBuffer, VkEvent ev
 VKAPI_ATTR void VKAPI_CALL CmdResetEvent(VkCommandBuffer commandBuffer, VkEvent event, VkPipelineStageFlags stageMask) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     GLOBAL_CB_NODE *pCB = GetCBNode(dev_data, commandBuffer);
     if (pCB) {
         skip |= ValidateCmdQueueFlags(dev_data, pCB, "vkCmdResetEvent()", VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT,
@@ -7674,8 +8519,7 @@ VKAPI_ATTR void VKAPI_CALL CmdResetEvent(VkCommandBuffer commandBuffer, VkEvent
                                              VALIDATION_ERROR_1c400906);
         auto event_state = GetEventNode(dev_data, event);
         if (event_state) {
-            addCommandBufferBinding(&event_state->cb_bindings, {HandleToUint64(event), kVulkanObjectTypeEvent}, pCB);
-            event_state->cb_bindings.insert(pCB);
+            addCommandBufferBinding(event_state, {HandleToUint64(event), kVulkanObjectTypeEvent}, pCB);
         }
         pCB->events.push_back(event);
         if (!pCB->waitedEvents.count(event)) {
@@ -7928,7 +8772,8 @@ bool ValidateStageMasksAgainstQueueCapabilities(layer_data *dev_data, GLOBAL_CB_
                                                 VkPipelineStageFlags source_stage_mask, VkPipelineStageFlags dest_stage_mask,
                                                 const char *function, UNIQUE_VALIDATION_ERROR_CODE error_code) {
     bool skip = false;
-    uint32_t queue_family_index = dev_data->commandPoolMap[cb_state->createInfo.commandPool].queueFamilyIndex;
+    auto pool = GetCommandPoolNode(dev_data, cb_state->createInfo.commandPool);
+    uint32_t queue_family_index = pool ? pool->queueFamilyIndex : VK_QUEUE_FAMILY_IGNORED;
     instance_layer_data *instance_data = GetLayerDataPtr(get_dispatch_key(dev_data->physical_device), instance_layer_data_map);
     auto physical_device_state = GetPhysicalDeviceState(instance_data, dev_data->physical_device);
 
@@ -7958,7 +8803,7 @@ VKAPI_ATTR void VKAPI_CALL CmdWaitEvents(VkCommandBuffer commandBuffer, uint32_t
                                          uint32_t imageMemoryBarrierCount, const VkImageMemoryBarrier *pImageMemoryBarriers) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     GLOBAL_CB_NODE *cb_state = GetCBNode(dev_data, commandBuffer);
     if (cb_state) {
         skip |= ValidateStageMasksAgainstQueueCapabilities(dev_data, cb_state, sourceStageMask, dstStageMask, "vkCmdWaitEvents",
@@ -7971,8 +8816,7 @@ VKAPI_ATTR void VKAPI_CALL CmdWaitEvents(VkCommandBuffer commandBuffer, uint32_t
         for (uint32_t i = 0; i < eventCount; ++i) {
             auto event_state = GetEventNode(dev_data, pEvents[i]);
             if (event_state) {
-                addCommandBufferBinding(&event_state->cb_bindings, {HandleToUint64(pEvents[i]), kVulkanObjectTypeEvent}, cb_state);
-                event_state->cb_bindings.insert(cb_state);
+                addCommandBufferBinding(event_state, {HandleToUint64(pEvents[i]), kVulkanObjectTypeEvent}, cb_state);
             }
             cb_state->waitedEvents.insert(pEvents[i]);
             cb_state->events.push_back(pEvents[i]);
@@ -8035,7 +8879,7 @@ VKAPI_ATTR void VKAPI_CALL CmdPipelineBarrier(VkCommandBuffer commandBuffer, VkP
                                               uint32_t imageMemoryBarrierCount, const VkImageMemoryBarrier *pImageMemoryBarriers) {
     bool skip = false;
     layer_data *device_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     GLOBAL_CB_NODE *cb_state = GetCBNode(device_data, commandBuffer);
     if (cb_state) {
         skip |= PreCallValidateCmdPipelineBarrier(device_data, cb_state, commandBuffer, srcStageMask, dstStageMask,
@@ -8071,7 +8915,7 @@ bool setQueryState(VkQueue queue, VkCommandBuffer commandBuffer, QueryObject obj
 VKAPI_ATTR void VKAPI_CALL CmdBeginQuery(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t slot, VkFlags flags) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     GLOBAL_CB_NODE *pCB = GetCBNode(dev_data, commandBuffer);
     if (pCB) {
         QueryObject query = {queryPool, slot};
@@ -8083,7 +8927,7 @@ VKAPI_ATTR void VKAPI_CALL CmdBeginQuery(VkCommandBuffer commandBuffer, VkQueryP
                                       VALIDATION_ERROR_17802415);
         skip |= ValidateCmd(dev_data, pCB, CMD_BEGINQUERY, "vkCmdBeginQuery()");
         UpdateCmdBufferLastCmd(pCB, CMD_BEGINQUERY);
-        addCommandBufferBinding(&GetQueryPoolNode(dev_data, queryPool)->cb_bindings,
+        addCommandBufferBinding(GetQueryPoolNode(dev_data, queryPool),
                                 {HandleToUint64(queryPool), kVulkanObjectTypeQueryPool}, pCB);
     }
     lock.unlock();
@@ -8093,7 +8937,7 @@ VKAPI_ATTR void VKAPI_CALL CmdBeginQuery(VkCommandBuffer commandBuffer, VkQueryP
 VKAPI_ATTR void VKAPI_CALL CmdEndQuery(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t slot) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     GLOBAL_CB_NODE *cb_state = GetCBNode(dev_data, commandBuffer);
     if (cb_state) {
         QueryObject query = {queryPool, slot};
@@ -8111,7 +8955,7 @@ VKAPI_ATTR void VKAPI_CALL CmdEndQuery(VkCommandBuffer commandBuffer, VkQueryPoo
                                       VALIDATION_ERROR_1ae02415);
         skip |= ValidateCmd(dev_data, cb_state, CMD_ENDQUERY, "VkCmdEndQuery()");
         UpdateCmdBufferLastCmd(cb_state, CMD_ENDQUERY);
-        addCommandBufferBinding(&GetQueryPoolNode(dev_data, queryPool)->cb_bindings,
+        addCommandBufferBinding(GetQueryPoolNode(dev_data, queryPool),
                                 {HandleToUint64(queryPool), kVulkanObjectTypeQueryPool}, cb_state);
     }
     lock.unlock();
@@ -8122,12 +8966,13 @@ VKAPI_ATTR void VKAPI_CALL CmdResetQueryPool(VkCommandBuffer commandBuffer, VkQu
                                              uint32_t queryCount) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     GLOBAL_CB_NODE *cb_state = GetCBNode(dev_data, commandBuffer);
     if (cb_state) {
         for (uint32_t i = 0; i < queryCount; i++) {
             QueryObject query = {queryPool, firstQuery + i};
-            cb_state->waitedEventsBeforeQueryReset[query] = cb_state->waitedEvents;
+            cb_state->waitedEventsBeforeQueryReset[query] =
+                std::unordered_set<VkEvent>(cb_state->waitedEvents.begin(), cb_state->waitedEvents.end());
             std::function<bool(VkQueue)> query_update =
                 std::bind(setQueryState, std::placeholders::_1, commandBuffer, query, false);
             cb_state->queryUpdates.push_back(query_update);
@@ -8137,7 +8982,7 @@ VKAPI_ATTR void VKAPI_CALL CmdResetQueryPool(VkCommandBuffer commandBuffer, VkQu
         skip |= ValidateCmd(dev_data, cb_state, CMD_RESETQUERYPOOL, "VkCmdResetQueryPool()");
         UpdateCmdBufferLastCmd(cb_state, CMD_RESETQUERYPOOL);
         skip |= insideRenderPass(dev_data, cb_state, "vkCmdResetQueryPool()", VALIDATION_ERROR_1c600017);
-        addCommandBufferBinding(&GetQueryPoolNode(dev_data, queryPool)->cb_bindings,
+        addCommandBufferBinding(GetQueryPoolNode(dev_data, queryPool),
                                 {HandleToUint64(queryPool), kVulkanObjectTypeQueryPool}, cb_state);
     }
     lock.unlock();
@@ -8182,7 +9027,7 @@ VKAPI_ATTR void VKAPI_CALL CmdCopyQueryPoolResults(VkCommandBuffer commandBuffer
                                                    VkDeviceSize stride, VkQueryResultFlags flags) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
 
     auto cb_node = GetCBNode(dev_data, commandBuffer);
     auto dst_buff_state = GetBufferState(dev_data, dstBuffer);
@@ -8207,7 +9052,7 @@ VKAPI_ATTR void VKAPI_CALL CmdCopyQueryPoolResults(VkCommandBuffer commandBuffer
         skip |= ValidateCmd(dev_data, cb_node, CMD_COPYQUERYPOOLRESULTS, "vkCmdCopyQueryPoolResults()");
         UpdateCmdBufferLastCmd(cb_node, CMD_COPYQUERYPOOLRESULTS);
         skip |= insideRenderPass(dev_data, cb_node, "vkCmdCopyQueryPoolResults()", VALIDATION_ERROR_19400017);
-        addCommandBufferBinding(&GetQueryPoolNode(dev_data, queryPool)->cb_bindings,
+        addCommandBufferBinding(GetQueryPoolNode(dev_data, queryPool),
                                 {HandleToUint64(queryPool), kVulkanObjectTypeQueryPool}, cb_node);
     } else {
         assert(0);
@@ -8222,7 +9067,7 @@ VKAPI_ATTR void VKAPI_CALL CmdPushConstants(VkCommandBuffer commandBuffer, VkPip
                                             uint32_t offset, uint32_t size, const void *pValues) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     GLOBAL_CB_NODE *cb_state = GetCBNode(dev_data, commandBuffer);
     if (cb_state) {
         skip |= ValidateCmdQueueFlags(dev_data, cb_state, "vkCmdPushConstants()", VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT,
@@ -8268,7 +9113,7 @@ VKAPI_ATTR void VKAPI_CALL CmdWriteTimestamp(VkCommandBuffer commandBuffer, VkPi
                                              VkQueryPool queryPool, uint32_t slot) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     GLOBAL_CB_NODE *cb_state = GetCBNode(dev_data, commandBuffer);
     if (cb_state) {
         QueryObject query = {queryPool, slot};
@@ -8508,7 +9353,7 @@ static void PostCallRecordCreateFramebuffer(layer_data *dev_data, const VkFrameb
 VKAPI_ATTR VkResult VKAPI_CALL CreateFramebuffer(VkDevice device, const VkFramebufferCreateInfo *pCreateInfo,
                                                  const VkAllocationCallbacks *pAllocator, VkFramebuffer *pFramebuffer) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     bool skip = PreCallValidateCreateFramebuffer(dev_data, pCreateInfo);
     lock.unlock();
 
@@ -8783,8 +9628,15 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateShaderModule(VkDevice device, const VkShade
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     bool skip = false;
     spv_result_t spv_valid = SPV_SUCCESS;
+    const bool use_cache = shader_cache.Enabled() && !(pCreateInfo->codeSize % 4);
+    shader_reflection_cache::key cache_key = {};
+    std::shared_ptr<const shader_reflection> cached;
+    if (use_cache && !GetDisables(dev_data)->shader_validation) {
+        cache_key = shader_reflection_cache::Hash(pCreateInfo);
+        cached = shader_cache.Find(cache_key);
+    }
 
-    if (!GetDisables(dev_data)->shader_validation) {
+    if (!GetDisables(dev_data)->shader_validation && !cached) {
         if (!dev_data->device_extensions.nv_glsl_shader && (pCreateInfo->codeSize % 4)) {
             skip |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
                             __LINE__, VALIDATION_ERROR_12a00ac0, "SC",
@@ -8816,8 +9668,16 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateShaderModule(VkDevice device, const VkShade
     VkResult res = dev_data->dispatch_table.CreateShaderModule(device, pCreateInfo, pAllocator, pShaderModule);
 
     if (res == VK_SUCCESS && !GetDisables(dev_data)->shader_validation) {
-        std::lock_guard<std::mutex> lock(global_lock);
-        const auto new_shader_module = (SPV_SUCCESS == spv_valid ? new shader_module(pCreateInfo) : new shader_module());
+        std::lock_guard<rw_lock> lock(global_lock);
+        shader_module *new_shader_module;
+        if (cached) {
+            new_shader_module = new shader_module(pCreateInfo, *cached);
+        } else if (SPV_SUCCESS == spv_valid) {
+            new_shader_module = new shader_module(pCreateInfo);
+            if (use_cache) shader_cache.Insert(cache_key, *new_shader_module);
+        } else {
+            new_shader_module = new shader_module();
+        }
         dev_data->shaderModuleMap[*pShaderModule] = unique_ptr<shader_module>(new_shader_module);
     }
     return res;
@@ -8977,7 +9837,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateRenderPass(VkDevice device, const VkRenderP
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     // TODO: As part of wrapping up the mem_tracker/core_validation merge the following routine should be consolidated with
     //       ValidateLayouts.
     skip |= ValidateRenderpassAttachmentUsage(dev_data, pCreateInfo);
@@ -9083,7 +9943,7 @@ VKAPI_ATTR void VKAPI_CALL CmdBeginRenderPass(VkCommandBuffer commandBuffer, con
                                               VkSubpassContents contents) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     GLOBAL_CB_NODE *cb_node = GetCBNode(dev_data, commandBuffer);
     auto render_pass_state = pRenderPassBegin ? GetRenderPassState(dev_data, pRenderPassBegin->renderPass) : nullptr;
     auto framebuffer = pRenderPassBegin ? GetFramebufferState(dev_data, pRenderPassBegin->framebuffer) : nullptr;
@@ -9149,6 +10009,7 @@ VKAPI_ATTR void VKAPI_CALL CmdBeginRenderPass(VkCommandBuffer commandBuffer, con
             skip |= ValidateCmd(dev_data, cb_node, CMD_BEGINRENDERPASS, "vkCmdBeginRenderPass()");
             UpdateCmdBufferLastCmd(cb_node, CMD_BEGINRENDERPASS);
             cb_node->activeRenderPass = render_pass_state;
+            ++cb_node->draw_state_generation;
             // This is a shallow copy as that is all that is needed for now
             cb_node->activeRenderPassBeginInfo = *pRenderPassBegin;
             cb_node->activeSubpass = 0;
@@ -9169,7 +10030,7 @@ VKAPI_ATTR void VKAPI_CALL CmdBeginRenderPass(VkCommandBuffer commandBuffer, con
 VKAPI_ATTR void VKAPI_CALL CmdNextSubpass(VkCommandBuffer commandBuffer, VkSubpassContents contents) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     GLOBAL_CB_NODE *pCB = GetCBNode(dev_data, commandBuffer);
     if (pCB) {
         skip |= validatePrimaryCommandBuffer(dev_data, pCB, "vkCmdNextSubpass()", VALIDATION_ERROR_1b600019);
@@ -9195,6 +10056,7 @@ VKAPI_ATTR void VKAPI_CALL CmdNextSubpass(VkCommandBuffer commandBuffer, VkSubpa
     if (pCB) {
         lock.lock();
         pCB->activeSubpass++;
+        ++pCB->draw_state_generation;
         pCB->activeSubpassContents = contents;
         TransitionSubpassLayouts(dev_data, pCB, pCB->activeRenderPass, pCB->activeSubpass,
                                  GetFramebufferState(dev_data, pCB->activeRenderPassBeginInfo.framebuffer));
@@ -9204,7 +10066,7 @@ VKAPI_ATTR void VKAPI_CALL CmdNextSubpass(VkCommandBuffer commandBuffer, VkSubpa
 VKAPI_ATTR void VKAPI_CALL CmdEndRenderPass(VkCommandBuffer commandBuffer) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    read_lock_guard lock(global_lock);
     auto pCB = GetCBNode(dev_data, commandBuffer);
     FRAMEBUFFER_STATE *framebuffer = NULL;
     if (pCB) {
@@ -9256,6 +10118,7 @@ VKAPI_ATTR void VKAPI_CALL CmdEndRenderPass(VkCommandBuffer commandBuffer) {
         pCB->activeRenderPass = nullptr;
         pCB->activeSubpass = 0;
         pCB->activeFramebuffer = VK_NULL_HANDLE;
+        ++pCB->draw_state_generation;
     }
 }
 
@@ -9477,7 +10340,7 @@ VKAPI_ATTR void VKAPI_CALL CmdExecuteCommands(VkCommandBuffer commandBuffer, uin
                                               const VkCommandBuffer *pCommandBuffers) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     GLOBAL_CB_NODE *pCB = GetCBNode(dev_data, commandBuffer);
     if (pCB) {
         GLOBAL_CB_NODE *pSubCB = NULL;
@@ -9565,9 +10428,7 @@ VKAPI_ATTR void VKAPI_CALL CmdExecuteCommands(VkCommandBuffer commandBuffer, uin
             }
             // TODO: separate validate from update! This is very tangled.
             // Propagate layout transitions to the primary cmd buffer
-            for (auto ilm_entry : pSubCB->imageLayoutMap) {
-                SetLayout(dev_data, pCB, ilm_entry.first, ilm_entry.second);
-            }
+            SetLayoutsFromSecondaryCmdBuf(dev_data, pCB, pSubCB);
             pSubCB->primaryCommandBuffer = pCB->commandBuffer;
             pCB->linkedCommandBuffers.insert(pSubCB);
             pSubCB->linkedCommandBuffers.insert(pCB);
@@ -9592,7 +10453,7 @@ VKAPI_ATTR VkResult VKAPI_CALL MapMemory(VkDevice device, VkDeviceMemory mem, Vk
 
     bool skip = false;
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     DEVICE_MEM_INFO *mem_info = GetMemObjInfo(dev_data, mem);
     if (mem_info) {
         // TODO : This could me more fine-grained to track just region that is valid
@@ -9629,7 +10490,7 @@ VKAPI_ATTR void VKAPI_CALL UnmapMemory(VkDevice device, VkDeviceMemory mem) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     bool skip = false;
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     skip |= deleteMemRanges(dev_data, mem);
     lock.unlock();
     if (!skip) {
@@ -9749,7 +10610,7 @@ static bool ValidateMappedMemoryRangeDeviceLimits(layer_data *dev_data, const ch
 static bool PreCallValidateFlushMappedMemoryRanges(layer_data *dev_data, uint32_t mem_range_count,
                                                    const VkMappedMemoryRange *mem_ranges) {
     bool skip = false;
-    std::lock_guard<std::mutex> lock(global_lock);
+    std::lock_guard<rw_lock> lock(global_lock);
     skip |= ValidateAndCopyNoncoherentMemoryToDriver(dev_data, mem_range_count, mem_ranges);
     skip |= validateMemoryIsMapped(dev_data, "vkFlushMappedMemoryRanges", mem_range_count, mem_ranges);
     return skip;
@@ -9769,14 +10630,14 @@ VKAPI_ATTR VkResult VKAPI_CALL FlushMappedMemoryRanges(VkDevice device, uint32_t
 static bool PreCallValidateInvalidateMappedMemoryRanges(layer_data *dev_data, uint32_t mem_range_count,
                                                         const VkMappedMemoryRange *mem_ranges) {
     bool skip = false;
-    std::lock_guard<std::mutex> lock(global_lock);
+    std::lock_guard<rw_lock> lock(global_lock);
     skip |= validateMemoryIsMapped(dev_data, "vkInvalidateMappedMemoryRanges", mem_range_count, mem_ranges);
     return skip;
 }
 
 static void PostCallRecordInvalidateMappedMemoryRanges(layer_data *dev_data, uint32_t mem_range_count,
                                                        const VkMappedMemoryRange *mem_ranges) {
-    std::lock_guard<std::mutex> lock(global_lock);
+    std::lock_guard<rw_lock> lock(global_lock);
     // Update our shadow copy with modified driver data
     CopyNoncoherentMemoryFromDriver(dev_data, mem_range_count, mem_ranges);
 }
@@ -9799,7 +10660,7 @@ static bool PreCallValidateBindImageMemory(layer_data *dev_data, VkImage image,
                                            VkDeviceSize memoryOffset) {
     bool skip = false;
     if (image_state) {
-        std::unique_lock<std::mutex> lock(global_lock);
+        std::unique_lock<rw_lock> lock(global_lock);
         // Track objects tied to memory
         uint64_t image_handle = HandleToUint64(image);
         skip = ValidateSetMemBinding(dev_data, mem, image_handle, kVulkanObjectTypeImage, "vkBindImageMemory()");
@@ -9856,7 +10717,7 @@ static bool PreCallValidateBindImageMemory(layer_data *dev_data, VkImage image,
 static void PostCallRecordBindImageMemory(layer_data *dev_data, VkImage image, IMAGE_STATE *image_state, VkDeviceMemory mem,
                                           VkDeviceSize memoryOffset) {
     if (image_state) {
-        std::unique_lock<std::mutex> lock(global_lock);
+        std::unique_lock<rw_lock> lock(global_lock);
         // Track bound memory range information
         auto mem_info = GetMemObjInfo(dev_data, mem);
         if (mem_info) {
@@ -9892,7 +10753,7 @@ VKAPI_ATTR VkResult VKAPI_CALL SetEvent(VkDevice device, VkEvent event) {
     bool skip = false;
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     auto event_state = GetEventNode(dev_data, event);
     if (event_state) {
         event_state->needsSignaled = false;
@@ -9921,9 +10782,11 @@ VKAPI_ATTR VkResult VKAPI_CALL SetEvent(VkDevice device, VkEvent event) {
 VKAPI_ATTR VkResult VKAPI_CALL QueueBindSparse(VkQueue queue, uint32_t bindInfoCount, const VkBindSparseInfo *pBindInfo,
                                                VkFence fence) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(queue), layer_data_map);
+    traced_call trace(dev_data, "vkQueueBindSparse");
+    trace.args().AddHandle("queue", HandleToUint64(queue)).Add("bindInfoCount", bindInfoCount).AddHandle("fence", HandleToUint64(fence));
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
     bool skip = false;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     auto pFence = GetFenceNode(dev_data, fence);
     auto pQueue = GetQueueState(dev_data, queue);
 
@@ -10006,14 +10869,14 @@ VKAPI_ATTR VkResult VKAPI_CALL QueueBindSparse(VkQueue queue, uint32_t bindInfoC
             }
         }
 
-        pQueue->submissions.emplace_back(std::vector<VkCommandBuffer>(), semaphore_waits, semaphore_signals,
-                                         bindIdx == bindInfoCount - 1 ? fence : VK_NULL_HANDLE);
+        RecordSubmission(dev_data, pQueue, std::vector<VkCommandBuffer>(), semaphore_waits, semaphore_signals,
+                         bindIdx == bindInfoCount - 1 ? fence : VK_NULL_HANDLE);
     }
 
     if (pFence && !bindInfoCount) {
         // No work to do, just dropping a fence in the queue by itself.
-        pQueue->submissions.emplace_back(std::vector<VkCommandBuffer>(), std::vector<SEMAPHORE_WAIT>(), std::vector<VkSemaphore>(),
-                                         fence);
+        RecordSubmission(dev_data, pQueue, std::vector<VkCommandBuffer>(), std::vector<SEMAPHORE_WAIT>(),
+                         std::vector<VkSemaphore>(), fence);
     }
 
     lock.unlock();
@@ -10028,7 +10891,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateSemaphore(VkDevice device, const VkSemaphor
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->dispatch_table.CreateSemaphore(device, pCreateInfo, pAllocator, pSemaphore);
     if (result == VK_SUCCESS) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         SEMAPHORE_NODE *sNode = &dev_data->semaphoreMap[*pSemaphore];
         sNode->signaler.first = VK_NULL_HANDLE;
         sNode->signaler.second = 0;
@@ -10042,7 +10905,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateEvent(VkDevice device, const VkEventCreateI
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->dispatch_table.CreateEvent(device, pCreateInfo, pAllocator, pEvent);
     if (result == VK_SUCCESS) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         dev_data->eventMap[*pEvent].needsSignaled = false;
         dev_data->eventMap[*pEvent].write_in_use = 0;
         dev_data->eventMap[*pEvent].stageMask = VkPipelineStageFlags(0);
@@ -10302,7 +11165,7 @@ static void PostCallRecordCreateSwapchainKHR(layer_data *dev_data, VkResult resu
                                              VkSwapchainKHR *pSwapchain, SURFACE_STATE *surface_state,
                                              SWAPCHAIN_NODE *old_swapchain_state) {
     if (VK_SUCCESS == result) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         auto swapchain_state = unique_ptr<SWAPCHAIN_NODE>(new SWAPCHAIN_NODE(pCreateInfo, *pSwapchain));
         if (VK_PRESENT_MODE_SHARED_DEMAND_REFRESH_KHR == pCreateInfo->presentMode ||
             VK_PRESENT_MODE_SHARED_CONTINUOUS_REFRESH_KHR == pCreateInfo->presentMode) {
@@ -10342,21 +11205,11 @@ VKAPI_ATTR void VKAPI_CALL DestroySwapchainKHR(VkDevice device, VkSwapchainKHR s
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     bool skip = false;
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     auto swapchain_data = GetSwapchainNode(dev_data, swapchain);
     if (swapchain_data) {
         if (swapchain_data->images.size() > 0) {
             for (auto swapchain_image : swapchain_data->images) {
-                auto image_sub = dev_data->imageSubresourceMap.find(swapchain_image);
-                if (image_sub != dev_data->imageSubresourceMap.end()) {
-                    for (auto imgsubpair : image_sub->second) {
-                        auto image_item = dev_data->imageLayoutMap.find(imgsubpair);
-                        if (image_item != dev_data->imageLayoutMap.end()) {
-                            dev_data->imageLayoutMap.erase(image_item);
-                        }
-                    }
-                    dev_data->imageSubresourceMap.erase(image_sub);
-                }
                 skip = ClearMemoryObjectBindings(dev_data, HandleToUint64(swapchain_image), kVulkanObjectTypeSwapchainKHR);
                 dev_data->imageMap.erase(swapchain_image);
             }
@@ -10382,7 +11235,7 @@ VKAPI_ATTR VkResult VKAPI_CALL GetSwapchainImagesKHR(VkDevice device, VkSwapchai
     if (result == VK_SUCCESS && pSwapchainImages != NULL) {
         // This should never happen and is checked by param checker.
         if (!pCount) return result;
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         const size_t count = *pCount;
         auto swapchain_node = GetSwapchainNode(dev_data, swapchain);
         if (swapchain_node && !swapchain_node->images.empty()) {
@@ -10399,10 +11252,7 @@ VKAPI_ATTR VkResult VKAPI_CALL GetSwapchainImagesKHR(VkDevice device, VkSwapchai
             }
         }
         for (uint32_t i = 0; i < *pCount; ++i) {
-            IMAGE_LAYOUT_NODE image_layout_node;
-            image_layout_node.layout = VK_IMAGE_LAYOUT_UNDEFINED;
-            image_layout_node.format = swapchain_node->createInfo.imageFormat;
-            // Add imageMap entries for each swapchain image
+            // Add imageMap entries for each swapchain image, which start out in VK_IMAGE_LAYOUT_UNDEFINED
             VkImageCreateInfo image_ci = {};
             image_ci.flags = 0;
             image_ci.imageType = VK_IMAGE_TYPE_2D;
@@ -10421,9 +11271,6 @@ VKAPI_ATTR VkResult VKAPI_CALL GetSwapchainImagesKHR(VkDevice device, VkSwapchai
             image_state->valid = false;
             image_state->binding.mem = MEMTRACKER_SWAP_CHAIN_IMAGE_KEY;
             swapchain_node->images.push_back(pSwapchainImages[i]);
-            ImageSubresourcePair subpair = {pSwapchainImages[i], false, VkImageSubresource()};
-            dev_data->imageSubresourceMap[pSwapchainImages[i]].push_back(subpair);
-            dev_data->imageLayoutMap[subpair] = image_layout_node;
         }
     }
     return result;
@@ -10433,7 +11280,7 @@ VKAPI_ATTR VkResult VKAPI_CALL QueuePresentKHR(VkQueue queue, const VkPresentInf
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(queue), layer_data_map);
     bool skip = false;
 
-    std::lock_guard<std::mutex> lock(global_lock);
+    std::lock_guard<rw_lock> lock(global_lock);
     auto queue_state = GetQueueState(dev_data, queue);
 
     for (uint32_t i = 0; i < pPresentInfo->waitSemaphoreCount; ++i) {
@@ -10616,6 +11463,36 @@ VKAPI_ATTR VkResult VKAPI_CALL QueuePresentKHR(VkQueue queue, const VkPresentInf
         // semaphore waits) /never/ participate in any completion proof.
     }
 
+    if (dev_data->cb_state_allocations) {
+        log_msg(dev_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_QUEUE_EXT,
+                HandleToUint64(queue), __LINE__, MEMTRACK_NONE, "MEM",
+                "vkQueuePresentKHR(): Command buffers reset since the last present made %" PRIu64
+                " allocations for recorded state, %" PRIu64 " of which went to the system heap.",
+                dev_data->cb_state_allocations, dev_data->cb_state_system_allocations);
+        dev_data->cb_state_allocations = 0;
+        dev_data->cb_state_system_allocations = 0;
+    }
+    if (dev_data->draw_validations) {
+        log_msg(dev_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_QUEUE_EXT,
+                HandleToUint64(queue), __LINE__, DRAWSTATE_NONE, "DS",
+                "vkQueuePresentKHR(): Command buffers reset since the last present recorded %" PRIu64
+                " draws and dispatches, %" PRIu64 " of which reused the draw-time validation of an identical earlier one.",
+                dev_data->draw_validations, dev_data->draw_validations_reused);
+        dev_data->draw_validations = 0;
+        dev_data->draw_validations_reused = 0;
+    }
+    if (dev_data->validation_sample_rate > 1 && dev_data->recordings_since_present) {
+        log_msg(dev_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_QUEUE_EXT,
+                HandleToUint64(queue), __LINE__, DRAWSTATE_NONE, "DS",
+                "vkQueuePresentKHR(): %" PRIu64 " of the %" PRIu64
+                " command buffer recordings begun since the last present were sampled for draw-time validation; %" PRIu64
+                " draws and dispatches in command buffers reset since then went unvalidated.",
+                dev_data->recordings_sampled, dev_data->recordings_since_present, dev_data->draw_validations_unsampled);
+        dev_data->recordings_since_present = 0;
+        dev_data->recordings_sampled = 0;
+        dev_data->draw_validations_unsampled = 0;
+    }
+
     return result;
 }
 
@@ -10624,7 +11501,7 @@ static bool PreCallValidateCreateSharedSwapchainsKHR(layer_data *dev_data, uint3
                                                      std::vector<SURFACE_STATE *> &surface_state,
                                                      std::vector<SWAPCHAIN_NODE *> &old_swapchain_state) {
     if (pCreateInfos) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         for (uint32_t i = 0; i < swapchainCount; i++) {
             surface_state.push_back(GetSurfaceState(dev_data->instance_data, pCreateInfos[i].surface));
             old_swapchain_state.push_back(GetSwapchainNode(dev_data, pCreateInfos[i].oldSwapchain));
@@ -10694,7 +11571,7 @@ VKAPI_ATTR VkResult VKAPI_CALL AcquireNextImageKHR(VkDevice device, VkSwapchainK
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     bool skip = false;
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
 
     if (fence == VK_NULL_HANDLE && semaphore == VK_NULL_HANDLE) {
         skip |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_EXT,
@@ -10915,7 +11792,7 @@ VKAPI_ATTR void VKAPI_CALL GetPhysicalDeviceQueueFamilyProperties(VkPhysicalDevi
     instance_layer_data *instance_data = GetLayerDataPtr(get_dispatch_key(physicalDevice), instance_layer_data_map);
     auto physical_device_state = GetPhysicalDeviceState(instance_data, physicalDevice);
     assert(physical_device_state);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
 
     bool skip = PreCallValidateGetPhysicalDeviceQueueFamilyProperties(instance_data, physical_device_state,
                                                                       pQueueFamilyPropertyCount, pQueueFamilyProperties);
@@ -10937,7 +11814,7 @@ VKAPI_ATTR void VKAPI_CALL GetPhysicalDeviceQueueFamilyProperties2KHR(VkPhysical
     instance_layer_data *instance_data = GetLayerDataPtr(get_dispatch_key(physicalDevice), instance_layer_data_map);
     auto physical_device_state = GetPhysicalDeviceState(instance_data, physicalDevice);
     assert(physical_device_state);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
 
     bool skip = PreCallValidateGetPhysicalDeviceQueueFamilyProperties2KHR(instance_data, physical_device_state,
                                                                           pQueueFamilyPropertyCount, pQueueFamilyProperties);
@@ -10963,7 +11840,7 @@ static VkResult CreateSurface(VkInstance instance, TCreateInfo const *pCreateInf
     VkResult result = (instance_data->dispatch_table.*fptr)(instance, pCreateInfo, pAllocator, pSurface);
 
     if (result == VK_SUCCESS) {
-        std::unique_lock<std::mutex> lock(global_lock);
+        std::unique_lock<rw_lock> lock(global_lock);
         instance_data->surface_map[*pSurface] = SURFACE_STATE(*pSurface);
         lock.unlock();
     }
@@ -10974,7 +11851,7 @@ static VkResult CreateSurface(VkInstance instance, TCreateInfo const *pCreateInf
 VKAPI_ATTR void VKAPI_CALL DestroySurfaceKHR(VkInstance instance, VkSurfaceKHR surface, const VkAllocationCallbacks *pAllocator) {
     bool skip = false;
     instance_layer_data *instance_data = GetLayerDataPtr(get_dispatch_key(instance), instance_layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     auto surface_state = GetSurfaceState(instance_data, surface);
 
     if (surface_state) {
@@ -11012,7 +11889,7 @@ VKAPI_ATTR VkBool32 VKAPI_CALL GetPhysicalDeviceMirPresentationSupportKHR(VkPhys
     bool skip = false;
     instance_layer_data *instance_data = GetLayerDataPtr(get_dispatch_key(physicalDevice), instance_layer_data_map);
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     const auto pd_state = GetPhysicalDeviceState(instance_data, physicalDevice);
 
     skip |= ValidatePhysicalDeviceQueueFamily(instance_data, pd_state, queueFamilyIndex, VALIDATION_ERROR_2d2009e2,
@@ -11042,7 +11919,7 @@ VKAPI_ATTR VkBool32 VKAPI_CALL GetPhysicalDeviceWaylandPresentationSupportKHR(Vk
     bool skip = false;
     instance_layer_data *instance_data = GetLayerDataPtr(get_dispatch_key(physicalDevice), instance_layer_data_map);
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     const auto pd_state = GetPhysicalDeviceState(instance_data, physicalDevice);
 
     skip |= ValidatePhysicalDeviceQueueFamily(instance_data, pd_state, queueFamilyIndex, VALIDATION_ERROR_2f000a34,
@@ -11071,7 +11948,7 @@ VKAPI_ATTR VkBool32 VKAPI_CALL GetPhysicalDeviceWin32PresentationSupportKHR(VkPh
     bool skip = false;
     instance_layer_data *instance_data = GetLayerDataPtr(get_dispatch_key(physicalDevice), instance_layer_data_map);
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     const auto pd_state = GetPhysicalDeviceState(instance_data, physicalDevice);
 
     skip |= ValidatePhysicalDeviceQueueFamily(instance_data, pd_state, queueFamilyIndex, VALIDATION_ERROR_2f200a3a,
@@ -11100,7 +11977,7 @@ VKAPI_ATTR VkBool32 VKAPI_CALL GetPhysicalDeviceXcbPresentationSupportKHR(VkPhys
     bool skip = false;
     instance_layer_data *instance_data = GetLayerDataPtr(get_dispatch_key(physicalDevice), instance_layer_data_map);
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     const auto pd_state = GetPhysicalDeviceState(instance_data, physicalDevice);
 
     skip |= ValidatePhysicalDeviceQueueFamily(instance_data, pd_state, queueFamilyIndex, VALIDATION_ERROR_2f400a40,
@@ -11130,7 +12007,7 @@ VKAPI_ATTR VkBool32 VKAPI_CALL GetPhysicalDeviceXlibPresentationSupportKHR(VkPhy
     bool skip = false;
     instance_layer_data *instance_data = GetLayerDataPtr(get_dispatch_key(physicalDevice), instance_layer_data_map);
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     const auto pd_state = GetPhysicalDeviceState(instance_data, physicalDevice);
 
     skip |= ValidatePhysicalDeviceQueueFamily(instance_data, pd_state, queueFamilyIndex, VALIDATION_ERROR_2f600a46,
@@ -11152,7 +12029,7 @@ VKAPI_ATTR VkResult VKAPI_CALL GetPhysicalDeviceSurfaceCapabilitiesKHR(VkPhysica
                                                                        VkSurfaceCapabilitiesKHR *pSurfaceCapabilities) {
     auto instance_data = GetLayerDataPtr(get_dispatch_key(physicalDevice), instance_layer_data_map);
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     auto physical_device_state = GetPhysicalDeviceState(instance_data, physicalDevice);
     lock.unlock();
 
@@ -11170,7 +12047,7 @@ VKAPI_ATTR VkResult VKAPI_CALL GetPhysicalDeviceSurfaceCapabilitiesKHR(VkPhysica
 static void PostCallRecordGetPhysicalDeviceSurfaceCapabilities2KHR(instance_layer_data *instanceData,
                                                                    VkPhysicalDevice physicalDevice,
                                                                    VkSurfaceCapabilities2KHR *pSurfaceCapabilities) {
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     auto physicalDeviceState = GetPhysicalDeviceState(instanceData, physicalDevice);
     physicalDeviceState->vkGetPhysicalDeviceSurfaceCapabilitiesKHRState = QUERY_DETAILS;
     physicalDeviceState->surfaceCapabilities = pSurfaceCapabilities->surfaceCapabilities;
@@ -11194,7 +12071,7 @@ VKAPI_ATTR VkResult VKAPI_CALL GetPhysicalDeviceSurfaceCapabilities2KHR(VkPhysic
 static void PostCallRecordGetPhysicalDeviceSurfaceCapabilities2EXT(instance_layer_data *instanceData,
                                                                    VkPhysicalDevice physicalDevice,
                                                                    VkSurfaceCapabilities2EXT *pSurfaceCapabilities) {
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     auto physicalDeviceState = GetPhysicalDeviceState(instanceData, physicalDevice);
     physicalDeviceState->vkGetPhysicalDeviceSurfaceCapabilitiesKHRState = QUERY_DETAILS;
     physicalDeviceState->surfaceCapabilities.minImageCount = pSurfaceCapabilities->minImageCount;
@@ -11228,7 +12105,7 @@ VKAPI_ATTR VkResult VKAPI_CALL GetPhysicalDeviceSurfaceSupportKHR(VkPhysicalDevi
     bool skip = false;
     auto instance_data = GetLayerDataPtr(get_dispatch_key(physicalDevice), instance_layer_data_map);
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     const auto pd_state = GetPhysicalDeviceState(instance_data, physicalDevice);
     auto surface_state = GetSurfaceState(instance_data, surface);
 
@@ -11254,7 +12131,7 @@ VKAPI_ATTR VkResult VKAPI_CALL GetPhysicalDeviceSurfacePresentModesKHR(VkPhysica
                                                                        VkPresentModeKHR *pPresentModes) {
     bool skip = false;
     auto instance_data = GetLayerDataPtr(get_dispatch_key(physicalDevice), instance_layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     // TODO: this isn't quite right. available modes may differ by surface AND physical device.
     auto physical_device_state = GetPhysicalDeviceState(instance_data, physicalDevice);
     auto &call_state = physical_device_state->vkGetPhysicalDeviceSurfacePresentModesKHRState;
@@ -11315,7 +12192,7 @@ VKAPI_ATTR VkResult VKAPI_CALL GetPhysicalDeviceSurfaceFormatsKHR(VkPhysicalDevi
                                                                   VkSurfaceFormatKHR *pSurfaceFormats) {
     bool skip = false;
     auto instance_data = GetLayerDataPtr(get_dispatch_key(physicalDevice), instance_layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     auto physical_device_state = GetPhysicalDeviceState(instance_data, physicalDevice);
     auto &call_state = physical_device_state->vkGetPhysicalDeviceSurfaceFormatsKHRState;
 
@@ -11376,7 +12253,7 @@ VKAPI_ATTR VkResult VKAPI_CALL GetPhysicalDeviceSurfaceFormatsKHR(VkPhysicalDevi
 
 static void PostCallRecordGetPhysicalDeviceSurfaceFormats2KHR(instance_layer_data *instanceData, VkPhysicalDevice physicalDevice,
                                                               uint32_t *pSurfaceFormatCount, VkSurfaceFormat2KHR *pSurfaceFormats) {
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     auto physicalDeviceState = GetPhysicalDeviceState(instanceData, physicalDevice);
     if (*pSurfaceFormatCount) {
         if (physicalDeviceState->vkGetPhysicalDeviceSurfaceFormatsKHRState < QUERY_COUNT) {
@@ -11415,7 +12292,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateDebugReportCallbackEXT(VkInstance instance,
     instance_layer_data *instance_data = GetLayerDataPtr(get_dispatch_key(instance), instance_layer_data_map);
     VkResult res = instance_data->dispatch_table.CreateDebugReportCallbackEXT(instance, pCreateInfo, pAllocator, pMsgCallback);
     if (VK_SUCCESS == res) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         res = layer_create_msg_callback(instance_data->report_data, false, pCreateInfo, pAllocator, pMsgCallback);
     }
     return res;
@@ -11425,7 +12302,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyDebugReportCallbackEXT(VkInstance instance, Vk
                                                          const VkAllocationCallbacks *pAllocator) {
     instance_layer_data *instance_data = GetLayerDataPtr(get_dispatch_key(instance), instance_layer_data_map);
     instance_data->dispatch_table.DestroyDebugReportCallbackEXT(instance, msgCallback, pAllocator);
-    std::lock_guard<std::mutex> lock(global_lock);
+    std::lock_guard<rw_lock> lock(global_lock);
     layer_destroy_msg_callback(instance_data->report_data, msgCallback, pAllocator);
 }
 
@@ -11530,7 +12407,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateDescriptorUpdateTemplateKHR(VkDevice device
     VkResult result =
         dev_data->dispatch_table.CreateDescriptorUpdateTemplateKHR(device, pCreateInfo, pAllocator, pDescriptorUpdateTemplate);
     if (VK_SUCCESS == result) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<rw_lock> lock(global_lock);
         // Shadow template createInfo for later updates
         safe_VkDescriptorUpdateTemplateCreateInfoKHR *local_create_info =
             new safe_VkDescriptorUpdateTemplateCreateInfoKHR(pCreateInfo);
@@ -11544,7 +12421,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyDescriptorUpdateTemplateKHR(VkDevice device,
                                                               VkDescriptorUpdateTemplateKHR descriptorUpdateTemplate,
                                                               const VkAllocationCallbacks *pAllocator) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<rw_lock> lock(global_lock);
     dev_data->desc_template_map.erase(descriptorUpdateTemplate);
     lock.unlock();
     dev_data->dispatch_table.DestroyDescriptorUpdateTemplateKHR(device, descriptorUpdateTemplate, pAllocator);
@@ -11597,7 +12474,7 @@ VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL GetDeviceProcAddr(VkDevice dev, const c
     PFN_vkVoidFunction proc = intercept_core_device_command(funcName);
     if (!proc) proc = intercept_device_extension_command(funcName, dev);
     if (!proc) proc = intercept_khr_swapchain_command(funcName, dev);
-    if (proc) return proc;
+    if (proc) return layer_profiler::get().wrap_entry_point(funcName, proc);
 
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(dev), layer_data_map);
     auto &table = dev_data->dispatch_table;
@@ -128,6 +128,7 @@ class QUEUE_STATE {
    public:
     VkQueue queue;
     uint32_t queueFamilyIndex;
+    uint32_t index;  // Position of this queue in the device's vector clocks
     std::unordered_map<VkEvent, VkPipelineStageFlags> eventToStageMap;
     std::unordered_map<QueryObject, bool> queryToStateMap;  // 0 is unavailable, 1 is available
 
@@ -52,6 +52,11 @@
 #include "vk_layer_logging.h"
 #include "vk_object_types.h"
 #include "device_extensions.h"
+#include "vk_layer_arena.h"
+#include "vk_layer_handle_map.h"
+#include "vk_layer_interval_tree.h"
+#include "vk_layer_range_map.h"
+#include "vk_layer_rwlock.h"
 #include <atomic>
 #include <functional>
 #include <map>
@@ -72,15 +77,24 @@ struct GLOBAL_CB_NODE;
 
 class BASE_NODE {
    public:
-    // Track when object is being used by an in-flight command buffer
+    // Count of pending submissions using this object directly: command buffers and semaphores. Objects bound to a command
+    //  buffer are not counted; core_validation::IsObjectInUse() checks them against their in-flight cb_bindings.
     std::atomic_int in_use;
     // Track command buffers that this object is bound to
     //  binding initialized when cmd referencing object is bound to command buffer
     //  binding removed when command buffer is reset or destroyed
     // When an object is destroyed, any bound cbs are set to INVALID
     std::unordered_set<GLOBAL_CB_NODE *> cb_bindings;
+    // Command buffers are recorded concurrently under a shared global_lock, so bindings added while recording
+    //  go through AddBoundCommandBuffer(). Reads and removals happen with global_lock held exclusively.
+    spin_lock cb_bindings_lock;
 
     BASE_NODE() { in_use.store(0); };
+
+    void AddBoundCommandBuffer(GLOBAL_CB_NODE *cb_node) {
+        std::lock_guard<spin_lock> lock(cb_bindings_lock);
+        cb_bindings.insert(cb_node);
+    }
 };
 
 // Track command pools and their command buffers
@@ -130,6 +144,35 @@ enum descriptor_req {
     DESCRIPTOR_REQ_MULTI_SAMPLE = DESCRIPTOR_REQ_SINGLE_SAMPLE << 1,
 };
 
+// Memory for the descriptors of the sets allocated from one descriptor pool. A block given back when its set is freed is
+// kept for the next set needing a block of the same size, so an application that refills a pool with the same layouts
+// every frame stops reaching the system heap for descriptor storage.
+class descriptor_block_cache {
+   public:
+    descriptor_block_cache() {}
+    ~descriptor_block_cache() {
+        for (auto &sized_blocks : free_blocks_) {
+            for (auto block : sized_blocks.second) ::operator delete(block);
+        }
+    }
+    descriptor_block_cache(const descriptor_block_cache &) = delete;
+    descriptor_block_cache &operator=(const descriptor_block_cache &) = delete;
+
+    void *allocate(size_t size) {
+        auto sized_blocks = free_blocks_.find(size);
+        if (sized_blocks != free_blocks_.end() && !sized_blocks->second.empty()) {
+            void *block = sized_blocks->second.back();
+            sized_blocks->second.pop_back();
+            return block;
+        }
+        return ::operator new(size);
+    }
+    void release(void *block, size_t size) { free_blocks_[size].push_back(block); }
+
+   private:
+    std::unordered_map<size_t, std::vector<void *>> free_blocks_;
+};
+
 struct DESCRIPTOR_POOL_STATE : BASE_NODE {
     VkDescriptorPool pool;
     uint32_t maxSets;        // Max descriptor sets allowed in this pool
@@ -139,6 +182,7 @@ struct DESCRIPTOR_POOL_STATE : BASE_NODE {
     std::unordered_set<cvdescriptorset::DescriptorSet *> sets;  // Collection of all sets in this pool
     std::vector<uint32_t> maxDescriptorTypeCount;               // Max # of descriptors of each type in this pool
     std::vector<uint32_t> availableDescriptorTypeCount;         // Available # of descriptors of each type in this pool
+    descriptor_block_cache descriptor_blocks;                   // Backs the descriptors of the sets above
 
     DESCRIPTOR_POOL_STATE(const VkDescriptorPool pool, const VkDescriptorPoolCreateInfo *pCreateInfo)
         : pool(pool),
@@ -248,6 +292,95 @@ struct SAMPLER_STATE : public BASE_NODE {
     SAMPLER_STATE(const VkSampler *ps, const VkSamplerCreateInfo *pci) : sampler(*ps), createInfo(*pci){};
 };
 
+// Dense index of a single image subresource. Array layers are innermost and aspects outermost, so every layer of a
+// mip level, every mip level of an aspect, and so every subresource of a whole-image range, is a contiguous run.
+// Aspect i is the aspect bit (1 << i): COLOR, DEPTH, STENCIL, METADATA.
+class ImageSubresourceEncoder {
+   public:
+    static const uint32_t kAspectCount = 4;
+
+    ImageSubresourceEncoder() : mip_levels_(0), array_layers_(0) {}
+    explicit ImageSubresourceEncoder(const VkImageCreateInfo &create_info)
+        : mip_levels_(create_info.mipLevels), array_layers_(create_info.arrayLayers) {}
+
+    uint64_t Encode(uint32_t aspect_index, uint32_t mip_level, uint32_t array_layer) const {
+        return (aspect_index * static_cast<uint64_t>(mip_levels_) + mip_level) * array_layers_ + array_layer;
+    }
+    // Encode a subresource whose aspectMask has a single bit set. Returns false if it is outside the image.
+    bool Encode(const VkImageSubresource &sub, uint64_t *index) const {
+        for (uint32_t aspect_index = 0; aspect_index < kAspectCount; ++aspect_index) {
+            if (sub.aspectMask == (1u << aspect_index)) {
+                if (sub.mipLevel >= mip_levels_ || sub.arrayLayer >= array_layers_) return false;
+                *index = Encode(aspect_index, sub.mipLevel, sub.arrayLayer);
+                return true;
+            }
+        }
+        return false;
+    }
+    VkImageSubresource Decode(uint64_t index) const {
+        VkImageSubresource sub;
+        sub.arrayLayer = static_cast<uint32_t>(index % array_layers_);
+        index /= array_layers_;
+        sub.mipLevel = static_cast<uint32_t>(index % mip_levels_);
+        sub.aspectMask = 1u << static_cast<uint32_t>(index / mip_levels_);
+        return sub;
+    }
+    // Index range [begin, end) covering every mip level and array layer of one aspect
+    uint64_t AspectBegin(uint32_t aspect_index) const { return Encode(aspect_index, 0, 0); }
+    uint64_t AspectEnd(uint32_t aspect_index) const { return Encode(aspect_index + 1, 0, 0); }
+
+    // Call f(begin, end) for each maximal run of indices in range, in increasing order. The range is clipped to the
+    // image, which also resolves VK_REMAINING_MIP_LEVELS and VK_REMAINING_ARRAY_LAYERS.
+    template <typename F>
+    void ForEachRun(const VkImageSubresourceRange &range, F f) const {
+        if (range.baseMipLevel >= mip_levels_ || range.baseArrayLayer >= array_layers_) return;
+        const uint32_t max_levels = mip_levels_ - range.baseMipLevel;
+        const uint32_t max_layers = array_layers_ - range.baseArrayLayer;
+        const uint32_t level_count = (range.levelCount < max_levels) ? range.levelCount : max_levels;
+        const uint32_t layer_count = (range.layerCount < max_layers) ? range.layerCount : max_layers;
+        bool have_run = false;
+        uint64_t run_begin = 0;
+        uint64_t run_end = 0;
+        auto add = [&](uint64_t begin, uint64_t end) {
+            if (have_run && begin == run_end) {
+                run_end = end;
+                return;
+            }
+            if (have_run) f(run_begin, run_end);
+            run_begin = begin;
+            run_end = end;
+            have_run = true;
+        };
+        for (uint32_t aspect_index = 0; aspect_index < kAspectCount; ++aspect_index) {
+            if (!(range.aspectMask & (1u << aspect_index))) continue;
+            if (layer_count == array_layers_) {
+                // All layers of each level are covered, so the levels themselves are contiguous
+                add(Encode(aspect_index, range.baseMipLevel, 0), Encode(aspect_index, range.baseMipLevel + level_count, 0));
+                continue;
+            }
+            for (uint32_t level = range.baseMipLevel; level < range.baseMipLevel + level_count; ++level) {
+                uint64_t begin = Encode(aspect_index, level, range.baseArrayLayer);
+                add(begin, begin + layer_count);
+            }
+        }
+        if (have_run) f(run_begin, run_end);
+    }
+
+   private:
+    uint32_t mip_levels_;
+    uint32_t array_layers_;
+};
+
+// Device-level layout of each subresource of an image, as of the last recorded submission.
+// Subresources without an explicit range are still in default_layout, the layout the image was created in.
+struct IMAGE_LAYOUT_MAP {
+    VkImageLayout default_layout;
+    range_map<uint64_t, VkImageLayout> layouts;
+
+    IMAGE_LAYOUT_MAP() : default_layout(VK_IMAGE_LAYOUT_UNDEFINED) {}
+    explicit IMAGE_LAYOUT_MAP(VkImageLayout initial_layout) : default_layout(initial_layout) {}
+};
+
 class IMAGE_STATE : public BINDABLE {
    public:
     VkImage image;
@@ -256,8 +389,17 @@ class IMAGE_STATE : public BINDABLE {
     bool acquired;  // If this is a swapchain image, has it been acquired by the app.
     bool shared_presentable;  // True for a front-buffered swapchain image
     bool layout_locked;       // A front-buffered image that has been presented can never have layout transitioned
+    ImageSubresourceEncoder subresource_encoder;
+    IMAGE_LAYOUT_MAP layout_map;
     IMAGE_STATE(VkImage img, const VkImageCreateInfo *pCreateInfo)
-        : image(img), createInfo(*pCreateInfo), valid(false), acquired(false), shared_presentable(false), layout_locked(false) {
+        : image(img),
+          createInfo(*pCreateInfo),
+          valid(false),
+          acquired(false),
+          shared_presentable(false),
+          layout_locked(false),
+          subresource_encoder(*pCreateInfo),
+          layout_map(pCreateInfo->initialLayout) {
         if ((createInfo.sharingMode == VK_SHARING_MODE_CONCURRENT) && (createInfo.queueFamilyIndexCount > 0)) {
             uint32_t *pQueueFamilyIndices = new uint32_t[createInfo.queueFamilyIndexCount];
             for (uint32_t i = 0; i < createInfo.queueFamilyIndexCount; i++) {
@@ -303,8 +445,6 @@ struct MEMORY_RANGE {
     VkDeviceSize start;
     VkDeviceSize size;
     VkDeviceSize end;  // Store this pre-computed for simplicity
-    // Set of ptrs to every range aliased with this one
-    std::unordered_set<MEMORY_RANGE *> aliases;
 };
 
 // Data struct for tracking memory object
@@ -315,9 +455,11 @@ struct DEVICE_MEM_INFO : public BASE_NODE {
     VkMemoryAllocateInfo alloc_info;
     std::unordered_set<VK_OBJECT> obj_bindings;               // objects bound to this memory
     std::unordered_map<uint64_t, MEMORY_RANGE> bound_ranges;  // Map of object to its binding range
-    // Convenience vectors image/buff handles to speed up iterating over images or buffers independently
-    std::unordered_set<uint64_t> bound_images;
-    std::unordered_set<uint64_t> bound_buffers;
+    // Every range in bound_ranges indexed by [start, end], split by linearity so that aliasing queries can pad only
+    // the linear vs. non-linear comparisons out to bufferImageGranularity. Keyed by start and the address of the range,
+    // which stays put because bound_ranges never moves its elements.
+    interval_tree<VkDeviceSize, MEMORY_RANGE *> linear_ranges;
+    interval_tree<VkDeviceSize, MEMORY_RANGE *> non_linear_ranges;
 
     MemRange mem_range;
     void *shadow_copy_base;    // Base of layer's allocation for guard band, data, and alignment space
@@ -359,6 +501,18 @@ class IMAGE_CMD_BUF_LAYOUT_NODE {
     VkImageLayout layout;
 };
 
+inline bool operator==(const IMAGE_CMD_BUF_LAYOUT_NODE &a, const IMAGE_CMD_BUF_LAYOUT_NODE &b) {
+    return a.initialLayout == b.initialLayout && a.layout == b.layout;
+}
+
+// Layouts a command buffer has recorded for the subresources of one image, indexed by ImageSubresourceEncoder
+struct IMAGE_CMD_BUF_LAYOUT_MAP {
+    ImageSubresourceEncoder encoder;
+    range_map<uint64_t, IMAGE_CMD_BUF_LAYOUT_NODE> layouts;
+
+    explicit IMAGE_CMD_BUF_LAYOUT_MAP(const ImageSubresourceEncoder &encoder) : encoder(encoder) {}
+};
+
 // Store the DAG.
 struct DAGNode {
     uint32_t pass;
@@ -485,35 +639,6 @@ struct DRAW_DATA {
     std::vector<VkBuffer> buffers;
 };
 
-struct ImageSubresourcePair {
-    VkImage image;
-    bool hasSubresource;
-    VkImageSubresource subresource;
-};
-
-inline bool operator==(const ImageSubresourcePair &img1, const ImageSubresourcePair &img2) {
-    if (img1.image != img2.image || img1.hasSubresource != img2.hasSubresource) return false;
-    return !img1.hasSubresource ||
-           (img1.subresource.aspectMask == img2.subresource.aspectMask && img1.subresource.mipLevel == img2.subresource.mipLevel &&
-            img1.subresource.arrayLayer == img2.subresource.arrayLayer);
-}
-
-namespace std {
-template <>
-struct hash<ImageSubresourcePair> {
-    size_t operator()(ImageSubresourcePair img) const throw() {
-        size_t hashVal = hash<uint64_t>()(reinterpret_cast<uint64_t &>(img.image));
-        hashVal ^= hash<bool>()(img.hasSubresource);
-        if (img.hasSubresource) {
-            hashVal ^= hash<uint32_t>()(reinterpret_cast<uint32_t &>(img.subresource.aspectMask));
-            hashVal ^= hash<uint32_t>()(img.subresource.mipLevel);
-            hashVal ^= hash<uint32_t>()(img.subresource.arrayLayer);
-        }
-        return hashVal;
-    }
-};
-}
-
 // Store layouts and pushconstants for PipelineLayout
 struct PIPELINE_LAYOUT_NODE {
     VkPipelineLayout layout;
@@ -604,6 +729,8 @@ class PIPELINE_STATE : public BASE_NODE {
 
 // Track last states that are bound per pipeline bind point (Gfx & Compute)
 struct LAST_BOUND_STATE {
+    LAST_BOUND_STATE() : pipeline_state(nullptr), generation(0) {}
+
     PIPELINE_STATE *pipeline_state;
     PIPELINE_LAYOUT_NODE pipeline_layout;
     // Track each set that has been bound
@@ -611,16 +738,87 @@ struct LAST_BOUND_STATE {
     std::vector<cvdescriptorset::DescriptorSet *> boundDescriptorSets;
     // one dynamic offset per dynamic descriptor bound to this CB
     std::vector<std::vector<uint32_t>> dynamicOffsets;
+    // Bumped on every change to the members above
+    uint64_t generation;
 
     void reset() {
         pipeline_state = nullptr;
         pipeline_layout.reset();
         boundDescriptorSets.clear();
         dynamicOffsets.clear();
+        ++generation;
     }
 };
+
+// Snapshot of the state a draw at one bind point depends on, taken after the draw-time checks last ran for it. A later
+// draw whose state still matches would get the same result from those checks.
+struct DRAW_STATE_MEMO {
+    DRAW_STATE_MEMO()
+        : valid(false),
+          indexed(false),
+          bound_generation(0),
+          cb_generation(0),
+          resource_generation(0),
+          status(0),
+          viewportMask(0),
+          scissorMask(0),
+          vertex_buffer_used(false) {}
+
+    bool valid;
+    bool indexed;
+    uint64_t bound_generation;     // LAST_BOUND_STATE::generation
+    uint64_t cb_generation;        // GLOBAL_CB_NODE::draw_state_generation
+    uint64_t resource_generation;  // Device-wide count of destroyed resources and freed descriptor sets
+    CBStatusFlags status;
+    uint32_t viewportMask;
+    uint32_t scissorMask;
+    bool vertex_buffer_used;
+    // Each descriptor set the pipeline uses, with its change count at the time
+    std::vector<std::pair<const cvdescriptorset::DescriptorSet *, uint64_t>> sets;
+};
+// Containers for state recorded into a command buffer, allocated from that command buffer's arena
+template <typename T>
+using cb_unordered_set = std::unordered_set<T, std::hash<T>, std::equal_to<T>, arena_allocator<T>>;
+template <typename Key, typename T>
+using cb_unordered_map = std::unordered_map<Key, T, std::hash<Key>, std::equal_to<Key>, arena_allocator<std::pair<const Key, T>>>;
+
 // Cmd Buffer Wrapper Struct - TODO : This desperately needs its own class
 struct GLOBAL_CB_NODE : public BASE_NODE {
+    GLOBAL_CB_NODE()
+        : framebuffers(arena_allocator<VkFramebuffer>(&recording_arena)),
+          object_bindings(arena_allocator<VK_OBJECT>(&recording_arena)),
+          waitedEvents(arena_allocator<VkEvent>(&recording_arena)),
+          queryToStateMap(arena_allocator<std::pair<const QueryObject, bool>>(&recording_arena)),
+          activeQueries(arena_allocator<QueryObject>(&recording_arena)),
+          startedQueries(arena_allocator<QueryObject>(&recording_arena)),
+          imageLayoutMap(arena_allocator<std::pair<const VkImage, IMAGE_CMD_BUF_LAYOUT_MAP>>(&recording_arena)),
+          eventToStageMap(arena_allocator<std::pair<const VkEvent, VkPipelineStageFlags>>(&recording_arena)),
+          updateImages(arena_allocator<VkImageView>(&recording_arena)),
+          updateBuffers(arena_allocator<VkBuffer>(&recording_arena)),
+          memObjs(arena_allocator<VkDeviceMemory>(&recording_arena)),
+          draw_state_generation(0),
+          recording_epoch(0),
+          validation_sampled(true),
+          draw_validations(0),
+          draw_validations_reused(0),
+          draw_validations_unsampled(0) {}
+
+    // Drop all arena-backed recorded state and rewind the arena, keeping its memory for the next recording
+    void RewindArena() {
+        ReleaseStorage(framebuffers);
+        ReleaseStorage(object_bindings);
+        ReleaseStorage(waitedEvents);
+        ReleaseStorage(queryToStateMap);
+        ReleaseStorage(activeQueries);
+        ReleaseStorage(startedQueries);
+        ReleaseStorage(imageLayoutMap);
+        ReleaseStorage(eventToStageMap);
+        ReleaseStorage(updateImages);
+        ReleaseStorage(updateBuffers);
+        ReleaseStorage(memObjs);
+        recording_arena.rewind();
+    }
+
     VkCommandBuffer commandBuffer;
     VkCommandBufferAllocateInfo createInfo;
     VkCommandBufferBeginInfo beginInfo;
@@ -644,36 +842,60 @@ struct GLOBAL_CB_NODE : public BASE_NODE {
     VkSubpassContents activeSubpassContents;
     uint32_t activeSubpass;
     VkFramebuffer activeFramebuffer;
-    std::unordered_set<VkFramebuffer> framebuffers;
+    // Backs the cb_unordered_* members below, so it must be declared (and so destroyed) before them
+    arena recording_arena;
+    cb_unordered_set<VkFramebuffer> framebuffers;
     // Unified data structs to track objects bound to this command buffer as well as object
     //  dependencies that have been broken : either destroyed objects, or updated descriptor sets
-    std::unordered_set<VK_OBJECT> object_bindings;
+    cb_unordered_set<VK_OBJECT> object_bindings;
     std::vector<VK_OBJECT> broken_bindings;
 
-    std::unordered_set<VkEvent> waitedEvents;
+    cb_unordered_set<VkEvent> waitedEvents;
     std::vector<VkEvent> writeEventsBeforeWait;
     std::vector<VkEvent> events;
     std::unordered_map<QueryObject, std::unordered_set<VkEvent>> waitedEventsBeforeQueryReset;
-    std::unordered_map<QueryObject, bool> queryToStateMap;  // 0 is unavailable, 1 is available
-    std::unordered_set<QueryObject> activeQueries;
-    std::unordered_set<QueryObject> startedQueries;
-    std::unordered_map<ImageSubresourcePair, IMAGE_CMD_BUF_LAYOUT_NODE> imageLayoutMap;
-    std::unordered_map<VkEvent, VkPipelineStageFlags> eventToStageMap;
+    cb_unordered_map<QueryObject, bool> queryToStateMap;  // 0 is unavailable, 1 is available
+    cb_unordered_set<QueryObject> activeQueries;
+    cb_unordered_set<QueryObject> startedQueries;
+    cb_unordered_map<VkImage, IMAGE_CMD_BUF_LAYOUT_MAP> imageLayoutMap;
+    cb_unordered_map<VkEvent, VkPipelineStageFlags> eventToStageMap;
     std::vector<DRAW_DATA> drawData;
     DRAW_DATA currentDrawData;
     bool vertex_buffer_used;  // Track for perf warning to make sure any bound vtx buffer used
     VkCommandBuffer primaryCommandBuffer;
     // Track images and buffers that are updated by this CB at the point of a draw
-    std::unordered_set<VkImageView> updateImages;
-    std::unordered_set<VkBuffer> updateBuffers;
+    cb_unordered_set<VkImageView> updateImages;
+    cb_unordered_set<VkBuffer> updateBuffers;
     // If primary, the secondary command buffers we will call.
     // If secondary, the primary command buffers we will be called by.
     std::unordered_set<GLOBAL_CB_NODE *> linkedCommandBuffers;
     // MTMTODO : Scrub these data fields and merge active sets w/ lastBound as appropriate
     std::vector<std::function<bool()>> validate_functions;
-    std::unordered_set<VkDeviceMemory> memObjs;
+    cb_unordered_set<VkDeviceMemory> memObjs;
     std::vector<std::function<bool(VkQueue)>> eventUpdates;
     std::vector<std::function<bool(VkQueue)>> queryUpdates;
+    // Bumped when vertex buffers, the render pass instance or subpass, or image layouts recorded in this CB change
+    uint64_t draw_state_generation;
+    // Identifies the current recording; replaced whenever the CB is reset or invalidated, so that checks deferred to the
+    //  background validation thread can tell that the recording they came from is gone
+    uint64_t recording_epoch;
+    // False if validation is sampled and this recording was not picked for full draw-time validation
+    bool validation_sampled;
+    // Per bind point, the state last validated at draw time without reporting anything, and last bound to this CB
+    DRAW_STATE_MEMO validated_draw_state[VK_PIPELINE_BIND_POINT_RANGE_SIZE];
+    DRAW_STATE_MEMO recorded_draw_state[VK_PIPELINE_BIND_POINT_RANGE_SIZE];
+    // Draws and dispatches recorded since the last reset, how many of them reused an earlier validation result, and how
+    //  many went unvalidated because this recording was not sampled
+    uint64_t draw_validations;
+    uint64_t draw_validations_reused;
+    uint64_t draw_validations_unsampled;
+
+   private:
+    // Swap in an empty container so the old contents are destroyed before their memory goes back to the arena
+    template <typename Container>
+    static void ReleaseStorage(Container &container) {
+        Container(container.get_allocator()).swap(container);
+    }
 };
 
 struct SEMAPHORE_WAIT {
@@ -691,11 +913,9 @@ struct CB_SUBMISSION {
     std::vector<SEMAPHORE_WAIT> waitSemaphores;
     std::vector<VkSemaphore> signalSemaphores;
     VkFence fence;
-};
-
-struct IMAGE_LAYOUT_NODE {
-    VkImageLayout layout;
-    VkFormat format;
+    // Vector clock, indexed by QUEUE_STATE::index: the seq each queue must have reached before this submission can
+    // complete. Covers this submission itself and everything it transitively depends on through semaphores.
+    std::vector<uint64_t> clock;
 };
 
 // CHECK_DISABLED struct is a container for bools that can block validation checks from being performed.
@@ -781,6 +1001,7 @@ void AddCommandBufferBindingImage(const layer_data *, GLOBAL_CB_NODE *, IMAGE_ST
 void AddCommandBufferBindingImageView(const layer_data *, GLOBAL_CB_NODE *, IMAGE_VIEW_STATE *);
 void AddCommandBufferBindingBuffer(const layer_data *, GLOBAL_CB_NODE *, BUFFER_STATE *);
 void AddCommandBufferBindingBufferView(const layer_data *, GLOBAL_CB_NODE *, BUFFER_VIEW_STATE *);
+bool IsObjectInUse(BASE_NODE const *obj_node, VK_OBJECT obj_struct);
 bool ValidateObjectNotInUse(const layer_data *dev_data, BASE_NODE *obj_node, VK_OBJECT obj_struct, UNIQUE_VALIDATION_ERROR_CODE error_code);
 void invalidateCommandBuffers(const layer_data *dev_data, std::unordered_set<GLOBAL_CB_NODE *> const &cb_nodes, VK_OBJECT obj);
 void RemoveImageMemoryRange(uint64_t handle, DEVICE_MEM_INFO *mem_info);
@@ -793,8 +1014,6 @@ bool insideRenderPass(const layer_data *my_data, GLOBAL_CB_NODE *pCB, const char
 void SetImageMemoryValid(layer_data *dev_data, IMAGE_STATE *image_state, bool valid);
 void UpdateCmdBufferLastCmd(GLOBAL_CB_NODE *cb_state, const CMD_TYPE cmd);
 bool outsideRenderPass(const layer_data *my_data, GLOBAL_CB_NODE *pCB, const char *apiName, UNIQUE_VALIDATION_ERROR_CODE msgCode);
-void SetLayout(GLOBAL_CB_NODE *pCB, ImageSubresourcePair imgpair, const IMAGE_CMD_BUF_LAYOUT_NODE &node);
-void SetLayout(GLOBAL_CB_NODE *pCB, ImageSubresourcePair imgpair, const VkImageLayout &layout);
 bool ValidateImageMemoryIsValid(layer_data *dev_data, IMAGE_STATE *image_state, const char *functionName);
 bool ValidateImageSampleCount(layer_data *dev_data, IMAGE_STATE *image_state, VkSampleCountFlagBits sample_count,
                               const char *location, UNIQUE_VALIDATION_ERROR_CODE msgCode);
@@ -813,13 +1032,10 @@ const VkImageFormatProperties *GetImageFormatProperties(core_validation::layer_d
 const debug_report_data *GetReportData(const layer_data *);
 const VkPhysicalDeviceProperties *GetPhysicalDeviceProperties(layer_data *);
 const CHECK_DISABLED *GetDisables(layer_data *);
-std::unordered_map<VkImage, std::unique_ptr<IMAGE_STATE>> *GetImageMap(core_validation::layer_data *);
-std::unordered_map<VkImage, std::vector<ImageSubresourcePair>> *GetImageSubresourceMap(layer_data *);
-std::unordered_map<ImageSubresourcePair, IMAGE_LAYOUT_NODE> *GetImageLayoutMap(layer_data *);
-std::unordered_map<ImageSubresourcePair, IMAGE_LAYOUT_NODE> const *GetImageLayoutMap(layer_data const *);
-std::unordered_map<VkBuffer, std::unique_ptr<BUFFER_STATE>> *GetBufferMap(layer_data *device_data);
-std::unordered_map<VkBufferView, std::unique_ptr<BUFFER_VIEW_STATE>> *GetBufferViewMap(layer_data *device_data);
-std::unordered_map<VkImageView, std::unique_ptr<IMAGE_VIEW_STATE>> *GetImageViewMap(layer_data *device_data);
+handle_map<VkImage, std::unique_ptr<IMAGE_STATE>> *GetImageMap(core_validation::layer_data *);
+handle_map<VkBuffer, std::unique_ptr<BUFFER_STATE>> *GetBufferMap(layer_data *device_data);
+handle_map<VkBufferView, std::unique_ptr<BUFFER_VIEW_STATE>> *GetBufferViewMap(layer_data *device_data);
+handle_map<VkImageView, std::unique_ptr<IMAGE_VIEW_STATE>> *GetImageViewMap(layer_data *device_data);
 const DeviceExtensions *GetDeviceExtensions(const layer_data *);
 }
 
@@ -314,12 +314,14 @@ cvdescriptorset::AllocateDescriptorSetsData::AllocateDescriptorSetsData(uint32_t
 cvdescriptorset::DescriptorSet::DescriptorSet(const VkDescriptorSet set, const VkDescriptorPool pool,
                                               const DescriptorSetLayout *layout, const layer_data *dev_data)
     : some_update_(false),
+      change_count_(0),
       set_(set),
       pool_state_(nullptr),
       p_layout_(layout),
       device_data_(dev_data),
       limits_(GetPhysDevProperties(dev_data)->properties.limits) {
     pool_state_ = GetDescriptorPoolState(dev_data, pool);
+    descriptors_.Reserve(p_layout_->GetTotalDescriptorCount(), pool_state_ ? &pool_state_->descriptor_blocks : nullptr);
     // Foreach binding, create default descriptors of given type
     for (uint32_t i = 0; i < p_layout_->GetBindingCount(); ++i) {
         auto type = p_layout_->GetTypeFromIndex(i);
@@ -328,10 +330,10 @@ cvdescriptorset::DescriptorSet::DescriptorSet(const VkDescriptorSet set, const V
                 auto immut_sampler = p_layout_->GetImmutableSamplerPtrFromIndex(i);
                 for (uint32_t di = 0; di < p_layout_->GetDescriptorCountFromIndex(i); ++di) {
                     if (immut_sampler) {
-                        descriptors_.emplace_back(new SamplerDescriptor(immut_sampler + di));
+                        descriptors_.Emplace<SamplerDescriptor>(immut_sampler + di);
                         some_update_ = true;  // Immutable samplers are updated at creation
                     } else
-                        descriptors_.emplace_back(new SamplerDescriptor(nullptr));
+                        descriptors_.Emplace<SamplerDescriptor>(nullptr);
                 }
                 break;
             }
@@ -339,10 +341,10 @@ cvdescriptorset::DescriptorSet::DescriptorSet(const VkDescriptorSet set, const V
                 auto immut = p_layout_->GetImmutableSamplerPtrFromIndex(i);
                 for (uint32_t di = 0; di < p_layout_->GetDescriptorCountFromIndex(i); ++di) {
                     if (immut) {
-                        descriptors_.emplace_back(new ImageSamplerDescriptor(immut + di));
+                        descriptors_.Emplace<ImageSamplerDescriptor>(immut + di);
                         some_update_ = true;  // Immutable samplers are updated at creation
                     } else
-                        descriptors_.emplace_back(new ImageSamplerDescriptor(nullptr));
+                        descriptors_.Emplace<ImageSamplerDescriptor>(nullptr);
                 }
                 break;
             }
@@ -351,19 +353,19 @@ cvdescriptorset::DescriptorSet::DescriptorSet(const VkDescriptorSet set, const V
             case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
             case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
                 for (uint32_t di = 0; di < p_layout_->GetDescriptorCountFromIndex(i); ++di)
-                    descriptors_.emplace_back(new ImageDescriptor(type));
+                    descriptors_.Emplace<ImageDescriptor>(type);
                 break;
             case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
             case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
                 for (uint32_t di = 0; di < p_layout_->GetDescriptorCountFromIndex(i); ++di)
-                    descriptors_.emplace_back(new TexelDescriptor(type));
+                    descriptors_.Emplace<TexelDescriptor>(type);
                 break;
             case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
             case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
             case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
             case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
                 for (uint32_t di = 0; di < p_layout_->GetDescriptorCountFromIndex(i); ++di)
-                    descriptors_.emplace_back(new BufferDescriptor(type));
+                    descriptors_.Emplace<BufferDescriptor>(type);
                 break;
             default:
                 assert(0);  // Bad descriptor type specified
@@ -374,6 +376,27 @@ cvdescriptorset::DescriptorSet::DescriptorSet(const VkDescriptorSet set, const V
 
 cvdescriptorset::DescriptorSet::~DescriptorSet() { InvalidateBoundCmdBuffers(); }
 
+void cvdescriptorset::DescriptorArray::Reserve(uint32_t count, descriptor_block_cache *cache) {
+    assert(!slots_);
+    if (!count) return;
+    cache_ = cache;
+    const size_t bytes = count * sizeof(Slot);
+    slots_ = static_cast<Slot *>(cache_ ? cache_->allocate(bytes) : ::operator new(bytes));
+    capacity_ = count;
+}
+
+cvdescriptorset::DescriptorArray::~DescriptorArray() {
+    for (size_t i = 0; i < size_; ++i) {
+        (*this)[i]->~Descriptor();
+    }
+    if (!slots_) return;
+    if (cache_) {
+        cache_->release(slots_, capacity_ * sizeof(Slot));
+    } else {
+        ::operator delete(slots_);
+    }
+}
+
 static std::string string_descriptor_req_view_type(descriptor_req req) {
     std::string result("");
     for (unsigned i = 0; i <= VK_IMAGE_VIEW_TYPE_END_RANGE; i++) {
@@ -423,7 +446,7 @@ bool cvdescriptorset::DescriptorSet::ValidateDrawState(const std::map<uint32_t,
                 auto descriptor_class = descriptors_[i]->GetClass();
                 if (descriptor_class == GeneralBuffer) {
                     // Verify that buffers are valid
-                    auto buffer = static_cast<BufferDescriptor *>(descriptors_[i].get())->GetBuffer();
+                    auto buffer = static_cast<BufferDescriptor *>(descriptors_[i])->GetBuffer();
                     auto buffer_node = GetBufferState(device_data_, buffer);
                     if (!buffer_node) {
                         std::stringstream error_str;
@@ -445,8 +468,8 @@ bool cvdescriptorset::DescriptorSet::ValidateDrawState(const std::map<uint32_t,
                     if (descriptors_[i]->IsDynamic()) {
                         // Validate that dynamic offsets are within the buffer
                         auto buffer_size = buffer_node->createInfo.size;
-                        auto range = static_cast<BufferDescriptor *>(descriptors_[i].get())->GetRange();
-                        auto desc_offset = static_cast<BufferDescriptor *>(descriptors_[i].get())->GetOffset();
+                        auto range = static_cast<BufferDescriptor *>(descriptors_[i])->GetRange();
+                        auto desc_offset = static_cast<BufferDescriptor *>(descriptors_[i])->GetOffset();
                         auto dyn_offset = dynamic_offsets[GetDynamicOffsetIndexFromBinding(binding) + array_idx];
                         if (VK_WHOLE_SIZE == range) {
                             if ((dyn_offset + desc_offset) > buffer_size) {
@@ -474,11 +497,11 @@ bool cvdescriptorset::DescriptorSet::ValidateDrawState(const std::map<uint32_t,
                     VkImageView image_view;
                     VkImageLayout image_layout;
                     if (descriptor_class == ImageSampler) {
-                        image_view = static_cast<ImageSamplerDescriptor *>(descriptors_[i].get())->GetImageView();
-                        image_layout = static_cast<ImageSamplerDescriptor *>(descriptors_[i].get())->GetImageLayout();
+                        image_view = static_cast<ImageSamplerDescriptor *>(descriptors_[i])->GetImageView();
+                        image_layout = static_cast<ImageSamplerDescriptor *>(descriptors_[i])->GetImageLayout();
                     } else {
-                        image_view = static_cast<ImageDescriptor *>(descriptors_[i].get())->GetImageView();
-                        image_layout = static_cast<ImageDescriptor *>(descriptors_[i].get())->GetImageLayout();
+                        image_view = static_cast<ImageDescriptor *>(descriptors_[i])->GetImageView();
+                        image_layout = static_cast<ImageDescriptor *>(descriptors_[i])->GetImageLayout();
                     }
                     auto reqs = binding_pair.second;
 
@@ -498,28 +521,8 @@ bool cvdescriptorset::DescriptorSet::ValidateDrawState(const std::map<uint32_t,
 
                     auto image_node = GetImageState(device_data_, image_view_ci.image);
                     assert(image_node);
-                    // Verify Image Layout
-                    // TODO: VALIDATION_ERROR_046002ae is the error physically closest to the spec language of interest, however
-                    //  there is no VUID for the actual spec language. Need to file a spec MR to add VU language for:
-                    // imageLayout is the layout that the image subresources accessible from imageView will be in at the time
-                    // this descriptor is accessed.
-                    // Copy first mip level into sub_layers and loop over each mip level to verify layout
-                    VkImageSubresourceLayers sub_layers;
-                    sub_layers.aspectMask = image_view_ci.subresourceRange.aspectMask;
-                    sub_layers.baseArrayLayer = image_view_ci.subresourceRange.baseArrayLayer;
-                    sub_layers.layerCount = image_view_ci.subresourceRange.layerCount;
-                    bool hit_error = false;
-                    for (auto cur_level = image_view_ci.subresourceRange.baseMipLevel;
-                         cur_level < image_view_ci.subresourceRange.levelCount; ++cur_level) {
-                        sub_layers.mipLevel = cur_level;
-                        VerifyImageLayout(device_data_, cb_node, image_node, sub_layers, image_layout, VK_IMAGE_LAYOUT_UNDEFINED,
-                                          caller, VALIDATION_ERROR_046002ae, &hit_error);
-                        if (hit_error) {
-                            *error =
-                                "Image layout specified at vkUpdateDescriptorSets() time doesn't match actual image layout at "
-                                "time descriptor is used. See previous error callback for specific details.";
-                            return false;
-                        }
+                    if (cb_node && !VerifyDescriptorImageLayout(image_view_ci, image_node, image_layout, cb_node, caller, error)) {
+                        return false;
                     }
                     // Verify Sample counts
                     if ((reqs & DESCRIPTOR_REQ_SINGLE_SAMPLE) && image_node->createInfo.samples != VK_SAMPLE_COUNT_1_BIT) {
@@ -544,10 +547,74 @@ bool cvdescriptorset::DescriptorSet::ValidateDrawState(const std::map<uint32_t,
     return true;
 }
 
+bool cvdescriptorset::DescriptorSet::ValidateDrawStateImageLayouts(const std::map<uint32_t, descriptor_req> &bindings,
+                                                                   const GLOBAL_CB_NODE *cb_node, const char *caller,
+                                                                   std::string *error) const {
+    for (auto binding_pair : bindings) {
+        auto binding = binding_pair.first;
+        if (!p_layout_->HasBinding(binding)) continue;
+        auto start_idx = p_layout_->GetGlobalStartIndexFromBinding(binding);
+        auto end_idx = p_layout_->GetGlobalEndIndexFromBinding(binding);
+        for (uint32_t i = start_idx; i <= end_idx; ++i) {
+            // Anything else wrong with the descriptor is reported by ValidateDrawState()
+            if (!descriptors_[i]->updated) continue;
+            auto descriptor_class = descriptors_[i]->GetClass();
+            if (descriptor_class != ImageSampler && descriptor_class != Image) continue;
+            VkImageView image_view;
+            VkImageLayout image_layout;
+            if (descriptor_class == ImageSampler) {
+                image_view = static_cast<ImageSamplerDescriptor *>(descriptors_[i])->GetImageView();
+                image_layout = static_cast<ImageSamplerDescriptor *>(descriptors_[i])->GetImageLayout();
+            } else {
+                image_view = static_cast<ImageDescriptor *>(descriptors_[i])->GetImageView();
+                image_layout = static_cast<ImageDescriptor *>(descriptors_[i])->GetImageLayout();
+            }
+            auto image_view_state = GetImageViewState(device_data_, image_view);
+            if (!image_view_state) continue;
+            auto image_node = GetImageState(device_data_, image_view_state->create_info.image);
+            if (!image_node) continue;
+            if (!VerifyDescriptorImageLayout(image_view_state->create_info, image_node, image_layout, cb_node, caller, error)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Verify that every mip level of the image subresources behind an image view is in image_layout, as tracked by cb_node
+bool cvdescriptorset::DescriptorSet::VerifyDescriptorImageLayout(const VkImageViewCreateInfo &image_view_ci,
+                                                                 IMAGE_STATE *image_node, VkImageLayout image_layout,
+                                                                 const GLOBAL_CB_NODE *cb_node, const char *caller,
+                                                                 std::string *error) const {
+    // TODO: VALIDATION_ERROR_046002ae is the error physically closest to the spec language of interest, however
+    //  there is no VUID for the actual spec language. Need to file a spec MR to add VU language for:
+    // imageLayout is the layout that the image subresources accessible from imageView will be in at the time
+    // this descriptor is accessed.
+    // Copy first mip level into sub_layers and loop over each mip level to verify layout
+    VkImageSubresourceLayers sub_layers;
+    sub_layers.aspectMask = image_view_ci.subresourceRange.aspectMask;
+    sub_layers.baseArrayLayer = image_view_ci.subresourceRange.baseArrayLayer;
+    sub_layers.layerCount = image_view_ci.subresourceRange.layerCount;
+    bool hit_error = false;
+    for (auto cur_level = image_view_ci.subresourceRange.baseMipLevel; cur_level < image_view_ci.subresourceRange.levelCount;
+         ++cur_level) {
+        sub_layers.mipLevel = cur_level;
+        VerifyImageLayout(device_data_, cb_node, image_node, sub_layers, image_layout, VK_IMAGE_LAYOUT_UNDEFINED, caller,
+                          VALIDATION_ERROR_046002ae, &hit_error);
+        if (hit_error) {
+            *error =
+                "Image layout specified at vkUpdateDescriptorSets() time doesn't match actual image layout at "
+                "time descriptor is used. See previous error callback for specific details.";
+            return false;
+        }
+    }
+    return true;
+}
+
 // For given bindings, place any update buffers or images into the passed-in unordered_sets
 uint32_t cvdescriptorset::DescriptorSet::GetStorageUpdates(const std::map<uint32_t, descriptor_req> &bindings,
-                                                           std::unordered_set<VkBuffer> *buffer_set,
-                                                           std::unordered_set<VkImageView> *image_set) const {
+                                                           cb_unordered_set<VkBuffer> *buffer_set,
+                                                           cb_unordered_set<VkImageView> *image_set) const {
     auto num_updates = 0;
     for (auto binding_pair : bindings) {
         auto binding = binding_pair.first;
@@ -560,14 +627,14 @@ uint32_t cvdescriptorset::DescriptorSet::GetStorageUpdates(const std::map<uint32
             if (Image == descriptors_[start_idx]->descriptor_class) {
                 for (uint32_t i = 0; i < p_layout_->GetDescriptorCountFromBinding(binding); ++i) {
                     if (descriptors_[start_idx + i]->updated) {
-                        image_set->insert(static_cast<ImageDescriptor *>(descriptors_[start_idx + i].get())->GetImageView());
+                        image_set->insert(static_cast<ImageDescriptor *>(descriptors_[start_idx + i])->GetImageView());
                         num_updates++;
                     }
                 }
             } else if (TexelBuffer == descriptors_[start_idx]->descriptor_class) {
                 for (uint32_t i = 0; i < p_layout_->GetDescriptorCountFromBinding(binding); ++i) {
                     if (descriptors_[start_idx + i]->updated) {
-                        auto bufferview = static_cast<TexelDescriptor *>(descriptors_[start_idx + i].get())->GetBufferView();
+                        auto bufferview = static_cast<TexelDescriptor *>(descriptors_[start_idx + i])->GetBufferView();
                         auto bv_state = GetBufferViewState(device_data_, bufferview);
                         if (bv_state) {
                             buffer_set->insert(bv_state->create_info.buffer);
@@ -578,7 +645,7 @@ uint32_t cvdescriptorset::DescriptorSet::GetStorageUpdates(const std::map<uint32
             } else if (GeneralBuffer == descriptors_[start_idx]->descriptor_class) {
                 for (uint32_t i = 0; i < p_layout_->GetDescriptorCountFromBinding(binding); ++i) {
                     if (descriptors_[start_idx + i]->updated) {
-                        buffer_set->insert(static_cast<BufferDescriptor *>(descriptors_[start_idx + i].get())->GetBuffer());
+                        buffer_set->insert(static_cast<BufferDescriptor *>(descriptors_[start_idx + i])->GetBuffer());
                         num_updates++;
                     }
                 }
@@ -610,6 +677,7 @@ void cvdescriptorset::DescriptorSet::PerformWriteUpdate(const VkWriteDescriptorS
         binding_being_updated++;
     }
     if (update->descriptorCount) some_update_ = true;
+    ++change_count_;
 
     InvalidateBoundCmdBuffers();
 }
@@ -618,7 +686,7 @@ bool cvdescriptorset::DescriptorSet::ValidateCopyUpdate(const debug_report_data
                                                         const DescriptorSet *src_set, UNIQUE_VALIDATION_ERROR_CODE *error_code,
                                                         std::string *error_msg) {
     // Verify idle ds
-    if (in_use.load()) {
+    if (core_validation::IsObjectInUse(this, {HandleToUint64(set_), kVulkanObjectTypeDescriptorSet})) {
         // TODO : Re-using Free Idle error code, need copy update idle error code
         *error_code = VALIDATION_ERROR_2860026a;
         std::stringstream error_str;
@@ -710,9 +778,10 @@ void cvdescriptorset::DescriptorSet::PerformCopyUpdate(const VkCopyDescriptorSet
     auto dst_start_idx = p_layout_->GetGlobalStartIndexFromBinding(update->dstBinding) + update->dstArrayElement;
     // Update parameters all look good so perform update
     for (uint32_t di = 0; di < update->descriptorCount; ++di) {
-        descriptors_[dst_start_idx + di]->CopyUpdate(src_set->descriptors_[src_start_idx + di].get());
+        descriptors_[dst_start_idx + di]->CopyUpdate(src_set->descriptors_[src_start_idx + di]);
     }
     if (update->descriptorCount) some_update_ = true;
+    ++change_count_;
 
     InvalidateBoundCmdBuffers();
 }
@@ -723,10 +792,10 @@ void cvdescriptorset::DescriptorSet::PerformCopyUpdate(const VkCopyDescriptorSet
 void cvdescriptorset::DescriptorSet::BindCommandBuffer(GLOBAL_CB_NODE *cb_node,
                                                        const std::map<uint32_t, descriptor_req> &binding_req_map) {
     // bind cb to this descriptor set
-    cb_bindings.insert(cb_node);
+    AddBoundCommandBuffer(cb_node);
     // Add bindings for descriptor set, the set's pool, and individual objects in the set
     cb_node->object_bindings.insert({HandleToUint64(set_), kVulkanObjectTypeDescriptorSet});
-    pool_state_->cb_bindings.insert(cb_node);
+    pool_state_->AddBoundCommandBuffer(cb_node);
     cb_node->object_bindings.insert({HandleToUint64(pool_state_->pool), kVulkanObjectTypeDescriptorPool});
     // For the active slots, use set# to look up descriptorSet from boundDescriptorSets, and bind all of that descriptor set's
     // resources
@@ -1232,7 +1301,7 @@ void cvdescriptorset::PerformUpdateDescriptorSetsWithTemplateKHR(layer_data *dev
 bool cvdescriptorset::DescriptorSet::ValidateWriteUpdate(const debug_report_data *report_data, const VkWriteDescriptorSet *update,
                                                          UNIQUE_VALIDATION_ERROR_CODE *error_code, std::string *error_msg) {
     // Verify idle ds
-    if (in_use.load()) {
+    if (core_validation::IsObjectInUse(this, {HandleToUint64(set_), kVulkanObjectTypeDescriptorSet})) {
         // TODO : Re-using Free Idle error code, need write update idle error code
         *error_code = VALIDATION_ERROR_2860026a;
         std::stringstream error_str;
@@ -1445,7 +1514,7 @@ bool cvdescriptorset::DescriptorSet::VerifyWriteUpdateContents(const VkWriteDesc
         }
         case VK_DESCRIPTOR_TYPE_SAMPLER: {
             for (uint32_t di = 0; di < update->descriptorCount; ++di) {
-                if (!descriptors_[index + di].get()->IsImmutableSampler()) {
+                if (!descriptors_[index + di]->IsImmutableSampler()) {
                     if (!ValidateSampler(update->pImageInfo[di].sampler, device_data_)) {
                         *error_code = VALIDATION_ERROR_15c0028a;
                         std::stringstream error_str;
@@ -1529,7 +1598,7 @@ bool cvdescriptorset::DescriptorSet::VerifyCopyUpdateContents(const VkCopyDescri
         case PlainSampler: {
             for (uint32_t di = 0; di < update->descriptorCount; ++di) {
                 if (!src_set->descriptors_[index + di]->IsImmutableSampler()) {
-                    auto update_sampler = static_cast<SamplerDescriptor *>(src_set->descriptors_[index + di].get())->GetSampler();
+                    auto update_sampler = static_cast<SamplerDescriptor *>(src_set->descriptors_[index + di])->GetSampler();
                     if (!ValidateSampler(update_sampler, device_data_)) {
                         *error_code = VALIDATION_ERROR_15c0028a;
                         std::stringstream error_str;
@@ -1545,7 +1614,7 @@ bool cvdescriptorset::DescriptorSet::VerifyCopyUpdateContents(const VkCopyDescri
         }
         case ImageSampler: {
             for (uint32_t di = 0; di < update->descriptorCount; ++di) {
-                auto img_samp_desc = static_cast<const ImageSamplerDescriptor *>(src_set->descriptors_[index + di].get());
+                auto img_samp_desc = static_cast<const ImageSamplerDescriptor *>(src_set->descriptors_[index + di]);
                 // First validate sampler
                 if (!img_samp_desc->IsImmutableSampler()) {
                     auto update_sampler = img_samp_desc->GetSampler();
@@ -1573,7 +1642,7 @@ bool cvdescriptorset::DescriptorSet::VerifyCopyUpdateContents(const VkCopyDescri
         }
         case Image: {
             for (uint32_t di = 0; di < update->descriptorCount; ++di) {
-                auto img_desc = static_cast<const ImageDescriptor *>(src_set->descriptors_[index + di].get());
+                auto img_desc = static_cast<const ImageDescriptor *>(src_set->descriptors_[index + di]);
                 auto image_view = img_desc->GetImageView();
                 auto image_layout = img_desc->GetImageLayout();
                 if (!ValidateImageUpdate(image_view, image_layout, type, device_data_, error_code, error_msg)) {
@@ -1587,7 +1656,7 @@ bool cvdescriptorset::DescriptorSet::VerifyCopyUpdateContents(const VkCopyDescri
         }
         case TexelBuffer: {
             for (uint32_t di = 0; di < update->descriptorCount; ++di) {
-                auto buffer_view = static_cast<TexelDescriptor *>(src_set->descriptors_[index + di].get())->GetBufferView();
+                auto buffer_view = static_cast<TexelDescriptor *>(src_set->descriptors_[index + di])->GetBufferView();
                 auto bv_state = GetBufferViewState(device_data_, buffer_view);
                 if (!bv_state) {
                     *error_code = VALIDATION_ERROR_15c00286;
@@ -1608,7 +1677,7 @@ bool cvdescriptorset::DescriptorSet::VerifyCopyUpdateContents(const VkCopyDescri
         }
         case GeneralBuffer: {
             for (uint32_t di = 0; di < update->descriptorCount; ++di) {
-                auto buffer = static_cast<BufferDescriptor *>(src_set->descriptors_[index + di].get())->GetBuffer();
+                auto buffer = static_cast<BufferDescriptor *>(src_set->descriptors_[index + di])->GetBuffer();
                 if (!ValidateBufferUsage(GetBufferState(device_data_, buffer), type, error_code, error_msg)) {
                     std::stringstream error_str;
                     error_str << "Attempted copy update to buffer descriptor failed due to: " << error_msg->c_str();
@@ -1690,8 +1759,8 @@ bool cvdescriptorset::ValidateAllocateDescriptorSets(const core_validation::laye
 void cvdescriptorset::PerformAllocateDescriptorSets(const VkDescriptorSetAllocateInfo *p_alloc_info,
                                                     const VkDescriptorSet *descriptor_sets,
                                                     const AllocateDescriptorSetsData *ds_data,
-                                                    std::unordered_map<VkDescriptorPool, DESCRIPTOR_POOL_STATE *> *pool_map,
-                                                    std::unordered_map<VkDescriptorSet, cvdescriptorset::DescriptorSet *> *set_map,
+                                                    handle_map<VkDescriptorPool, DESCRIPTOR_POOL_STATE *> *pool_map,
+                                                    handle_map<VkDescriptorSet, cvdescriptorset::DescriptorSet *> *set_map,
                                                     const layer_data *dev_data) {
     auto pool_state = (*pool_map)[p_alloc_info->descriptorPool];
     /* Account for sets and individual descriptors allocated from pool */
@@ -53,8 +53,10 @@
 #include "vk_object_types.h"
 #include <map>
 #include <memory>
+#include <new>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 using core_validation::layer_data;
@@ -273,6 +275,49 @@ class BufferDescriptor : public Descriptor {
     VkDeviceSize offset_;
     VkDeviceSize range_;
 };
+
+// The descriptors of one set, constructed in place in a single block of equal-sized slots, one per descriptor. Each slot
+//  fits the largest Descriptor class, so descriptors sit at a fixed stride in set order and a set needs one allocation
+//  however many descriptors it holds.
+class DescriptorArray {
+   public:
+    DescriptorArray() : slots_(nullptr), size_(0), capacity_(0), cache_(nullptr) {}
+    ~DescriptorArray();
+    DescriptorArray(const DescriptorArray &) = delete;
+    DescriptorArray &operator=(const DescriptorArray &) = delete;
+
+    // Get slots for count descriptors from cache, or straight from the heap if cache is null. Called once, before Emplace().
+    void Reserve(uint32_t count, descriptor_block_cache *cache);
+    // Construct the next descriptor
+    template <typename T, typename... Args>
+    void Emplace(Args &&... args) {
+        static_assert(sizeof(T) <= sizeof(Slot) && alignof(T) <= alignof(Slot), "Descriptor class does not fit a slot");
+        assert(size_ < capacity_);
+        T *descriptor = new (&slots_[size_]) T(std::forward<Args>(args)...);
+        assert(static_cast<Descriptor *>(descriptor) == (*this)[size_]);
+        (void)descriptor;
+        ++size_;
+    }
+    Descriptor *operator[](size_t index) const { return reinterpret_cast<Descriptor *>(&slots_[index]); }
+    size_t size() const { return size_; }
+
+   private:
+    union Slot {
+        char sampler[sizeof(SamplerDescriptor)];
+        char image_sampler[sizeof(ImageSamplerDescriptor)];
+        char image[sizeof(ImageDescriptor)];
+        char texel[sizeof(TexelDescriptor)];
+        char buffer[sizeof(BufferDescriptor)];
+        // Only here for alignment
+        void *pointer;
+        uint64_t handle;
+    };
+
+    Slot *slots_;
+    size_t size_;
+    size_t capacity_;
+    descriptor_block_cache *cache_;
+};
 // Structs to contain common elements that need to be shared between Validate* and Perform* calls below
 struct AllocateDescriptorSetsData {
     uint32_t required_descriptors_by_type[VK_DESCRIPTOR_TYPE_RANGE_SIZE];
@@ -297,8 +342,8 @@ bool ValidateAllocateDescriptorSets(const core_validation::layer_data *, const V
                                     const AllocateDescriptorSetsData *);
 // Update state based on allocating new descriptorsets
 void PerformAllocateDescriptorSets(const VkDescriptorSetAllocateInfo *, const VkDescriptorSet *, const AllocateDescriptorSetsData *,
-                                   std::unordered_map<VkDescriptorPool, DESCRIPTOR_POOL_STATE *> *,
-                                   std::unordered_map<VkDescriptorSet, cvdescriptorset::DescriptorSet *> *,
+                                   handle_map<VkDescriptorPool, DESCRIPTOR_POOL_STATE *> *,
+                                   handle_map<VkDescriptorSet, cvdescriptorset::DescriptorSet *> *,
                                    const core_validation::layer_data *);
 
 /*
@@ -351,12 +396,16 @@ class DescriptorSet : public BASE_NODE {
     // Is this set compatible with the given layout?
     bool IsCompatible(const DescriptorSetLayout *, std::string *) const;
     // For given bindings validate state at time of draw is correct, returning false on error and writing error details into string*
+    //  A null GLOBAL_CB_NODE leaves out the image layout checks, which ValidateDrawStateImageLayouts() performs on their own
     bool ValidateDrawState(const std::map<uint32_t, descriptor_req> &, const std::vector<uint32_t> &, const GLOBAL_CB_NODE *,
                            const char *caller, std::string *) const;
+    // Only the checks of ValidateDrawState that compare image descriptors' layouts with the layouts the cmd buffer has tracked
+    bool ValidateDrawStateImageLayouts(const std::map<uint32_t, descriptor_req> &, const GLOBAL_CB_NODE *, const char *caller,
+                                       std::string *) const;
     // For given set of bindings, add any buffers and images that will be updated to their respective unordered_sets & return number
     // of objects inserted
-    uint32_t GetStorageUpdates(const std::map<uint32_t, descriptor_req> &, std::unordered_set<VkBuffer> *,
-                               std::unordered_set<VkImageView> *) const;
+    uint32_t GetStorageUpdates(const std::map<uint32_t, descriptor_req> &, cb_unordered_set<VkBuffer> *,
+                               cb_unordered_set<VkImageView> *) const;
 
     // Descriptor Update functions. These functions validate state and perform update separately
     // Validate contents of a WriteUpdate
@@ -390,8 +439,12 @@ class DescriptorSet : public BASE_NODE {
     };
     // Return true if any part of set has ever been updated
     bool IsUpdated() const { return some_update_; };
+    // Number of write and copy updates performed on this set so far
+    uint64_t GetChangeCount() const { return change_count_; };
 
    private:
+    bool VerifyDescriptorImageLayout(const VkImageViewCreateInfo &, IMAGE_STATE *, VkImageLayout, const GLOBAL_CB_NODE *,
+                                     const char *caller, std::string *) const;
     bool VerifyWriteUpdateContents(const VkWriteDescriptorSet *, const uint32_t, UNIQUE_VALIDATION_ERROR_CODE *,
                                    std::string *) const;
     bool VerifyCopyUpdateContents(const VkCopyDescriptorSet *, const DescriptorSet *, VkDescriptorType, uint32_t,
@@ -402,10 +455,11 @@ class DescriptorSet : public BASE_NODE {
     // Private helper to set all bound cmd buffers to INVALID state
     void InvalidateBoundCmdBuffers();
     bool some_update_;  // has any part of the set ever been updated?
+    uint64_t change_count_;
     VkDescriptorSet set_;
     DESCRIPTOR_POOL_STATE *pool_state_;
     const DescriptorSetLayout *p_layout_;
-    std::vector<std::unique_ptr<Descriptor>> descriptors_;
+    DescriptorArray descriptors_;
     // Ptr to device data used for various data look-ups
     const core_validation::layer_data *device_data_;
     const VkPhysicalDeviceLimits limits_;
@@ -37,6 +37,7 @@
 #include "vk_layer_config.h"
 #include "vk_layer_data.h"
 #include "vk_layer_logging.h"
+#include "vk_layer_profiler.h"
 #include "vk_layer_table.h"
 #include "vk_object_types.h"
 #include "vulkan/vk_layer.h"
@@ -454,6 +455,9 @@ VKAPI_ATTR void VKAPI_CALL DestroyInstance(VkInstance instance, const VkAllocati
         instance_data->num_tmp_callbacks = 0;
     }
 
+    // Counts of held back messages go to the layer's own callbacks too, so report them first
+    report_suppressed_log_msgs(instance_data->report_data);
+
     // Clean up logging callback, if any
     while (instance_data->logging_callback.size() > 0) {
         VkDebugReportCallbackEXT callback = instance_data->logging_callback.back();
@@ -461,6 +465,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyInstance(VkInstance instance, const VkAllocati
         instance_data->logging_callback.pop_back();
     }
 
+    layer_flush_async_logs();
     layer_debug_report_destroy_instance(instance_data->report_data);
     layer_data_map.erase(key);
 
@@ -512,6 +517,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyDevice(VkDevice device, const VkAllocationCall
     dispatch_key key = get_dispatch_key(device);
     VkLayerDispatchTable *pDisp = get_dispatch_table(ot_device_table_map, device);
     pDisp->DestroyDevice(device, pAllocator);
+    layer_profiler::get().device_destroyed(device);
     ot_device_table_map.erase(key);
 }
 
@@ -3460,7 +3466,10 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateDevice(VkPhysicalDevice physicalDevice, con
     // Add link back to physDev
     device_data->physical_device = physicalDevice;
 
-    initDeviceTable(*pDevice, fpGetDeviceProcAddr, ot_device_table_map);
+    VkLayerDispatchTable *ot_table = initDeviceTable(*pDevice, fpGetDeviceProcAddr, ot_device_table_map);
+    layer_profiler::get().configure("lunarg_object_tracker");
+    layer_profiler::get().wrap_dispatch_table(*pDevice, &device_data->dispatch_table);
+    layer_profiler::get().wrap_dispatch_table(*pDevice, ot_table);
 
     CheckDeviceRegisterExtensions(pCreateInfo, *pDevice);
     CreateObject(*pDevice, *pDevice, kVulkanObjectTypeDevice, pAllocator);
@@ -5509,17 +5518,17 @@ VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL GetDeviceProcAddr(VkDevice device, cons
     PFN_vkVoidFunction addr;
     addr = InterceptCoreDeviceCommand(funcName);
     if (addr) {
-        return addr;
+        return layer_profiler::get().wrap_entry_point(funcName, addr);
     }
     assert(device);
 
     addr = InterceptWsiEnabledCommand(funcName, device);
     if (addr) {
-        return addr;
+        return layer_profiler::get().wrap_entry_point(funcName, addr);
     }
     addr = InterceptDeviceExtensionCommand(funcName, device);
     if (addr) {
-        return addr;
+        return layer_profiler::get().wrap_entry_point(funcName, addr);
     }
     if (get_dispatch_table(ot_device_table_map, device)->GetDeviceProcAddr == NULL) {
         return NULL;
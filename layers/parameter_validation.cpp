@@ -48,6 +48,7 @@
 #include "vk_layer_data.h"
 #include "vk_layer_logging.h"
 #include "vk_layer_extension_utils.h"
+#include "vk_layer_profiler.h"
 #include "vk_layer_utils.h"
 
 #include "parameter_name.h"
@@ -1404,6 +1405,9 @@ VKAPI_ATTR void VKAPI_CALL DestroyInstance(VkInstance instance, const VkAllocati
     if (!skip) {
         my_data->dispatch_table.DestroyInstance(instance, pAllocator);
 
+        // Counts of held back messages go to the layer's own callbacks too, so report them first
+        report_suppressed_log_msgs(my_data->report_data);
+
         // Clean up logging callback, if any
         while (my_data->logging_callback.size() > 0) {
             VkDebugReportCallbackEXT callback = my_data->logging_callback.back();
@@ -1411,6 +1415,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyInstance(VkInstance instance, const VkAllocati
             my_data->logging_callback.pop_back();
         }
 
+        layer_flush_async_logs();
         layer_debug_report_destroy_instance(my_data->report_data);
         instance_layer_data_map.erase(key);
     }
@@ -1680,6 +1685,8 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateDevice(VkPhysicalDevice physicalDevice, con
 
             my_device_data->report_data = layer_debug_report_create_device(my_instance_data->report_data, *pDevice);
             layer_init_device_dispatch_table(*pDevice, &my_device_data->dispatch_table, fpGetDeviceProcAddr);
+            layer_profiler::get().configure("lunarg_parameter_validation");
+            layer_profiler::get().wrap_dispatch_table(*pDevice, &my_device_data->dispatch_table);
 
             my_device_data->enables.InitFromDeviceCreateInfo(pCreateInfo);
 
@@ -1720,6 +1727,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyDevice(VkDevice device, const VkAllocationCall
 #endif
 
         my_data->dispatch_table.DestroyDevice(device, pAllocator);
+        layer_profiler::get().device_destroyed(device);
         layer_data_map.erase(key);
     }
 }
@@ -7113,7 +7121,7 @@ VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL GetDeviceProcAddr(VkDevice device, cons
     assert(device);
 
     PFN_vkVoidFunction addr = layer_intercept_proc(funcName);
-    if (addr) return addr;
+    if (addr) return layer_profiler::get().wrap_entry_point(funcName, addr);
 
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
 
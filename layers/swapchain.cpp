@@ -207,12 +207,16 @@ VKAPI_ATTR void VKAPI_CALL DestroyInstance(VkInstance instance, const VkAllocati
         my_data->num_tmp_callbacks = 0;
     }
 
+    // Counts of held back messages go to the layer's own callbacks too, so report them first
+    report_suppressed_log_msgs(my_data->report_data);
+
     // Clean up logging callback, if any
     while (my_data->logging_callback.size() > 0) {
         VkDebugReportCallbackEXT callback = my_data->logging_callback.back();
         layer_destroy_msg_callback(my_data->report_data, callback, pAllocator);
         my_data->logging_callback.pop_back();
     }
+    layer_flush_async_logs();
     layer_debug_report_destroy_instance(my_data->report_data);
 
     delete my_data->instance_dispatch_table;
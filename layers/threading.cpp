@@ -29,6 +29,7 @@
 #include "vk_layer_utils.h"
 #include "vk_layer_table.h"
 #include "vk_layer_logging.h"
+#include "vk_layer_profiler.h"
 #include "threading.h"
 #include "vk_dispatch_table_helper.h"
 #include "vk_enum_string_helper.h"
@@ -92,15 +93,13 @@ VKAPI_ATTR void VKAPI_CALL DestroyInstance(VkInstance instance, const VkAllocati
         }
     }
 
-    bool threadChecks = startMultiThread();
+    bool threadChecks = startMultiThread(my_data, "vkDestroyInstance");
     if (threadChecks) {
         startWriteObject(my_data, instance);
     }
     pTable->DestroyInstance(instance, pAllocator);
     if (threadChecks) {
         finishWriteObject(my_data, instance);
-    } else {
-        finishMultiThread();
     }
 
     // Disable and cleanup the temporary callback(s):
@@ -112,6 +111,9 @@ VKAPI_ATTR void VKAPI_CALL DestroyInstance(VkInstance instance, const VkAllocati
         my_data->num_tmp_callbacks = 0;
     }
 
+    // Counts of held back messages go to the layer's own callbacks too, so report them first
+    report_suppressed_log_msgs(my_data->report_data);
+
     // Clean up logging callback, if any
     while (my_data->logging_callback.size() > 0) {
         VkDebugReportCallbackEXT callback = my_data->logging_callback.back();
@@ -119,6 +121,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyInstance(VkInstance instance, const VkAllocati
         my_data->logging_callback.pop_back();
     }
 
+    layer_flush_async_logs();
     layer_debug_report_destroy_instance(my_data->report_data);
     delete my_data->instance_dispatch_table;
     layer_data_map.erase(key);
@@ -150,23 +153,33 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateDevice(VkPhysicalDevice gpu, const VkDevice
     // Setup device dispatch table
     my_device_data->device_dispatch_table = new VkLayerDispatchTable;
     layer_init_device_dispatch_table(*pDevice, my_device_data->device_dispatch_table, fpGetDeviceProcAddr);
+    layer_profiler::get().configure("google_threading");
+    layer_profiler::get().wrap_dispatch_table(*pDevice, my_device_data->device_dispatch_table);
 
     my_device_data->report_data = layer_debug_report_create_device(my_instance_data->report_data, *pDevice);
+    const char *contention_file = getLayerOption("google_threading.contention_file");
+    if (contention_file && *contention_file) {
+        my_device_data->contention = new contention_stats(contention_file);
+    }
     return result;
 }
 
 VKAPI_ATTR void VKAPI_CALL DestroyDevice(VkDevice device, const VkAllocationCallbacks *pAllocator) {
     dispatch_key key = get_dispatch_key(device);
     layer_data *dev_data = GetLayerDataPtr(key, layer_data_map);
-    bool threadChecks = startMultiThread();
+    bool threadChecks = startMultiThread(dev_data, "vkDestroyDevice");
     if (threadChecks) {
         startWriteObject(dev_data, device);
     }
     dev_data->device_dispatch_table->DestroyDevice(device, pAllocator);
+    layer_profiler::get().device_destroyed(device);
     if (threadChecks) {
         finishWriteObject(dev_data, device);
-    } else {
-        finishMultiThread();
+    }
+    if (dev_data->contention) {
+        dev_data->contention->write_report(device);
+        delete dev_data->contention;
+        dev_data->contention = nullptr;
     }
     layer_data_map.erase(key);
 }
@@ -177,7 +190,7 @@ VKAPI_ATTR VkResult VKAPI_CALL GetSwapchainImagesKHR(VkDevice device, VkSwapchai
     layer_data *my_data = GetLayerDataPtr(key, layer_data_map);
     VkLayerDispatchTable *pTable = my_data->device_dispatch_table;
     VkResult result;
-    bool threadChecks = startMultiThread();
+    bool threadChecks = startMultiThread(my_data, "vkGetSwapchainImagesKHR");
     if (threadChecks) {
         startReadObject(my_data, device);
         startReadObject(my_data, swapchain);
@@ -186,8 +199,6 @@ VKAPI_ATTR VkResult VKAPI_CALL GetSwapchainImagesKHR(VkDevice device, VkSwapchai
     if (threadChecks) {
         finishReadObject(my_data, device);
         finishReadObject(my_data, swapchain);
-    } else {
-        finishMultiThread();
     }
     return result;
 }
@@ -265,7 +276,7 @@ VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL GetDeviceProcAddr(VkDevice device, cons
     assert(device);
 
     addr = layer_intercept_proc(funcName);
-    if (addr) return addr;
+    if (addr) return layer_profiler::get().wrap_entry_point(funcName, addr);
 
     dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     VkLayerDispatchTable *pTable = dev_data->device_dispatch_table;
@@ -315,7 +326,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateDebugReportCallbackEXT(VkInstance instance,
                                                             const VkAllocationCallbacks *pAllocator,
                                                             VkDebugReportCallbackEXT *pMsgCallback) {
     layer_data *my_data = GetLayerDataPtr(get_dispatch_key(instance), layer_data_map);
-    bool threadChecks = startMultiThread();
+    bool threadChecks = startMultiThread(my_data, "vkCreateDebugReportCallbackEXT");
     if (threadChecks) {
         startReadObject(my_data, instance);
     }
@@ -326,8 +337,6 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateDebugReportCallbackEXT(VkInstance instance,
     }
     if (threadChecks) {
         finishReadObject(my_data, instance);
-    } else {
-        finishMultiThread();
     }
     return result;
 }
@@ -335,7 +344,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateDebugReportCallbackEXT(VkInstance instance,
 VKAPI_ATTR void VKAPI_CALL DestroyDebugReportCallbackEXT(VkInstance instance, VkDebugReportCallbackEXT callback,
                                                          const VkAllocationCallbacks *pAllocator) {
     layer_data *my_data = GetLayerDataPtr(get_dispatch_key(instance), layer_data_map);
-    bool threadChecks = startMultiThread();
+    bool threadChecks = startMultiThread(my_data, "vkDestroyDebugReportCallbackEXT");
     if (threadChecks) {
         startReadObject(my_data, instance);
         startWriteObject(my_data, callback);
@@ -345,8 +354,6 @@ VKAPI_ATTR void VKAPI_CALL DestroyDebugReportCallbackEXT(VkInstance instance, Vk
     if (threadChecks) {
         finishReadObject(my_data, instance);
         finishWriteObject(my_data, callback);
-    } else {
-        finishMultiThread();
     }
 }
 
@@ -356,7 +363,7 @@ VKAPI_ATTR VkResult VKAPI_CALL AllocateCommandBuffers(VkDevice device, const VkC
     layer_data *my_data = GetLayerDataPtr(key, layer_data_map);
     VkLayerDispatchTable *pTable = my_data->device_dispatch_table;
     VkResult result;
-    bool threadChecks = startMultiThread();
+    bool threadChecks = startMultiThread(my_data, "vkAllocateCommandBuffers");
     if (threadChecks) {
         startReadObject(my_data, device);
         startWriteObject(my_data, pAllocateInfo->commandPool);
@@ -366,15 +373,12 @@ VKAPI_ATTR VkResult VKAPI_CALL AllocateCommandBuffers(VkDevice device, const VkC
     if (threadChecks) {
         finishReadObject(my_data, device);
         finishWriteObject(my_data, pAllocateInfo->commandPool);
-    } else {
-        finishMultiThread();
     }
 
     // Record mapping from command buffer to command pool
     if (VK_SUCCESS == result) {
         for (uint32_t index = 0; index < pAllocateInfo->commandBufferCount; index++) {
-            std::lock_guard<std::mutex> lock(command_pool_lock);
-            command_pool_map[pCommandBuffers[index]] = pAllocateInfo->commandPool;
+            my_data->command_pools.insert(pCommandBuffers[index], pAllocateInfo->commandPool);
         }
     }
 
@@ -387,7 +391,7 @@ VKAPI_ATTR VkResult VKAPI_CALL AllocateDescriptorSets(VkDevice device, const VkD
     layer_data *my_data = GetLayerDataPtr(key, layer_data_map);
     VkLayerDispatchTable *pTable = my_data->device_dispatch_table;
     VkResult result;
-    bool threadChecks = startMultiThread();
+    bool threadChecks = startMultiThread(my_data, "vkAllocateDescriptorSets");
     if (threadChecks) {
         startReadObject(my_data, device);
         startWriteObject(my_data, pAllocateInfo->descriptorPool);
@@ -398,8 +402,6 @@ VKAPI_ATTR VkResult VKAPI_CALL AllocateDescriptorSets(VkDevice device, const VkD
         finishReadObject(my_data, device);
         finishWriteObject(my_data, pAllocateInfo->descriptorPool);
         // Host access to pAllocateInfo::descriptorPool must be externally synchronized
-    } else {
-        finishMultiThread();
     }
     return result;
 }
@@ -410,7 +412,7 @@ VKAPI_ATTR void VKAPI_CALL FreeCommandBuffers(VkDevice device, VkCommandPool com
     layer_data *my_data = GetLayerDataPtr(key, layer_data_map);
     VkLayerDispatchTable *pTable = my_data->device_dispatch_table;
     const bool lockCommandPool = false;  // pool is already directly locked
-    bool threadChecks = startMultiThread();
+    bool threadChecks = startMultiThread(my_data, "vkFreeCommandBuffers");
     if (threadChecks) {
         startReadObject(my_data, device);
         startWriteObject(my_data, commandPool);
@@ -421,17 +423,36 @@ VKAPI_ATTR void VKAPI_CALL FreeCommandBuffers(VkDevice device, VkCommandPool com
         // These updates need to be done before calling down to the driver.
         for (uint32_t index = 0; index < commandBufferCount; index++) {
             finishWriteObject(my_data, pCommandBuffers[index], lockCommandPool);
-            std::lock_guard<std::mutex> lock(command_pool_lock);
-            command_pool_map.erase(pCommandBuffers[index]);
         }
     }
+    for (uint32_t index = 0; index < commandBufferCount; index++) {
+        my_data->command_pools.erase(pCommandBuffers[index]);
+    }
 
     pTable->FreeCommandBuffers(device, commandPool, commandBufferCount, pCommandBuffers);
     if (threadChecks) {
         finishReadObject(my_data, device);
         finishWriteObject(my_data, commandPool);
-    } else {
-        finishMultiThread();
+    }
+}
+
+VKAPI_ATTR void VKAPI_CALL DestroyCommandPool(VkDevice device, VkCommandPool commandPool, const VkAllocationCallbacks *pAllocator) {
+    dispatch_key key = get_dispatch_key(device);
+    layer_data *my_data = GetLayerDataPtr(key, layer_data_map);
+    VkLayerDispatchTable *pTable = my_data->device_dispatch_table;
+    bool threadChecks = startMultiThread(my_data, "vkDestroyCommandPool");
+    if (threadChecks) {
+        startReadObject(my_data, device);
+        startWriteObject(my_data, commandPool);
+        // Host access to commandPool must be externally synchronized
+    }
+    // The pool's command buffers are freed with it, and the driver may hand their handles out again
+    my_data->command_pools.erase_pool(commandPool);
+    pTable->DestroyCommandPool(device, commandPool, pAllocator);
+    if (threadChecks) {
+        finishReadObject(my_data, device);
+        finishWriteObject(my_data, commandPool);
+        // Host access to commandPool must be externally synchronized
     }
 }
 
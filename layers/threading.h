@@ -20,8 +20,17 @@
 
 #ifndef THREADING_H
 #define THREADING_H
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
 #include <condition_variable>
+#include <cstdio>
+#include <map>
 #include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 #include "vk_layer_config.h"
 #include "vk_layer_logging.h"
@@ -46,178 +55,481 @@ struct object_use_data {
     int writer_count;
 };
 
-struct layer_data;
+// Where threads meet on the same object, recorded for one device when google_threading.contention_file is set and written to
+// that file when the device is destroyed. It is meant for finding objects that are passed between threads so often that it
+// costs throughput, which shows up as handoffs even when the application synchronizes them correctly.
+//
+// Events are counted per handle type, per object and per entry point:
+//  - a collision is a use that overlapped a use from another thread, i.e. a THREADING ERROR
+//  - a wait is a collision where the callback asked to skip the call, so the layer waited for the other use to end instead
+//  - a handoff is a use that started on a different thread from the object's previous use, as long as no other object has
+//    taken over its home slot in counter<T> in between
+class contention_stats {
+   public:
+    struct totals {
+        uint64_t collisions;
+        uint64_t waits;
+        uint64_t wait_ns;
+        uint64_t max_wait_ns;
+        uint64_t handoffs;
 
-namespace threading {
-volatile bool vulkan_in_use = false;
-volatile bool vulkan_multi_threaded = false;
-// starting check if an application is using vulkan from multiple threads.
-inline bool startMultiThread() {
-    if (vulkan_multi_threaded) {
-        return true;
+        totals() : collisions(0), waits(0), wait_ns(0), max_wait_ns(0), handoffs(0) {}
+        void add(const totals &other) {
+            collisions += other.collisions;
+            waits += other.waits;
+            wait_ns += other.wait_ns;
+            max_wait_ns = std::max(max_wait_ns, other.max_wait_ns);
+            handoffs += other.handoffs;
+        }
+        // Hottest first: longest waits, then most collisions, then most handoffs
+        bool hotter_than(const totals &other) const {
+            if (wait_ns != other.wait_ns) return wait_ns > other.wait_ns;
+            if (collisions != other.collisions) return collisions > other.collisions;
+            return handoffs > other.handoffs;
+        }
+    };
+
+    static const size_t kTopCount = 20;  // Objects and entry points listed in the report
+
+    explicit contention_stats(const char *filename) : filename_(filename) {}
+
+    static uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count();
     }
-    if (vulkan_in_use) {
-        vulkan_multi_threaded = true;
-        return true;
+
+    // Entry point the calling thread is in; set by startMultiThread()
+    static const char *&current_call() {
+        static thread_local const char *call = nullptr;
+        return call;
+    }
+
+    void handoff(const char *type_name, uint64_t handle) {
+        totals event;
+        event.handoffs = 1;
+        record(type_name, handle, event);
+    }
+
+    // A collision the caller carried on through, or, if waited, one it spent wait_ns waiting out
+    void collision(const char *type_name, uint64_t handle, bool waited, uint64_t wait_ns) {
+        totals event;
+        event.collisions = 1;
+        if (waited) {
+            event.waits = 1;
+            event.wait_ns = event.max_wait_ns = wait_ns;
+        }
+        record(type_name, handle, event);
     }
-    vulkan_in_use = true;
-    return false;
-}
 
-// finishing check if an application is using vulkan from multiple threads.
-inline void finishMultiThread() { vulkan_in_use = false; }
-}  // namespace threading
+    // Append the report for device to the file, replacing whatever an earlier run of the process left there
+    void write_report(VkDevice device) {
+        std::map<std::string, totals> types;
+        std::map<std::pair<std::string, uint64_t>, totals> objects;
+        std::map<std::string, totals> calls;
+        for (auto &s : shards_) {
+            std::lock_guard<std::mutex> lock(s.lock);
+            for (auto &entry : s.objects) {
+                types[entry.first.first].add(entry.second);
+                objects[entry.first].add(entry.second);
+            }
+            for (auto &entry : s.calls) calls[entry.first ? entry.first : "(unknown)"].add(entry.second);
+        }
+
+        static std::mutex file_lock;
+        static bool written = false;
+        std::lock_guard<std::mutex> lock(file_lock);
+        FILE *out = fopen(filename_.c_str(), written ? "a" : "w");
+        if (!out) return;
+        written = true;
+        fprintf(out, "# Thread contention on VkDevice 0x%" PRIx64 "\n", HandleToUint64(device));
+        fprintf(out, "type,collisions,waits,total_wait_us,max_wait_us,handoffs\n");
+        for (auto &entry : types) write_row(out, entry.first.c_str(), entry.second);
+        fprintf(out, "\ntype,object,collisions,waits,total_wait_us,max_wait_us,handoffs\n");
+        for (auto &entry : hottest(objects)) {
+            char name[96];
+            snprintf(name, sizeof(name), "%s,0x%" PRIx64, entry.first.first.c_str(), entry.first.second);
+            write_row(out, name, entry.second);
+        }
+        fprintf(out, "\nentry_point,collisions,waits,total_wait_us,max_wait_us,handoffs\n");
+        for (auto &entry : hottest(calls)) write_row(out, entry.first.c_str(), entry.second);
+        fprintf(out, "\n");
+        fclose(out);
+    }
+
+   private:
+    static const size_t kShards = 16;
+
+    // Events are rare next to uses, but handoffs can come from many threads at once, so objects are spread over shards
+    struct shard {
+        std::mutex lock;
+        std::map<std::pair<std::string, uint64_t>, totals> objects;
+        std::unordered_map<const char *, totals> calls;
+    };
+
+    void record(const char *type_name, uint64_t handle, const totals &event) {
+        shard &s = shards_[(handle * 0x9E3779B97F4A7C15ull) >> 60];
+        std::lock_guard<std::mutex> lock(s.lock);
+        s.objects[std::make_pair(std::string(type_name), handle)].add(event);
+        s.calls[current_call()].add(event);
+    }
+
+    template <typename K>
+    static std::vector<std::pair<K, totals>> hottest(const std::map<K, totals> &all) {
+        std::vector<std::pair<K, totals>> sorted(all.begin(), all.end());
+        std::stable_sort(sorted.begin(), sorted.end(), [](const std::pair<K, totals> &a, const std::pair<K, totals> &b) {
+            return a.second.hotter_than(b.second);
+        });
+        if (sorted.size() > kTopCount) sorted.resize(kTopCount);
+        return sorted;
+    }
+
+    static void write_row(FILE *out, const char *name, const totals &t) {
+        fprintf(out, "%s,%" PRIu64 ",%" PRIu64 ",%.3f,%.3f,%" PRIu64 "\n", name, t.collisions, t.waits, t.wait_ns / 1000.0,
+                t.max_wait_ns / 1000.0, t.handoffs);
+    }
+
+    std::string filename_;
+    shard shards_[kShards];
+};
 
+// Tracks which threads are using each object of one handle type, and reports objects used from two threads at once.
+//
+// Every object hashes to a home slot in a fixed table. The slot's state is one atomic word that packs its reader and writer
+// counts, so starting or finishing a use with no other thread involved is a load and a compare and swap, or a single atomic
+// subtraction, without a lock. A slot is taken over by an object when it is idle, under a lock bit in the same word, which also
+// records the thread for the error message and for telling recursion apart from a second thread. Only real collisions take
+// counter_lock: two threads using the same object, which may park the caller, or two objects in use at once that share a home
+// slot, in which case the later one is tracked in the overflow map as before.
 template <typename T>
 class counter {
    public:
     const char *typeName;
     VkDebugReportObjectTypeEXT objectType;
-    std::unordered_map<T, object_use_data> uses;
-    std::mutex counter_lock;
-    std::condition_variable counter_condition;
-    void startWrite(debug_report_data *report_data, T object) {
-        if (object == VK_NULL_HANDLE) {
-            return;
+
+    void startWrite(debug_report_data *report_data, T object, contention_stats *contention = nullptr) {
+        start(report_data, object, true, contention);
+    }
+    void finishWrite(T object) { finish(object, true); }
+    void startRead(debug_report_data *report_data, T object, contention_stats *contention = nullptr) {
+        start(report_data, object, false, contention);
+    }
+    void finishRead(T object) { finish(object, false); }
+
+    counter(const char *name = "", VkDebugReportObjectTypeEXT type = VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT)
+        : typeName(name), objectType(type), waiters(0) {
+        for (auto &slot : slots) {
+            slot.key.store(0, std::memory_order_relaxed);
+            slot.state.store(0, std::memory_order_relaxed);
+            slot.thread.store(loader_platform_thread_id(), std::memory_order_relaxed);
         }
-        bool skipCall = false;
-        loader_platform_thread_id tid = loader_platform_get_thread_id();
-        std::unique_lock<std::mutex> lock(counter_lock);
-        if (uses.find(object) == uses.end()) {
-            // There is no current use of the object.  Record writer thread.
-            struct object_use_data *use_data = &uses[object];
-            use_data->reader_count = 0;
-            use_data->writer_count = 1;
-            use_data->thread = tid;
-        } else {
-            struct object_use_data *use_data = &uses[object];
-            if (use_data->reader_count == 0) {
-                // There are no readers.  Two writers just collided.
-                if (use_data->thread != tid) {
-                    skipCall |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, objectType, (uint64_t)(object), 0,
-                                        THREADING_CHECKER_MULTIPLE_THREADS, "THREADING",
-                                        "THREADING ERROR : object of type %s is simultaneously used in thread %ld and thread %ld",
-                                        typeName, use_data->thread, tid);
-                    if (skipCall) {
-                        // Wait for thread-safe access to object instead of skipping call.
-                        while (uses.find(object) != uses.end()) {
-                            counter_condition.wait(lock);
-                        }
-                        // There is now no current use of the object.  Record writer thread.
-                        struct object_use_data *new_use_data = &uses[object];
-                        new_use_data->thread = tid;
-                        new_use_data->reader_count = 0;
-                        new_use_data->writer_count = 1;
-                    } else {
-                        // Continue with an unsafe use of the object.
-                        use_data->thread = tid;
-                        use_data->writer_count += 1;
-                    }
-                } else {
-                    // This is either safe multiple use in one call, or recursive use.
-                    // There is no way to make recursion safe.  Just forge ahead.
-                    use_data->writer_count += 1;
+    }
+
+   private:
+    // Layout of slot::state
+    static const uint64_t kReader = 1;              // Bits 0-19
+    static const uint64_t kWriter = 1ull << 20;     // Bits 20-31
+    static const uint64_t kOverflow = 1ull << 32;   // Bits 32-43: uses of other objects with this home, in overflow
+    static const uint64_t kGeneration = 1ull << 44; // Bits 44-62: bumped whenever key or thread change
+    static const uint64_t kLocked = 1ull << 63;     // key and thread are being changed
+    static const uint64_t kReaderMask = kWriter - kReader;
+    static const uint64_t kWriterMask = kOverflow - kWriter;
+    static const uint64_t kUseMask = kReaderMask | kWriterMask;
+    static const uint64_t kOverflowMask = kGeneration - kOverflow;
+    static const uint64_t kGenerationMask = kLocked - kGeneration;
+    static const unsigned kSlotBits = 8;
+
+    struct slot {
+        std::atomic<uint64_t> key;  // Object using the slot, or that last used it; only changes under kLocked
+        std::atomic<uint64_t> state;
+        // Thread that started the current use, or the last writer to carry on after a collision
+        std::atomic<loader_platform_thread_id> thread;
+    };
+
+    enum attempt_result { kStarted, kCollided, kOverflowed };
+
+    static uint64_t key_of(T object) { return HandleToUint64(object); }
+    slot &home(uint64_t key) { return slots[(key * 0x9E3779B97F4A7C15ull) >> (64 - kSlotBits)]; }
+
+    // One lock-free try at starting a use of object in its home slot. On kCollided, *other is the thread using it. Unless
+    // allow_collision is set, a collision leaves the slot as it was. If handoff is given, it is set when the use takes over
+    // the slot from the object's previous use on another thread.
+    attempt_result try_start(slot &home, uint64_t key, bool write, loader_platform_thread_id tid, bool allow_collision,
+                             loader_platform_thread_id *other, bool *handoff = nullptr) {
+        const uint64_t use = write ? kWriter : kReader;
+        while (true) {
+            uint64_t state = home.state.load(std::memory_order_acquire);
+            if (state & kLocked) {
+                std::this_thread::yield();
+                continue;
+            }
+            if ((state & kUseMask) == 0) {
+                if (home.key.load(std::memory_order_relaxed) != key && (state & kOverflowMask)) {
+                    // Another object's use is in overflow and might be this one's; joining it there keeps one record each
+                    if (home.state.compare_exchange_weak(state, state + kOverflow, std::memory_order_acq_rel)) return kOverflowed;
+                    continue;
                 }
-            } else {
-                // There are readers.  This writer collided with them.
-                if (use_data->thread != tid) {
-                    skipCall |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, objectType, (uint64_t)(object), 0,
-                                        THREADING_CHECKER_MULTIPLE_THREADS, "THREADING",
-                                        "THREADING ERROR : object of type %s is simultaneously used in thread %ld and thread %ld",
-                                        typeName, use_data->thread, tid);
-                    if (skipCall) {
-                        // Wait for thread-safe access to object instead of skipping call.
-                        while (uses.find(object) != uses.end()) {
-                            counter_condition.wait(lock);
-                        }
-                        // There is now no current use of the object.  Record writer thread.
-                        struct object_use_data *new_use_data = &uses[object];
-                        new_use_data->thread = tid;
-                        new_use_data->reader_count = 0;
-                        new_use_data->writer_count = 1;
-                    } else {
-                        // Continue with an unsafe use of the object.
-                        use_data->thread = tid;
-                        use_data->writer_count += 1;
-                    }
-                } else {
-                    // This is either safe multiple use in one call, or recursive use.
-                    // There is no way to make recursion safe.  Just forge ahead.
-                    use_data->writer_count += 1;
+                // Idle: take the slot over, recording which thread is now using it
+                uint64_t locked = ((state & kGenerationMask) + kGeneration) & kGenerationMask;
+                if (!home.state.compare_exchange_weak(state, (state & kOverflowMask) | locked | kLocked,
+                                                      std::memory_order_acquire)) {
+                    continue;
+                }
+                if (handoff) {
+                    *handoff = home.key.load(std::memory_order_relaxed) == key && home.thread.load(std::memory_order_relaxed) != tid;
                 }
+                home.key.store(key, std::memory_order_relaxed);
+                home.thread.store(tid, std::memory_order_relaxed);
+                // finish() can still take an overflow use off the slot while it is locked, so publish with an RMW that keeps
+                // whatever overflow count is there now; subtracting kLocked just clears the top bit
+                home.state.fetch_add(use - kLocked, std::memory_order_release);
+                return kStarted;
+            }
+            if (home.key.load(std::memory_order_relaxed) != key) {
+                // In use by another object with the same home
+                if (home.state.compare_exchange_weak(state, state + kOverflow, std::memory_order_acq_rel)) return kOverflowed;
+                continue;
+            }
+            const bool collision = (write || (state & kWriterMask)) && home.thread.load(std::memory_order_relaxed) != tid;
+            if (collision && !allow_collision) {
+                *other = home.thread.load(std::memory_order_relaxed);
+                // Make sure that was not read from a slot that changed hands in the meantime
+                if (home.state.load(std::memory_order_acquire) == state) return kCollided;
+                continue;
+            }
+            if (home.state.compare_exchange_weak(state, state + use, std::memory_order_acq_rel)) {
+                // An unsafe writer becomes the thread named in later collisions, as readers never do
+                if (collision && write) home.thread.store(tid, std::memory_order_relaxed);
+                return kStarted;
             }
         }
     }
 
-    void finishWrite(T object) {
+    void start(debug_report_data *report_data, T object, bool write, contention_stats *contention) {
         if (object == VK_NULL_HANDLE) {
             return;
         }
-        // Object is no longer in use
+        const uint64_t key = key_of(object);
+        slot &home_slot = home(key);
+        loader_platform_thread_id tid = loader_platform_get_thread_id();
+        loader_platform_thread_id other;
+        bool handoff = false;
+        attempt_result result = try_start(home_slot, key, write, tid, false, &other, contention ? &handoff : nullptr);
+        if (result == kStarted) {
+            if (handoff) contention->handoff(typeName, key);
+            return;
+        }
+        if (result == kOverflowed) return startOverflow(report_data, object, write, tid, contention);
+
+        bool skipCall = log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, objectType, key, 0, THREADING_CHECKER_MULTIPLE_THREADS,
+                                "THREADING", "THREADING ERROR : object of type %s is simultaneously used in thread %ld and thread %ld",
+                                typeName, other, tid);
+        if (!skipCall) {
+            if (contention) contention->collision(typeName, key, false, 0);
+            // Continue with an unsafe use of the object.
+            if (try_start(home_slot, key, write, tid, true, &other) == kOverflowed) {
+                startOverflow(report_data, object, write, tid, nullptr);
+            }
+            return;
+        }
+        // Wait for thread-safe access to object instead of skipping call.
+        const uint64_t wait_start = contention ? contention_stats::now() : 0;
         std::unique_lock<std::mutex> lock(counter_lock);
-        uses[object].writer_count -= 1;
-        if ((uses[object].reader_count == 0) && (uses[object].writer_count == 0)) {
-            uses.erase(object);
+        waiters.fetch_add(1);
+        // Pairs with the fence in finish(), so either this sees that use end or that finish() sees this waiter
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while ((result = try_start(home_slot, key, write, tid, false, &other)) == kCollided) {
+            counter_condition.wait(lock);
         }
-        // Notify any waiting threads that this object may be safe to use
+        waiters.fetch_sub(1);
         lock.unlock();
-        counter_condition.notify_all();
+        if (contention) contention->collision(typeName, key, true, contention_stats::now() - wait_start);
+        if (result == kOverflowed) startOverflow(report_data, object, write, tid, nullptr);
     }
 
-    void startRead(debug_report_data *report_data, T object) {
+    void finish(T object, bool write) {
         if (object == VK_NULL_HANDLE) {
             return;
         }
-        bool skipCall = false;
-        loader_platform_thread_id tid = loader_platform_get_thread_id();
+        const uint64_t key = key_of(object);
+        slot &home_slot = home(key);
+        // The key can't change while this use is counted in the slot, nor become this object's while it is in overflow
+        if (home_slot.key.load(std::memory_order_acquire) == key && (home_slot.state.load(std::memory_order_acquire) & kUseMask)) {
+            home_slot.state.fetch_sub(write ? kWriter : kReader);
+        } else {
+            finishOverflow(object, write);
+            home_slot.state.fetch_sub(kOverflow);
+        }
+        // Notify any waiting threads that this object may be safe to use
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load() > 0) {
+            std::lock_guard<std::mutex> lock(counter_lock);
+            counter_condition.notify_all();
+        }
+    }
+
+    // Uses of objects whose home slot was taken by another object, tracked as they all used to be
+    void startOverflow(debug_report_data *report_data, T object, bool write, loader_platform_thread_id tid,
+                       contention_stats *contention) {
         std::unique_lock<std::mutex> lock(counter_lock);
-        if (uses.find(object) == uses.end()) {
-            // There is no current use of the object.  Record reader count
-            struct object_use_data *use_data = &uses[object];
-            use_data->reader_count = 1;
-            use_data->writer_count = 0;
-            use_data->thread = tid;
-        } else if (uses[object].writer_count > 0 && uses[object].thread != tid) {
-            // There is a writer of the object.
-            skipCall |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, objectType, (uint64_t)(object), 0,
-                                THREADING_CHECKER_MULTIPLE_THREADS, "THREADING",
-                                "THREADING ERROR : object of type %s is simultaneously used in thread %ld and thread %ld", typeName,
-                                uses[object].thread, tid);
+        auto use_data = overflow.find(object);
+        if (use_data == overflow.end()) {
+            // There is no current use of the object.  Record the thread.
+            overflow[object] = {tid, write ? 0 : 1, write ? 1 : 0};
+            return;
+        }
+        const bool collision = (write || use_data->second.writer_count > 0) && use_data->second.thread != tid;
+        if (collision) {
+            bool skipCall = log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, objectType, key_of(object), 0,
+                                    THREADING_CHECKER_MULTIPLE_THREADS, "THREADING",
+                                    "THREADING ERROR : object of type %s is simultaneously used in thread %ld and thread %ld",
+                                    typeName, use_data->second.thread, tid);
             if (skipCall) {
                 // Wait for thread-safe access to object instead of skipping call.
-                while (uses.find(object) != uses.end()) {
+                const uint64_t wait_start = contention ? contention_stats::now() : 0;
+                waiters.fetch_add(1);
+                while (overflow.find(object) != overflow.end()) {
                     counter_condition.wait(lock);
                 }
-                // There is no current use of the object.  Record reader count
-                struct object_use_data *use_data = &uses[object];
-                use_data->reader_count = 1;
-                use_data->writer_count = 0;
-                use_data->thread = tid;
-            } else {
-                uses[object].reader_count += 1;
+                waiters.fetch_sub(1);
+                overflow[object] = {tid, write ? 0 : 1, write ? 1 : 0};
+                if (contention) contention->collision(typeName, key_of(object), true, contention_stats::now() - wait_start);
+                return;
             }
-        } else {
-            // There are other readers of the object.  Increase reader count
-            uses[object].reader_count += 1;
+            if (contention) contention->collision(typeName, key_of(object), false, 0);
+            // Continue with an unsafe use of the object.
+            if (write) use_data->second.thread = tid;
         }
+        // This is either safe multiple use, or recursive use.  There is no way to make recursion safe.  Just forge ahead.
+        (write ? use_data->second.writer_count : use_data->second.reader_count) += 1;
     }
-    void finishRead(T object) {
-        if (object == VK_NULL_HANDLE) {
-            return;
+
+    void finishOverflow(T object, bool write) {
+        std::lock_guard<std::mutex> lock(counter_lock);
+        auto use_data = overflow.find(object);
+        if (use_data == overflow.end()) return;
+        (write ? use_data->second.writer_count : use_data->second.reader_count) -= 1;
+        if ((use_data->second.reader_count == 0) && (use_data->second.writer_count == 0)) {
+            overflow.erase(use_data);
         }
-        std::unique_lock<std::mutex> lock(counter_lock);
-        uses[object].reader_count -= 1;
-        if ((uses[object].reader_count == 0) && (uses[object].writer_count == 0)) {
-            uses.erase(object);
+    }
+
+    slot slots[1 << kSlotBits];
+    std::mutex counter_lock;  // Guards overflow, and parks threads waiting for an object
+    std::condition_variable counter_condition;
+    std::atomic<int> waiters;
+    std::unordered_map<T, object_use_data> overflow;
+};
+
+// Which pool each command buffer was allocated from, so that a use of a command buffer can also count as a use of its pool.
+//
+// Every command recorded looks a buffer up, from whichever threads are recording, so lookups take no lock. A buffer's entry
+// goes in one of kEntries places in its bucket, which a lookup scans; buffers whose bucket is full go in an overflow map
+// under a mutex, and the bucket counts them so a lookup only takes the mutex when the buffer might be there. An entry is
+// written before vkAllocateCommandBuffers returns and cleared when the buffer is freed, and the application can't use a
+// buffer outside that window, so a lookup never sees one half written.
+class command_pool_table {
+   public:
+    command_pool_table() {
+        for (auto &b : buckets) {
+            for (auto &e : b.entries) {
+                e.buffer.store(nullptr, std::memory_order_relaxed);
+                e.pool.store(0, std::memory_order_relaxed);
+            }
+            b.overflow.store(0, std::memory_order_relaxed);
         }
-        // Notify any waiting threads that this object may be safe to use
-        lock.unlock();
-        counter_condition.notify_all();
     }
-    counter(const char *name = "", VkDebugReportObjectTypeEXT type = VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT) {
-        typeName = name;
-        objectType = type;
+
+    VkCommandPool find(VkCommandBuffer buffer) {
+        bucket &b = bucket_of(buffer);
+        for (auto &e : b.entries) {
+            if (e.buffer.load(std::memory_order_acquire) == buffer) return Uint64ToPool(e.pool.load(std::memory_order_acquire));
+        }
+        if (b.overflow.load(std::memory_order_acquire) == 0) return VK_NULL_HANDLE;
+        std::lock_guard<std::mutex> lock(overflow_lock);
+        auto it = overflow.find(buffer);
+        return it == overflow.end() ? VK_NULL_HANDLE : it->second;
     }
+
+    void insert(VkCommandBuffer buffer, VkCommandPool pool) {
+        if (buffer == VK_NULL_HANDLE) return;
+        bucket &b = bucket_of(buffer);
+        for (auto &e : b.entries) {
+            VkCommandBuffer empty = nullptr;
+            if (e.buffer.load(std::memory_order_relaxed) == nullptr &&
+                e.buffer.compare_exchange_strong(empty, buffer, std::memory_order_acq_rel)) {
+                e.pool.store(HandleToUint64(pool), std::memory_order_release);
+                return;
+            }
+        }
+        std::lock_guard<std::mutex> lock(overflow_lock);
+        overflow[buffer] = pool;
+        b.overflow.fetch_add(1, std::memory_order_release);
+    }
+
+    void erase(VkCommandBuffer buffer) {
+        if (buffer == VK_NULL_HANDLE) return;
+        bucket &b = bucket_of(buffer);
+        for (auto &e : b.entries) {
+            if (e.buffer.load(std::memory_order_relaxed) == buffer) {
+                e.pool.store(0, std::memory_order_relaxed);
+                e.buffer.store(nullptr, std::memory_order_release);
+                return;
+            }
+        }
+        std::lock_guard<std::mutex> lock(overflow_lock);
+        if (overflow.erase(buffer)) b.overflow.fetch_sub(1, std::memory_order_release);
+    }
+
+    // Forget the buffers of a pool being destroyed, which frees them without vkFreeCommandBuffers
+    void erase_pool(VkCommandPool pool) {
+        if (pool == VK_NULL_HANDLE) return;
+        const uint64_t pool_key = HandleToUint64(pool);
+        for (auto &b : buckets) {
+            for (auto &e : b.entries) {
+                if (e.buffer.load(std::memory_order_acquire) != nullptr && e.pool.load(std::memory_order_relaxed) == pool_key) {
+                    e.pool.store(0, std::memory_order_relaxed);
+                    e.buffer.store(nullptr, std::memory_order_release);
+                }
+            }
+        }
+        std::lock_guard<std::mutex> lock(overflow_lock);
+        for (auto it = overflow.begin(); it != overflow.end();) {
+            if (it->second == pool) {
+                bucket_of(it->first).overflow.fetch_sub(1, std::memory_order_release);
+                it = overflow.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+   private:
+    static const unsigned kBucketBits = 10;
+    static const unsigned kEntries = 4;
+
+    struct entry {
+        std::atomic<VkCommandBuffer> buffer;
+        std::atomic<uint64_t> pool;
+    };
+    struct bucket {
+        entry entries[kEntries];
+        std::atomic<uint32_t> overflow;  // Buffers with this bucket in the overflow map
+    };
+
+    static VkCommandPool Uint64ToPool(uint64_t pool) {
+#ifdef DISTINCT_NONDISPATCHABLE_HANDLES
+        return reinterpret_cast<VkCommandPool>(pool);
+#else
+        return pool;
+#endif
+    }
+    bucket &bucket_of(VkCommandBuffer buffer) {
+        return buckets[(HandleToUint64(buffer) * 0x9E3779B97F4A7C15ull) >> (64 - kBucketBits)];
+    }
+
+    bucket buckets[1 << kBucketBits];
+    std::mutex overflow_lock;  // Guards overflow
+    std::unordered_map<VkCommandBuffer, VkCommandPool> overflow;
 };
 
 struct layer_data {
@@ -232,6 +544,12 @@ struct layer_data {
     uint32_t num_tmp_callbacks;
     VkDebugReportCallbackCreateInfoEXT *tmp_dbg_create_infos;
     VkDebugReportCallbackEXT *tmp_callbacks;
+    // Until a second thread calls into this instance or device, the one thread that has is single_thread and objects are not
+    // tracked; see startMultiThread()
+    std::atomic<loader_platform_thread_id> single_thread;
+    std::atomic<bool> multi_threaded;
+    command_pool_table command_pools;
+    contention_stats *contention;  // Only for devices, and only when google_threading.contention_file is set
     counter<VkCommandBuffer> c_VkCommandBuffer;
     counter<VkDevice> c_VkDevice;
     counter<VkInstance> c_VkInstance;
@@ -274,6 +592,9 @@ struct layer_data {
           num_tmp_callbacks(0),
           tmp_dbg_create_infos(nullptr),
           tmp_callbacks(nullptr),
+          single_thread(loader_platform_thread_id()),
+          multi_threaded(false),
+          contention(nullptr),
           c_VkCommandBuffer("VkCommandBuffer", VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT),
           c_VkDevice("VkDevice", VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_EXT),
           c_VkInstance("VkInstance", VK_DEBUG_REPORT_OBJECT_TYPE_INSTANCE_EXT),
@@ -314,13 +635,37 @@ struct layer_data {
               {};
 };
 
+// Whether a call should track the objects it uses. Tracking starts with the first call from a second thread into the same
+// instance or device and stays on from then on; until then a call costs a load and a compare. A call already under way on the
+// first thread when the second one arrives finishes untracked, so a collision with it goes unreported.
+//
+// call_name is the entry point, for the contention report.
+static inline bool startMultiThread(layer_data *my_data, const char *call_name) {
+    if (my_data->multi_threaded.load(std::memory_order_acquire)) {
+        if (my_data->contention) contention_stats::current_call() = call_name;
+        return true;
+    }
+    const loader_platform_thread_id tid = loader_platform_get_thread_id();
+    loader_platform_thread_id owner = my_data->single_thread.load(std::memory_order_relaxed);
+    if (owner == tid) {
+        return false;
+    }
+    if (owner == loader_platform_thread_id() && my_data->single_thread.compare_exchange_strong(owner, tid)) {
+        // First call of all
+        return false;
+    }
+    my_data->multi_threaded.store(true, std::memory_order_release);
+    if (my_data->contention) contention_stats::current_call() = call_name;
+    return true;
+}
+
 #define WRAPPER(type)                                                                                                 \
     static void startWriteObject(struct layer_data *my_data, type object) {                                           \
-        my_data->c_##type.startWrite(my_data->report_data, object);                                                   \
+        my_data->c_##type.startWrite(my_data->report_data, object, my_data->contention);                              \
     }                                                                                                                 \
     static void finishWriteObject(struct layer_data *my_data, type object) { my_data->c_##type.finishWrite(object); } \
     static void startReadObject(struct layer_data *my_data, type object) {                                            \
-        my_data->c_##type.startRead(my_data->report_data, object);                                                    \
+        my_data->c_##type.startRead(my_data->report_data, object, my_data->contention);                               \
     }                                                                                                                 \
     static void finishReadObject(struct layer_data *my_data, type object) { my_data->c_##type.finishRead(object); }
 
@@ -361,40 +706,26 @@ WRAPPER(uint64_t)
 #endif  // DISTINCT_NONDISPATCHABLE_HANDLES
 
 static std::unordered_map<void *, layer_data *> layer_data_map;
-static std::mutex command_pool_lock;
-static std::unordered_map<VkCommandBuffer, VkCommandPool> command_pool_map;
 
 // VkCommandBuffer needs check for implicit use of command pool
 static void startWriteObject(struct layer_data *my_data, VkCommandBuffer object, bool lockPool = true) {
     if (lockPool) {
-        std::unique_lock<std::mutex> lock(command_pool_lock);
-        VkCommandPool pool = command_pool_map[object];
-        lock.unlock();
-        startWriteObject(my_data, pool);
+        startWriteObject(my_data, my_data->command_pools.find(object));
     }
-    my_data->c_VkCommandBuffer.startWrite(my_data->report_data, object);
+    my_data->c_VkCommandBuffer.startWrite(my_data->report_data, object, my_data->contention);
 }
 static void finishWriteObject(struct layer_data *my_data, VkCommandBuffer object, bool lockPool = true) {
     my_data->c_VkCommandBuffer.finishWrite(object);
     if (lockPool) {
-        std::unique_lock<std::mutex> lock(command_pool_lock);
-        VkCommandPool pool = command_pool_map[object];
-        lock.unlock();
-        finishWriteObject(my_data, pool);
+        finishWriteObject(my_data, my_data->command_pools.find(object));
     }
 }
 static void startReadObject(struct layer_data *my_data, VkCommandBuffer object) {
-    std::unique_lock<std::mutex> lock(command_pool_lock);
-    VkCommandPool pool = command_pool_map[object];
-    lock.unlock();
-    startReadObject(my_data, pool);
-    my_data->c_VkCommandBuffer.startRead(my_data->report_data, object);
+    startReadObject(my_data, my_data->command_pools.find(object));
+    my_data->c_VkCommandBuffer.startRead(my_data->report_data, object, my_data->contention);
 }
 static void finishReadObject(struct layer_data *my_data, VkCommandBuffer object) {
     my_data->c_VkCommandBuffer.finishRead(object);
-    std::unique_lock<std::mutex> lock(command_pool_lock);
-    VkCommandPool pool = command_pool_map[object];
-    lock.unlock();
-    finishReadObject(my_data, pool);
+    finishReadObject(my_data, my_data->command_pools.find(object));
 }
 #endif  // THREADING_H
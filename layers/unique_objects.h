@@ -26,13 +26,190 @@
 #include "vk_layer_utils.h"
 #include "device_extensions.h"
 #include "mutex"
+#include <atomic>
+#include <cassert>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 #pragma once
 
 namespace unique_objects {
 
-// All increments must be guarded by global_lock
-static uint64_t global_unique_id = 1;
+// Real handles of the objects one instance or device has wrapped, looked up by the unique IDs handed out in their place.
+//
+// An ID is a slot index in its low 32 bits and that slot's generation in its high 32 bits. All tables share one set of slots,
+// so IDs are unique across every instance and device in the process, as object_tracker's wrong-device check needs; each slot
+// records the table that owns it, and a table misses on an ID another table handed out. Slots live in chunks that double in
+// size and are not moved or freed while the process has the layer loaded, so finding an ID is an index calculation and three
+// loads, without a lock, and can run alongside other threads inserting and erasing. Erased slots go on a free list, a
+// lock-free stack whose head carries a tag against ABA, and their generation moves on, so a stale ID misses instead of
+// finding the next object in its slot. A slot's generation is odd while it holds a handle, which keeps every ID non-zero.
+class unique_id_table {
+   public:
+    unique_id_table() : owner_(slots().new_owner()) {}
+    // Releases the slots of objects the application never destroyed, such as those freed along with their pool or device
+    ~unique_id_table() { slots().release_all(owner_); }
+    unique_id_table(const unique_id_table &) = delete;
+    unique_id_table &operator=(const unique_id_table &) = delete;
+
+    // Store handle and return a new ID for it
+    uint64_t insert(uint64_t handle) {
+        shared_slots &all = slots();
+        const uint32_t index = all.allocate_slot();
+        slot &s = all.at(index);
+        s.handle.store(handle, std::memory_order_relaxed);
+        s.owner.store(owner_, std::memory_order_relaxed);
+        const uint32_t generation = s.generation.load(std::memory_order_relaxed) + 1;
+        s.generation.store(generation, std::memory_order_release);
+        return (static_cast<uint64_t>(generation) << 32) | index;
+    }
+
+    // The handle stored for id, or 0 if id is not in the table
+    uint64_t find(uint64_t id) const {
+        const slot *s = lookup(id);
+        return s ? s->handle.load(std::memory_order_relaxed) : 0;
+    }
+
+    // Remove id and return the handle that was stored for it, or 0 if id is not in the table
+    uint64_t erase(uint64_t id) {
+        slot *s = lookup(id);
+        if (!s) return 0;
+        const uint64_t handle = s->handle.load(std::memory_order_relaxed);
+        if (!slots().release(static_cast<uint32_t>(id), static_cast<uint32_t>(id >> 32))) return 0;
+        return handle;
+    }
+
+   private:
+    struct slot {
+        std::atomic<uint64_t> handle;
+        std::atomic<uint32_t> generation;
+        std::atomic<uint32_t> owner;      // Table holding the slot; set before the generation that publishes it
+        std::atomic<uint32_t> next_free;  // While on the free list, the list below it in free_head_'s encoding
+    };
+
+    // The slots of every table in the process
+    class shared_slots {
+       public:
+        shared_slots() : next_index_(0), free_head_(0), next_owner_(0) {
+            for (auto &chunk : chunks_) chunk.store(nullptr, std::memory_order_relaxed);
+        }
+        ~shared_slots() {
+            for (auto &chunk : chunks_) delete[] chunk.load(std::memory_order_relaxed);
+        }
+
+        uint32_t new_owner() { return next_owner_.fetch_add(1, std::memory_order_relaxed) + 1; }
+
+        slot &at(uint32_t index) const {
+            uint32_t offset;
+            const unsigned chunk = chunk_of(index, &offset);
+            return chunks_[chunk].load(std::memory_order_acquire)[offset];
+        }
+
+        slot *lookup(uint64_t id) const {
+            const uint32_t generation = static_cast<uint32_t>(id >> 32);
+            if ((generation & 1) == 0) return nullptr;
+            uint32_t offset;
+            const unsigned chunk = chunk_of(static_cast<uint32_t>(id), &offset);
+            if (chunk >= kChunkCount) return nullptr;
+            slot *slots = chunks_[chunk].load(std::memory_order_acquire);
+            if (!slots || slots[offset].generation.load(std::memory_order_acquire) != generation) return nullptr;
+            return &slots[offset];
+        }
+
+        // free_head_ is a tag in its high 32 bits, bumped on every change, and the top slot's index + 1, or 0, in its low 32
+        // bits
+        uint32_t allocate_slot() {
+            uint64_t head = free_head_.load(std::memory_order_acquire);
+            while (static_cast<uint32_t>(head) != 0) {
+                const uint32_t index = static_cast<uint32_t>(head) - 1;
+                const uint64_t next = ((head >> 32) + 1) << 32 | at(index).next_free.load(std::memory_order_relaxed);
+                if (free_head_.compare_exchange_weak(head, next, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                    return index;
+                }
+            }
+            const uint32_t index = next_index_.fetch_add(1, std::memory_order_relaxed);
+            uint32_t offset;
+            const unsigned chunk = chunk_of(index, &offset);
+            assert(chunk < kChunkCount);
+            if (!chunks_[chunk].load(std::memory_order_acquire)) {
+                slot *slots = new slot[static_cast<size_t>(1) << (kFirstChunkBits + chunk)]();
+                slot *expected = nullptr;
+                if (!chunks_[chunk].compare_exchange_strong(expected, slots, std::memory_order_acq_rel)) delete[] slots;
+            }
+            return index;
+        }
+
+        // Move the slot on from generation and put it on the free list, unless another thread got there first
+        bool release(uint32_t index, uint32_t generation) {
+            if (!at(index).generation.compare_exchange_strong(generation, generation + 1, std::memory_order_acq_rel)) {
+                return false;
+            }
+            push_free(index);
+            return true;
+        }
+
+        void release_all(uint32_t owner) {
+            const uint32_t end = next_index_.load(std::memory_order_acquire);
+            for (uint32_t index = 0; index < end; index++) {
+                uint32_t offset;
+                const unsigned chunk = chunk_of(index, &offset);
+                slot *slots = chunks_[chunk].load(std::memory_order_acquire);
+                if (!slots) continue;  // Handed out, but the chunk is still being allocated by another table
+                const uint32_t generation = slots[offset].generation.load(std::memory_order_acquire);
+                if ((generation & 1) && slots[offset].owner.load(std::memory_order_relaxed) == owner) {
+                    release(index, generation);
+                }
+            }
+        }
+
+       private:
+        static const unsigned kFirstChunkBits = 8;  // Chunk c holds 256 << c slots
+        static const unsigned kChunkCount = 24;     // Just under 2^32 slots in all
+
+        static unsigned floor_log2(uint32_t value) {
+#if defined(_MSC_VER)
+            unsigned long bit;
+            _BitScanReverse(&bit, value);
+            return bit;
+#else
+            return 31 - __builtin_clz(value);
+#endif
+        }
+        static unsigned chunk_of(uint32_t index, uint32_t *offset) {
+            const unsigned chunk = floor_log2((index >> kFirstChunkBits) + 1);
+            *offset = index - (((1u << chunk) - 1) << kFirstChunkBits);
+            return chunk;
+        }
+
+        void push_free(uint32_t index) {
+            slot &s = at(index);
+            uint64_t head = free_head_.load(std::memory_order_relaxed);
+            do {
+                s.next_free.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+            } while (!free_head_.compare_exchange_weak(head, ((head >> 32) + 1) << 32 | (index + 1), std::memory_order_release,
+                                                       std::memory_order_relaxed));
+        }
+
+        std::atomic<slot *> chunks_[kChunkCount];
+        std::atomic<uint32_t> next_index_;  // Slots below this have been handed out at least once
+        std::atomic<uint64_t> free_head_;
+        std::atomic<uint32_t> next_owner_;
+    };
+
+    // Destroyed when the layer is unloaded, by which time every instance and device, and so every table, is gone
+    static shared_slots &slots() {
+        static shared_slots all;
+        return all;
+    }
+
+    slot *lookup(uint64_t id) const {
+        slot *s = slots().lookup(id);
+        return s && s->owner.load(std::memory_order_relaxed) == owner_ ? s : nullptr;
+    }
+
+    const uint32_t owner_;
+};
 
 struct TEMPLATE_STATE {
     VkDescriptorUpdateTemplateKHR desc_update_template;
@@ -55,7 +232,7 @@ struct instance_layer_data {
     VkDebugReportCallbackCreateInfoEXT *tmp_dbg_create_infos;
     VkDebugReportCallbackEXT *tmp_callbacks;
 
-    std::unordered_map<uint64_t, uint64_t> unique_id_mapping;  // Map uniqueID to actual object handle
+    unique_id_table unique_id_mapping;  // Map uniqueID to actual object handle
 
     InstanceExtensions extensions = {};
 };
@@ -69,7 +246,7 @@ struct layer_data {
     std::unordered_map<uint64_t, std::unique_ptr<TEMPLATE_STATE>> desc_template_map;
 
     bool wsi_enabled;
-    std::unordered_map<uint64_t, uint64_t> unique_id_mapping;  // Map uniqueID to actual object handle
+    unique_id_table unique_id_mapping;  // Map uniqueID to actual object handle
     VkPhysicalDevice gpu;
 
     layer_data() : wsi_enabled(false), gpu(VK_NULL_HANDLE){};
@@ -78,7 +255,7 @@ struct layer_data {
 static std::unordered_map<void *, instance_layer_data *> instance_layer_data_map;
 static std::unordered_map<void *, layer_data *> layer_data_map;
 
-static std::mutex global_lock;  // Protect map accesses and unique_id increments
+static std::mutex global_lock;  // Protects desc_template_map
 
 struct GenericHeader {
     VkStructureType sType;
@@ -104,20 +281,17 @@ bool ContainsExtStruct(const T *target, VkStructureType ext_type) {
 
 
 /* Unwrap a handle. */
-// must hold lock!
+// Needs no lock. An unknown handle unwraps to VK_NULL_HANDLE.
 template<typename HandleType, typename MapType>
 HandleType Unwrap(MapType *layer_data, HandleType wrappedHandle) {
-    // TODO: don't use operator[] here.
-    return (HandleType)layer_data->unique_id_mapping[reinterpret_cast<uint64_t const &>(wrappedHandle)];
+    return (HandleType)layer_data->unique_id_mapping.find(reinterpret_cast<uint64_t const &>(wrappedHandle));
 }
 
 /* Wrap a newly created handle with a new unique ID, and return the new ID. */
-// must hold lock!
+// Needs no lock.
 template<typename HandleType, typename MapType>
 HandleType WrapNew(MapType *layer_data, HandleType newlyCreatedHandle) {
-    auto unique_id = global_unique_id++;
-    layer_data->unique_id_mapping[unique_id] = reinterpret_cast<uint64_t const &>(newlyCreatedHandle);
-    return (HandleType)unique_id;
+    return (HandleType)layer_data->unique_id_mapping.insert(reinterpret_cast<uint64_t const &>(newlyCreatedHandle));
 }
 
 }  // namespace unique_objects
@@ -0,0 +1,157 @@
+/* Copyright (c) 2015-2017 The Khronos Group Inc.
+ * Copyright (c) 2015-2017 Valve Corporation
+ * Copyright (c) 2015-2017 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VK_LAYER_ARENA_H
+#define VK_LAYER_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Memory pool for state that is built up one small allocation at a time and then thrown away all at once, such as
+// everything a command buffer records between two resets.
+//
+// Allocations are carved out of large blocks. Sizes are rounded up to a multiple of kGranularity, and a freed
+// allocation of up to kMaxClassSize bytes goes on a free list for its size class so that containers which erase and
+// re-insert while recording reuse the same memory. rewind() forgets every allocation in one step and keeps the blocks,
+// so after the first few recordings a command buffer is re-recorded without touching the system heap at all.
+// Requests larger than a quarter block go straight to the system heap.
+//
+// Not thread safe; each arena belongs to one owner whose users are externally synchronized.
+class arena {
+   public:
+    static const size_t kGranularity = 16;
+    static const size_t kMaxClassSize = 512;
+    static const size_t kDefaultBlockSize = 16 * 1024;
+
+    explicit arena(size_t block_size = kDefaultBlockSize)
+        : block_size_(block_size), block_index_(0), offset_(0), allocations_(0), system_allocations_(0) {
+        for (auto &head : free_lists_) head = nullptr;
+    }
+    ~arena() {
+        for (auto block : blocks_) ::operator delete(block);
+    }
+    arena(const arena &) = delete;
+    arena &operator=(const arena &) = delete;
+
+    void *allocate(size_t size) {
+        ++allocations_;
+        const size_t rounded = round_up(size);
+        if (rounded > block_size_ / 4) {
+            ++system_allocations_;
+            return ::operator new(size);
+        }
+        if (rounded <= kMaxClassSize) {
+            free_node *&head = free_lists_[size_class(rounded)];
+            if (head) {
+                free_node *node = head;
+                head = node->next;
+                return node;
+            }
+        }
+        if (blocks_.empty() || offset_ + rounded > block_size_) next_block();
+        void *p = static_cast<char *>(blocks_[block_index_]) + offset_;
+        offset_ += rounded;
+        return p;
+    }
+
+    void deallocate(void *p, size_t size) {
+        const size_t rounded = round_up(size);
+        if (rounded > block_size_ / 4) {
+            ::operator delete(p);
+        } else if (rounded <= kMaxClassSize) {
+            free_node *&head = free_lists_[size_class(rounded)];
+            head = new (p) free_node{head};
+        }
+        // Anything between kMaxClassSize and a quarter block is reclaimed by rewind()
+    }
+
+    // Release every allocation made since the last rewind. Nothing allocated from the arena may be used afterwards.
+    void rewind() {
+        block_index_ = 0;
+        offset_ = 0;
+        for (auto &head : free_lists_) head = nullptr;
+        allocations_ = 0;
+        system_allocations_ = 0;
+    }
+
+    // Allocations served since the last rewind, and how many of them needed memory from the system heap
+    uint64_t allocations() const { return allocations_; }
+    uint64_t system_allocations() const { return system_allocations_; }
+
+   private:
+    struct free_node {
+        free_node *next;
+    };
+
+    static size_t round_up(size_t size) { return (size + kGranularity - 1) & ~(kGranularity - 1); }
+    static size_t size_class(size_t rounded) { return rounded / kGranularity - 1; }
+
+    void next_block() {
+        if (!blocks_.empty()) ++block_index_;
+        offset_ = 0;
+        if (block_index_ == blocks_.size()) {
+            ++system_allocations_;
+            blocks_.push_back(::operator new(block_size_));
+        }
+    }
+
+    size_t block_size_;
+    std::vector<void *> blocks_;  // Kept across rewind() and reused in order
+    size_t block_index_;          // Block currently being carved up
+    size_t offset_;               // Bytes of that block already handed out
+    free_node *free_lists_[kMaxClassSize / kGranularity];
+    uint64_t allocations_;
+    uint64_t system_allocations_;
+};
+
+// Standard allocator that draws from an arena, for use with the std containers
+template <typename T>
+class arena_allocator {
+   public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    explicit arena_allocator(arena *pool) : pool_(pool) {}
+    template <typename U>
+    arena_allocator(const arena_allocator<U> &other) : pool_(other.pool_) {}
+
+    T *allocate(size_t n) {
+        static_assert(alignof(T) <= arena::kGranularity, "arena_allocator does not support over-aligned types");
+        return static_cast<T *>(pool_->allocate(n * sizeof(T)));
+    }
+    void deallocate(T *p, size_t n) { pool_->deallocate(p, n * sizeof(T)); }
+
+    template <typename U>
+    bool operator==(const arena_allocator<U> &other) const {
+        return pool_ == other.pool_;
+    }
+    template <typename U>
+    bool operator!=(const arena_allocator<U> &other) const {
+        return pool_ != other.pool_;
+    }
+
+   private:
+    template <typename U>
+    friend class arena_allocator;
+    arena *pool_;
+};
+
+#endif  // VK_LAYER_ARENA_H
@@ -0,0 +1,337 @@
+/* Copyright (c) 2015-2017 The Khronos Group Inc.
+ * Copyright (c) 2015-2017 Valve Corporation
+ * Copyright (c) 2015-2017 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VK_LAYER_BINARY_LOG_H
+#define VK_LAYER_BINARY_LOG_H
+
+#include <chrono>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "vulkan/vulkan.h"
+
+// Writes validation messages as compact binary records instead of text; scripts/vk_binary_log_decoder.py turns a file back
+// into the text log_callback would have written.
+//
+// A message is stored as its printf format string and the raw arguments, so nothing is formatted while the application runs.
+// Format strings, layer prefixes and string arguments are written once, as string records, and referred to by id afterwards,
+// which is where most of the saving comes from: most of the text of a message is its format and the valid usage text passed
+// for %s. A string argument is interned by address, and checked against the text stored for that address, so reused buffers
+// are still written correctly.
+//
+// The file is in host byte order and every record is a multiple of 8 bytes, so it can be mapped and walked in place:
+//
+//   file_header
+//   record*        record_header, then for kStringRecord: uint32 id, uint32 length, the bytes
+//                                      for kMessageRecord: message_record, then arg_count args
+//   arg            uint32 kind, uint32 aux, uint64 value; kInlineString is followed by aux bytes, padded to 8
+//
+// Thread safe; records are serialized on an internal mutex. Layers logging to the same file share one writer, so its records
+// can come from several layers.
+class binary_log_writer {
+   public:
+    static const uint32_t kVersion = 1;
+    static const uint32_t kByteOrderMark = 0x01020304;
+
+    struct file_header {
+        char magic[8];  // "VKBINLOG"
+        uint32_t version;
+        uint32_t byte_order_mark;
+        uint64_t start_steady_ns;  // Message times count from here
+        uint64_t start_unix_ns;    // Wall clock time at the same moment
+    };
+    enum record_type : uint32_t { kStringRecord = 1, kMessageRecord = 2 };
+    struct record_header {
+        uint32_t size;  // Including this header and padding
+        uint32_t type;
+    };
+    struct message_record {
+        uint64_t time_ns;
+        uint32_t thread;  // Small number per thread, in order of first message to this file
+        uint32_t msgFlags;
+        int32_t msgCode;
+        int32_t objectType;
+        uint64_t srcObject;
+        uint64_t location;
+        uint32_t prefix_id;
+        uint32_t format_id;
+        uint32_t arg_count;
+        uint32_t reserved;
+    };
+    enum arg_kind : uint32_t { kSigned = 1, kUnsigned = 2, kDouble = 3, kPointer = 4, kString = 5, kInlineString = 6, kNull = 7 };
+
+    explicit binary_log_writer(const char *filename) : file_(fopen(filename, "wb")), next_string_id_(1) {
+        if (!file_) return;
+        setvbuf(file_, nullptr, _IOFBF, 1 << 20);
+        file_header header = {};
+        memcpy(header.magic, "VKBINLOG", sizeof(header.magic));
+        header.version = kVersion;
+        header.byte_order_mark = kByteOrderMark;
+        header.start_steady_ns = start_ = steady_ns();
+        header.start_unix_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   std::chrono::system_clock::now().time_since_epoch())
+                                   .count();
+        fwrite(&header, sizeof(header), 1, file_);
+    }
+    ~binary_log_writer() {
+        if (file_) fclose(file_);
+    }
+    binary_log_writer(const binary_log_writer &) = delete;
+    binary_log_writer &operator=(const binary_log_writer &) = delete;
+
+    bool is_open() const { return file_ != nullptr; }
+
+    void write(VkFlags msgFlags, VkDebugReportObjectTypeEXT objectType, uint64_t srcObject, size_t location, int32_t msgCode,
+               const char *pLayerPrefix, const char *format, va_list args) {
+        const uint64_t time = steady_ns();
+        std::lock_guard<std::mutex> guard(mutex_);
+        const uint32_t thread = thread_number();
+        message_.clear();
+        message_record message = {};
+        message.time_ns = time - start_;
+        message.thread = thread;
+        message.msgFlags = msgFlags;
+        message.msgCode = msgCode;
+        message.objectType = objectType;
+        message.srcObject = srcObject;
+        message.location = location;
+        message.prefix_id = intern(pLayerPrefix);
+        message.format_id = intern(format);
+        va_list copy;
+        va_copy(copy, args);
+        message.arg_count = encode_args(format, copy);
+        va_end(copy);
+        emit(kMessageRecord, &message, sizeof(message), message_.data(), message_.size());
+    }
+
+    // A message that only exists as text, e.g. one formatted earlier on another thread
+    void write_text(VkFlags msgFlags, VkDebugReportObjectTypeEXT objectType, uint64_t srcObject, size_t location,
+                    int32_t msgCode, const char *pLayerPrefix, const char *pMsg) {
+        write_text_args(msgFlags, objectType, srcObject, location, msgCode, pLayerPrefix, "%s", pMsg);
+    }
+
+    void flush() {
+        std::lock_guard<std::mutex> guard(mutex_);
+        fflush(file_);
+    }
+
+   private:
+    void write_text_args(VkFlags msgFlags, VkDebugReportObjectTypeEXT objectType, uint64_t srcObject, size_t location,
+                         int32_t msgCode, const char *pLayerPrefix, const char *format, ...) {
+        va_list args;
+        va_start(args, format);
+        write(msgFlags, objectType, srcObject, location, msgCode, pLayerPrefix, format, args);
+        va_end(args);
+    }
+
+    static uint64_t steady_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    // Numbered per writer rather than per library, since each layer library would count threads on its own
+    uint32_t thread_number() {
+        auto &thread = threads_[std::this_thread::get_id()];
+        if (!thread) thread = static_cast<uint32_t>(threads_.size());
+        return thread;
+    }
+
+    void emit(uint32_t type, const void *fixed, size_t fixed_size, const void *rest, size_t rest_size) {
+        static const char padding[8] = {};
+        const size_t unpadded = sizeof(record_header) + fixed_size + rest_size;
+        const size_t size = (unpadded + 7) & ~size_t(7);
+        record_header header = {static_cast<uint32_t>(size), type};
+        fwrite(&header, sizeof(header), 1, file_);
+        fwrite(fixed, fixed_size, 1, file_);
+        if (rest_size) fwrite(rest, rest_size, 1, file_);
+        if (size != unpadded) fwrite(padding, size - unpadded, 1, file_);
+    }
+
+    // Id of a string record holding text, writing the record if the text at this address has not been seen before
+    uint32_t intern(const char *text) {
+        auto &entry = strings_[text];
+        if (entry.id && entry.text == text) return entry.id;
+        entry.id = next_string_id_++;
+        entry.text = text;
+        const uint32_t fixed[2] = {entry.id, static_cast<uint32_t>(entry.text.size())};
+        emit(kStringRecord, fixed, sizeof(fixed), entry.text.data(), entry.text.size());
+        return entry.id;
+    }
+
+    void add_arg(uint32_t kind, uint32_t aux, uint64_t value) {
+        const uint32_t words[2] = {kind, aux};
+        append(words, sizeof(words));
+        append(&value, sizeof(value));
+    }
+    void append(const void *data, size_t size) {
+        auto bytes = static_cast<const uint8_t *>(data);
+        message_.insert(message_.end(), bytes, bytes + size);
+    }
+
+    void add_string(const char *text) {
+        if (!text) return add_arg(kNull, 0, 0);
+        // Interning every string would keep one copy of each generated message in memory, so only keep the first few
+        // thousand addresses; anything else goes in the record itself
+        if (strings_.size() < kMaxInternedStrings || strings_.count(text)) return add_arg(kString, intern(text), 0);
+        const size_t length = strlen(text);
+        add_arg(kInlineString, static_cast<uint32_t>(length), 0);
+        append(text, length);
+        message_.resize((message_.size() + 7) & ~size_t(7));
+    }
+
+    enum length_modifier { kInt, kLong, kLongLong, kSize, kIntMax, kPtrDiff, kLongDouble };
+
+    static int64_t signed_arg(length_modifier length, va_list &args) {
+        switch (length) {
+            case kLong:
+                return va_arg(args, long);
+            case kLongLong:
+                return va_arg(args, long long);
+            case kSize:
+                return static_cast<int64_t>(va_arg(args, size_t));
+            case kIntMax:
+                return va_arg(args, intmax_t);
+            case kPtrDiff:
+                return va_arg(args, ptrdiff_t);
+            default:
+                return va_arg(args, int);
+        }
+    }
+
+    static uint64_t unsigned_arg(length_modifier length, va_list &args) {
+        switch (length) {
+            case kLong:
+                return va_arg(args, unsigned long);
+            case kLongLong:
+                return va_arg(args, unsigned long long);
+            case kSize:
+                return va_arg(args, size_t);
+            case kIntMax:
+                return va_arg(args, uintmax_t);
+            case kPtrDiff:
+                return static_cast<uint64_t>(va_arg(args, ptrdiff_t));
+            default:
+                return va_arg(args, unsigned);
+        }
+    }
+
+    // Pull the arguments format asks for off args, the way printf would. Returns how many were added.
+    uint32_t encode_args(const char *format, va_list &args) {
+        uint32_t count = 0;
+        for (const char *c = format; *c; ++c) {
+            if (*c != '%') continue;
+            ++c;
+            if (*c == '%') continue;
+            while (*c && strchr("-+ #0'", *c)) ++c;
+            if (*c == '*') {
+                add_arg(kSigned, 0, static_cast<uint64_t>(static_cast<int64_t>(va_arg(args, int)))), ++count, ++c;
+            }
+            while (*c >= '0' && *c <= '9') ++c;
+            if (*c == '.') {
+                ++c;
+                if (*c == '*') {
+                    add_arg(kSigned, 0, static_cast<uint64_t>(static_cast<int64_t>(va_arg(args, int)))), ++count, ++c;
+                }
+                while (*c >= '0' && *c <= '9') ++c;
+            }
+            length_modifier length = kInt;
+            if (c[0] == 'h') {
+                c += (c[1] == 'h') ? 2 : 1;
+            } else if (c[0] == 'l') {
+                length = (c[1] == 'l') ? kLongLong : kLong;
+                c += (c[1] == 'l') ? 2 : 1;
+            } else if (c[0] == 'z') {
+                length = kSize, ++c;
+            } else if (c[0] == 'j') {
+                length = kIntMax, ++c;
+            } else if (c[0] == 't') {
+                length = kPtrDiff, ++c;
+            } else if (c[0] == 'L') {
+                length = kLongDouble, ++c;
+            } else if (c[0] == 'I' && c[1] == '6' && c[2] == '4') {
+                length = kLongLong, c += 3;
+            } else if (c[0] == 'I' && c[1] == '3' && c[2] == '2') {
+                c += 3;
+            } else if (c[0] == 'I') {
+                length = kSize, ++c;
+            }
+            if (!*c) break;
+            switch (*c) {
+                case 'd':
+                case 'i':
+                    add_arg(kSigned, 0, static_cast<uint64_t>(signed_arg(length, args)));
+                    break;
+                case 'u':
+                case 'x':
+                case 'X':
+                case 'o':
+                case 'c':
+                    add_arg(kUnsigned, 0, unsigned_arg(length, args));
+                    break;
+                case 'e':
+                case 'E':
+                case 'f':
+                case 'F':
+                case 'g':
+                case 'G':
+                case 'a':
+                case 'A': {
+                    double value = length == kLongDouble ? static_cast<double>(va_arg(args, long double)) : va_arg(args, double);
+                    uint64_t bits;
+                    memcpy(&bits, &value, sizeof(bits));
+                    add_arg(kDouble, 0, bits);
+                    break;
+                }
+                case 'p':
+                    add_arg(kPointer, 0, reinterpret_cast<uintptr_t>(va_arg(args, void *)));
+                    break;
+                case 's':
+                    add_string(va_arg(args, const char *));
+                    break;
+                default:
+                    // %n or something this does not understand; the decoder shows the conversion as it is
+                    continue;
+            }
+            ++count;
+        }
+        return count;
+    }
+
+    static const size_t kMaxInternedStrings = 4096;
+
+    struct interned {
+        uint32_t id = 0;
+        std::string text;
+    };
+
+    FILE *file_;
+    uint64_t start_;
+    std::mutex mutex_;  // Guards everything below and writes to file_
+    std::unordered_map<const char *, interned> strings_;  // By address; formats, prefixes and %s arguments
+    uint32_t next_string_id_;
+    std::unordered_map<std::thread::id, uint32_t> threads_;  // Number written for each thread
+    std::vector<uint8_t> message_;  // Arguments of the message being written
+};
+
+#endif  // VK_LAYER_BINARY_LOG_H
@@ -0,0 +1,247 @@
+/* Copyright (c) 2015-2017 The Khronos Group Inc.
+ * Copyright (c) 2015-2017 Valve Corporation
+ * Copyright (c) 2015-2017 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VK_LAYER_HANDLE_MAP_H
+#define VK_LAYER_HANDLE_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Map from a Vulkan handle to layer state, used in place of std::unordered_map for the per-device object maps.
+//
+// Lookups probe a flat, open-addressed array of {handle, entry pointer} slots, so a find() touches one or two
+// contiguous cache lines instead of walking a bucket list. Entries are allocated individually and never move,
+// so pointers and references to mapped values stay valid until that entry is erased, as with unordered_map.
+//
+// Concurrency: const member functions (find, count, begin/end, size) never modify the map and take no lock, so
+// any number of threads may read concurrently. Anything that inserts or erases must be externally serialized
+// against all readers; core_validation does this by holding global_lock exclusively.
+//
+// The interface is the subset of std::unordered_map the layers use. Erased slots are left as tombstones until
+// the next rehash so that erase(iterator) during iteration never moves entries that have not been visited yet.
+template <typename Key, typename T>
+class handle_map {
+   public:
+    typedef Key key_type;
+    typedef T mapped_type;
+    typedef std::pair<const Key, T> value_type;
+    typedef size_t size_type;
+
+   private:
+    struct slot {
+        uint64_t key;
+        value_type *entry;
+    };
+
+    template <typename V, typename S>
+    class iterator_base {
+       public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef V value_type;
+        typedef ptrdiff_t difference_type;
+        typedef V *pointer;
+        typedef V &reference;
+
+        iterator_base() : slot_(nullptr), end_(nullptr) {}
+        iterator_base(S *slot, S *end) : slot_(slot), end_(end) { skip_empty(); }
+        // Allow iterator -> const_iterator conversion
+        template <typename V2, typename S2>
+        iterator_base(const iterator_base<V2, S2> &other) : slot_(other.slot_), end_(other.end_) {}
+
+        reference operator*() const { return *slot_->entry; }
+        pointer operator->() const { return slot_->entry; }
+        iterator_base &operator++() {
+            ++slot_;
+            skip_empty();
+            return *this;
+        }
+        iterator_base operator++(int) {
+            iterator_base prev = *this;
+            ++*this;
+            return prev;
+        }
+        template <typename V2, typename S2>
+        bool operator==(const iterator_base<V2, S2> &other) const {
+            return slot_ == other.slot_;
+        }
+        template <typename V2, typename S2>
+        bool operator!=(const iterator_base<V2, S2> &other) const {
+            return slot_ != other.slot_;
+        }
+
+       private:
+        friend class handle_map;
+        template <typename V2, typename S2>
+        friend class iterator_base;
+
+        void skip_empty() {
+            while (slot_ != end_ && !occupied(*slot_)) ++slot_;
+        }
+        S *slot_;
+        S *end_;
+    };
+
+   public:
+    typedef iterator_base<value_type, slot> iterator;
+    typedef iterator_base<const value_type, const slot> const_iterator;
+
+    handle_map() : size_(0), tombstones_(0) {}
+    ~handle_map() { clear(); }
+    handle_map(const handle_map &) = delete;
+    handle_map &operator=(const handle_map &) = delete;
+
+    iterator begin() { return iterator(slots_.data(), slots_.data() + slots_.size()); }
+    iterator end() { return iterator(slots_.data() + slots_.size(), slots_.data() + slots_.size()); }
+    const_iterator begin() const { return const_iterator(slots_.data(), slots_.data() + slots_.size()); }
+    const_iterator end() const { return const_iterator(slots_.data() + slots_.size(), slots_.data() + slots_.size()); }
+
+    size_type size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    iterator find(const Key &key) {
+        size_t index = lookup(key_bits(key));
+        if (index == npos) return end();
+        return iterator(&slots_[index], slots_.data() + slots_.size());
+    }
+    const_iterator find(const Key &key) const {
+        size_t index = lookup(key_bits(key));
+        if (index == npos) return end();
+        return const_iterator(&slots_[index], slots_.data() + slots_.size());
+    }
+    size_type count(const Key &key) const { return lookup(key_bits(key)) == npos ? 0 : 1; }
+
+    T &operator[](const Key &key) {
+        size_t index = lookup(key_bits(key));
+        if (index != npos) return slots_[index].entry->second;
+        return place(new value_type(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple()))->second;
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args &&... args) {
+        value_type *entry = new value_type(std::forward<Args>(args)...);
+        size_t index = lookup(key_bits(entry->first));
+        if (index != npos) {
+            delete entry;
+            return std::make_pair(iterator(&slots_[index], slots_.data() + slots_.size()), false);
+        }
+        place(entry);
+        return std::make_pair(find(entry->first), true);
+    }
+    template <typename P>
+    std::pair<iterator, bool> insert(P &&value) {
+        return emplace(std::forward<P>(value));
+    }
+
+    size_type erase(const Key &key) {
+        size_t index = lookup(key_bits(key));
+        if (index == npos) return 0;
+        release(slots_[index]);
+        return 1;
+    }
+    iterator erase(const_iterator pos) {
+        slot *target = const_cast<slot *>(pos.slot_);
+        release(*target);
+        return iterator(target + 1, slots_.data() + slots_.size());
+    }
+
+    void clear() {
+        for (auto &s : slots_) {
+            if (occupied(s)) delete s.entry;
+        }
+        slots_.clear();
+        size_ = 0;
+        tombstones_ = 0;
+    }
+
+   private:
+    static const size_t npos = static_cast<size_t>(-1);
+    static const size_t kMinCapacity = 16;
+
+    template <typename H>
+    static uint64_t key_bits(H *key) {
+        return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(key));
+    }
+    static uint64_t key_bits(uint64_t key) { return key; }
+
+    // Handles are frequently aligned pointers, so spread the high bits over the index with a multiplicative hash
+    size_t home(uint64_t bits) const { return static_cast<size_t>((bits * 0x9E3779B97F4A7C15ULL) >> 32) & (slots_.size() - 1); }
+
+    static value_type *tombstone() {
+        static char marker;
+        return reinterpret_cast<value_type *>(&marker);
+    }
+    static bool occupied(const slot &s) { return s.entry != nullptr && s.entry != tombstone(); }
+
+    size_t lookup(uint64_t bits) const {
+        if (slots_.empty()) return npos;
+        const size_t mask = slots_.size() - 1;
+        for (size_t index = home(bits);; index = (index + 1) & mask) {
+            const slot &s = slots_[index];
+            if (s.entry == nullptr) return npos;
+            if (s.entry != tombstone() && s.key == bits) return index;
+        }
+    }
+
+    // Caller has verified the key is not present
+    value_type *place(value_type *entry) {
+        if ((size_ + tombstones_ + 1) * 4 > slots_.size() * 3) rehash();
+        const uint64_t bits = key_bits(entry->first);
+        const size_t mask = slots_.size() - 1;
+        size_t index = home(bits);
+        while (occupied(slots_[index])) index = (index + 1) & mask;
+        if (slots_[index].entry == tombstone()) --tombstones_;
+        slots_[index].key = bits;
+        slots_[index].entry = entry;
+        ++size_;
+        return entry;
+    }
+
+    void release(slot &s) {
+        delete s.entry;
+        s.entry = tombstone();
+        --size_;
+        ++tombstones_;
+    }
+
+    void rehash() {
+        size_t capacity = kMinCapacity;
+        if (!slots_.empty()) capacity = slots_.size();
+        while ((size_ + 1) * 2 > capacity) capacity *= 2;
+        std::vector<slot> old_slots(capacity, slot{0, nullptr});
+        old_slots.swap(slots_);
+        size_ = 0;
+        tombstones_ = 0;
+        const size_t mask = slots_.size() - 1;
+        for (auto &s : old_slots) {
+            if (!occupied(s)) continue;
+            size_t index = home(s.key);
+            while (slots_[index].entry != nullptr) index = (index + 1) & mask;
+            slots_[index] = s;
+            ++size_;
+        }
+    }
+
+    std::vector<slot> slots_;
+    size_t size_;
+    size_t tombstones_;
+};
+
+#endif  // VK_LAYER_HANDLE_MAP_H
@@ -0,0 +1,184 @@
+/* Copyright (c) 2015-2017 The Khronos Group Inc.
+ * Copyright (c) 2015-2017 Valve Corporation
+ * Copyright (c) 2015-2017 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VK_LAYER_INTERVAL_TREE_H
+#define VK_LAYER_INTERVAL_TREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+// Set of closed intervals [low, high], each carrying a value, that may overlap one another.
+//
+// Intervals are kept in a randomized balanced search tree (a treap) whose key is low, with ties broken by value; high is
+// not part of the key. Every node also records the largest high in its subtree. That lets for_each_overlap() skip any
+// subtree that ends before the query starts, so insert, erase and an overlap query each cost O(log N), plus O(K) for the
+// K intervals reported.
+//
+// The (low, value) pair identifies an interval for erase(), so values must be unique among intervals with the same low.
+// Values are compared with std::less, so pointers, as the memory tracker stores, order by address.
+template <typename Index, typename T>
+class interval_tree {
+   public:
+    interval_tree() : root_(nullptr), size_(0), seed_(0x9E3779B9u) {}
+    ~interval_tree() { destroy(root_); }
+    interval_tree(const interval_tree &) = delete;
+    interval_tree &operator=(const interval_tree &) = delete;
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    void insert(Index low, Index high, const T &value) {
+        node *fresh = new node{low, high, high, value, next_priority(), nullptr, nullptr};
+        root_ = insert(root_, fresh);
+        ++size_;
+    }
+
+    // Remove the interval starting at low with the given value. Returns false if there is none.
+    bool erase(Index low, const T &value) {
+        bool found = false;
+        root_ = erase(root_, low, value, &found);
+        if (found) --size_;
+        return found;
+    }
+
+    void clear() {
+        destroy(root_);
+        root_ = nullptr;
+        size_ = 0;
+    }
+
+    // Call f(low, high, value) for every interval that overlaps [low, high], in increasing order of low
+    template <typename F>
+    void for_each_overlap(Index low, Index high, F f) const {
+        overlap(root_, low, high, f);
+    }
+
+   private:
+    struct node {
+        Index low;
+        Index high;
+        Index max_high;  // Largest high in the subtree rooted here
+        T value;
+        uint32_t priority;
+        node *left;
+        node *right;
+    };
+
+    static bool less(Index low_a, const T &value_a, Index low_b, const T &value_b) {
+        return low_a < low_b || (!(low_b < low_a) && std::less<T>()(value_a, value_b));
+    }
+
+    static void update(node *n) {
+        n->max_high = n->high;
+        if (n->left && n->max_high < n->left->max_high) n->max_high = n->left->max_high;
+        if (n->right && n->max_high < n->right->max_high) n->max_high = n->right->max_high;
+    }
+
+    static node *rotate_right(node *n) {
+        node *pivot = n->left;
+        n->left = pivot->right;
+        pivot->right = n;
+        update(n);
+        update(pivot);
+        return pivot;
+    }
+
+    static node *rotate_left(node *n) {
+        node *pivot = n->right;
+        n->right = pivot->left;
+        pivot->left = n;
+        update(n);
+        update(pivot);
+        return pivot;
+    }
+
+    static node *insert(node *n, node *fresh) {
+        if (!n) return fresh;
+        if (less(fresh->low, fresh->value, n->low, n->value)) {
+            n->left = insert(n->left, fresh);
+            if (n->left->priority > n->priority) return rotate_right(n);
+        } else {
+            n->right = insert(n->right, fresh);
+            if (n->right->priority > n->priority) return rotate_left(n);
+        }
+        update(n);
+        return n;
+    }
+
+    // Join two treaps where every interval in a orders before every interval in b
+    static node *merge(node *a, node *b) {
+        if (!a) return b;
+        if (!b) return a;
+        if (a->priority > b->priority) {
+            a->right = merge(a->right, b);
+            update(a);
+            return a;
+        }
+        b->left = merge(a, b->left);
+        update(b);
+        return b;
+    }
+
+    static node *erase(node *n, Index low, const T &value, bool *found) {
+        if (!n) return nullptr;
+        if (less(low, value, n->low, n->value)) {
+            n->left = erase(n->left, low, value, found);
+        } else if (less(n->low, n->value, low, value)) {
+            n->right = erase(n->right, low, value, found);
+        } else {
+            *found = true;
+            node *joined = merge(n->left, n->right);
+            delete n;
+            return joined;
+        }
+        update(n);
+        return n;
+    }
+
+    template <typename F>
+    static void overlap(const node *n, Index low, Index high, F &f) {
+        // Nothing in this subtree reaches low
+        if (!n || n->max_high < low) return;
+        overlap(n->left, low, high, f);
+        // This node and everything to its right start after high
+        if (high < n->low) return;
+        if (!(n->high < low)) f(n->low, n->high, n->value);
+        overlap(n->right, low, high, f);
+    }
+
+    static void destroy(node *n) {
+        if (!n) return;
+        destroy(n->left);
+        destroy(n->right);
+        delete n;
+    }
+
+    // xorshift32, only needs to be well spread to keep the tree balanced in expectation
+    uint32_t next_priority() {
+        seed_ ^= seed_ << 13;
+        seed_ ^= seed_ >> 17;
+        seed_ ^= seed_ << 5;
+        return seed_;
+    }
+
+    node *root_;
+    size_t size_;
+    uint32_t seed_;
+};
+
+#endif  // VK_LAYER_INTERVAL_TREE_H
@@ -0,0 +1,246 @@
+/* Copyright (c) 2015-2017 The Khronos Group Inc.
+ * Copyright (c) 2015-2017 Valve Corporation
+ * Copyright (c) 2015-2017 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VK_LAYER_LOG_SINK_H
+#define VK_LAYER_LOG_SINK_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include "vulkan/vulkan.h"
+
+// One message as handed to a debug report callback. The strings point into the record that holds it.
+struct log_record {
+    VkFlags msgFlags;
+    VkDebugReportObjectTypeEXT objectType;
+    uint64_t srcObject;
+    size_t location;
+    int32_t msgCode;
+    const char *layer_prefix;
+    const char *msg;
+};
+
+// Writes messages to a FILE on a background thread, so that threads which log, often while holding a layer's lock, only copy
+// the message into memory instead of waiting on the file.
+//
+// Messages go into a fixed ring of records that any number of threads fill without taking a lock: a producer claims a record
+// by advancing the write position with a compare and swap, copies the message fields and text in and then publishes the
+// record through its sequence number. The single drain thread formats and writes records in the order they were claimed,
+// flushing the file after each one so that a crash handler knows exactly which records are not in the file yet. Text that
+// does not fit a record is copied to the heap. When the ring is full producers yield until the drain thread frees a record,
+// so no message is lost. The drain thread sleeps while the ring is empty; a producer that finds it asleep wakes it.
+//
+// flush() returns once everything logged before it was called is in the file. stop() ends the thread, makes later messages
+// go straight to the file and drains what is left. A producer that claimed a record around then and finds the sink stopped
+// once it has published it drains the ring itself, so no message is stranded in it.
+class async_log_sink {
+   public:
+    typedef void (*line_writer)(FILE *file, const log_record &record);
+
+    static const size_t kCapacity = 1024;  // Records; a power of two
+    static const size_t kTextSize = 448;   // Bytes of prefix and message kept inside a record
+
+    async_log_sink(FILE *file, line_writer write) : file_(file), write_(write), enqueue_pos_(0), dequeue_pos_(0), written_(0) {
+#ifndef WIN32
+        fd_ = fileno(file);
+#endif
+        stopped_.store(false);
+        sleeping_.store(false);
+        for (size_t i = 0; i < kCapacity; ++i) ring_[i].sequence.store(i, std::memory_order_relaxed);
+        stop_ = false;
+        worker_ = std::thread([this] { run(); });
+    }
+    ~async_log_sink() { stop(); }
+    async_log_sink(const async_log_sink &) = delete;
+    async_log_sink &operator=(const async_log_sink &) = delete;
+
+    FILE *file() const { return file_; }
+
+    void push(const log_record &message) {
+        if (stopped_.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> guard(mutex_);
+            write_(file_, message);
+            fflush(file_);
+            return;
+        }
+
+        uint64_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        slot *record;
+        while (true) {
+            record = &ring_[pos & (kCapacity - 1)];
+            const uint64_t sequence = record->sequence.load(std::memory_order_acquire);
+            if (sequence == pos) {
+                // Sequentially consistent, like stopped_, so that either stop() sees this claim or this producer sees stopped_
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1)) break;
+            } else if (sequence < pos) {
+                // Full; wait for the drain thread to write the oldest record out
+                std::this_thread::yield();
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        record->fill(message);
+        // Sequentially consistent, like sleeping_, so that either the drain thread sees this record before it goes to sleep or
+        // this producer sees it asleep
+        record->sequence.store(pos + 1);
+        if (sleeping_.load()) {
+            std::lock_guard<std::mutex> guard(mutex_);
+            wake_.notify_one();
+        }
+
+        if (stopped_.load()) {
+            std::lock_guard<std::mutex> guard(mutex_);
+            drain();
+        }
+    }
+
+    void flush() {
+        const uint64_t target = enqueue_pos_.load(std::memory_order_acquire);
+        std::unique_lock<std::mutex> guard(mutex_);
+        if (stop_) return;
+        wake_.notify_one();
+        written_cv_.wait(guard, [this, target] { return written_ >= target || stop_; });
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            if (stop_) return;
+            stop_ = true;
+        }
+        wake_.notify_one();
+        worker_.join();
+        // Only now, so that no producer drains the ring while the drain thread still does
+        stopped_.store(true);
+        std::lock_guard<std::mutex> guard(mutex_);
+        drain();
+    }
+
+#ifndef WIN32
+    typedef void (*crash_line_writer)(int fd, const log_record &record);
+
+    // For a crash handler: write each published record that is not in the file yet through write, which must only make
+    // async-signal-safe calls. Takes no lock and does not touch file's stdio buffer. Only the line the drain thread was writing
+    // when the signal arrived can end up in the file twice.
+    void write_pending_on_crash(crash_line_writer write) const {
+        for (uint64_t pos = dequeue_pos_.load(std::memory_order_acquire);; ++pos) {
+            const slot &record = ring_[pos & (kCapacity - 1)];
+            if (record.sequence.load(std::memory_order_acquire) != pos + 1) break;
+            write(fd_, record.view());
+        }
+    }
+#endif
+
+   private:
+    struct slot {
+        std::atomic<uint64_t> sequence;  // Position it will be filled for, or that position + 1 once published
+        log_record fields;
+        char *heap_text;
+        char text[kTextSize];
+
+        void fill(const log_record &message) {
+            fields = message;
+            const size_t prefix_length = strlen(message.layer_prefix) + 1;
+            const size_t msg_length = strlen(message.msg) + 1;
+            char *buffer = text;
+            heap_text = nullptr;
+            if (prefix_length + msg_length > kTextSize) {
+                heap_text = static_cast<char *>(malloc(prefix_length + msg_length));
+                if (heap_text) {
+                    buffer = heap_text;
+                } else {
+                    fields.msg = "Allocation failure";
+                    return fill(fields);
+                }
+            }
+            memcpy(buffer, message.layer_prefix, prefix_length);
+            memcpy(buffer + prefix_length, message.msg, msg_length);
+            fields.layer_prefix = buffer;
+            fields.msg = buffer + prefix_length;
+        }
+        const log_record &view() const { return fields; }
+    };
+
+    bool published(uint64_t pos) const { return ring_[pos & (kCapacity - 1)].sequence.load() == pos + 1; }
+
+    // Write the oldest record out to the file if it has been published
+    bool write_next() {
+        const uint64_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        slot &record = ring_[pos & (kCapacity - 1)];
+        if (record.sequence.load(std::memory_order_acquire) != pos + 1) return false;
+        write_(file_, record.view());
+        fflush(file_);
+        dequeue_pos_.store(pos + 1, std::memory_order_release);
+        free(record.heap_text);
+        record.sequence.store(pos + kCapacity, std::memory_order_release);
+        return true;
+    }
+
+    // Write everything claimed so far, waiting for records that are claimed but not yet published. Only called with mutex_
+    // held once the drain thread has ended.
+    void drain() {
+        while (enqueue_pos_.load() != dequeue_pos_.load(std::memory_order_relaxed)) {
+            if (!write_next()) std::this_thread::yield();
+        }
+    }
+
+    void run() {
+        while (true) {
+            bool wrote = false;
+            while (write_next()) wrote = true;
+
+            std::unique_lock<std::mutex> guard(mutex_);
+            if (wrote) {
+                written_ = dequeue_pos_.load(std::memory_order_relaxed);
+                written_cv_.notify_all();
+            }
+            if (stop_) return;
+            if (wrote) continue;
+            // A producer that publishes after this store sees it and wakes the thread, which holds mutex_ until it waits
+            sleeping_.store(true);
+            if (!published(dequeue_pos_.load(std::memory_order_relaxed))) wake_.wait(guard);
+            sleeping_.store(false);
+        }
+    }
+
+    FILE *file_;
+#ifndef WIN32
+    int fd_;  // Of file_, for the crash handler
+#endif
+    line_writer write_;
+    slot ring_[kCapacity];
+    std::atomic<uint64_t> enqueue_pos_;  // Next position a producer will claim
+    std::atomic<uint64_t> dequeue_pos_;  // Next position to write, all before it are in the file; only the drain thread
+                                         // advances it until stopped_
+    std::atomic<bool> stopped_;
+    std::atomic<bool> sleeping_;  // The drain thread is waiting on wake_, or about to
+    std::mutex mutex_;  // Guards everything below, and direct writes once stopped
+    std::condition_variable wake_;
+    std::condition_variable written_cv_;
+    uint64_t written_;  // Positions before this are in the file
+    bool stop_;
+    std::thread worker_;
+};
+
+#endif  // VK_LAYER_LOG_SINK_H
@@ -23,23 +23,211 @@
 #define LAYER_LOGGING_H
 
 #include "vk_loader_layer.h"
+#include "vk_layer_binary_log.h"
 #include "vk_layer_config.h"
 #include "vk_layer_data.h"
 #include "vk_layer_table.h"
 #include "vk_loader_platform.h"
 #include "vulkan/vk_layer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cinttypes>
+#include <mutex>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
+// Holds back repeats of a message so that a bug which fires on every draw does not bury the application in callbacks.
+//
+// With a duplicate limit, each message ID is reported at most that many times for any one object. With a rate limit, each
+// message ID is reported at most that many times per second across all objects. Whatever is held back is counted, and once a
+// second the counts go out as one summary message per message ID; see take_summaries().
+//
+// admit() runs before the message text is formatted, so a held back message costs a hash lookup or two and nothing else.
+// The per-object counts and the per-message ID state are split into shards by key, each with its own mutex, so threads
+// logging about different objects or message IDs do not wait on each other. Only kMaxObjectsPerShard objects are counted
+// per shard; when a shard fills up its counts start afresh, which lets a few repeats through rather than growing forever.
+// admit() is told what the callbacks returned the last time that message ID was reported and hands that back for held back
+// messages, so an application whose callback asks for failing calls to be skipped keeps skipping them.
+//
+// Thread safe.
+class log_msg_filter {
+   public:
+    struct summary {
+        VkFlags msgFlags;
+        int32_t msgCode;
+        std::string layer_prefix;
+        uint64_t suppressed;
+    };
+
+    log_msg_filter(uint32_t duplicate_limit, uint32_t rate_limit)
+        : duplicate_limit_(duplicate_limit), rate_limit_(rate_limit), suppressed_(0), last_summary_(now()) {}
+
+    // Whether a message should be reported. If not, *skip is set to what the callbacks last returned for its message ID.
+    // Summaries that have come due are appended to due either way, for the caller to report once the lock is released.
+    bool admit(VkFlags msgFlags, int32_t msgCode, uint64_t srcObject, const char *pLayerPrefix, bool *skip,
+               std::vector<summary> *due) {
+        const uint64_t time = now();
+        uint64_t last_summary = last_summary_.load(std::memory_order_relaxed);
+        // Whichever thread moves last_summary_ on writes the summaries
+        if (suppressed_.load(std::memory_order_relaxed) && time - last_summary >= kSummaryInterval &&
+            last_summary_.compare_exchange_strong(last_summary, time, std::memory_order_relaxed)) {
+            collect_summaries(due);
+        }
+
+        const object_key key = {msgCode, srcObject};
+        if (duplicate_limit_) {
+            // Counted now rather than once the rate limit has passed it, so that threads racing on one object can't all
+            // get under the limit; given back below if the rate limit holds the message back after all
+            auto &shard = shard_for_object(key);
+            std::lock_guard<std::mutex> guard(shard.mutex);
+            auto it = shard.objects.find(key);
+            if (it == shard.objects.end()) {
+                if (shard.objects.size() >= kMaxObjectsPerShard) shard.objects.clear();
+                it = shard.objects.emplace(key, 0).first;
+            }
+            if (it->second >= duplicate_limit_) return suppress(msgFlags, msgCode, pLayerPrefix, skip);
+            ++it->second;
+        }
+        if (rate_limit_) {
+            bool limited;
+            {
+                auto &shard = shard_for_code(msgCode);
+                std::lock_guard<std::mutex> guard(shard.mutex);
+                auto &state = code(shard, msgCode, pLayerPrefix);
+                if (time - state.window_start >= kRateWindow) {
+                    state.window_start = time;
+                    state.in_window = 0;
+                }
+                limited = state.in_window >= rate_limit_;
+                if (!limited) ++state.in_window;
+            }
+            if (limited) {
+                if (duplicate_limit_) {
+                    auto &shard = shard_for_object(key);
+                    std::lock_guard<std::mutex> guard(shard.mutex);
+                    auto it = shard.objects.find(key);
+                    if (it != shard.objects.end() && it->second) --it->second;
+                }
+                return suppress(msgFlags, msgCode, pLayerPrefix, skip);
+            }
+        }
+        return true;
+    }
+
+    // What the callbacks returned for an admitted message
+    void reported(int32_t msgCode, const char *pLayerPrefix, bool skip) {
+        auto &shard = shard_for_code(msgCode);
+        std::lock_guard<std::mutex> guard(shard.mutex);
+        code(shard, msgCode, pLayerPrefix).skip = skip;
+    }
+
+    // Append a summary for every message ID with held back messages since the last summary, and start counting afresh
+    void take_summaries(std::vector<summary> *due) {
+        last_summary_.store(now(), std::memory_order_relaxed);
+        if (suppressed_.load(std::memory_order_relaxed)) collect_summaries(due);
+    }
+
+   private:
+    static const uint64_t kRateWindow = 1000000000;       // ns
+    static const uint64_t kSummaryInterval = 1000000000;  // ns
+    static const size_t kShards = 16;
+    static const size_t kMaxObjectsPerShard = 4096;
+
+    struct object_key {
+        int32_t msgCode;
+        uint64_t srcObject;
+        bool operator==(const object_key &other) const { return msgCode == other.msgCode && srcObject == other.srcObject; }
+    };
+    struct object_key_hash {
+        size_t operator()(const object_key &key) const {
+            return std::hash<uint64_t>()(key.srcObject * 0x9E3779B97F4A7C15ull ^ static_cast<uint32_t>(key.msgCode));
+        }
+    };
+    struct code_state {
+        std::string layer_prefix;
+        VkFlags msgFlags = 0;  // Of the most recent held back message
+        bool skip = false;
+        uint64_t window_start = 0;
+        uint32_t in_window = 0;
+        uint64_t suppressed = 0;  // Since the last summary
+    };
+    struct object_shard {
+        std::mutex mutex;                                                   // Guards objects
+        std::unordered_map<object_key, uint32_t, object_key_hash> objects;  // Times reported, by message ID and object
+    };
+    struct code_shard {
+        std::mutex mutex;  // Guards codes
+        std::unordered_map<int32_t, code_state> codes;
+    };
+
+    static uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    code_shard &shard_for_code(int32_t msgCode) { return code_shards_[static_cast<uint32_t>(msgCode) % kShards]; }
+    object_shard &shard_for_object(const object_key &key) { return object_shards_[object_key_hash()(key) % kShards]; }
+
+    // Only called with shard.mutex held
+    static code_state &code(code_shard &shard, int32_t msgCode, const char *pLayerPrefix) {
+        auto it = shard.codes.find(msgCode);
+        if (it != shard.codes.end()) return it->second;
+        auto &state = shard.codes[msgCode];
+        state.layer_prefix = pLayerPrefix;
+        return state;
+    }
+
+    bool suppress(VkFlags msgFlags, int32_t msgCode, const char *pLayerPrefix, bool *skip) {
+        auto &shard = shard_for_code(msgCode);
+        std::lock_guard<std::mutex> guard(shard.mutex);
+        auto &state = code(shard, msgCode, pLayerPrefix);
+        state.msgFlags = msgFlags;
+        ++state.suppressed;
+        suppressed_.fetch_add(1, std::memory_order_relaxed);
+        *skip = state.skip;
+        return false;
+    }
+
+    void collect_summaries(std::vector<summary> *due) {
+        const size_t first = due->size();
+        uint64_t collected = 0;
+        for (auto &shard : code_shards_) {
+            std::lock_guard<std::mutex> guard(shard.mutex);
+            for (auto &entry : shard.codes) {
+                auto &state = entry.second;
+                if (!state.suppressed) continue;
+                due->push_back({state.msgFlags, entry.first, state.layer_prefix, state.suppressed});
+                collected += state.suppressed;
+                state.suppressed = 0;
+            }
+        }
+        suppressed_.fetch_sub(collected, std::memory_order_relaxed);
+        // Summaries come out by message ID
+        std::sort(due->begin() + first, due->end(),
+                  [](const summary &a, const summary &b) { return a.msgCode < b.msgCode; });
+    }
+
+    const uint32_t duplicate_limit_;
+    const uint32_t rate_limit_;
+    object_shard object_shards_[kShards];
+    code_shard code_shards_[kShards];
+    std::atomic<uint64_t> suppressed_;  // Held back since the last summary, across all message IDs
+    std::atomic<uint64_t> last_summary_;
+};
+
 typedef struct _debug_report_data {
     VkLayerDbgFunctionNode *debug_callback_list;
     VkLayerDbgFunctionNode *default_debug_callback_list;
     VkFlags active_flags;
     bool g_DEBUG_REPORT;
+    log_msg_filter *filter;  // nullptr unless the layer settings limit repeated messages
+    binary_log_writer *binary_log;  // nullptr unless the layer settings ask for a binary log
+    VkFlags binary_log_flags;       // Messages that go to binary_log; always part of active_flags
 } debug_report_data;
 
 template debug_report_data *GetLayerDataPtr<debug_report_data>(void *data_key,
@@ -85,7 +273,7 @@ static inline void RemoveDebugMessageCallback(debug_report_data *debug_data, VkL
             free(prev_callback);
         }
     }
-    debug_data->active_flags = local_flags;
+    debug_data->active_flags = local_flags | debug_data->binary_log_flags;
 }
 
 // Removes all debug callback function nodes from the specified callback linked lists and frees their resources
@@ -146,10 +334,14 @@ static inline debug_report_data *debug_report_create_instance(
     return debug_data;
 }
 
+VK_LAYER_EXPORT void layer_release_binary_log(binary_log_writer *binary_log);
+
 static inline void layer_debug_report_destroy_instance(debug_report_data *debug_data) {
     if (debug_data) {
         RemoveAllMessageCallbacks(debug_data, &debug_data->default_debug_callback_list);
         RemoveAllMessageCallbacks(debug_data, &debug_data->debug_callback_list);
+        delete debug_data->filter;
+        layer_release_binary_log(debug_data->binary_log);
         free(debug_data);
     }
 }
@@ -188,7 +380,7 @@ static inline VkResult layer_create_msg_callback(debug_report_data *debug_data,
         debug_data->active_flags |= pCreateInfo->flags;
     } else {
         AddDebugMessageCallback(debug_data, &debug_data->debug_callback_list, pNewDbgFuncNode);
-        debug_data->active_flags = pCreateInfo->flags;
+        debug_data->active_flags = pCreateInfo->flags | debug_data->binary_log_flags;
     }
 
     debug_report_log_msg(debug_data, VK_DEBUG_REPORT_DEBUG_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEBUG_REPORT_EXT,
@@ -306,6 +498,94 @@ static inline bool will_log_msg(debug_report_data *debug_data, VkFlags msgFlags)
     return true;
 }
 
+// Whether any callback would be called for a message with msgFlags
+static inline bool debug_report_callbacks_want(const debug_report_data *debug_data, VkFlags msgFlags) {
+    VkLayerDbgFunctionNode *pTrav =
+        debug_data->debug_callback_list ? debug_data->debug_callback_list : debug_data->default_debug_callback_list;
+    for (; pTrav; pTrav = pTrav->pNext) {
+        if (pTrav->msgFlags & msgFlags) return true;
+    }
+    return false;
+}
+
+// Number of messages the calling thread has passed to log_msg, whether or not any callback wanted them, so a caller can tell
+// whether a check it ran reported anything. Not static, so every translation unit of a layer shares the one counter.
+inline uint64_t &log_msg_count() {
+    static thread_local uint64_t count = 0;
+    return count;
+}
+
+// A message log_msg held back instead of reporting it; see deferred_log_msgs()
+struct deferred_log_msg {
+    const debug_report_data *debug_data;
+    VkFlags msgFlags;
+    VkDebugReportObjectTypeEXT objectType;
+    uint64_t srcObject;
+    size_t location;
+    int32_t msgCode;
+    std::string layer_prefix;
+    std::string msg;
+    // Set for a message the filter held back whose ID the callbacks last asked to skip. It is not reported again; only that
+    // skip is carried to the calling thread.
+    bool suppressed_skip;
+};
+
+// While a thread points this at a list, log_msg on that thread appends every wanted message to the list and returns false
+// rather than calling the callbacks. Validation that runs on worker threads uses this so its messages can be reported
+// afterwards, from the calling thread, in the order the checks would have produced them when run one after another.
+inline std::vector<deferred_log_msg> *&deferred_log_msgs() {
+    static thread_local std::vector<deferred_log_msg> *list = nullptr;
+    return list;
+}
+
+// Report held back messages in order. Returns true if any callback asked for the call to be skipped.
+static inline bool report_deferred_log_msgs(std::vector<deferred_log_msg> const &msgs) {
+    bool skip = false;
+    for (auto &msg : msgs) {
+        if (msg.suppressed_skip) {
+            skip = true;
+            continue;
+        }
+        if (msg.debug_data->binary_log_flags & msg.msgFlags) {
+            msg.debug_data->binary_log->write_text(msg.msgFlags, msg.objectType, msg.srcObject, msg.location, msg.msgCode,
+                                                   msg.layer_prefix.c_str(), msg.msg.c_str());
+        }
+        bool result = debug_report_log_msg(msg.debug_data, msg.msgFlags, msg.objectType, msg.srcObject, msg.location,
+                                           msg.msgCode, msg.layer_prefix.c_str(), msg.msg.c_str());
+        if (msg.debug_data->filter) msg.debug_data->filter->reported(msg.msgCode, msg.layer_prefix.c_str(), result);
+        skip |= result;
+    }
+    return skip;
+}
+
+// Report counts of messages the filter held back; see log_msg_filter. Layers also call this from vkDestroyInstance while their
+// own logging callbacks still exist, so the last counts are not lost.
+static inline void report_suppressed_log_msgs(const debug_report_data *debug_data,
+                                              std::vector<log_msg_filter::summary> const &summaries) {
+    for (auto &summary : summaries) {
+        std::string msg = std::to_string(summary.suppressed) + " more messages with ID " + std::to_string(summary.msgCode) +
+                          " were suppressed by the duplicate_message_limit or message_rate_limit layer setting";
+        if (deferred_log_msgs()) {
+            deferred_log_msgs()->push_back({debug_data, summary.msgFlags, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0, 0,
+                                            summary.msgCode, summary.layer_prefix, msg, false});
+        } else {
+            if (debug_data->binary_log_flags & summary.msgFlags) {
+                debug_data->binary_log->write_text(summary.msgFlags, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0, 0,
+                                                   summary.msgCode, summary.layer_prefix.c_str(), msg.c_str());
+            }
+            debug_report_log_msg(debug_data, summary.msgFlags, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0, 0, summary.msgCode,
+                                 summary.layer_prefix.c_str(), msg.c_str());
+        }
+    }
+}
+
+static inline void report_suppressed_log_msgs(const debug_report_data *debug_data) {
+    if (!debug_data || !debug_data->filter) return;
+    std::vector<log_msg_filter::summary> summaries;
+    debug_data->filter->take_summaries(&summaries);
+    report_suppressed_log_msgs(debug_data, summaries);
+}
+
 #ifdef WIN32
 static inline int vasprintf(char **strp, char const *fmt, va_list ap) {
     *strp = nullptr;
@@ -332,11 +612,36 @@ static inline bool log_msg(const debug_report_data *debug_data, VkFlags msgFlags
 static inline bool log_msg(const debug_report_data *debug_data, VkFlags msgFlags, VkDebugReportObjectTypeEXT objectType,
                            uint64_t srcObject, size_t location, int32_t msgCode, const char *pLayerPrefix, const char *format,
                            ...) {
+    ++log_msg_count();
     if (!debug_data || !(debug_data->active_flags & msgFlags)) {
         // Message is not wanted
         return false;
     }
 
+    if (debug_data->filter) {
+        bool skip = false;
+        std::vector<log_msg_filter::summary> summaries;
+        bool admitted = debug_data->filter->admit(msgFlags, msgCode, srcObject, pLayerPrefix, &skip, &summaries);
+        if (!summaries.empty()) report_suppressed_log_msgs(debug_data, summaries);
+        if (!admitted) {
+            if (!deferred_log_msgs()) return skip;
+            if (skip) {
+                deferred_log_msgs()->push_back(
+                    {debug_data, msgFlags, objectType, srcObject, location, msgCode, pLayerPrefix, std::string(), true});
+            }
+            return false;
+        }
+    }
+
+    if ((debug_data->binary_log_flags & msgFlags) && !deferred_log_msgs()) {
+        va_list argptr;
+        va_start(argptr, format);
+        debug_data->binary_log->write(msgFlags, objectType, srcObject, location, msgCode, pLayerPrefix, format, argptr);
+        va_end(argptr);
+        // Only format the message if a callback wants it as well
+        if (!debug_report_callbacks_want(debug_data, msgFlags)) return false;
+    }
+
     va_list argptr;
     va_start(argptr, format);
     char *str;
@@ -345,9 +650,16 @@ static inline bool log_msg(const debug_report_data *debug_data, VkFlags msgFlags
         str = nullptr;
     }
     va_end(argptr);
+    if (deferred_log_msgs()) {
+        deferred_log_msgs()->push_back({debug_data, msgFlags, objectType, srcObject, location, msgCode, pLayerPrefix,
+                                        str ? str : "Allocation failure", false});
+        free(str);
+        return false;
+    }
     bool result = debug_report_log_msg(debug_data, msgFlags, objectType, srcObject, location, msgCode, pLayerPrefix,
                                        str ? str : "Allocation failure");
     free(str);
+    if (debug_data->filter) debug_data->filter->reported(msgCode, pLayerPrefix, result);
     return result;
 }
 
@@ -0,0 +1,390 @@
+/* Copyright (c) 2015-2017 The Khronos Group Inc.
+ * Copyright (c) 2015-2017 Valve Corporation
+ * Copyright (c) 2015-2017 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VK_LAYER_PROFILER_H
+#define VK_LAYER_PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "vulkan/vk_layer.h"
+#include "vk_dispatch_table_helper.h"
+#include "vk_layer_config.h"
+
+// Per-entry point call counts and timings for a layer, enabled by setting <layer prefix>.profile_file in the layer
+// settings. A report is written to that file at each vkDestroyDevice, as JSON if the name ends in .json and as CSV otherwise.
+//
+// Nothing in the layer changes while profiling is off. When it is on, GetDeviceProcAddr hands out a timing wrapper in
+// place of each of the layer's device-level entry points, and every member of the layer's device dispatch table is
+// replaced by a wrapper that times the call down the chain. Time an entry point spends before its first call down the
+// chain is counted as validation, time after its last one as recording. Time spent blocked on an rw_lock is counted
+// separately as lock wait, and is also included in the validation or recording time it interrupted.
+//
+// Each layer library has its own profiler, as the layers are built with hidden symbol visibility.
+
+enum ProfilePhase { PROFILE_VALIDATE, PROFILE_DOWN_CHAIN, PROFILE_RECORD, PROFILE_LOCK_WAIT, PROFILE_PHASE_COUNT };
+
+inline uint64_t profile_now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Timing of the entry point call the current thread is in
+struct profile_call {
+    uint64_t start;
+    uint64_t first_down_chain;     // Start of the first call down the chain, 0 if none yet
+    uint64_t last_down_chain_end;  // End of the last call down the chain
+    uint64_t down_chain;           // Total time spent down the chain
+    uint64_t lock_wait;            // Total time spent blocked on locks
+};
+
+inline profile_call *&current_profile_call() {
+    static thread_local profile_call *call = nullptr;
+    return call;
+}
+
+// Charges the time between construction and destruction to the lock wait of the calling thread's entry point, if any
+class profile_lock_wait {
+   public:
+    profile_lock_wait() : call_(current_profile_call()), start_(call_ ? profile_now() : 0) {}
+    ~profile_lock_wait() {
+        if (call_) call_->lock_wait += profile_now() - start_;
+    }
+    profile_lock_wait(const profile_lock_wait &) = delete;
+    profile_lock_wait &operator=(const profile_lock_wait &) = delete;
+
+   private:
+    profile_call *call_;
+    uint64_t start_;
+};
+
+class layer_profiler {
+   public:
+    // Durations are histogrammed by power of two, so percentiles are reported as the bucket's upper bound
+    static const uint32_t kBuckets = 48;
+
+    struct entry_stats {
+        std::atomic<uint64_t> calls;
+        std::atomic<uint64_t> total[PROFILE_PHASE_COUNT];
+        std::atomic<uint64_t> histogram[PROFILE_PHASE_COUNT][kBuckets];
+    };
+
+    // The profiler of the calling layer library
+    static layer_profiler &get() {
+        // Deliberately never destroyed, as wrapped entry points may still be running while the library is unloaded
+        static layer_profiler *profiler = new layer_profiler();
+        return *profiler;
+    }
+
+    // Read the report file name from <layer_prefix>.profile_file; called at each vkCreateDevice. Devices created from then on
+    // are profiled if it is set, and reports go to the file it names. Devices that are already wrapped stay wrapped, and the
+    // counts carry on from where they were.
+    void configure(const char *layer_prefix) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        layer_prefix_ = layer_prefix;
+        const char *file = getLayerOption((layer_prefix_ + ".profile_file").c_str());
+        report_file_ = (file && *file) ? file : "";
+        enabled_.store(!report_file_.empty(), std::memory_order_release);
+    }
+    bool enabled() const { return enabled_.load(std::memory_order_acquire); }
+
+    // Make every call the layer makes through table for device go through a timing wrapper
+    void wrap_dispatch_table(VkDevice device, VkLayerDispatchTable *table) {
+        if (!enabled()) return;
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            // A layer may keep more than one table per device; the first one holds the real next entry points
+            void *key = dispatch_key(device);
+            if (!next_table(key)) {
+                next_table_node *node = next_tables_.load(std::memory_order_relaxed);
+                while (node && node->key.load(std::memory_order_relaxed)) node = node->next;
+                if (!node) {
+                    node = new next_table_node();
+                    node->key.store(nullptr, std::memory_order_relaxed);
+                    node->next = next_tables_.load(std::memory_order_relaxed);
+                    next_tables_.store(node, std::memory_order_release);
+                }
+                node->table = *table;
+                node->key.store(key, std::memory_order_release);
+            }
+        }
+        wrap_table_visitor visitor{table};
+        layer_visit_device_dispatch_table(visitor);
+    }
+
+    // Return a timing wrapper for the layer's own entry point proc for name, or proc itself if it has none
+    PFN_vkVoidFunction wrap_entry_point(const char *name, PFN_vkVoidFunction proc) {
+        if (!enabled() || !proc) return proc;
+        wrap_entry_visitor visitor{name, proc, nullptr};
+        layer_visit_device_dispatch_table(visitor);
+        return visitor.wrapper ? visitor.wrapper : proc;
+    }
+
+    // Write the report and drop the next entry points of device. Call after passing vkDestroyDevice down the chain.
+    void device_destroyed(VkDevice device) {
+        // A device wrapped while profiling was on still has to give up its table, or a later device with the same dispatch
+        // key would find it
+        if (!next_tables_.load(std::memory_order_acquire)) return;
+        std::lock_guard<std::mutex> guard(mutex_);
+        for (auto node = next_tables_.load(std::memory_order_relaxed); node; node = node->next) {
+            if (node->key.load(std::memory_order_relaxed) == dispatch_key(device)) node->key.store(nullptr, std::memory_order_release);
+        }
+        if (enabled()) write_report();
+    }
+
+   private:
+    struct wrap_table_visitor {
+        VkLayerDispatchTable *table;
+        template <typename Fn, Fn VkLayerDispatchTable::*Member>
+        void visit(const char *name) {
+            if (!(table->*Member)) return;
+            get().register_entry<Fn, Member>(name, nullptr);
+            table->*Member = &profile_wrapper<Fn, Member>::down_chain;
+        }
+    };
+
+    struct wrap_entry_visitor {
+        const char *name;
+        PFN_vkVoidFunction proc;
+        PFN_vkVoidFunction wrapper;
+        template <typename Fn, Fn VkLayerDispatchTable::*Member>
+        void visit(const char *member_name) {
+            if (wrapper || strcmp(name, member_name)) return;
+            get().register_entry<Fn, Member>(member_name, reinterpret_cast<Fn>(proc));
+            wrapper = reinterpret_cast<PFN_vkVoidFunction>(&profile_wrapper<Fn, Member>::entry_point);
+        }
+    };
+
+    template <typename Fn, Fn VkLayerDispatchTable::*Member>
+    struct profile_wrapper;
+
+    // Calls through the wrappers of one dispatch table member
+    template <typename R, typename... Args, R(VKAPI_PTR *VkLayerDispatchTable::*Member)(Args...)>
+    struct profile_wrapper<R(VKAPI_PTR *)(Args...), Member> {
+        static R VKAPI_CALL entry_point(Args... args) {
+            entry_point_scope scope(stats);
+            return (get().entry_points_.*Member)(args...);
+        }
+        template <typename Handle, typename... Rest>
+        static void *first_key(Handle handle, Rest...) {
+            return dispatch_key(handle);
+        }
+        static R VKAPI_CALL down_chain(Args... args) {
+            down_chain_scope scope;
+            // A handle that outlived its device has no next table; skip the call rather than throw across the API boundary
+            VkLayerDispatchTable const *next = get().next_table(first_key(args...));
+            if (!next) return R();
+            return (next->*Member)(args...);
+        }
+        static entry_stats *stats;
+    };
+
+    // Set up the statistics for a dispatch table member on first use, and record entry_point as the layer's own
+    template <typename Fn, Fn VkLayerDispatchTable::*Member>
+    void register_entry(const char *name, Fn entry_point) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (entry_point) entry_points_.*Member = entry_point;
+        auto &stats = profile_wrapper<Fn, Member>::stats;
+        if (stats) return;
+        entries_.emplace_back(name, std::unique_ptr<entry_stats>(new entry_stats()));
+        auto &fresh = *entries_.back().second;
+        fresh.calls.store(0);
+        for (uint32_t phase = 0; phase < PROFILE_PHASE_COUNT; ++phase) {
+            fresh.total[phase].store(0);
+            for (auto &bucket : fresh.histogram[phase]) bucket.store(0);
+        }
+        stats = &fresh;
+    }
+
+    // Times one call of a wrapped entry point and charges it to stats when it returns
+    class entry_point_scope {
+       public:
+        explicit entry_point_scope(entry_stats *stats) : stats_(stats), outer_(current_profile_call()) {
+            call_ = {profile_now(), 0, 0, 0, 0};
+            current_profile_call() = &call_;
+        }
+        ~entry_point_scope() {
+            uint64_t end = profile_now();
+            current_profile_call() = outer_;
+            uint64_t before = (call_.first_down_chain ? call_.first_down_chain : end) - call_.start;
+            uint64_t after = call_.first_down_chain ? end - call_.last_down_chain_end : 0;
+            stats_->calls.fetch_add(1, std::memory_order_relaxed);
+            add(PROFILE_VALIDATE, before);
+            add(PROFILE_DOWN_CHAIN, call_.down_chain);
+            add(PROFILE_RECORD, after);
+            add(PROFILE_LOCK_WAIT, call_.lock_wait);
+        }
+        entry_point_scope(const entry_point_scope &) = delete;
+        entry_point_scope &operator=(const entry_point_scope &) = delete;
+
+       private:
+        void add(ProfilePhase phase, uint64_t ns) {
+            stats_->total[phase].fetch_add(ns, std::memory_order_relaxed);
+            stats_->histogram[phase][bucket(ns)].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        entry_stats *stats_;
+        profile_call *outer_;
+        profile_call call_;
+    };
+
+    // Times one call down the chain made from inside a wrapped entry point
+    class down_chain_scope {
+       public:
+        down_chain_scope() : call_(current_profile_call()), start_(call_ ? profile_now() : 0) {
+            if (call_ && !call_->first_down_chain) call_->first_down_chain = start_;
+        }
+        ~down_chain_scope() {
+            if (!call_) return;
+            call_->last_down_chain_end = profile_now();
+            call_->down_chain += call_->last_down_chain_end - start_;
+        }
+        down_chain_scope(const down_chain_scope &) = delete;
+        down_chain_scope &operator=(const down_chain_scope &) = delete;
+
+       private:
+        profile_call *call_;
+        uint64_t start_;
+    };
+
+    // The next entry points of one device. Nodes are only ever added, at the head, and are reused once their device is
+    // destroyed, so the list is as long as the most devices alive at once and can be searched without a lock.
+    struct next_table_node {
+        std::atomic<void *> key;  // Dispatch key of the device, or nullptr if the node is free
+        VkLayerDispatchTable table;
+        next_table_node *next;
+    };
+
+    layer_profiler() : enabled_(false), next_tables_(nullptr) { memset(&entry_points_, 0, sizeof(entry_points_)); }
+
+    template <typename Handle>
+    static void *dispatch_key(Handle handle) {
+        return *reinterpret_cast<void **>(handle);
+    }
+
+    // Bucket b holds durations below 2^b ns
+    static uint32_t bucket(uint64_t ns) {
+        uint32_t b = 0;
+        while (ns && b < kBuckets - 1) {
+            ns >>= 1;
+            ++b;
+        }
+        return b;
+    }
+
+    static uint64_t percentile(std::atomic<uint64_t> const (&histogram)[kBuckets], uint64_t count, uint32_t percent) {
+        uint64_t rank = (count * percent + 99) / 100;
+        uint64_t seen = 0;
+        for (uint32_t b = 0; b < kBuckets; ++b) {
+            seen += histogram[b].load(std::memory_order_relaxed);
+            if (seen >= rank) return b ? (uint64_t(1) << b) - 1 : 0;
+        }
+        return 0;
+    }
+
+    // Takes no lock, as every call down the chain looks its table up here. nullptr if the device is gone.
+    VkLayerDispatchTable const *next_table(void *key) const {
+        for (auto node = next_tables_.load(std::memory_order_acquire); node; node = node->next) {
+            if (node->key.load(std::memory_order_acquire) == key) return &node->table;
+        }
+        return nullptr;
+    }
+
+    bool json_report() const {
+        static const char suffix[] = ".json";
+        const size_t length = report_file_.size(), suffix_length = sizeof(suffix) - 1;
+        return length >= suffix_length && report_file_.compare(length - suffix_length, suffix_length, suffix) == 0;
+    }
+
+    // Caller holds mutex_
+    void write_report() {
+        FILE *out = fopen(report_file_.c_str(), "w");
+        if (!out) return;
+        if (json_report()) {
+            write_json_report(out);
+        } else {
+            write_csv_report(out);
+        }
+        fclose(out);
+    }
+
+    static const char *phase_name(uint32_t phase) {
+        static const char *const phase_names[PROFILE_PHASE_COUNT] = {"validate", "down_chain", "record", "lock_wait"};
+        return phase_names[phase];
+    }
+
+    void write_csv_report(FILE *out) {
+        fprintf(out, "layer,entry_point,calls");
+        for (uint32_t phase = 0; phase < PROFILE_PHASE_COUNT; ++phase) {
+            fprintf(out, ",%s_total_ns,%s_p50_ns,%s_p99_ns", phase_name(phase), phase_name(phase), phase_name(phase));
+        }
+        fprintf(out, "\n");
+        for (auto const &entry : entries_) {
+            auto const &stats = *entry.second;
+            uint64_t calls = stats.calls.load(std::memory_order_relaxed);
+            if (!calls) continue;
+            fprintf(out, "%s,%s,%llu", layer_prefix_.c_str(), entry.first.c_str(), static_cast<unsigned long long>(calls));
+            for (uint32_t phase = 0; phase < PROFILE_PHASE_COUNT; ++phase) {
+                fprintf(out, ",%llu,%llu,%llu", static_cast<unsigned long long>(stats.total[phase].load(std::memory_order_relaxed)),
+                        static_cast<unsigned long long>(percentile(stats.histogram[phase], calls, 50)),
+                        static_cast<unsigned long long>(percentile(stats.histogram[phase], calls, 99)));
+            }
+            fprintf(out, "\n");
+        }
+    }
+
+    // Entry point names are C identifiers, so nothing in the report needs escaping
+    void write_json_report(FILE *out) {
+        fprintf(out, "{\n  \"layer\": \"%s\",\n  \"entry_points\": [", layer_prefix_.c_str());
+        const char *separator = "\n";
+        for (auto const &entry : entries_) {
+            auto const &stats = *entry.second;
+            uint64_t calls = stats.calls.load(std::memory_order_relaxed);
+            if (!calls) continue;
+            fprintf(out, "%s    {\"name\": \"%s\", \"calls\": %llu", separator, entry.first.c_str(),
+                    static_cast<unsigned long long>(calls));
+            for (uint32_t phase = 0; phase < PROFILE_PHASE_COUNT; ++phase) {
+                fprintf(out, ", \"%s\": {\"total_ns\": %llu, \"p50_ns\": %llu, \"p99_ns\": %llu}", phase_name(phase),
+                        static_cast<unsigned long long>(stats.total[phase].load(std::memory_order_relaxed)),
+                        static_cast<unsigned long long>(percentile(stats.histogram[phase], calls, 50)),
+                        static_cast<unsigned long long>(percentile(stats.histogram[phase], calls, 99)));
+            }
+            fprintf(out, "}");
+            separator = ",\n";
+        }
+        fprintf(out, "\n  ]\n}\n");
+    }
+
+    std::atomic<bool> enabled_;
+    std::mutex mutex_;  // Guards the members below, except that next_tables_ is read without it
+    std::string layer_prefix_;
+    std::string report_file_;
+    std::atomic<next_table_node *> next_tables_;  // Deliberately never freed, as the profiler is never destroyed
+    std::vector<std::pair<std::string, std::unique_ptr<entry_stats>>> entries_;
+    VkLayerDispatchTable entry_points_;  // The layer's own entry points, in place of those it hands out wrappers for
+};
+
+template <typename R, typename... Args, R(VKAPI_PTR *VkLayerDispatchTable::*Member)(Args...)>
+layer_profiler::entry_stats *layer_profiler::profile_wrapper<R(VKAPI_PTR *)(Args...), Member>::stats = nullptr;
+
+#endif  // VK_LAYER_PROFILER_H
@@ -0,0 +1,127 @@
+/* Copyright (c) 2015-2017 The Khronos Group Inc.
+ * Copyright (c) 2015-2017 Valve Corporation
+ * Copyright (c) 2015-2017 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VK_LAYER_RANGE_MAP_H
+#define VK_LAYER_RANGE_MAP_H
+
+#include <iterator>
+#include <map>
+#include <utility>
+#include <vector>
+
+// Map from half-open index ranges [begin, end) to values.
+//
+// Stored ranges never overlap, and adjacent ranges holding equal values are merged, so state that is uniform over a
+// large span of indices (e.g. every subresource of an image in the same layout) is a single entry no matter how many
+// indices it covers. Indices with no stored range are "gaps"; the caller decides what a gap means.
+//
+// T must be copyable and equality comparable. Iteration visits the stored ranges in increasing index order; for an
+// iterator it, it->first is the range begin, it->second.end the range end and it->second.value the mapped value.
+template <typename Index, typename T>
+class range_map {
+   public:
+    struct entry {
+        Index end;
+        T value;
+    };
+    typedef typename std::map<Index, entry>::const_iterator const_iterator;
+
+    const_iterator begin() const { return ranges_.begin(); }
+    const_iterator end() const { return ranges_.end(); }
+    size_t size() const { return ranges_.size(); }
+    bool empty() const { return ranges_.empty(); }
+    void clear() { ranges_.clear(); }
+
+    // Value stored for index, or nullptr if index is in a gap
+    const T *find(Index index) const {
+        auto it = ranges_.upper_bound(index);
+        if (it == ranges_.begin()) return nullptr;
+        --it;
+        return (index < it->second.end) ? &it->second.value : nullptr;
+    }
+
+    // Call f(piece_begin, piece_end, const T *value) for each stored range and each gap intersecting [begin, end),
+    // clipped to [begin, end). value is nullptr for gaps.
+    template <typename F>
+    void for_each(Index begin, Index end, F f) const {
+        auto it = ranges_.upper_bound(begin);
+        if (it != ranges_.begin()) {
+            auto prev = std::prev(it);
+            if (begin < prev->second.end) it = prev;
+        }
+        Index pos = begin;
+        for (; it != ranges_.end() && it->first < end; ++it) {
+            if (pos < it->first) {
+                f(pos, it->first, static_cast<const T *>(nullptr));
+                pos = it->first;
+            }
+            Index piece_end = (it->second.end < end) ? it->second.end : end;
+            f(pos, piece_end, &it->second.value);
+            pos = piece_end;
+        }
+        if (pos < end) f(pos, end, static_cast<const T *>(nullptr));
+    }
+
+    // Set every index in [begin, end) to value
+    void overwrite(Index begin, Index end, const T &value) {
+        if (!(begin < end)) return;
+        split(begin);
+        split(end);
+        auto next = ranges_.erase(ranges_.lower_bound(begin), ranges_.lower_bound(end));
+        auto it = ranges_.insert(next, std::make_pair(begin, entry{end, value}));
+        // Coalesce with neighbors holding the same value
+        if (next != ranges_.end() && next->first == end && next->second.value == value) {
+            it->second.end = next->second.end;
+            ranges_.erase(next);
+        }
+        if (it != ranges_.begin()) {
+            auto prev = std::prev(it);
+            if (prev->second.end == begin && prev->second.value == value) {
+                prev->second.end = it->second.end;
+                ranges_.erase(it);
+            }
+        }
+    }
+
+    // Replace each stored range and gap within [begin, end) by f(const T *value), where value is nullptr for gaps
+    template <typename F>
+    void update(Index begin, Index end, F f) {
+        std::vector<std::pair<std::pair<Index, Index>, T>> pieces;
+        for_each(begin, end, [&pieces, &f](Index piece_begin, Index piece_end, const T *value) {
+            pieces.emplace_back(std::make_pair(piece_begin, piece_end), f(value));
+        });
+        for (const auto &piece : pieces) {
+            overwrite(piece.first.first, piece.first.second, piece.second);
+        }
+    }
+
+   private:
+    // Make index a range boundary if it falls strictly inside a stored range
+    void split(Index index) {
+        auto it = ranges_.upper_bound(index);
+        if (it == ranges_.begin()) return;
+        --it;
+        if (it->first < index && index < it->second.end) {
+            ranges_.insert(std::next(it), std::make_pair(index, entry{it->second.end, it->second.value}));
+            it->second.end = index;
+        }
+    }
+
+    std::map<Index, entry> ranges_;
+};
+
+#endif  // VK_LAYER_RANGE_MAP_H
@@ -0,0 +1,122 @@
+/* Copyright (c) 2015-2017 The Khronos Group Inc.
+ * Copyright (c) 2015-2017 Valve Corporation
+ * Copyright (c) 2015-2017 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VK_LAYER_RWLOCK_H
+#define VK_LAYER_RWLOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "vk_layer_profiler.h"
+
+// Reader/writer lock for layer state that is read far more often than it is modified.
+//   Readers only touch an atomic counter, so concurrent readers never serialize on each other.
+//   Writers are serialized by writer_mutex_, announce themselves with WRITER_BIT and then wait for the
+//   active readers to drain. Readers arriving while a writer is active block on writer_mutex_ until it is done.
+// Meets the BasicLockable requirements, so std::unique_lock and std::lock_guard can be used for exclusive access.
+// Use read_lock_guard (below) for shared access. Neither mode is recursive.
+// Time spent blocked is charged to the entry point being profiled on the calling thread, if any (see vk_layer_profiler.h).
+class rw_lock {
+   public:
+    rw_lock() : state_(0) {}
+    rw_lock(const rw_lock &) = delete;
+    rw_lock &operator=(const rw_lock &) = delete;
+
+    void lock() {
+        if (!writer_mutex_.try_lock()) {
+            profile_lock_wait wait;
+            writer_mutex_.lock();
+        }
+        if (state_.fetch_or(WRITER_BIT, std::memory_order_acquire) != 0) {
+            profile_lock_wait wait;
+            while (state_.load(std::memory_order_acquire) != WRITER_BIT) {
+                std::this_thread::yield();
+            }
+        }
+    }
+    void unlock() {
+        state_.fetch_and(~WRITER_BIT, std::memory_order_release);
+        writer_mutex_.unlock();
+    }
+
+    void lock_shared() {
+        uint32_t state = state_.load(std::memory_order_relaxed);
+        while (true) {
+            if (state & WRITER_BIT) {
+                // Wait for the writer to finish rather than spinning on the counter
+                profile_lock_wait wait;
+                { std::lock_guard<std::mutex> writer_done(writer_mutex_); }
+                state = state_.load(std::memory_order_relaxed);
+            } else if (state_.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+    }
+    void unlock_shared() { state_.fetch_sub(1, std::memory_order_release); }
+
+   private:
+    static const uint32_t WRITER_BIT = 0x80000000;
+    std::atomic<uint32_t> state_;
+    std::mutex writer_mutex_;
+};
+
+// Scoped shared ownership of an rw_lock, mirroring the std::unique_lock interface used throughout the layers
+class read_lock_guard {
+   public:
+    explicit read_lock_guard(rw_lock &lock) : lock_(lock), owns_(true) { lock_.lock_shared(); }
+    ~read_lock_guard() {
+        if (owns_) lock_.unlock_shared();
+    }
+    read_lock_guard(const read_lock_guard &) = delete;
+    read_lock_guard &operator=(const read_lock_guard &) = delete;
+
+    void lock() {
+        lock_.lock_shared();
+        owns_ = true;
+    }
+    void unlock() {
+        lock_.unlock_shared();
+        owns_ = false;
+    }
+    bool owns_lock() const { return owns_; }
+
+   private:
+    rw_lock &lock_;
+    bool owns_;
+};
+
+// Minimal spin lock for short critical sections on per-object state, e.g. inserting into a small set
+class spin_lock {
+   public:
+    spin_lock() { flag_.clear(); }
+    spin_lock(const spin_lock &) = delete;
+    spin_lock &operator=(const spin_lock &) = delete;
+
+    void lock() {
+        while (flag_.test_and_set(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+    void unlock() { flag_.clear(std::memory_order_release); }
+
+   private:
+    std::atomic_flag flag_;
+};
+
+#endif  // VK_LAYER_RWLOCK_H
@@ -0,0 +1,192 @@
+/* Copyright (c) 2015-2017 The Khronos Group Inc.
+ * Copyright (c) 2015-2017 Valve Corporation
+ * Copyright (c) 2015-2017 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VK_LAYER_THREAD_POOL_H
+#define VK_LAYER_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for splitting independent pieces of validation work, e.g. the pipelines of one
+// vkCreateGraphicsPipelines call, across cores.
+//
+// parallel_for() runs one job at a time: the calling thread works on the job alongside the workers and only returns once
+// every index has been processed and no worker is still looking at the job, so f may safely refer to the caller's locals.
+// The work must not log or otherwise depend on the order in which indices run.
+class thread_pool {
+   public:
+    explicit thread_pool(unsigned worker_count) : stop_(false), generation_(0), count_(0), active_(0), done_(0), next_(0) {
+        for (unsigned i = 0; i < worker_count; ++i) {
+            workers_.emplace_back([this] { run(); });
+        }
+    }
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto &worker : workers_) worker.join();
+    }
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    // Call f(i) for every i in [0, count)
+    template <typename F>
+    void parallel_for(size_t count, F f) {
+        if (workers_.empty() || count < 2) {
+            for (size_t i = 0; i < count; ++i) f(i);
+            return;
+        }
+
+        std::lock_guard<std::mutex> one_job_at_a_time(job_mutex_);
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            job_ = [&f](size_t i) { f(i); };
+            count_ = count;
+            done_ = 0;
+            next_.store(0);
+            ++generation_;
+        }
+        wake_.notify_all();
+
+        work(job_, count);
+
+        std::unique_lock<std::mutex> guard(mutex_);
+        finished_.wait(guard, [this] { return done_ == count_ && active_ == 0; });
+        job_ = nullptr;
+    }
+
+   private:
+    void run() {
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> guard(mutex_);
+        while (true) {
+            wake_.wait(guard, [this, seen] { return stop_ || generation_ != seen; });
+            if (stop_) return;
+            seen = generation_;
+            if (!job_) continue;  // Woke after that job already finished
+            // Take a copy so the job can be replaced as soon as this worker is done with it
+            auto job = job_;
+            size_t count = count_;
+            ++active_;
+            guard.unlock();
+            work(job, count);
+            guard.lock();
+            --active_;
+            if (done_ == count_ && active_ == 0) finished_.notify_all();
+        }
+    }
+
+    // Claim and run indices of the current job until none are left
+    void work(std::function<void(size_t)> const &job, size_t count) {
+        size_t finished = 0;
+        for (size_t i = next_.fetch_add(1); i < count; i = next_.fetch_add(1)) {
+            job(i);
+            ++finished;
+        }
+        if (finished) {
+            std::lock_guard<std::mutex> guard(mutex_);
+            done_ += finished;
+            if (done_ == count_ && active_ == 0) finished_.notify_all();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::mutex job_mutex_;
+    std::mutex mutex_;  // Guards everything below except next_
+    std::condition_variable wake_;
+    std::condition_variable finished_;
+    bool stop_;
+    uint64_t generation_;  // Bumped for each job, so a worker picks up every job exactly once
+    std::function<void(size_t)> job_;
+    size_t count_;
+    size_t active_;  // Workers currently inside work()
+    size_t done_;
+    std::atomic<size_t> next_;
+};
+
+// Single background thread that runs posted tasks one after another in the order they were posted.
+//
+// post() only queues the task and never waits for the thread, so it is cheap enough to call from an API entry point. Once
+// capacity tasks are waiting it refuses the task instead and returns false, leaving the caller to do the work itself.
+// drain() waits until every task posted so far has finished; anything a task refers to must stay alive until then.
+class task_queue {
+   public:
+    explicit task_queue(size_t capacity) : capacity_(capacity), stop_(false), busy_(false), worker_([this] { run(); }) {}
+    ~task_queue() {
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        worker_.join();
+    }
+    task_queue(const task_queue &) = delete;
+    task_queue &operator=(const task_queue &) = delete;
+
+    bool post(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            if (tasks_.size() >= capacity_) return false;
+            tasks_.push_back(std::move(task));
+        }
+        wake_.notify_one();
+        return true;
+    }
+
+    void drain() {
+        std::unique_lock<std::mutex> guard(mutex_);
+        idle_.wait(guard, [this] { return tasks_.empty() && !busy_; });
+    }
+
+   private:
+    void run() {
+        std::unique_lock<std::mutex> guard(mutex_);
+        while (true) {
+            wake_.wait(guard, [this] { return stop_ || !tasks_.empty(); });
+            // Finish whatever was posted before stopping so that no task is silently dropped
+            if (tasks_.empty()) return;
+            auto task = std::move(tasks_.front());
+            tasks_.pop_front();
+            busy_ = true;
+            guard.unlock();
+            task();
+            guard.lock();
+            busy_ = false;
+            if (tasks_.empty()) idle_.notify_all();
+        }
+    }
+
+    const size_t capacity_;
+    std::mutex mutex_;  // Guards everything below except worker_
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    std::deque<std::function<void()>> tasks_;
+    bool stop_;
+    bool busy_;  // The worker is running a task it has already taken off tasks_
+    std::thread worker_;  // Declared last so it starts after the members it uses are constructed
+};
+
+#endif  // VK_LAYER_THREAD_POOL_H
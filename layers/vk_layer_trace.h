@@ -0,0 +1,160 @@
+/* Copyright (c) 2015-2017 The Khronos Group Inc.
+ * Copyright (c) 2015-2017 Valve Corporation
+ * Copyright (c) 2015-2017 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VK_LAYER_TRACE_H
+#define VK_LAYER_TRACE_H
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include "vk_loader_platform.h"
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Streams events in the Trace Event JSON format, which chrome://tracing and Perfetto load directly.
+//
+// Events are written as they happen and the closing bracket of the event array is never written, which both viewers
+// accept, so a trace stays readable even if the process dies. Each event after the first starts with the comma that
+// separates it from the one before, so appending "]" to the file at any time gives a strict JSON array.
+//
+// Calls go on the track of the CPU thread that made them (process 1), identified by its OS thread id so that it lines up
+// with other profilers and named after the thread, and spans of work on a track named by the caller, such as one per
+// VkQueue (process 2). Arguments are passed as the body of a JSON object, e.g. "\"seq\":3", and must already be valid JSON.
+//
+// Thread safe; events are serialized on an internal mutex.
+class trace_event_writer {
+   public:
+    explicit trace_event_writer(const char *filename) : file_(fopen(filename, "w")), separator_("[\n"), next_track_(1) {
+        if (!file_) return;
+        fprintf(file_, "%s{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\",\"args\":{\"name\":\"CPU threads\"}}", separator());
+        fprintf(file_, "%s{\"ph\":\"M\",\"pid\":2,\"name\":\"process_name\",\"args\":{\"name\":\"Queues\"}}", separator());
+    }
+    ~trace_event_writer() {
+        if (file_) fclose(file_);
+    }
+    trace_event_writer(const trace_event_writer &) = delete;
+    trace_event_writer &operator=(const trace_event_writer &) = delete;
+
+    bool is_open() const { return file_ != nullptr; }
+
+    static uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    // Name the track for key, creating it if needed
+    void name_track(const void *key, const std::string &name) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        fprintf(file_, "%s{\"ph\":\"M\",\"pid\":2,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":\"%s\"}}", separator(),
+                track(key), name.c_str());
+    }
+
+    // A call on the calling thread that ran from start to end, as returned by now()
+    void complete(const char *name, uint64_t start, uint64_t end, const std::string &args) {
+        const uint64_t tid = thread_id();
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (named_threads_.insert(tid).second) {
+            fprintf(file_, "%s{\"ph\":\"M\",\"pid\":1,\"tid\":%" PRIu64 ",\"name\":\"thread_name\",\"args\":{\"name\":\"%s\"}}",
+                    separator(), tid, thread_name(tid).c_str());
+        }
+        fprintf(file_, "%s{\"ph\":\"X\",\"pid\":1,\"tid\":%" PRIu64 ",\"name\":\"%s\",\"ts\":%.3f,\"dur\":%.3f,\"args\":{%s}}",
+                separator(), tid, name, start / 1000.0, (end - start) / 1000.0, args.c_str());
+    }
+
+    // Start or end of a span on the track for key, e.g. a submission from when it is queued to when it is known to be done.
+    // id tells overlapping spans on the same track apart.
+    void begin_span(const void *key, const char *name, uint64_t id, const std::string &args) { span(key, "b", name, id, args); }
+    void end_span(const void *key, const char *name, uint64_t id, const std::string &args) { span(key, "e", name, id, args); }
+
+    void flush() {
+        std::lock_guard<std::mutex> guard(mutex_);
+        fflush(file_);
+    }
+
+   private:
+    void span(const void *key, const char *phase, const char *name, uint64_t id, const std::string &args) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        unsigned tid = track(key);
+        fprintf(file_,
+                "%s{\"ph\":\"%s\",\"cat\":\"track%u\",\"pid\":2,\"tid\":%u,\"id\":\"%u:%" PRIu64
+                "\",\"name\":\"%s\",\"ts\":%.3f,\"args\":{%s}}",
+                separator(), phase, tid, tid, tid, id, name, now() / 1000.0, args.c_str());
+    }
+
+    // What goes before the next event: the opening bracket for the first, a comma and a newline for the rest.
+    // Caller holds mutex_, or is the constructor.
+    const char *separator() {
+        const char *separator = separator_;
+        separator_ = ",\n";
+        return separator;
+    }
+
+    unsigned track(const void *key) {
+        auto it = tracks_.find(key);
+        if (it != tracks_.end()) return it->second;
+        return tracks_[key] = next_track_++;
+    }
+
+    // The OS id of the calling thread, as debuggers and other profilers show it
+    static uint64_t thread_id() {
+        static thread_local uint64_t tid = [] {
+#if defined(_WIN32)
+            return static_cast<uint64_t>(GetCurrentThreadId());
+#elif defined(__linux__)
+            return static_cast<uint64_t>(syscall(SYS_gettid));
+#elif defined(__APPLE__)
+            uint64_t id = 0;
+            pthread_threadid_np(nullptr, &id);
+            return id;
+#else
+            return static_cast<uint64_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+#endif
+        }();
+        return tid;
+    }
+
+    // The calling thread's name where the platform has one, made safe to put in a JSON string; tid otherwise
+    static std::string thread_name(uint64_t tid) {
+        std::string name;
+#if (defined(__linux__) && defined(__GLIBC__)) || defined(__APPLE__)
+        char buffer[64] = {};
+        if (pthread_getname_np(pthread_self(), buffer, sizeof(buffer)) == 0) name = buffer;
+#endif
+        for (auto &c : name) {
+            if (c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20) c = '_';
+        }
+        if (name.empty()) name = "Thread " + std::to_string(tid);
+        return name;
+    }
+
+    FILE *file_;
+    std::mutex mutex_;  // Guards everything below and writes to file_
+    const char *separator_;
+    std::unordered_map<const void *, unsigned> tracks_;
+    unsigned next_track_;
+    std::unordered_set<uint64_t> named_threads_;  // CPU threads whose thread_name has been written
+};
+
+#endif  // VK_LAYER_TRACE_H
@@ -23,8 +23,16 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <atomic>
+#include <mutex>
+#include <signal.h>
+#ifndef WIN32
+#include <errno.h>
+#include <unistd.h>
+#endif
 #include "vulkan/vulkan.h"
 #include "vk_layer_config.h"
+#include "vk_layer_log_sink.h"
 #include "vk_layer_utils.h"
 
 static const uint8_t UTF8_ONE_BYTE_CODE = 0xC0;
@@ -80,6 +88,163 @@ VK_LAYER_EXPORT bool white_list(const char *item, const char *list) {
     return (white_list.find(candidate) != std::string::npos);
 }
 
+// Sinks for the files that layers log to asynchronously, at most one per file. They are never destroyed, only stopped at exit
+// or when this library is unloaded, so that anything logged later still reaches the file.
+static const size_t kMaxAsyncLogSinks = 16;
+static std::atomic<async_log_sink *> async_log_sinks[kMaxAsyncLogSinks];
+static std::mutex async_log_sinks_mutex;
+
+// Same output as log_callback
+static void write_log_line(FILE *file, const log_record &record) {
+    char msg_flags[30];
+
+    print_msg_flags(record.msgFlags, msg_flags);
+
+    fprintf(file, "%s(%s): object: 0x%" PRIx64 " type: %d location: %lu msgCode: %d: %s\n", record.layer_prefix, msg_flags,
+            record.srcObject, record.objectType, (unsigned long)record.location, record.msgCode, record.msg);
+}
+
+static VKAPI_ATTR VkBool32 VKAPI_CALL async_log_callback(VkFlags msgFlags, VkDebugReportObjectTypeEXT objType,
+                                                         uint64_t srcObject, size_t location, int32_t msgCode,
+                                                         const char *pLayerPrefix, const char *pMsg, void *pUserData) {
+    static_cast<async_log_sink *>(pUserData)->push({msgFlags, objType, srcObject, location, msgCode, pLayerPrefix, pMsg});
+    return false;
+}
+
+#ifndef WIN32
+static const int crash_signals[] = {SIGABRT, SIGBUS, SIGFPE, SIGILL, SIGSEGV};
+static struct sigaction previous_crash_actions[sizeof(crash_signals) / sizeof(crash_signals[0])];
+static bool crash_actions_installed = false;  // Guarded by async_log_sinks_mutex
+
+// The helpers below only make async-signal-safe calls, for use in write_async_logs_on_crash
+static void append_text(char *line, size_t size, size_t *length, const char *text) {
+    while (*text && *length < size) line[(*length)++] = *text++;
+}
+
+static void append_number(char *line, size_t size, size_t *length, uint64_t value, unsigned base) {
+    char digits[20];
+    size_t count = 0;
+    do {
+        digits[count++] = "0123456789abcdef"[value % base];
+        value /= base;
+    } while (value);
+    while (count && *length < size) line[(*length)++] = digits[--count];
+}
+
+static void append_signed(char *line, size_t size, size_t *length, int64_t value) {
+    if (value < 0) append_text(line, size, length, "-");
+    append_number(line, size, length, value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value), 10);
+}
+
+static void write_all(int fd, const char *data, size_t size) {
+    while (size) {
+        const ssize_t written = write(fd, data, size);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return;
+        data += written;
+        size -= written;
+    }
+}
+
+// Same output as write_log_line, built in a buffer on the stack and written with write(2) instead of stdio
+static void write_log_line_on_crash(int fd, const log_record &record) {
+    char line[512];
+    size_t length = 0;
+    char msg_flags[30];
+    print_msg_flags(record.msgFlags, msg_flags);
+    append_text(line, sizeof(line), &length, record.layer_prefix);
+    append_text(line, sizeof(line), &length, "(");
+    append_text(line, sizeof(line), &length, msg_flags);
+    append_text(line, sizeof(line), &length, "): object: 0x");
+    append_number(line, sizeof(line), &length, record.srcObject, 16);
+    append_text(line, sizeof(line), &length, " type: ");
+    append_signed(line, sizeof(line), &length, record.objectType);
+    append_text(line, sizeof(line), &length, " location: ");
+    append_number(line, sizeof(line), &length, record.location, 10);
+    append_text(line, sizeof(line), &length, " msgCode: ");
+    append_signed(line, sizeof(line), &length, record.msgCode);
+    append_text(line, sizeof(line), &length, ": ");
+    write_all(fd, line, length);
+    write_all(fd, record.msg, strlen(record.msg));
+    write_all(fd, "\n", 1);
+}
+
+// Write out what the drain threads have not got to yet, then let whatever handled the signal before take over
+static void write_async_logs_on_crash(int signal_number) {
+    for (auto &sink : async_log_sinks) {
+        if (sink.load()) sink.load()->write_pending_on_crash(write_log_line_on_crash);
+    }
+    for (size_t i = 0; i < sizeof(crash_signals) / sizeof(crash_signals[0]); ++i) {
+        if (crash_signals[i] == signal_number) sigaction(signal_number, &previous_crash_actions[i], nullptr);
+    }
+    raise(signal_number);
+}
+
+// For the async_log_crash_flush setting. Only called with async_log_sinks_mutex held.
+static void install_crash_actions() {
+    if (crash_actions_installed) return;
+    crash_actions_installed = true;
+    struct sigaction action = {};
+    action.sa_handler = write_async_logs_on_crash;
+    sigemptyset(&action.sa_mask);
+    for (size_t i = 0; i < sizeof(crash_signals) / sizeof(crash_signals[0]); ++i) {
+        sigaction(crash_signals[i], &action, &previous_crash_actions[i]);
+    }
+}
+
+// Put back the handlers that write_async_logs_on_crash replaced, unless something else has replaced it since
+static void restore_crash_actions() {
+    if (!crash_actions_installed) return;
+    for (size_t i = 0; i < sizeof(crash_signals) / sizeof(crash_signals[0]); ++i) {
+        struct sigaction current = {};
+        sigaction(crash_signals[i], nullptr, &current);
+        if (current.sa_handler == write_async_logs_on_crash) sigaction(crash_signals[i], &previous_crash_actions[i], nullptr);
+    }
+}
+#endif
+
+// Registered with atexit, which for this library also runs when it is unloaded, so the crash handlers must not outlive it
+static void stop_async_logs() {
+    for (auto &sink : async_log_sinks) {
+        if (sink.load()) sink.load()->stop();
+    }
+#ifndef WIN32
+    restore_crash_actions();
+#endif
+}
+
+// The sink for file, or nullptr if there are already too many to add one. With crash_flush, what the sinks still hold is
+// also written out when the process crashes.
+static async_log_sink *get_async_log_sink(FILE *file, bool crash_flush) {
+    std::lock_guard<std::mutex> lock(async_log_sinks_mutex);
+#ifndef WIN32
+    if (crash_flush) install_crash_actions();
+#endif
+    for (auto &sink : async_log_sinks) {
+        if (sink.load() && sink.load()->file() == file) return sink.load();
+    }
+    for (size_t i = 0; i < kMaxAsyncLogSinks; ++i) {
+        if (async_log_sinks[i].load()) continue;
+        if (i == 0) atexit(stop_async_logs);
+        async_log_sinks[i].store(new async_log_sink(file, write_log_line));
+        return async_log_sinks[i].load();
+    }
+    return nullptr;
+}
+
+// Wait until everything logged so far through an async_log setting is in its file
+VK_LAYER_EXPORT void layer_flush_async_logs() {
+    for (auto &sink : async_log_sinks) {
+        if (sink.load()) sink.load()->flush();
+    }
+}
+
+// Layers that name the same binary log file share one writer
+static shared_file_writer<binary_log_writer> binary_logs;
+
+// Called by each layer_debug_report_destroy_instance that acquired binary_log
+VK_LAYER_EXPORT void layer_release_binary_log(binary_log_writer *binary_log) { binary_logs.release(binary_log); }
+
 // Debug callbacks get created in three ways:
 //   o  Application-defined debug callbacks
 //   o  Through settings in a vk_layer_settings.txt file
@@ -98,9 +263,15 @@ VK_LAYER_EXPORT void layer_debug_actions(debug_report_data *report_data, std::ve
     std::string report_flags_key = layer_identifier;
     std::string debug_action_key = layer_identifier;
     std::string log_filename_key = layer_identifier;
+    std::string async_log_key = layer_identifier;
+    std::string async_log_crash_flush_key = layer_identifier;
+    std::string log_format_key = layer_identifier;
     report_flags_key.append(".report_flags");
     debug_action_key.append(".debug_action");
     log_filename_key.append(".log_filename");
+    async_log_key.append(".async_log");
+    async_log_crash_flush_key.append(".async_log_crash_flush");
+    log_format_key.append(".log_format");
 
     // Initialize layer options
     VkDebugReportFlagsEXT report_flags = GetLayerOptionFlags(report_flags_key, report_flags_option_definitions, 0);
@@ -108,15 +279,39 @@ VK_LAYER_EXPORT void layer_debug_actions(debug_report_data *report_data, std::ve
     // Flag as default if these settings are not from a vk_layer_settings.txt file
     bool default_layer_callback = (debug_action & VK_DBG_LAYER_ACTION_DEFAULT) ? true : false;
 
+    const char *log_format = getLayerOption(log_format_key.c_str());
+    if ((debug_action & VK_DBG_LAYER_ACTION_LOG_MSG) && log_format && !strcmp(log_format, "binary") && !report_data->binary_log) {
+        // Binary output can't go to stdout, so without a log file name each layer gets a file named after it
+        const char *log_filename = getLayerOption(log_filename_key.c_str());
+        std::string binary_filename = layer_identifier;
+        binary_filename.append(".vkbinlog");
+        if (log_filename && *log_filename && strcmp(log_filename, "stdout")) binary_filename = log_filename;
+        binary_log_writer *binary_log = binary_logs.acquire(binary_filename);
+        if (binary_log) {
+            report_data->binary_log = binary_log;
+            report_data->binary_log_flags = report_flags;
+            report_data->active_flags |= report_flags;
+            debug_action &= ~VK_DBG_LAYER_ACTION_LOG_MSG;
+        } else {
+            printf("\n%s ERROR: Bad binary log filename %s. Writing text instead\n\n", layer_identifier,
+                   binary_filename.c_str());
+        }
+    }
+
     if (debug_action & VK_DBG_LAYER_ACTION_LOG_MSG) {
         const char *log_filename = getLayerOption(log_filename_key.c_str());
         FILE *log_output = getLayerLogOutput(log_filename, layer_identifier);
+        const char *async_log = getLayerOption(async_log_key.c_str());
+        const char *crash_flush = getLayerOption(async_log_crash_flush_key.c_str());
+        async_log_sink *sink = (async_log && !strcmp(async_log, "true"))
+                                   ? get_async_log_sink(log_output, crash_flush && !strcmp(crash_flush, "true"))
+                                   : nullptr;
         VkDebugReportCallbackCreateInfoEXT dbgCreateInfo;
         memset(&dbgCreateInfo, 0, sizeof(dbgCreateInfo));
         dbgCreateInfo.sType = VK_STRUCTURE_TYPE_DEBUG_REPORT_CREATE_INFO_EXT;
         dbgCreateInfo.flags = report_flags;
-        dbgCreateInfo.pfnCallback = log_callback;
-        dbgCreateInfo.pUserData = (void *)log_output;
+        dbgCreateInfo.pfnCallback = sink ? async_log_callback : log_callback;
+        dbgCreateInfo.pUserData = sink ? (void *)sink : (void *)log_output;
         layer_create_msg_callback(report_data, default_layer_callback, &dbgCreateInfo, pAllocator, &callback);
         logging_callback.push_back(callback);
     }
@@ -133,4 +328,14 @@ VK_LAYER_EXPORT void layer_debug_actions(debug_report_data *report_data, std::ve
         layer_create_msg_callback(report_data, default_layer_callback, &dbgCreateInfo, pAllocator, &callback);
         logging_callback.push_back(callback);
     }
+
+    std::string duplicate_limit_key = layer_identifier;
+    std::string rate_limit_key = layer_identifier;
+    duplicate_limit_key.append(".duplicate_message_limit");
+    rate_limit_key.append(".message_rate_limit");
+    const char *duplicate_limit = getLayerOption(duplicate_limit_key.c_str());
+    const char *rate_limit = getLayerOption(rate_limit_key.c_str());
+    uint32_t duplicates = duplicate_limit ? static_cast<uint32_t>(strtoul(duplicate_limit, nullptr, 10)) : 0;
+    uint32_t rate = rate_limit ? static_cast<uint32_t>(strtoul(rate_limit, nullptr, 10)) : 0;
+    if ((duplicates || rate) && !report_data->filter) report_data->filter = new log_msg_filter(duplicates, rate);
 }
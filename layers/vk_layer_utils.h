@@ -21,6 +21,9 @@
 
 #pragma once
 #include <stdbool.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include "vk_format_utils.h"
 #include "vk_layer_logging.h"
@@ -47,6 +50,7 @@ typedef VkFlags VkStringErrorFlags;
 VK_LAYER_EXPORT void layer_debug_actions(debug_report_data *report_data, std::vector<VkDebugReportCallbackEXT> &logging_callback,
                                          const VkAllocationCallbacks *pAllocator, const char *layer_identifier);
 
+VK_LAYER_EXPORT void layer_flush_async_logs();
 VK_LAYER_EXPORT VkStringErrorFlags vk_string_validate(const int max_length, const char *char_array);
 VK_LAYER_EXPORT bool white_list(const char *item, const char *whitelist);
 
@@ -65,3 +69,47 @@ static inline int u_ffs(int val) {
 #ifdef __cplusplus
 }
 #endif
+
+// One T per file name, shared by everyone writing to that file and deleted with the last of them, so that two layers or
+// devices given the same file add to it instead of truncating each other's output. T is constructed from the file name
+// and has is_open() and flush().
+template <typename T>
+class shared_file_writer {
+   public:
+    // The writer for filename, or nullptr if the file can't be opened
+    T *acquire(const std::string &filename) {
+        std::lock_guard<std::mutex> lock(lock_);
+        auto &entry = writers_[filename];
+        if (!entry.first) {
+            T *writer = new T(filename.c_str());
+            if (!writer->is_open()) {
+                delete writer;
+                writers_.erase(filename);
+                return nullptr;
+            }
+            entry.first = writer;
+        }
+        ++entry.second;
+        return entry.first;
+    }
+
+    // Called with what acquire returned, once nothing can still write through it; the last release closes the file
+    void release(T *writer) {
+        if (!writer) return;
+        std::lock_guard<std::mutex> lock(lock_);
+        for (auto it = writers_.begin(); it != writers_.end(); ++it) {
+            if (it->second.first != writer) continue;
+            if (--it->second.second == 0) {
+                delete writer;
+                writers_.erase(it);
+            } else {
+                writer->flush();
+            }
+            return;
+        }
+    }
+
+   private:
+    std::mutex lock_;
+    std::unordered_map<std::string, std::pair<T *, uint32_t>> writers_;  // Writer and the number of its users
+};
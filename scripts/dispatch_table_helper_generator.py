@@ -111,6 +111,7 @@ class DispatchTableHelperOutputGenerator(OutputGenerator):
         copyright += ' */\n'
 
         preamble = ''
+        preamble += '#pragma once\n'
         preamble += '#include <vulkan/vulkan.h>\n'
         preamble += '#include <vulkan/vk_layer.h>\n'
         preamble += '#include <string.h>\n'
@@ -129,6 +130,8 @@ class DispatchTableHelperOutputGenerator(OutputGenerator):
         write(device_table, file=self.outFile);
         write("\n", file=self.outFile)
         write(instance_table, file=self.outFile);
+        write("\n", file=self.outFile)
+        write(self.OutputDispatchTableVisitor(), file=self.outFile);
 
         # Finish processing in superclass
         OutputGenerator.endFile(self)
@@ -204,3 +207,22 @@ class DispatchTableHelperOutputGenerator(OutputGenerator):
                 table += '#endif // %s\n' % item[1]
         table += '}'
         return table
+    #
+    # Create a function template that hands every device dispatch table member to a visitor, so that layer code can
+    # operate on all members generically, e.g. to substitute wrappers for them
+    def OutputDispatchTableVisitor(self):
+        table = ''
+        table += '// Call visitor.visit<PFN type, member>("vkName") for each device dispatch table member except GetDeviceProcAddr\n'
+        table += 'template <typename Visitor>\n'
+        table += 'static inline void layer_visit_device_dispatch_table(Visitor &visitor) {\n'
+        for item in self.device_dispatch_list:
+            base_name = item[0][2:]
+            if base_name == 'GetDeviceProcAddr':
+                continue
+            if item[1] is not None:
+                table += '#ifdef %s\n' % item[1]
+            table += '    visitor.template visit<PFN_%s, &VkLayerDispatchTable::%s>("%s");\n' % (item[0], base_name, item[0])
+            if item[1] is not None:
+                table += '#endif // %s\n' % item[1]
+        table += '}'
+        return table
@@ -380,6 +380,7 @@ class ThreadOutputGenerator(OutputGenerator):
             'vkDestroyInstance',
             'vkAllocateCommandBuffers',
             'vkFreeCommandBuffers',
+            'vkDestroyCommandPool',
             'vkCreateDebugReportCallbackEXT',
             'vkDestroyDebugReportCallbackEXT',
             'vkAllocateDescriptorSets',
@@ -433,7 +434,7 @@ class ThreadOutputGenerator(OutputGenerator):
         else:
             assignresult = ''
 
-        self.appendSection('command', '    bool threadChecks = startMultiThread();')
+        self.appendSection('command', '    bool threadChecks = startMultiThread(my_data, "%s");' % name)
         self.appendSection('command', '    if (threadChecks) {')
         self.appendSection('command', "    "+"\n    ".join(str(startthreadsafety).rstrip().split("\n")))
         self.appendSection('command', '    }')
@@ -443,8 +444,6 @@ class ThreadOutputGenerator(OutputGenerator):
         self.appendSection('command', '    ' + assignresult + API + '(' + paramstext + ');')
         self.appendSection('command', '    if (threadChecks) {')
         self.appendSection('command', "    "+"\n    ".join(str(finishthreadsafety).rstrip().split("\n")))
-        self.appendSection('command', '    } else {')
-        self.appendSection('command', '        finishMultiThread();')
         self.appendSection('command', '    }')
         # Return result variable, if any.
         if (resulttype != None):
@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2015-2017 The Khronos Group Inc.
+# Copyright (c) 2015-2017 Valve Corporation
+# Copyright (c) 2015-2017 LunarG, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Turns a binary validation log, written when a layer's log_format setting is
+# "binary", back into the text the layer would have logged. The file format is
+# described in layers/vk_layer_binary_log.h.
+#
+#   vk_binary_log_decoder.py lunarg_core_validation.vkbinlog > validation.txt
+#
+# With --annotate each line also gets the time since the log was opened, the
+# thread that logged it and, for messages with a unique validation error code,
+# the VALIDATION_ERROR_ name from vk_validation_error_messages.h.
+
+import argparse
+import mmap
+import os
+import re
+import struct
+import sys
+
+FILE_HEADER = struct.Struct('8sIIQQ')
+RECORD_HEADER = struct.Struct('II')
+MESSAGE = struct.Struct('QIIiiQQIIII')
+ARG = struct.Struct('IIQ')
+
+STRING_RECORD = 1
+MESSAGE_RECORD = 2
+
+ARG_SIGNED, ARG_UNSIGNED, ARG_DOUBLE, ARG_POINTER, ARG_STRING, ARG_INLINE_STRING, ARG_NULL = range(1, 8)
+
+FLAG_NAMES = [(0x10, 'DEBUG'), (0x1, 'INFO'), (0x2, 'WARN'), (0x4, 'PERF'), (0x8, 'ERROR')]
+
+# Conversion specification as vk_layer_binary_log.h parses it
+CONVERSION = re.compile(r"%([-+ #0']*)(\*|\d+)?(?:\.(\*|\d*))?(hh|h|ll|l|z|j|t|L|I64|I32|I)?([diouxXceEfFgGaAps%n])")
+
+
+def flags_text(flags):
+    return ','.join(name for bit, name in FLAG_NAMES if flags & bit)
+
+
+def error_names(header_path):
+    names = {}
+    if header_path and os.path.exists(header_path):
+        with open(header_path) as header:
+            for match in re.finditer(r'(VALIDATION_ERROR_\w+) = (-?(?:0x)?[0-9a-fA-F]+),', header.read()):
+                names[int(match.group(2), 0)] = match.group(1)
+    return names
+
+
+def render(fmt, args):
+    """printf fmt with the decoded args, as the C library would have"""
+    args = iter(args)
+
+    def convert(match):
+        flags, width, precision, _, conversion = match.groups()
+        if conversion == '%':
+            return '%'
+        if conversion == 'n':
+            return ''
+        if width == '*':
+            width = str(next(args))
+        if precision == '*':
+            precision = str(next(args))
+        value = next(args, None)
+        spec = '%' + flags.replace("'", '') + (width or '') + ('.' + precision if precision is not None else '')
+        if conversion == 'p':
+            return (spec + 's') % ('(nil)' if not value else '0x%x' % value)
+        if conversion == 'c':
+            return (spec + 's') % chr(value & 0xff)
+        if conversion == 's':
+            return (spec + 's') % ('(null)' if value is None else value)
+        if conversion in 'aA':
+            text = float(value).hex()
+            return (spec + 's') % (text.upper() if conversion == 'A' else text)
+        if conversion in 'iu':
+            conversion = 'd'
+        return (spec + conversion) % value
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def decode(path, out, annotate, names):
+    with open(path, 'rb') as log:
+        data = mmap.mmap(log.fileno(), 0, access=mmap.ACCESS_READ)
+        magic, version, byte_order, _, start_unix_ns = FILE_HEADER.unpack_from(data, 0)
+        if magic != b'VKBINLOG' or byte_order != 0x01020304:
+            sys.exit('%s is not a binary validation log written on a machine with this byte order' % path)
+        if version != 1:
+            sys.exit('%s is version %d; this decoder reads version 1' % (path, version))
+
+        strings = {}
+        offset = FILE_HEADER.size
+        while offset + RECORD_HEADER.size <= len(data):
+            size, record_type = RECORD_HEADER.unpack_from(data, offset)
+            if size < RECORD_HEADER.size or offset + size > len(data):
+                break  # Cut off mid record, e.g. by a crash
+            body = offset + RECORD_HEADER.size
+            if record_type == STRING_RECORD:
+                string_id, length = struct.unpack_from('II', data, body)
+                strings[string_id] = data[body + 8:body + 8 + length].decode('utf-8', 'replace')
+            elif record_type == MESSAGE_RECORD:
+                (time_ns, thread, flags, code, object_type, handle, location, prefix_id, format_id, arg_count,
+                 _) = MESSAGE.unpack_from(data, body)
+                position = body + MESSAGE.size
+                args = []
+                for _ in range(arg_count):
+                    kind, aux, value = ARG.unpack_from(data, position)
+                    position += ARG.size
+                    if kind == ARG_SIGNED:
+                        value = struct.unpack('q', struct.pack('Q', value))[0]
+                    elif kind == ARG_DOUBLE:
+                        value = struct.unpack('d', struct.pack('Q', value))[0]
+                    elif kind == ARG_STRING:
+                        value = strings[aux]
+                    elif kind == ARG_INLINE_STRING:
+                        value = data[position:position + aux].decode('utf-8', 'replace')
+                        position += (aux + 7) & ~7
+                    elif kind == ARG_NULL:
+                        value = None
+                    args.append(value)
+                text = render(strings[format_id], args)
+                if annotate:
+                    name = names.get(code)
+                    out.write('[%12.6f thread %u%s] ' % (time_ns / 1e9, thread, ' ' + name if name else ''))
+                out.write('%s(%s): object: 0x%x type: %d location: %d msgCode: %d: %s\n' %
+                          (strings[prefix_id], flags_text(flags), handle, object_type, location, code, text))
+            offset += size
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Render a binary validation layer log as text.')
+    parser.add_argument('log', help='file written with <LayerIdentifier>.log_format = binary')
+    parser.add_argument('--annotate', action='store_true',
+                        help='prefix each line with its time, thread and validation error name')
+    parser.add_argument('--header', default=os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'layers',
+                                                         'vk_validation_error_messages.h'),
+                        help='vk_validation_error_messages.h to take validation error names from')
+    args = parser.parse_args()
+    decode(args.log, sys.stdout, args.annotate, error_names(args.header) if args.annotate else {})
+
+
+if __name__ == '__main__':
+    main()
@@ -35,12 +35,18 @@
 #include "icd-spv.h"
 #include "test_common.h"
 #include "vk_layer_config.h"
+#include "vk_layer_log_sink.h"
 #include "vk_format_utils.h"
 #include "vk_validation_error_messages.h"
 #include "vkrenderframework.h"
 
 #include <algorithm>
+#include <chrono>
 #include <limits.h>
+#include <memory>
+#include <sstream>
+#include <sys/stat.h>
+#include <thread>
 #include <unordered_set>
 
 #define GLM_FORCE_RADIANS
@@ -346,6 +352,30 @@ static VKAPI_ATTR VkBool32 VKAPI_CALL myDbgFunc(VkFlags msgFlags, VkDebugReportO
     return false;
 }
 
+// Sets a layer setting for as long as it is in scope, as if it were in vk_layer_settings.txt, and restores the previous
+// value afterwards. Layers read their settings when an instance or device is created, so create those afterwards.
+// The layers only see the change where they share this process's copy of VkLayer_utils, which is not the case on
+// Windows or Android; tests check Supported() and skip there.
+class ScopedLayerSetting {
+   public:
+    ScopedLayerSetting(const char *option, const char *value) : option_(option), previous_(getLayerOption(option)) {
+        setLayerOption(option, value);
+    }
+    ~ScopedLayerSetting() { setLayerOption(option_.c_str(), previous_.c_str()); }
+
+    static bool Supported() {
+#if defined(_WIN32) || defined(__ANDROID__)
+        return false;
+#else
+        return true;
+#endif
+    }
+
+   private:
+    std::string option_;
+    std::string previous_;
+};
+
 class VkLayerTest : public VkRenderFramework {
    public:
     void VKTriangleTest(const char *vertShaderText, const char *fragShaderText, BsoFailSelect failMask);
@@ -929,6 +959,75 @@ TEST_F(VkLayerTest, ReservedParameter) {
     m_errorMonitor->VerifyFound();
 }
 
+// Create an event with a reserved flag set, which parameter_validation reports against object 0 every time
+static VkResult CreateEventWithReservedFlag(VkDevice device) {
+    VkEvent event_handle = VK_NULL_HANDLE;
+    VkEventCreateInfo event_info = {};
+    event_info.sType = VK_STRUCTURE_TYPE_EVENT_CREATE_INFO;
+    event_info.flags = 1;
+    VkResult result = vkCreateEvent(device, &event_info, NULL, &event_handle);
+    if (event_handle != VK_NULL_HANDLE) vkDestroyEvent(device, event_handle, NULL);
+    return result;
+}
+
+TEST_F(VkLayerTest, DuplicateMessageLimitSuppressesRepeats) {
+    TEST_DESCRIPTION(
+        "With duplicate_message_limit set to 1, report the same error for the same object ten times: only the first is "
+        "delivered, the held back ones still skip the call as the callback asked the first time, and a second later a summary "
+        "says how many were held back.");
+
+    if (!ScopedLayerSetting::Supported()) {
+        printf("             Layer settings can't be changed from this test on this platform; skipped.\n");
+        return;
+    }
+    ScopedLayerSetting duplicate_limit("lunarg_parameter_validation.duplicate_message_limit", "1");
+    ASSERT_NO_FATAL_FAILURE(Init());
+
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, " must be 0");
+    for (uint32_t i = 0; i < 10; i++) {
+        // The error monitor asks for the first one to be skipped, and the other nine must be skipped the same way
+        EXPECT_EQ(VK_ERROR_VALIDATION_FAILED_EXT, CreateEventWithReservedFlag(device())) << "call " << i;
+    }
+    EXPECT_TRUE(m_errorMonitor->GetOtherFailureMsgs().empty());
+    m_errorMonitor->VerifyFound();
+
+    // The next message after the summary interval brings out the summary, and is itself held back
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, "9 more messages with ID");
+    EXPECT_EQ(VK_ERROR_VALIDATION_FAILED_EXT, CreateEventWithReservedFlag(device()));
+    EXPECT_TRUE(m_errorMonitor->GetOtherFailureMsgs().empty());
+    m_errorMonitor->VerifyFound();
+}
+
+TEST_F(VkLayerTest, MessageRateLimitSuppressesRepeats) {
+    TEST_DESCRIPTION(
+        "With message_rate_limit set to 1, report the same error ten times in quick succession: only the first is delivered "
+        "and the held back ones still skip the call. A second later the error is delivered again, after a summary that says "
+        "how many were held back.");
+
+    if (!ScopedLayerSetting::Supported()) {
+        printf("             Layer settings can't be changed from this test on this platform; skipped.\n");
+        return;
+    }
+    ScopedLayerSetting rate_limit("lunarg_parameter_validation.message_rate_limit", "1");
+    ASSERT_NO_FATAL_FAILURE(Init());
+
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, " must be 0");
+    for (uint32_t i = 0; i < 10; i++) {
+        EXPECT_EQ(VK_ERROR_VALIDATION_FAILED_EXT, CreateEventWithReservedFlag(device())) << "call " << i;
+    }
+    EXPECT_TRUE(m_errorMonitor->GetOtherFailureMsgs().empty());
+    m_errorMonitor->VerifyFound();
+
+    // A new one second window; unlike the duplicate limit, the rate limit lets the same error through again
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, "9 more messages with ID");
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, " must be 0");
+    EXPECT_EQ(VK_ERROR_VALIDATION_FAILED_EXT, CreateEventWithReservedFlag(device()));
+    EXPECT_TRUE(m_errorMonitor->GetOtherFailureMsgs().empty());
+    m_errorMonitor->VerifyFound();
+}
+
 TEST_F(VkLayerTest, InvalidStructSType) {
     TEST_DESCRIPTION(
         "Specify an invalid VkStructureType for a Vulkan "
@@ -1652,6 +1751,79 @@ TEST_F(VkLayerTest, InvalidMemoryAliasing) {
     vkFreeMemory(m_device->device(), mem_img, NULL);
 }
 
+TEST_F(VkLayerTest, BindManyBuffersToOneAllocation) {
+    TEST_DESCRIPTION(
+        "Sub-allocate many buffers side by side from a single memory allocation, which must not report any aliasing, "
+        "then bind an optimally tiled image over the middle of them, which must.");
+
+    ASSERT_NO_FATAL_FAILURE(Init());
+
+    VkBufferCreateInfo buf_info = {};
+    buf_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buf_info.size = 256;
+    buf_info.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    buf_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    const uint32_t buffer_count = 64;
+    std::vector<VkBuffer> buffers(buffer_count);
+    for (auto &buffer : buffers) {
+        ASSERT_VK_SUCCESS(vkCreateBuffer(m_device->device(), &buf_info, NULL, &buffer));
+    }
+    VkMemoryRequirements buf_mem_reqs;
+    vkGetBufferMemoryRequirements(m_device->device(), buffers[0], &buf_mem_reqs);
+    const VkDeviceSize stride = (buf_mem_reqs.size + buf_mem_reqs.alignment - 1) & ~(buf_mem_reqs.alignment - 1);
+
+    VkImageCreateInfo image_create_info = {};
+    image_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    image_create_info.imageType = VK_IMAGE_TYPE_2D;
+    image_create_info.format = VK_FORMAT_R8G8B8A8_UNORM;
+    image_create_info.extent = {64, 64, 1};
+    image_create_info.mipLevels = 1;
+    image_create_info.arrayLayers = 1;
+    image_create_info.samples = VK_SAMPLE_COUNT_1_BIT;
+    // Image tiling must be optimal to trigger the warning when aliasing linear buffers
+    image_create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    image_create_info.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    image_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    VkImage image;
+    ASSERT_VK_SUCCESS(vkCreateImage(m_device->device(), &image_create_info, NULL, &image));
+    VkMemoryRequirements img_mem_reqs;
+    vkGetImageMemoryRequirements(m_device->device(), image, &img_mem_reqs);
+    const VkDeviceSize image_offset =
+        (stride * buffer_count / 2 + img_mem_reqs.alignment - 1) & ~(img_mem_reqs.alignment - 1);
+
+    VkMemoryAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = std::max(stride * buffer_count, image_offset + img_mem_reqs.size);
+    bool pass = m_device->phy().set_memory_type(buf_mem_reqs.memoryTypeBits & img_mem_reqs.memoryTypeBits, &alloc_info, 0);
+    VkDeviceMemory mem = VK_NULL_HANDLE;
+    if (pass) {
+        pass = (vkAllocateMemory(m_device->device(), &alloc_info, NULL, &mem) == VK_SUCCESS);
+    }
+    if (pass) {
+        m_errorMonitor->ExpectSuccess();
+        for (uint32_t i = 0; i < buffer_count; i++) {
+            ASSERT_VK_SUCCESS(vkBindBufferMemory(m_device->device(), buffers[i], mem, stride * i));
+        }
+        m_errorMonitor->VerifyNotFound();
+
+        m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_WARNING_BIT_EXT, " is aliased with linear buffer 0x");
+        vkBindImageMemory(m_device->device(), image, mem, image_offset);
+        m_errorMonitor->VerifyFound();
+    } else {
+        printf("             Unable to allocate memory shared by buffers and an image; skipped.\n");
+    }
+
+    vkDestroyImage(m_device->device(), image, NULL);
+    for (auto buffer : buffers) {
+        vkDestroyBuffer(m_device->device(), buffer, NULL);
+    }
+    if (mem != VK_NULL_HANDLE) {
+        vkFreeMemory(m_device->device(), mem, NULL);
+    }
+}
+
 TEST_F(VkLayerTest, InvalidMemoryMapping) {
     TEST_DESCRIPTION("Attempt to map memory in a number of incorrect ways");
     VkResult err;
@@ -2481,6 +2653,50 @@ TEST_F(VkLayerTest, UseObjectWithWrongDevice) {
     vkDestroyDevice(second_device, NULL);
 }
 
+TEST_F(VkLayerTest, UseObjectWithWrongFreshDevice) {
+    TEST_DESCRIPTION(
+        "Create a buffer as the first object of each of two new devices, then destroy one device's buffer using the other "
+        "device. Wrapped handles must be unique across devices for this to be told apart from a use on the right device.");
+    ASSERT_NO_FATAL_FAILURE(Init());
+
+    float priorities[] = {1.0f};
+    VkDeviceQueueCreateInfo queue_info = {};
+    queue_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queue_info.queueFamilyIndex = 0;
+    queue_info.queueCount = 1;
+    queue_info.pQueuePriorities = &priorities[0];
+
+    VkDeviceCreateInfo device_create_info = {};
+    auto features = m_device->phy().features();
+    device_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    device_create_info.queueCreateInfoCount = 1;
+    device_create_info.pQueueCreateInfos = &queue_info;
+    device_create_info.pEnabledFeatures = &features;
+
+    VkBufferCreateInfo buffer_info = {};
+    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffer_info.size = 256;
+    buffer_info.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VkDevice devices[2];
+    VkBuffer buffers[2];
+    for (uint32_t i = 0; i < 2; i++) {
+        ASSERT_VK_SUCCESS(vkCreateDevice(gpu(), &device_create_info, NULL, &devices[i]));
+        ASSERT_VK_SUCCESS(vkCreateBuffer(devices[i], &buffer_info, NULL, &buffers[i]));
+    }
+    EXPECT_NE(buffers[0], buffers[1]);
+
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, VALIDATION_ERROR_23c01a07);
+    vkDestroyBuffer(devices[1], buffers[0], NULL);
+    m_errorMonitor->VerifyFound();
+
+    for (uint32_t i = 0; i < 2; i++) {
+        vkDestroyBuffer(devices[i], buffers[i], NULL);
+        vkDestroyDevice(devices[i], NULL);
+    }
+}
+
 TEST_F(VkLayerTest, PipelineNotBound) {
     VkResult err;
 
@@ -4183,6 +4399,39 @@ TEST_F(VkLayerTest, DynamicLineWidthNotBound) {
     m_errorMonitor->VerifyFound();
 }
 
+TEST_F(VkLayerTest, DynamicLineWidthNotBoundUnsampled) {
+    TEST_DESCRIPTION(
+        "Check that validation_sample_rate is read for each device: with a high rate, a draw missing its dynamic line "
+        "width in a recording that isn't sampled goes unreported; with a rate of 1 on the next device it is reported.");
+
+    if (!ScopedLayerSetting::Supported()) {
+        printf("             Layer settings can't be changed from this test on this platform; skipped.\n");
+        return;
+    }
+    const char *rates[] = {"1000000", "1"};
+    for (auto rate : rates) {
+        ScopedLayerSetting sample_rate("lunarg_core_validation.validation_sample_rate", rate);
+        ASSERT_NO_FATAL_FAILURE(Init());
+        // Only the first recording of the device is sampled at the high rate, so use it up
+        m_commandBuffer->BeginCommandBuffer();
+        m_commandBuffer->EndCommandBuffer();
+
+        if (!strcmp(rate, "1")) {
+            m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                                                 "Dynamic line width state not set for this command buffer");
+            VKTriangleTest(bindStateVertShaderText, bindStateFragShaderText, BsoFailLineWidth);
+            m_errorMonitor->VerifyFound();
+        } else {
+            m_errorMonitor->ExpectSuccess();
+            VKTriangleTest(bindStateVertShaderText, bindStateFragShaderText, BsoFailLineWidth);
+            m_errorMonitor->VerifyNotFound();
+        }
+
+        // The setting is read when the device is created
+        ShutdownFramework();
+    }
+}
+
 TEST_F(VkLayerTest, DynamicViewportNotBound) {
     TEST_DESCRIPTION(
         "Run a simple draw calls to validate failure when Viewport dynamic "
@@ -4328,6 +4577,52 @@ TEST_F(VkLayerTest, CommandBufferTwoSubmits) {
     m_errorMonitor->VerifyFound();
 }
 
+TEST_F(VkLayerTest, CommandBufferUnendedAmongManySubmitted) {
+    TEST_DESCRIPTION(
+        "Submit 64 command buffers in one vkQueueSubmit call where one of them was never ended, once with the command buffers "
+        "checked inline and once with them checked on the validation worker threads.");
+
+    const uint32_t cb_count = 64;
+    const uint32_t unended_index = 37;
+    const char *const modes[] = {"false", "true"};
+    for (auto parallel : modes) {
+        if (!strcmp(parallel, "true") && !ScopedLayerSetting::Supported()) {
+            printf("             Layer settings can't be changed from this test on this platform; parallel run skipped.\n");
+            break;
+        }
+        ScopedLayerSetting parallel_submit("lunarg_core_validation.parallel_submit_validation", parallel);
+        ASSERT_NO_FATAL_FAILURE(Init());
+
+        {
+            VkCommandPoolObj pool(m_device, m_device->graphics_queue_node_index_);
+            std::vector<std::unique_ptr<VkCommandBufferObj>> command_buffers;
+            std::vector<VkCommandBuffer> handles;
+            for (uint32_t i = 0; i < cb_count; i++) {
+                command_buffers.emplace_back(new VkCommandBufferObj(m_device, &pool));
+                command_buffers.back()->BeginCommandBuffer();
+                if (i != unended_index) command_buffers.back()->EndCommandBuffer();
+                handles.push_back(command_buffers.back()->handle());
+            }
+
+            VkSubmitInfo submit_info = {};
+            submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submit_info.commandBufferCount = cb_count;
+            submit_info.pCommandBuffers = handles.data();
+
+            m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                                                 "You must call vkEndCommandBuffer() on command buffer");
+            vkQueueSubmit(m_device->m_queue, 1, &submit_info, VK_NULL_HANDLE);
+            m_errorMonitor->VerifyFound();
+
+            vkQueueWaitIdle(m_device->m_queue);
+            command_buffers[unended_index]->EndCommandBuffer();
+        }
+
+        // The setting is read when the device is created
+        ShutdownFramework();
+    }
+}
+
 TEST_F(VkLayerTest, AllocDescriptorFromEmptyPool) {
     TEST_DESCRIPTION("Attempt to allocate more sets and descriptors than descriptor pool has available.");
     VkResult err;
@@ -6692,6 +6987,123 @@ TEST_F(VkLayerTest, DescriptorSetNotUpdated) {
     vkDestroyDescriptorPool(m_device->device(), ds_pool, NULL);
 }
 
+TEST_F(VkLayerTest, AsyncValidationReportsDescriptorSetNotUpdated) {
+    TEST_DESCRIPTION(
+        "With async_validation set, draw with a descriptor set that hasn't been updated and check that the check "
+        "deferred to the background thread reports it by the time the command buffer is submitted.");
+    VkResult err;
+
+    if (!ScopedLayerSetting::Supported()) {
+        printf("             Layer settings can't be changed from this test on this platform; skipped.\n");
+        return;
+    }
+    // The setting is read when the device is created
+    ScopedLayerSetting async_validation("lunarg_core_validation.async_validation", "true");
+    ASSERT_NO_FATAL_FAILURE(Init());
+    ASSERT_NO_FATAL_FAILURE(InitViewport());
+    ASSERT_NO_FATAL_FAILURE(InitRenderTarget());
+
+    VkDescriptorPoolSize ds_type_count = {};
+    ds_type_count.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    ds_type_count.descriptorCount = 1;
+
+    VkDescriptorPoolCreateInfo ds_pool_ci = {};
+    ds_pool_ci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    ds_pool_ci.maxSets = 1;
+    ds_pool_ci.poolSizeCount = 1;
+    ds_pool_ci.pPoolSizes = &ds_type_count;
+
+    VkDescriptorPool ds_pool;
+    err = vkCreateDescriptorPool(m_device->device(), &ds_pool_ci, NULL, &ds_pool);
+    ASSERT_VK_SUCCESS(err);
+
+    VkDescriptorSetLayoutBinding dsl_binding = {};
+    dsl_binding.binding = 0;
+    dsl_binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    dsl_binding.descriptorCount = 1;
+    dsl_binding.stageFlags = VK_SHADER_STAGE_ALL;
+    dsl_binding.pImmutableSamplers = NULL;
+
+    VkDescriptorSetLayoutCreateInfo ds_layout_ci = {};
+    ds_layout_ci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    ds_layout_ci.bindingCount = 1;
+    ds_layout_ci.pBindings = &dsl_binding;
+    VkDescriptorSetLayout ds_layout;
+    err = vkCreateDescriptorSetLayout(m_device->device(), &ds_layout_ci, NULL, &ds_layout);
+    ASSERT_VK_SUCCESS(err);
+
+    VkDescriptorSet descriptorSet;
+    VkDescriptorSetAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorSetCount = 1;
+    alloc_info.descriptorPool = ds_pool;
+    alloc_info.pSetLayouts = &ds_layout;
+    err = vkAllocateDescriptorSets(m_device->device(), &alloc_info, &descriptorSet);
+    ASSERT_VK_SUCCESS(err);
+
+    VkPipelineLayoutCreateInfo pipeline_layout_ci = {};
+    pipeline_layout_ci.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_ci.setLayoutCount = 1;
+    pipeline_layout_ci.pSetLayouts = &ds_layout;
+
+    VkPipelineLayout pipeline_layout;
+    err = vkCreatePipelineLayout(m_device->device(), &pipeline_layout_ci, NULL, &pipeline_layout);
+    ASSERT_VK_SUCCESS(err);
+
+    char const *vsSource =
+        "#version 450\n"
+        "\n"
+        "void main(){\n"
+        "   gl_Position = vec4(1);\n"
+        "}\n";
+    char const *fsSource =
+        "#version 450\n"
+        "\n"
+        "layout(location=0) out vec4 x;\n"
+        "layout(set=0) layout(binding=0) uniform foo { int x; int y; } bar;\n"
+        "void main(){\n"
+        "   x = vec4(bar.y);\n"
+        "}\n";
+    VkShaderObj vs(m_device, vsSource, VK_SHADER_STAGE_VERTEX_BIT, this);
+    VkShaderObj fs(m_device, fsSource, VK_SHADER_STAGE_FRAGMENT_BIT, this);
+    VkPipelineObj pipe(m_device);
+    pipe.AddShader(&vs);
+    pipe.AddShader(&fs);
+    pipe.AddColorAttachment();
+    pipe.CreateVKPipeline(pipeline_layout, renderPass());
+
+    // Only the deferred check names the command buffer, so this can't be satisfied by the draw checking synchronously
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                                         "encountered the following validation error at vkCmdDraw() time in command buffer");
+
+    m_commandBuffer->BeginCommandBuffer();
+    m_commandBuffer->BeginRenderPass(m_renderPassBeginInfo);
+    vkCmdBindPipeline(m_commandBuffer->GetBufferHandle(), VK_PIPELINE_BIND_POINT_GRAPHICS, pipe.handle());
+    vkCmdBindDescriptorSets(m_commandBuffer->GetBufferHandle(), VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, 0, 1,
+                            &descriptorSet, 0, NULL);
+
+    vkCmdSetViewport(m_commandBuffer->handle(), 0, 1, &m_viewports[0]);
+    vkCmdSetScissor(m_commandBuffer->handle(), 0, 1, &m_scissors[0]);
+
+    Draw(1, 0, 0, 0);
+    m_commandBuffer->EndRenderPass();
+    m_commandBuffer->EndCommandBuffer();
+
+    // vkQueueSubmit waits for the deferred checks, so the error must be in by the time it returns
+    VkSubmitInfo submit_info = {};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &m_commandBuffer->handle();
+    vkQueueSubmit(m_device->m_queue, 1, &submit_info, VK_NULL_HANDLE);
+    m_errorMonitor->VerifyFound();
+    vkQueueWaitIdle(m_device->m_queue);
+
+    vkDestroyPipelineLayout(m_device->device(), pipeline_layout, NULL);
+    vkDestroyDescriptorSetLayout(m_device->device(), ds_layout, NULL);
+    vkDestroyDescriptorPool(m_device->device(), ds_pool, NULL);
+    ShutdownFramework();
+}
+
 TEST_F(VkLayerTest, InvalidBufferViewObject) {
     // Create a single TEXEL_BUFFER descriptor and send it an invalid bufferView
     VkResult err;
@@ -6970,6 +7382,148 @@ TEST_F(VkLayerTest, InvalidDynamicOffsetCases) {
     vkDestroyDescriptorPool(m_device->device(), ds_pool, NULL);
 }
 
+TEST_F(VkLayerTest, DynamicOffsetOverstepAfterRepeatedDraws) {
+    TEST_DESCRIPTION(
+        "Draw several times with unchanged valid state, then rebind the "
+        "descriptor set with a dynamic offset that oversteps its buffer and "
+        "verify the next draw is still validated");
+
+    ASSERT_NO_FATAL_FAILURE(Init());
+    ASSERT_NO_FATAL_FAILURE(InitViewport());
+    ASSERT_NO_FATAL_FAILURE(InitRenderTarget());
+
+    VkDescriptorPoolSize ds_type_count = {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1};
+    VkDescriptorPoolCreateInfo ds_pool_ci = {};
+    ds_pool_ci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    ds_pool_ci.maxSets = 1;
+    ds_pool_ci.poolSizeCount = 1;
+    ds_pool_ci.pPoolSizes = &ds_type_count;
+    VkDescriptorPool ds_pool;
+    VkResult err = vkCreateDescriptorPool(m_device->device(), &ds_pool_ci, NULL, &ds_pool);
+    ASSERT_VK_SUCCESS(err);
+
+    VkDescriptorSetLayoutBinding dsl_binding = {0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_ALL, NULL};
+    VkDescriptorSetLayoutCreateInfo ds_layout_ci = {};
+    ds_layout_ci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    ds_layout_ci.bindingCount = 1;
+    ds_layout_ci.pBindings = &dsl_binding;
+    VkDescriptorSetLayout ds_layout;
+    err = vkCreateDescriptorSetLayout(m_device->device(), &ds_layout_ci, NULL, &ds_layout);
+    ASSERT_VK_SUCCESS(err);
+
+    VkDescriptorSet descriptorSet;
+    VkDescriptorSetAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorSetCount = 1;
+    alloc_info.descriptorPool = ds_pool;
+    alloc_info.pSetLayouts = &ds_layout;
+    err = vkAllocateDescriptorSets(m_device->device(), &alloc_info, &descriptorSet);
+    ASSERT_VK_SUCCESS(err);
+
+    VkPipelineLayoutCreateInfo pipeline_layout_ci = {};
+    pipeline_layout_ci.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_ci.setLayoutCount = 1;
+    pipeline_layout_ci.pSetLayouts = &ds_layout;
+    VkPipelineLayout pipeline_layout;
+    err = vkCreatePipelineLayout(m_device->device(), &pipeline_layout_ci, NULL, &pipeline_layout);
+    ASSERT_VK_SUCCESS(err);
+
+    uint32_t qfi = 0;
+    VkBufferCreateInfo buffCI = {};
+    buffCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffCI.size = 1024;
+    buffCI.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    buffCI.queueFamilyIndexCount = 1;
+    buffCI.pQueueFamilyIndices = &qfi;
+    VkBuffer dyub;
+    err = vkCreateBuffer(m_device->device(), &buffCI, NULL, &dyub);
+    ASSERT_VK_SUCCESS(err);
+
+    VkMemoryRequirements memReqs;
+    vkGetBufferMemoryRequirements(m_device->device(), dyub, &memReqs);
+    VkMemoryAllocateInfo mem_alloc = {};
+    mem_alloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    mem_alloc.allocationSize = memReqs.size;
+    bool pass = m_device->phy().set_memory_type(memReqs.memoryTypeBits, &mem_alloc, 0);
+    if (!pass) {
+        vkDestroyBuffer(m_device->device(), dyub, NULL);
+        return;
+    }
+    VkDeviceMemory mem;
+    err = vkAllocateMemory(m_device->device(), &mem_alloc, NULL, &mem);
+    ASSERT_VK_SUCCESS(err);
+    err = vkBindBufferMemory(m_device->device(), dyub, mem, 0);
+    ASSERT_VK_SUCCESS(err);
+
+    VkDescriptorBufferInfo buffInfo = {dyub, 0, 512};
+    VkWriteDescriptorSet descriptor_write = {};
+    descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptor_write.dstSet = descriptorSet;
+    descriptor_write.dstBinding = 0;
+    descriptor_write.descriptorCount = 1;
+    descriptor_write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    descriptor_write.pBufferInfo = &buffInfo;
+    vkUpdateDescriptorSets(m_device->device(), 1, &descriptor_write, 0, NULL);
+
+    char const *vsSource =
+        "#version 450\n"
+        "\n"
+        "void main(){\n"
+        "   gl_Position = vec4(1);\n"
+        "}\n";
+    char const *fsSource =
+        "#version 450\n"
+        "\n"
+        "layout(location=0) out vec4 x;\n"
+        "layout(set=0) layout(binding=0) uniform foo { int x; int y; } bar;\n"
+        "void main(){\n"
+        "   x = vec4(bar.y);\n"
+        "}\n";
+    VkShaderObj vs(m_device, vsSource, VK_SHADER_STAGE_VERTEX_BIT, this);
+    VkShaderObj fs(m_device, fsSource, VK_SHADER_STAGE_FRAGMENT_BIT, this);
+    VkPipelineObj pipe(m_device);
+    pipe.AddShader(&vs);
+    pipe.AddShader(&fs);
+    pipe.AddColorAttachment();
+    pipe.CreateVKPipeline(pipeline_layout, renderPass());
+
+    m_errorMonitor->ExpectSuccess();
+    m_commandBuffer->BeginCommandBuffer();
+    m_commandBuffer->BeginRenderPass(m_renderPassBeginInfo);
+    VkViewport viewport = {0, 0, 16, 16, 0, 1};
+    vkCmdSetViewport(m_commandBuffer->handle(), 0, 1, &viewport);
+    VkRect2D scissor = {{0, 0}, {16, 16}};
+    vkCmdSetScissor(m_commandBuffer->handle(), 0, 1, &scissor);
+    vkCmdBindPipeline(m_commandBuffer->GetBufferHandle(), VK_PIPELINE_BIND_POINT_GRAPHICS, pipe.handle());
+
+    // Offset 256 with range 512 fits in the 1024 byte buffer, so repeated draws are clean
+    uint32_t dyn_offset = 256;
+    vkCmdBindDescriptorSets(m_commandBuffer->GetBufferHandle(), VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, 0, 1,
+                            &descriptorSet, 1, &dyn_offset);
+    for (uint32_t i = 0; i < 4; i++) {
+        Draw(1, 0, 0, 0);
+    }
+    m_errorMonitor->VerifyNotFound();
+
+    // Offset 768 oversteps it; the draw after rebinding must be checked again rather than reuse the earlier result
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                                         " dynamic offset 768 combined with "
+                                         "offset 0 and range 512 that "
+                                         "oversteps the buffer size of 1024");
+    dyn_offset = 768;
+    vkCmdBindDescriptorSets(m_commandBuffer->GetBufferHandle(), VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, 0, 1,
+                            &descriptorSet, 1, &dyn_offset);
+    Draw(1, 0, 0, 0);
+    m_errorMonitor->VerifyFound();
+
+    vkDestroyBuffer(m_device->device(), dyub, NULL);
+    vkFreeMemory(m_device->device(), mem, NULL);
+
+    vkDestroyPipelineLayout(m_device->device(), pipeline_layout, NULL);
+    vkDestroyDescriptorSetLayout(m_device->device(), ds_layout, NULL);
+    vkDestroyDescriptorPool(m_device->device(), ds_pool, NULL);
+}
+
 TEST_F(VkLayerTest, DescriptorBufferUpdateNoMemoryBound) {
     TEST_DESCRIPTION(
         "Attempt to update a descriptor with a non-sparse buffer "
@@ -13030,6 +13584,65 @@ TEST_F(VkLayerTest, InvalidStorageImageLayout) {
     vkDestroyDescriptorPool(m_device->device(), ds_pool, NULL);
 }
 
+TEST_F(VkLayerTest, SubmitImageLayoutMismatchOnSingleMipLevel) {
+    TEST_DESCRIPTION(
+        "Transition a whole image and then a single mip level of it in one command buffer, then submit a second command "
+        "buffer whose first use of the whole image assumes the earlier whole-image layout.");
+
+    ASSERT_NO_FATAL_FAILURE(Init());
+    VkImageObj image(m_device);
+    image.Init(64, 64, 4, VK_FORMAT_B8G8R8A8_UNORM, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+               VK_IMAGE_TILING_OPTIMAL, 0);
+    ASSERT_TRUE(image.initialized());
+
+    VkImageMemoryBarrier img_barrier = {};
+    img_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    img_barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    img_barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    img_barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    img_barrier.image = image.handle();
+    img_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    img_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    img_barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    img_barrier.subresourceRange.baseArrayLayer = 0;
+    img_barrier.subresourceRange.baseMipLevel = 0;
+    img_barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+    img_barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+
+    // Whole image to TRANSFER_DST, then only mip level 2 on to GENERAL
+    m_errorMonitor->ExpectSuccess();
+    VkCommandBufferObj cmd_buf(m_device, m_commandPool);
+    cmd_buf.BeginCommandBuffer();
+    vkCmdPipelineBarrier(cmd_buf.handle(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0,
+                         nullptr, 1, &img_barrier);
+    img_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    img_barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    img_barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    img_barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    img_barrier.subresourceRange.baseMipLevel = 2;
+    img_barrier.subresourceRange.levelCount = 1;
+    vkCmdPipelineBarrier(cmd_buf.handle(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0,
+                         nullptr, 1, &img_barrier);
+    cmd_buf.EndCommandBuffer();
+    cmd_buf.QueueCommandBuffer();
+    m_errorMonitor->VerifyNotFound();
+
+    // The second command buffer expects every mip level in TRANSFER_DST, but mip level 2 is in GENERAL
+    img_barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    img_barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    img_barrier.subresourceRange.baseMipLevel = 0;
+    img_barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+    m_commandBuffer->BeginCommandBuffer();
+    vkCmdPipelineBarrier(m_commandBuffer->handle(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr,
+                         0, nullptr, 1, &img_barrier);
+    m_commandBuffer->EndCommandBuffer();
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                                         "[sub-resource: aspectMask 0x1 array layer 0, mip level 2], with layout "
+                                         "VK_IMAGE_LAYOUT_GENERAL when first use is VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL.");
+    m_commandBuffer->QueueCommandBuffer(false);
+    m_errorMonitor->VerifyFound();
+}
+
 TEST_F(VkLayerTest, NonSimultaneousSecondaryMarksPrimary) {
     ASSERT_NO_FATAL_FAILURE(Init());
     const char *simultaneous_use_message =
@@ -13378,6 +13991,50 @@ TEST_F(VkLayerTest, InUseDestroyedSignaled) {
     vkDestroyPipelineLayout(m_device->device(), pipeline_layout, nullptr);
 }
 
+TEST_F(VkLayerTest, BufferInUseAmongManyDestroyedSignaled) {
+    TEST_DESCRIPTION(
+        "Submit a command buffer that writes to many buffers and delete one of them while it is in flight, then again once "
+        "the submission has retired.");
+
+    ASSERT_NO_FATAL_FAILURE(Init());
+
+    const uint32_t buffer_count = 256;
+    VkMemoryPropertyFlags reqs = 0;
+    std::vector<std::unique_ptr<vk_testing::Buffer>> buffers;
+    for (uint32_t i = 0; i < buffer_count; i++) {
+        buffers.emplace_back(new vk_testing::Buffer);
+        buffers.back()->init_as_dst(*m_device, (VkDeviceSize)256, reqs);
+    }
+
+    m_commandBuffer->BeginCommandBuffer();
+    for (auto &buffer : buffers) {
+        vkCmdFillBuffer(m_commandBuffer->handle(), buffer->handle(), 0, VK_WHOLE_SIZE, 0);
+    }
+    m_commandBuffer->EndCommandBuffer();
+
+    VkFenceCreateInfo fence_create_info = {VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, nullptr, 0};
+    VkFence fence;
+    ASSERT_VK_SUCCESS(vkCreateFence(m_device->device(), &fence_create_info, nullptr, &fence));
+
+    VkSubmitInfo submit_info = {};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &m_commandBuffer->handle();
+    vkQueueSubmit(m_device->m_queue, 1, &submit_info, fence);
+
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, VALIDATION_ERROR_23c00734);
+    vkDestroyBuffer(m_device->device(), buffers[buffer_count / 2]->handle(), nullptr);
+    m_errorMonitor->VerifyFound();
+
+    // Once the fence retires the submission, none of the buffers are in use any more
+    m_errorMonitor->ExpectSuccess();
+    vkWaitForFences(m_device->device(), 1, &fence, VK_TRUE, UINT64_MAX);
+    buffers.clear();
+    m_errorMonitor->VerifyNotFound();
+
+    vkDestroyFence(m_device->device(), fence, nullptr);
+}
+
 TEST_F(VkLayerTest, QueryPoolInUseDestroyedSignaled) {
     TEST_DESCRIPTION("Delete in-use query pool.");
 
@@ -14294,66 +14951,521 @@ TEST_F(VkLayerTest, ThreadCommandBufferCollision) {
 
     vkDestroyEvent(device(), event, NULL);
 }
-#endif  // GTEST_IS_THREADSAFE
 
-TEST_F(VkLayerTest, InvalidSPIRVCodeSize) {
-    TEST_DESCRIPTION("Test that errors are produced for a spirv modules with invalid code sizes");
+TEST_F(VkLayerTest, ThreadCommandBufferCollisionMidFrame) {
+    TEST_DESCRIPTION(
+        "Record on one thread only, so the threading layer is not yet tracking objects, then start a second thread recording "
+        "into the same command buffer part way through.");
+    test_platform_thread thread;
 
-    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, "Invalid SPIR-V header");
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, "THREADING ERROR");
 
     ASSERT_NO_FATAL_FAILURE(Init());
-    ASSERT_NO_FATAL_FAILURE(InitRenderTarget());
-
-    VkShaderModule module;
-    VkShaderModuleCreateInfo moduleCreateInfo;
-    struct icd_spv_header spv;
 
-    spv.magic = ICD_SPV_MAGIC;
-    spv.version = ICD_SPV_VERSION;
-    spv.gen_magic = 0;
+    VkCommandBufferObj commandBuffer(m_device, m_commandPool);
+    commandBuffer.BeginCommandBuffer();
 
-    moduleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    moduleCreateInfo.pNext = NULL;
-    moduleCreateInfo.pCode = (const uint32_t *)&spv;
-    moduleCreateInfo.codeSize = 4;
-    moduleCreateInfo.flags = 0;
-    vkCreateShaderModule(m_device->device(), &moduleCreateInfo, NULL, &module);
+    VkEventCreateInfo event_info = {VK_STRUCTURE_TYPE_EVENT_CREATE_INFO, nullptr, 0};
+    VkEvent event;
+    VkResult err = vkCreateEvent(device(), &event_info, NULL, &event);
+    ASSERT_VK_SUCCESS(err);
 
-    m_errorMonitor->VerifyFound();
+    struct thread_data_struct data;
+    data.commandBuffer = commandBuffer.GetBufferHandle();
+    data.event = event;
+    data.bailout = false;
+    m_errorMonitor->SetBailout(&data.bailout);
 
-    char const *vsSource =
-        "#version 450\n"
-        "\n"
-        "layout(location=0) out float x;\n"
-        "void main(){\n"
-        "   gl_Position = vec4(1);\n"
-        "   x = 0;\n"
-        "}\n";
+    // Half a frame of single-threaded recording
+    for (int i = 0; i < 1000; i++) {
+        vkCmdSetEvent(data.commandBuffer, event, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+    }
+    // Then a second thread joins in on the same command buffer
+    test_platform_thread_create(&thread, AddToCommandBuffer, (void *)&data);
+    AddToCommandBuffer(&data);
+    test_platform_thread_join(thread, NULL);
+    commandBuffer.EndCommandBuffer();
 
-    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, VALIDATION_ERROR_12a00ac0);
-    std::vector<unsigned int> shader;
-    VkShaderModuleCreateInfo module_create_info;
-    VkShaderModule shader_module;
-    module_create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    module_create_info.pNext = NULL;
-    this->GLSLtoSPV(VK_SHADER_STAGE_VERTEX_BIT, vsSource, shader);
-    module_create_info.pCode = shader.data();
-    // Introduce failure by making codeSize a non-multiple of 4
-    module_create_info.codeSize = shader.size() * sizeof(unsigned int) - 1;
-    module_create_info.flags = 0;
-    vkCreateShaderModule(m_device->handle(), &module_create_info, NULL, &shader_module);
+    m_errorMonitor->SetBailout(NULL);
 
     m_errorMonitor->VerifyFound();
+
+    vkDestroyEvent(device(), event, NULL);
 }
 
-TEST_F(VkLayerTest, InvalidSPIRVMagic) {
+TEST_F(VkLayerTest, ThreadCommandBufferCollisionContentionReport) {
     TEST_DESCRIPTION(
-        "Test that an error is produced for a spirv module "
-        "with a bad magic number");
+        "Record into the same command buffer from two threads with contention_file set, and check that the report written "
+        "when the device is destroyed lists the command buffer with a collision the layer waited out, and the entry point "
+        "it happened in.");
 
-    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, "Invalid SPIR-V magic number");
+    if (!ScopedLayerSetting::Supported()) {
+        printf("             Layer settings can't be changed from this test on this platform; skipped.\n");
+        return;
+    }
+    const char *path = "vk_test_contention.csv";
+    remove(path);
+    {
+        ScopedLayerSetting contention_file("google_threading.contention_file", path);
+        test_platform_thread thread;
 
-    ASSERT_NO_FATAL_FAILURE(Init());
+        // Each vkCmdSetEvent also uses the command pool, and collides there first. Only the command buffer's message is
+        // matched, so the layer carries on through the pool collisions and waits out the first command buffer collision.
+        m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                                             "object of type VkCommandBuffer is simultaneously used");
+
+        ASSERT_NO_FATAL_FAILURE(Init());
+
+        VkCommandBufferObj commandBuffer(m_device, m_commandPool);
+        commandBuffer.BeginCommandBuffer();
+
+        VkEventCreateInfo event_info = {VK_STRUCTURE_TYPE_EVENT_CREATE_INFO, nullptr, 0};
+        VkEvent event;
+        VkResult err = vkCreateEvent(device(), &event_info, NULL, &event);
+        ASSERT_VK_SUCCESS(err);
+
+        // No bailout, as the pool collisions would end the recording before the command buffer collides
+        struct thread_data_struct data;
+        data.commandBuffer = commandBuffer.GetBufferHandle();
+        data.event = event;
+        data.bailout = false;
+
+        test_platform_thread_create(&thread, AddToCommandBuffer, (void *)&data);
+        AddToCommandBuffer(&data);
+        test_platform_thread_join(thread, NULL);
+        commandBuffer.EndCommandBuffer();
+
+        m_errorMonitor->VerifyFound();
+
+        vkDestroyEvent(device(), event, NULL);
+
+        // The report is written when the device is destroyed
+        ShutdownFramework();
+    }
+
+    FILE *report = fopen(path, "r");
+    ASSERT_NE(report, nullptr) << "no contention report was written to " << path;
+    std::string text;
+    unsigned long long type_collisions = 0, type_waits = 0, call_collisions = 0;
+    char line[1024];
+    while (fgets(line, sizeof(line), report)) {
+        text += line;
+        unsigned long long collisions, waits;
+        // Only the per type rows have a count right after the type; the per object rows have the handle there
+        if (sscanf(line, "VkCommandBuffer,%llu,%llu,", &collisions, &waits) == 2) {
+            type_collisions = collisions;
+            type_waits = waits;
+        }
+        if (sscanf(line, "vkCmdSetEvent,%llu,", &collisions) == 1) call_collisions = collisions;
+    }
+    fclose(report);
+    remove(path);
+
+    EXPECT_GT(type_collisions, 0u) << text;
+    EXPECT_GT(type_waits, 0u) << text;
+    EXPECT_GT(call_collisions, 0u) << text;
+}
+
+TEST_F(VkLayerTest, ThreadCommandPoolCollision) {
+    TEST_DESCRIPTION(
+        "Record into two command buffers allocated from the same command pool from two threads at once. Each recording "
+        "uses the pool, which must be externally synchronized.");
+    test_platform_thread thread;
+
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, "THREADING ERROR");
+
+    ASSERT_NO_FATAL_FAILURE(Init());
+
+    VkCommandBufferObj first(m_device, m_commandPool);
+    VkCommandBufferObj second(m_device, m_commandPool);
+    first.BeginCommandBuffer();
+    second.BeginCommandBuffer();
+
+    VkEventCreateInfo event_info = {VK_STRUCTURE_TYPE_EVENT_CREATE_INFO, nullptr, 0};
+    VkEvent event;
+    VkResult err = vkCreateEvent(device(), &event_info, NULL, &event);
+    ASSERT_VK_SUCCESS(err);
+
+    struct thread_data_struct data[2];
+    data[0].commandBuffer = first.GetBufferHandle();
+    data[1].commandBuffer = second.GetBufferHandle();
+    for (auto &d : data) {
+        d.event = event;
+        d.bailout = false;
+    }
+    m_errorMonitor->SetBailout(&data[0].bailout);
+
+    test_platform_thread_create(&thread, AddToCommandBuffer, (void *)&data[1]);
+    AddToCommandBuffer(&data[0]);
+    test_platform_thread_join(thread, NULL);
+    first.EndCommandBuffer();
+    second.EndCommandBuffer();
+
+    m_errorMonitor->SetBailout(NULL);
+
+    m_errorMonitor->VerifyFound();
+
+    vkDestroyEvent(device(), event, NULL);
+}
+
+extern "C" void *RecordOwnCommandBuffer(void *arg) {
+    struct thread_data_struct *data = (struct thread_data_struct *)arg;
+
+    for (int i = 0; i < 20000; i++) {
+        vkCmdSetEvent(data->commandBuffer, data->event, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+        vkCmdResetEvent(data->commandBuffer, data->event, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+    }
+    return NULL;
+}
+
+TEST_F(VkPositiveLayerTest, ThreadsStartedMidFrame) {
+    TEST_DESCRIPTION(
+        "Start recording threads, each with its own command pool, while the main thread is part way through recording, and "
+        "again while those threads run. Moving from single-threaded to full tracking must not report anything.");
+
+    m_errorMonitor->ExpectSuccess();
+
+    ASSERT_NO_FATAL_FAILURE(Init());
+
+    VkEventCreateInfo event_info = {VK_STRUCTURE_TYPE_EVENT_CREATE_INFO, nullptr, 0};
+    VkEvent event;
+    VkResult err = vkCreateEvent(device(), &event_info, NULL, &event);
+    ASSERT_VK_SUCCESS(err);
+
+    const uint32_t thread_count = 4;
+    std::vector<std::unique_ptr<VkCommandPoolObj>> pools;
+    std::vector<std::unique_ptr<VkCommandBufferObj>> command_buffers;
+    for (uint32_t i = 0; i <= thread_count; i++) {
+        pools.emplace_back(new VkCommandPoolObj(m_device, m_device->graphics_queue_node_index_));
+        command_buffers.emplace_back(new VkCommandBufferObj(m_device, pools.back().get()));
+        command_buffers.back()->BeginCommandBuffer();
+    }
+    std::vector<thread_data_struct> data(thread_count + 1);
+    for (uint32_t i = 0; i <= thread_count; i++) {
+        data[i].commandBuffer = command_buffers[i]->GetBufferHandle();
+        data[i].event = event;
+        data[i].bailout = false;
+    }
+
+    // The main thread records into the last command buffer throughout, starting the others one at a time as it goes
+    std::vector<test_platform_thread> threads(thread_count);
+    for (uint32_t i = 0; i < thread_count; i++) {
+        for (int j = 0; j < 1000; j++) {
+            vkCmdSetEvent(data[thread_count].commandBuffer, event, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+        }
+        test_platform_thread_create(&threads[i], RecordOwnCommandBuffer, (void *)&data[i]);
+    }
+    RecordOwnCommandBuffer(&data[thread_count]);
+    for (uint32_t i = 0; i < thread_count; i++) {
+        test_platform_thread_join(threads[i], NULL);
+    }
+    for (auto &command_buffer : command_buffers) {
+        command_buffer->EndCommandBuffer();
+    }
+
+    vkDestroyEvent(device(), event, NULL);
+
+    m_errorMonitor->VerifyNotFound();
+}
+
+extern "C" void *CreateAndDestroyBuffers(void *arg) {
+    struct thread_data_struct *data = (struct thread_data_struct *)arg;
+
+    VkBufferCreateInfo buffer_info = {};
+    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffer_info.size = 256;
+    buffer_info.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    for (int i = 0; i < 2000; i++) {
+        VkBuffer buffers[4];
+        for (auto &buffer : buffers) {
+            vkCreateBuffer(data->device, &buffer_info, NULL, &buffer);
+        }
+        for (auto &buffer : buffers) {
+            vkDestroyBuffer(data->device, buffer, NULL);
+        }
+    }
+    return NULL;
+}
+
+TEST_F(VkPositiveLayerTest, ThreadsCreateAndDestroyObjects) {
+    TEST_DESCRIPTION(
+        "Create and destroy buffers on several threads at once, so that handles are wrapped, unwrapped and their IDs reused "
+        "concurrently.");
+
+    m_errorMonitor->ExpectSuccess();
+
+    ASSERT_NO_FATAL_FAILURE(Init());
+
+    const uint32_t thread_count = 4;
+    std::vector<thread_data_struct> data(thread_count + 1);
+    for (auto &d : data) {
+        d.device = device();
+        d.bailout = false;
+    }
+    std::vector<test_platform_thread> threads(thread_count);
+    for (uint32_t i = 0; i < thread_count; i++) {
+        test_platform_thread_create(&threads[i], CreateAndDestroyBuffers, (void *)&data[i]);
+    }
+    CreateAndDestroyBuffers(&data[thread_count]);
+    for (uint32_t i = 0; i < thread_count; i++) {
+        test_platform_thread_join(threads[i], NULL);
+    }
+
+    m_errorMonitor->VerifyNotFound();
+}
+
+struct colliding_objects_data {
+    VkCommandBuffer commandBuffer;
+    std::vector<VkEvent> events;
+};
+
+extern "C" void *RecordManyEvents(void *arg) {
+    struct colliding_objects_data *data = (struct colliding_objects_data *)arg;
+
+    // Holds several events at once in each call's worth of tracking, then lets go of them, over and over
+    for (int i = 0; i < 200; i++) {
+        for (auto event : data->events) {
+            vkCmdSetEvent(data->commandBuffer, event, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+        }
+        vkCmdWaitEvents(data->commandBuffer, static_cast<uint32_t>(data->events.size()), data->events.data(),
+                        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, nullptr, 0, nullptr, 0,
+                        nullptr);
+    }
+    return NULL;
+}
+
+TEST_F(VkLayerTest, ThreadsUseObjectsSharingHomeSlots) {
+    TEST_DESCRIPTION(
+        "Record on several threads at once, each with its own command pool and many events of its own. There are more events "
+        "than the threading layer has home slots, so objects in use on different threads share slots and go through the "
+        "overflow path. None of this is a collision, and a real one on the same events must still be reported afterwards.");
+
+    m_errorMonitor->ExpectSuccess();
+
+    ASSERT_NO_FATAL_FAILURE(Init());
+
+    const uint32_t thread_count = 4;
+    const uint32_t events_per_thread = 128;
+    VkEventCreateInfo event_info = {VK_STRUCTURE_TYPE_EVENT_CREATE_INFO, nullptr, 0};
+    std::vector<std::unique_ptr<VkCommandPoolObj>> pools;
+    std::vector<std::unique_ptr<VkCommandBufferObj>> command_buffers;
+    std::vector<colliding_objects_data> data(thread_count + 1);
+    for (uint32_t i = 0; i <= thread_count; i++) {
+        pools.emplace_back(new VkCommandPoolObj(m_device, m_device->graphics_queue_node_index_));
+        command_buffers.emplace_back(new VkCommandBufferObj(m_device, pools.back().get()));
+        command_buffers.back()->BeginCommandBuffer();
+        data[i].commandBuffer = command_buffers.back()->GetBufferHandle();
+        data[i].events.resize(events_per_thread);
+        for (auto &event : data[i].events) {
+            VkResult err = vkCreateEvent(device(), &event_info, NULL, &event);
+            ASSERT_VK_SUCCESS(err);
+        }
+    }
+
+    std::vector<test_platform_thread> threads(thread_count);
+    for (uint32_t i = 0; i < thread_count; i++) {
+        test_platform_thread_create(&threads[i], RecordManyEvents, (void *)&data[i]);
+    }
+    RecordManyEvents(&data[thread_count]);
+    for (uint32_t i = 0; i < thread_count; i++) {
+        test_platform_thread_join(threads[i], NULL);
+    }
+    for (auto &command_buffer : command_buffers) {
+        command_buffer->EndCommandBuffer();
+    }
+    m_errorMonitor->VerifyNotFound();
+
+    // Every slot must have gone back to idle: two threads now recording the same command buffer is still caught
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, "THREADING ERROR");
+    command_buffers[0]->BeginCommandBuffer();
+    struct thread_data_struct collide;
+    collide.commandBuffer = command_buffers[0]->GetBufferHandle();
+    collide.event = data[0].events[0];
+    collide.bailout = false;
+    m_errorMonitor->SetBailout(&collide.bailout);
+    test_platform_thread thread;
+    test_platform_thread_create(&thread, AddToCommandBuffer, (void *)&collide);
+    AddToCommandBuffer(&collide);
+    test_platform_thread_join(thread, NULL);
+    command_buffers[0]->EndCommandBuffer();
+    m_errorMonitor->SetBailout(NULL);
+    m_errorMonitor->VerifyFound();
+
+    for (auto &d : data) {
+        for (auto event : d.events) {
+            vkDestroyEvent(device(), event, NULL);
+        }
+    }
+}
+
+static void WriteLogRecordLine(FILE *file, const log_record &record) { fprintf(file, "%s\n", record.msg); }
+
+extern "C" void *PushManyLogRecords(void *arg) {
+    async_log_sink *sink = (async_log_sink *)arg;
+    for (int i = 0; i < 2000; i++) {
+        sink->push({VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0, 0, 0, "Test", "message"});
+    }
+    return NULL;
+}
+
+TEST_F(VkLayerTest, AsyncLogSinkKeepsMessagesPushedDuringStop) {
+    TEST_DESCRIPTION(
+        "Log from several threads through the sink behind the async_log setting while it is stopped part way through, as "
+        "happens at exit. Every message must reach the file, whether it went into the ring before, during or after stop().");
+
+    const uint32_t thread_count = 4;
+    for (uint32_t round = 0; round < 20; round++) {
+        FILE *file = tmpfile();
+        ASSERT_NE(file, nullptr);
+        {
+            async_log_sink sink(file, WriteLogRecordLine);
+            std::vector<test_platform_thread> threads(thread_count);
+            for (uint32_t i = 0; i < thread_count; i++) {
+                test_platform_thread_create(&threads[i], PushManyLogRecords, (void *)&sink);
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(round * 50));
+            sink.stop();
+            for (uint32_t i = 0; i < thread_count; i++) {
+                test_platform_thread_join(threads[i], NULL);
+            }
+        }
+
+        rewind(file);
+        uint32_t lines = 0;
+        for (int c = fgetc(file); c != EOF; c = fgetc(file)) {
+            if (c == '\n') lines++;
+        }
+        fclose(file);
+        ASSERT_EQ(thread_count * 2000, lines) << "in round " << round;
+    }
+}
+#endif  // GTEST_IS_THREADSAFE
+
+#if defined(VK_BINARY_LOG_DECODER)
+TEST_F(VkLayerTest, BinaryLogSharedByLayersDecodes) {
+    TEST_DESCRIPTION(
+        "Point two layers' binary logs at the same file, log an error from each, and check that "
+        "scripts/vk_binary_log_decoder.py reads both back: neither layer may truncate or interleave with the other's records.");
+
+    if (!ScopedLayerSetting::Supported()) {
+        printf("             Layer settings can't be changed from the test on this platform; skipped.\n");
+        return;
+    }
+    if (system("python3 --version > /dev/null 2>&1") != 0) {
+        printf("             python3 is needed to run the decoder; skipped.\n");
+        return;
+    }
+
+    const char *log_path = "vk_layer_validation_tests.vkbinlog";
+    {
+        ScopedLayerSetting core_action("lunarg_core_validation.debug_action", "VK_DBG_LAYER_ACTION_LOG_MSG");
+        ScopedLayerSetting core_flags("lunarg_core_validation.report_flags", "error");
+        ScopedLayerSetting core_format("lunarg_core_validation.log_format", "binary");
+        ScopedLayerSetting core_file("lunarg_core_validation.log_filename", log_path);
+        ScopedLayerSetting param_action("lunarg_parameter_validation.debug_action", "VK_DBG_LAYER_ACTION_LOG_MSG");
+        ScopedLayerSetting param_flags("lunarg_parameter_validation.report_flags", "error");
+        ScopedLayerSetting param_format("lunarg_parameter_validation.log_format", "binary");
+        ScopedLayerSetting param_file("lunarg_parameter_validation.log_filename", log_path);
+
+        ASSERT_NO_FATAL_FAILURE(Init());
+
+        m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, "parameter pAllocateInfo->sType must be");
+        VkMemoryAllocateInfo alloc_info = {};
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        vkAllocateMemory(device(), &alloc_info, NULL, &memory);
+        m_errorMonitor->VerifyFound();
+
+        m_commandBuffer->BeginCommandBuffer();
+        VkCommandBuffer handle = m_commandBuffer->handle();
+        VkSubmitInfo submit_info = {};
+        submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit_info.commandBufferCount = 1;
+        submit_info.pCommandBuffers = &handle;
+        m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, "You must call vkEndCommandBuffer() on command buffer");
+        vkQueueSubmit(m_device->m_queue, 1, &submit_info, VK_NULL_HANDLE);
+        m_errorMonitor->VerifyFound();
+        vkQueueWaitIdle(m_device->m_queue);
+        m_commandBuffer->EndCommandBuffer();
+
+        // The last instance to let go of the file closes it
+        ShutdownFramework();
+    }
+
+    std::string command = std::string("python3 \"") + VK_BINARY_LOG_DECODER + "\" " + log_path;
+    FILE *decoder = popen(command.c_str(), "r");
+    ASSERT_NE(decoder, nullptr);
+    std::string text;
+    char buffer[4096];
+    for (size_t read; (read = fread(buffer, 1, sizeof(buffer), decoder)) != 0;) text.append(buffer, read);
+    EXPECT_EQ(0, pclose(decoder)) << text;
+    remove(log_path);
+
+    EXPECT_NE(text.find("ParameterValidation(ERROR)"), std::string::npos) << text;
+    EXPECT_NE(text.find("parameter pAllocateInfo->sType must be"), std::string::npos) << text;
+    EXPECT_NE(text.find("DS(ERROR)"), std::string::npos) << text;
+    EXPECT_NE(text.find("You must call vkEndCommandBuffer() on command buffer"), std::string::npos) << text;
+}
+#endif  // VK_BINARY_LOG_DECODER
+
+TEST_F(VkLayerTest, InvalidSPIRVCodeSize) {
+    TEST_DESCRIPTION("Test that errors are produced for a spirv modules with invalid code sizes");
+
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, "Invalid SPIR-V header");
+
+    ASSERT_NO_FATAL_FAILURE(Init());
+    ASSERT_NO_FATAL_FAILURE(InitRenderTarget());
+
+    VkShaderModule module;
+    VkShaderModuleCreateInfo moduleCreateInfo;
+    struct icd_spv_header spv;
+
+    spv.magic = ICD_SPV_MAGIC;
+    spv.version = ICD_SPV_VERSION;
+    spv.gen_magic = 0;
+
+    moduleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    moduleCreateInfo.pNext = NULL;
+    moduleCreateInfo.pCode = (const uint32_t *)&spv;
+    moduleCreateInfo.codeSize = 4;
+    moduleCreateInfo.flags = 0;
+    vkCreateShaderModule(m_device->device(), &moduleCreateInfo, NULL, &module);
+
+    m_errorMonitor->VerifyFound();
+
+    char const *vsSource =
+        "#version 450\n"
+        "\n"
+        "layout(location=0) out float x;\n"
+        "void main(){\n"
+        "   gl_Position = vec4(1);\n"
+        "   x = 0;\n"
+        "}\n";
+
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, VALIDATION_ERROR_12a00ac0);
+    std::vector<unsigned int> shader;
+    VkShaderModuleCreateInfo module_create_info;
+    VkShaderModule shader_module;
+    module_create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    module_create_info.pNext = NULL;
+    this->GLSLtoSPV(VK_SHADER_STAGE_VERTEX_BIT, vsSource, shader);
+    module_create_info.pCode = shader.data();
+    // Introduce failure by making codeSize a non-multiple of 4
+    module_create_info.codeSize = shader.size() * sizeof(unsigned int) - 1;
+    module_create_info.flags = 0;
+    vkCreateShaderModule(m_device->handle(), &module_create_info, NULL, &shader_module);
+
+    m_errorMonitor->VerifyFound();
+}
+
+TEST_F(VkLayerTest, InvalidSPIRVMagic) {
+    TEST_DESCRIPTION(
+        "Test that an error is produced for a spirv module "
+        "with a bad magic number");
+
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, "Invalid SPIR-V magic number");
+
+    ASSERT_NO_FATAL_FAILURE(Init());
     ASSERT_NO_FATAL_FAILURE(InitRenderTarget());
 
     VkShaderModule module;
@@ -15151,6 +16263,191 @@ TEST_F(VkLayerTest, CreatePipelineVsFsMismatchByLocation) {
     m_errorMonitor->VerifyFound();
 }
 
+TEST_F(VkLayerTest, CreatePipelineVsFsMismatchInSecondBlock) {
+    TEST_DESCRIPTION(
+        "Test that member locations are matched per block when a shader declares several interface blocks, so the "
+        "OpMemberDecorates of each struct are found through its own entry in the decoration tables.");
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, "location 4.0 which is not written by vertex shader");
+
+    ASSERT_NO_FATAL_FAILURE(Init());
+    ASSERT_NO_FATAL_FAILURE(InitRenderTarget());
+
+    char const *vsSource =
+        "#version 450\n"
+        "\n"
+        "out blockA { layout(location=0) float a; layout(location=1) float b; } outA;\n"
+        "out blockB { layout(location=2) float c; layout(location=3) float d; } outB;\n"
+        "void main(){\n"
+        "   outA.a = 0; outA.b = 0;\n"
+        "   outB.c = 0; outB.d = 0;\n"
+        "   gl_Position = vec4(1);\n"
+        "}\n";
+    char const *fsSource =
+        "#version 450\n"
+        "\n"
+        "in blockA { layout(location=0) float a; layout(location=1) float b; } inA;\n"
+        "in blockB { layout(location=2) float c; layout(location=4) float d; } inB;\n"
+        "layout(location=0) out vec4 color;\n"
+        "void main(){\n"
+        "   color = vec4(inA.a, inA.b, inB.c, inB.d);\n"
+        "}\n";
+
+    VkShaderObj vs(m_device, vsSource, VK_SHADER_STAGE_VERTEX_BIT, this);
+    VkShaderObj fs(m_device, fsSource, VK_SHADER_STAGE_FRAGMENT_BIT, this);
+
+    VkPipelineObj pipe(m_device);
+    pipe.AddColorAttachment();
+    pipe.AddShader(&vs);
+    pipe.AddShader(&fs);
+
+    VkDescriptorSetObj descriptorSet(m_device);
+    descriptorSet.AppendDummy();
+    descriptorSet.CreateVKDescriptorSet(m_commandBuffer);
+
+    pipe.CreateVKPipeline(descriptorSet.GetPipelineLayout(), renderPass());
+
+    m_errorMonitor->VerifyFound();
+}
+
+// Builds a shader cache file in the layout lunarg_core_validation.shader_cache_file uses: magic, version, 64-bit checksum
+// of the rest, entry count and then the entries
+static std::vector<uint32_t> BuildShaderCacheFile(uint32_t version, uint32_t entry_count, std::vector<uint32_t> const &entries) {
+    std::vector<uint32_t> contents = {0x43535643, version, 0, 0, entry_count};
+    contents.insert(contents.end(), entries.begin(), entries.end());
+    uint64_t checksum = 0xcbf29ce484222325ULL;
+    for (size_t i = 4; i < contents.size(); ++i) checksum = (checksum ^ contents[i]) * 0x100000001b3ULL;
+    contents[2] = static_cast<uint32_t>(checksum);
+    contents[3] = static_cast<uint32_t>(checksum >> 32);
+    return contents;
+}
+
+// One cache entry for a 16 word module whose only def is at def_offset
+static std::vector<uint32_t> BuildShaderCacheEntry(uint32_t def_offset) {
+    std::vector<uint32_t> entry = {64, 0, 1, 0, 2, 0};  // codeSize, hash and check, as 64-bit values
+    entry.insert(entry.end(), {2, 0, def_offset});      // def_index
+    entry.insert(entry.end(), {0});                     // decoration_index
+    entry.insert(entry.end(), {9, 0, 0, 0, 0, 0, 0, 0, 0, 0});  // decorations: the empty set
+    entry.insert(entry.end(), {0, 0, 0});               // member_decorations, entry_points, capabilities
+    return entry;
+}
+
+static void WriteShaderCacheFile(const char *path, std::vector<uint32_t> const &contents) {
+    FILE *file = fopen(path, "wb");
+    ASSERT_NE(file, nullptr);
+    fwrite(contents.data(), sizeof(uint32_t), contents.size(), file);
+    fclose(file);
+}
+
+TEST_F(VkLayerTest, ShaderCacheRejectsOutOfRangeOffset) {
+    TEST_DESCRIPTION(
+        "Load a shader cache file whose checksum is correct, first with a def offset inside its module, which is accepted, "
+        "then with one past the end of the module, which must be reported and ignored.");
+
+    if (!ScopedLayerSetting::Supported()) {
+        printf("             Layer settings can't be changed from this test on this platform; skipped.\n");
+        return;
+    }
+    const char *path = "vk_test_shader_cache.bin";
+    ScopedLayerSetting cache_file("lunarg_core_validation.shader_cache_file", path);
+
+    ASSERT_NO_FATAL_FAILURE(WriteShaderCacheFile(path, BuildShaderCacheFile(1, 1, BuildShaderCacheEntry(6))));
+    m_errorMonitor->ExpectSuccess(VK_DEBUG_REPORT_ERROR_BIT_EXT | VK_DEBUG_REPORT_WARNING_BIT_EXT);
+    ASSERT_NO_FATAL_FAILURE(Init());
+    m_errorMonitor->VerifyNotFound();
+    ShutdownFramework();
+
+    ASSERT_NO_FATAL_FAILURE(WriteShaderCacheFile(path, BuildShaderCacheFile(1, 1, BuildShaderCacheEntry(16))));
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_WARNING_BIT_EXT, "is corrupt or from a different layer version");
+    ASSERT_NO_FATAL_FAILURE(Init());
+    m_errorMonitor->VerifyFound();
+    ShutdownFramework();
+
+    remove(path);
+}
+
+TEST_F(VkLayerTest, ShaderCacheVersionMismatch) {
+    TEST_DESCRIPTION("Load a shader cache file written by a different cache version, which must be reported and ignored.");
+
+    if (!ScopedLayerSetting::Supported()) {
+        printf("             Layer settings can't be changed from this test on this platform; skipped.\n");
+        return;
+    }
+    const char *path = "vk_test_shader_cache.bin";
+    ScopedLayerSetting cache_file("lunarg_core_validation.shader_cache_file", path);
+
+    ASSERT_NO_FATAL_FAILURE(WriteShaderCacheFile(path, BuildShaderCacheFile(1000, 1, BuildShaderCacheEntry(6))));
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_WARNING_BIT_EXT, "is corrupt or from a different layer version");
+    ASSERT_NO_FATAL_FAILURE(Init());
+    m_errorMonitor->VerifyFound();
+    ShutdownFramework();
+
+    remove(path);
+}
+
+TEST_F(VkLayerTest, ShaderCacheHit) {
+    TEST_DESCRIPTION(
+        "Create a pipeline with an interface mismatch with the shader cache enabled, then do it again on a new device that "
+        "reads the cache file back. The reflection restored from the file must report the same error, and the file must "
+        "not be rewritten because both modules were found in it.");
+
+    if (!ScopedLayerSetting::Supported()) {
+        printf("             Layer settings can't be changed from this test on this platform; skipped.\n");
+        return;
+    }
+    const char *path = "vk_test_shader_cache.bin";
+    remove(path);
+    ScopedLayerSetting cache_file("lunarg_core_validation.shader_cache_file", path);
+
+    char const *vsSource =
+        "#version 450\n"
+        "\n"
+        "layout(location=0) out float x;\n"
+        "void main(){\n"
+        "   gl_Position = vec4(1);\n"
+        "   x = 0;\n"
+        "}\n";
+    char const *fsSource =
+        "#version 450\n"
+        "\n"
+        "layout(location=1) in float x;\n"
+        "layout(location=0) out vec4 color;\n"
+        "void main(){\n"
+        "   color = vec4(x);\n"
+        "}\n";
+
+    struct stat written[2];
+    for (int run = 0; run < 2; run++) {
+        ASSERT_NO_FATAL_FAILURE(Init());
+        ASSERT_NO_FATAL_FAILURE(InitRenderTarget());
+
+        m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, "location 1.0 which is not written by vertex shader");
+        {
+            VkShaderObj vs(m_device, vsSource, VK_SHADER_STAGE_VERTEX_BIT, this);
+            VkShaderObj fs(m_device, fsSource, VK_SHADER_STAGE_FRAGMENT_BIT, this);
+
+            VkPipelineObj pipe(m_device);
+            pipe.AddColorAttachment();
+            pipe.AddShader(&vs);
+            pipe.AddShader(&fs);
+
+            VkDescriptorSetObj descriptorSet(m_device);
+            descriptorSet.AppendDummy();
+            descriptorSet.CreateVKDescriptorSet(m_commandBuffer);
+
+            pipe.CreateVKPipeline(descriptorSet.GetPipelineLayout(), renderPass());
+        }
+        m_errorMonitor->VerifyFound();
+
+        // The cache is written when the device is destroyed
+        ShutdownFramework();
+        ASSERT_EQ(0, stat(path, &written[run]));
+    }
+    // Replacing the file always creates a new one, so an unchanged inode means the second run added nothing
+    EXPECT_EQ(written[0].st_ino, written[1].st_ino);
+
+    remove(path);
+}
+
 TEST_F(VkLayerTest, CreatePipelineVsFsMismatchByComponent) {
     TEST_DESCRIPTION(
         "Test that an error is produced for component mismatches across the "
@@ -16343,6 +17640,62 @@ TEST_F(VkLayerTest, CreateComputePipelineDescriptorTypeMismatch) {
     vkDestroyDescriptorSetLayout(m_device->device(), dsl, nullptr);
 }
 
+TEST_F(VkLayerTest, CreateComputePipelinesBatchMissingDescriptor) {
+    TEST_DESCRIPTION(
+        "Test that an error is produced for the one compute pipeline in a "
+        "batch that consumes a descriptor which is not provided in the "
+        "pipeline layout, while the rest of the batch is accepted");
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, "Shader uses descriptor slot 0.0");
+
+    ASSERT_NO_FATAL_FAILURE(Init());
+
+    char const *goodSource =
+        "#version 450\n"
+        "\n"
+        "layout(local_size_x=1) in;\n"
+        "void main(){\n"
+        "}\n";
+    char const *badSource =
+        "#version 450\n"
+        "\n"
+        "layout(local_size_x=1) in;\n"
+        "layout(set=0, binding=0) buffer block { vec4 x; };\n"
+        "void main(){\n"
+        "   x = vec4(1);\n"
+        "}\n";
+
+    VkShaderObj good_cs(m_device, goodSource, VK_SHADER_STAGE_COMPUTE_BIT, this);
+    VkShaderObj bad_cs(m_device, badSource, VK_SHADER_STAGE_COMPUTE_BIT, this);
+
+    VkDescriptorSetObj descriptorSet(m_device);
+    descriptorSet.CreateVKDescriptorSet(m_commandBuffer);
+
+    const uint32_t pipeline_count = 8;
+    const uint32_t bad_index = 5;
+    VkComputePipelineCreateInfo cpcis[pipeline_count];
+    for (uint32_t i = 0; i < pipeline_count; i++) {
+        cpcis[i] = {VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+                    nullptr,
+                    0,
+                    {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_COMPUTE_BIT,
+                     (i == bad_index) ? bad_cs.handle() : good_cs.handle(), "main", nullptr},
+                    descriptorSet.GetPipelineLayout(),
+                    VK_NULL_HANDLE,
+                    -1};
+    }
+
+    VkPipeline pipes[pipeline_count] = {};
+    VkResult err = vkCreateComputePipelines(m_device->device(), VK_NULL_HANDLE, pipeline_count, cpcis, nullptr, pipes);
+
+    m_errorMonitor->VerifyFound();
+
+    if (err == VK_SUCCESS) {
+        for (uint32_t i = 0; i < pipeline_count; i++) {
+            vkDestroyPipeline(m_device->device(), pipes[i], nullptr);
+        }
+    }
+}
+
 TEST_F(VkLayerTest, DrawTimeImageViewTypeMismatchWithPipeline) {
     TEST_DESCRIPTION(
         "Test that an error is produced when an image view type "
@@ -20617,6 +21970,89 @@ TEST_F(VkPositiveLayerTest, EmptyDescriptorUpdateTest) {
     vkDestroyDescriptorPool(m_device->device(), ds_pool, NULL);
 }
 
+TEST_F(VkPositiveLayerTest, ReallocateLargeDescriptorSets) {
+    TEST_DESCRIPTION(
+        "Repeatedly allocate, fully update and free a descriptor set with "
+        "many descriptors, then reset the pool, and verify no errors");
+    VkResult err;
+
+    ASSERT_NO_FATAL_FAILURE(Init());
+    m_errorMonitor->ExpectSuccess();
+
+    const uint32_t descriptor_count = 1024;
+    VkDescriptorPoolSize ds_type_count = {VK_DESCRIPTOR_TYPE_SAMPLER, descriptor_count};
+    VkDescriptorPoolCreateInfo ds_pool_ci = {};
+    ds_pool_ci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    ds_pool_ci.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    ds_pool_ci.maxSets = 1;
+    ds_pool_ci.poolSizeCount = 1;
+    ds_pool_ci.pPoolSizes = &ds_type_count;
+    VkDescriptorPool ds_pool;
+    err = vkCreateDescriptorPool(m_device->device(), &ds_pool_ci, NULL, &ds_pool);
+    ASSERT_VK_SUCCESS(err);
+
+    VkDescriptorSetLayoutBinding dsl_binding = {0, VK_DESCRIPTOR_TYPE_SAMPLER, descriptor_count, VK_SHADER_STAGE_FRAGMENT_BIT,
+                                                NULL};
+    VkDescriptorSetLayoutCreateInfo ds_layout_ci = {};
+    ds_layout_ci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    ds_layout_ci.bindingCount = 1;
+    ds_layout_ci.pBindings = &dsl_binding;
+    VkDescriptorSetLayout ds_layout;
+    err = vkCreateDescriptorSetLayout(m_device->device(), &ds_layout_ci, NULL, &ds_layout);
+    ASSERT_VK_SUCCESS(err);
+
+    VkSamplerCreateInfo sampler_ci = {};
+    sampler_ci.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    sampler_ci.magFilter = VK_FILTER_NEAREST;
+    sampler_ci.minFilter = VK_FILTER_NEAREST;
+    sampler_ci.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    sampler_ci.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_ci.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_ci.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_ci.maxAnisotropy = 1;
+    sampler_ci.compareOp = VK_COMPARE_OP_NEVER;
+    sampler_ci.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+    VkSampler sampler;
+    err = vkCreateSampler(m_device->device(), &sampler_ci, NULL, &sampler);
+    ASSERT_VK_SUCCESS(err);
+
+    std::vector<VkDescriptorImageInfo> image_infos(descriptor_count, {sampler, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_UNDEFINED});
+    VkWriteDescriptorSet descriptor_write = {};
+    descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptor_write.dstBinding = 0;
+    descriptor_write.descriptorCount = descriptor_count;
+    descriptor_write.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+    descriptor_write.pImageInfo = image_infos.data();
+
+    VkDescriptorSetAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorSetCount = 1;
+    alloc_info.descriptorPool = ds_pool;
+    alloc_info.pSetLayouts = &ds_layout;
+
+    VkDescriptorSet descriptor_set;
+    for (uint32_t i = 0; i < 3; i++) {
+        err = vkAllocateDescriptorSets(m_device->device(), &alloc_info, &descriptor_set);
+        ASSERT_VK_SUCCESS(err);
+        descriptor_write.dstSet = descriptor_set;
+        vkUpdateDescriptorSets(m_device->device(), 1, &descriptor_write, 0, NULL);
+        err = vkFreeDescriptorSets(m_device->device(), ds_pool, 1, &descriptor_set);
+        ASSERT_VK_SUCCESS(err);
+    }
+    err = vkAllocateDescriptorSets(m_device->device(), &alloc_info, &descriptor_set);
+    ASSERT_VK_SUCCESS(err);
+    descriptor_write.dstSet = descriptor_set;
+    vkUpdateDescriptorSets(m_device->device(), 1, &descriptor_write, 0, NULL);
+    err = vkResetDescriptorPool(m_device->device(), ds_pool, 0);
+    ASSERT_VK_SUCCESS(err);
+
+    m_errorMonitor->VerifyNotFound();
+
+    vkDestroySampler(m_device->device(), sampler, NULL);
+    vkDestroyDescriptorSetLayout(m_device->device(), ds_layout, NULL);
+    vkDestroyDescriptorPool(m_device->device(), ds_pool, NULL);
+}
+
 // This is a positive test. No failures are expected.
 TEST_F(VkPositiveLayerTest, TestAliasedMemoryTracking) {
     VkResult err;
@@ -22910,35 +24346,179 @@ TEST_F(VkPositiveLayerTest, TwoQueuesEnsureCorrectRetirementWithWorkStolen) {
     err = vkCreateSemaphore(m_device->device(), &sci, nullptr, &s);
     ASSERT_VK_SUCCESS(err);
 
-    // First submission, to q0
-    VkSubmitInfo s0 = {VK_STRUCTURE_TYPE_SUBMIT_INFO, nullptr, 0, nullptr, nullptr, 1, &cb, 1, &s};
+    // First submission, to q0
+    VkSubmitInfo s0 = {VK_STRUCTURE_TYPE_SUBMIT_INFO, nullptr, 0, nullptr, nullptr, 1, &cb, 1, &s};
+
+    err = vkQueueSubmit(q0, 1, &s0, VK_NULL_HANDLE);
+    ASSERT_VK_SUCCESS(err);
+
+    // Second submission, to q1, waiting on s
+    VkFlags waitmask = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;  // doesn't really matter what this value is.
+    VkSubmitInfo s1 = {VK_STRUCTURE_TYPE_SUBMIT_INFO, nullptr, 1, &s, &waitmask, 0, nullptr, 0, nullptr};
+
+    err = vkQueueSubmit(q1, 1, &s1, VK_NULL_HANDLE);
+    ASSERT_VK_SUCCESS(err);
+
+    // Wait for q0 idle
+    err = vkQueueWaitIdle(q0);
+    ASSERT_VK_SUCCESS(err);
+
+    // Command buffer should have been completed (it was on q0); reset the pool.
+    vkFreeCommandBuffers(m_device->device(), pool, 1, &cb);
+
+    m_errorMonitor->VerifyNotFound();
+
+    // Force device completely idle and clean up resources
+    vkDeviceWaitIdle(m_device->device());
+    vkDestroyCommandPool(m_device->device(), pool, nullptr);
+    vkDestroySemaphore(m_device->device(), s, nullptr);
+}
+
+TEST_F(VkLayerTest, RetireSemaphoreChainAcrossQueues) {
+    TEST_DESCRIPTION(
+        "Chain submissions round-robin across up to four queues, each waiting on a semaphore signaled by the previous one, "
+        "and fence only the last one. Resetting the command buffer before the fence is waited on must report it in use; "
+        "after the wait, every submission in the chain must have been retired, so resetting it again must not.");
+
+    ASSERT_NO_FATAL_FAILURE(Init());
+    if ((m_device->queue_props.empty()) || (m_device->queue_props[0].queueCount < 2)) {
+        printf("             Test requires two queues, skipping\n");
+        return;
+    }
+
+    const uint32_t queue_count = std::min(m_device->queue_props[0].queueCount, 4u);
+    std::vector<VkQueue> queues(queue_count);
+    for (uint32_t i = 0; i < queue_count; i++) {
+        vkGetDeviceQueue(m_device->device(), m_device->graphics_queue_node_index_, i, &queues[i]);
+    }
+
+    VkCommandPoolObj pool(m_device, m_device->graphics_queue_node_index_, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+    VkCommandBufferObj command_buffer(m_device, &pool);
+    VkCommandBufferBeginInfo begin_info = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, nullptr,
+                                           VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT, nullptr};
+    command_buffer.BeginCommandBuffer(&begin_info);
+    command_buffer.EndCommandBuffer();
+    VkCommandBuffer cb = command_buffer.GetBufferHandle();
+
+    // Each link waits on the semaphore the previous link signaled, so consecutive links use different semaphores
+    VkSemaphoreCreateInfo semaphore_create_info = {VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, nullptr, 0};
+    VkSemaphore semaphores[2];
+    for (auto &semaphore : semaphores) {
+        ASSERT_VK_SUCCESS(vkCreateSemaphore(m_device->device(), &semaphore_create_info, nullptr, &semaphore));
+    }
+    VkFenceCreateInfo fence_create_info = {VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, nullptr, 0};
+    VkFence fence;
+    ASSERT_VK_SUCCESS(vkCreateFence(m_device->device(), &fence_create_info, nullptr, &fence));
+
+    VkPipelineStageFlags wait_mask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    const uint32_t chain_length = 16;
+    for (uint32_t i = 0; i < chain_length; i++) {
+        VkSubmitInfo submit_info = {VK_STRUCTURE_TYPE_SUBMIT_INFO, nullptr, 0, nullptr, nullptr, 1, &cb, 0, nullptr};
+        if (i > 0) {
+            submit_info.waitSemaphoreCount = 1;
+            submit_info.pWaitSemaphores = &semaphores[(i - 1) % 2];
+            submit_info.pWaitDstStageMask = &wait_mask;
+        }
+        bool last = (i == chain_length - 1);
+        if (!last) {
+            submit_info.signalSemaphoreCount = 1;
+            submit_info.pSignalSemaphores = &semaphores[i % 2];
+        }
+        ASSERT_VK_SUCCESS(vkQueueSubmit(queues[i % queue_count], 1, &submit_info, last ? fence : VK_NULL_HANDLE));
+    }
+
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, VALIDATION_ERROR_3260005a);
+    vkResetCommandBuffer(cb, 0);
+    m_errorMonitor->VerifyFound();
+
+    m_errorMonitor->ExpectSuccess();
+    ASSERT_VK_SUCCESS(vkWaitForFences(m_device->device(), 1, &fence, VK_TRUE, UINT64_MAX));
+    // The fence retires the last submission, and through the semaphores every submission before it on the other queues
+    vkResetCommandBuffer(cb, 0);
+    m_errorMonitor->VerifyNotFound();
+
+    vkDestroyFence(m_device->device(), fence, nullptr);
+    for (auto semaphore : semaphores) {
+        vkDestroySemaphore(m_device->device(), semaphore, nullptr);
+    }
+}
+
+// Timing based, so disabled by default; run with --gtest_also_run_disabled_tests
+TEST_F(VkPositiveLayerTest, DISABLED_RetireLongSemaphoreChainAcrossQueuesLatency) {
+    TEST_DESCRIPTION(
+        "Chain submissions round-robin across up to four queues, each waiting on a semaphore signaled by the previous one, "
+        "fence only the last submission of each chain, and report how long the fence wait takes to retire chains of "
+        "increasing length. The command buffer is reset afterwards, so any submission left unretired is reported as in use.");
+
+    ASSERT_NO_FATAL_FAILURE(Init());
+    if ((m_device->queue_props.empty()) || (m_device->queue_props[0].queueCount < 2)) {
+        printf("             Test requires two queues, skipping\n");
+        return;
+    }
+
+    m_errorMonitor->ExpectSuccess();
+
+    const uint32_t queue_count = std::min(m_device->queue_props[0].queueCount, 4u);
+    std::vector<VkQueue> queues(queue_count);
+    for (uint32_t i = 0; i < queue_count; i++) {
+        vkGetDeviceQueue(m_device->device(), m_device->graphics_queue_node_index_, i, &queues[i]);
+    }
+
+    VkCommandPoolObj pool(m_device, m_device->graphics_queue_node_index_, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+    VkCommandBufferObj command_buffer(m_device, &pool);
+    VkCommandBufferBeginInfo begin_info = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, nullptr,
+                                           VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT, nullptr};
+    command_buffer.BeginCommandBuffer(&begin_info);
+    command_buffer.EndCommandBuffer();
+    VkCommandBuffer cb = command_buffer.GetBufferHandle();
 
-    err = vkQueueSubmit(q0, 1, &s0, VK_NULL_HANDLE);
-    ASSERT_VK_SUCCESS(err);
+    // Each link waits on the semaphore the previous link signaled, so consecutive links use different semaphores
+    VkSemaphoreCreateInfo semaphore_create_info = {VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, nullptr, 0};
+    VkSemaphore semaphores[2];
+    for (auto &semaphore : semaphores) {
+        ASSERT_VK_SUCCESS(vkCreateSemaphore(m_device->device(), &semaphore_create_info, nullptr, &semaphore));
+    }
+    VkFenceCreateInfo fence_create_info = {VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, nullptr, 0};
+    VkFence fence;
+    ASSERT_VK_SUCCESS(vkCreateFence(m_device->device(), &fence_create_info, nullptr, &fence));
 
-    // Second submission, to q1, waiting on s
-    VkFlags waitmask = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;  // doesn't really matter what this value is.
-    VkSubmitInfo s1 = {VK_STRUCTURE_TYPE_SUBMIT_INFO, nullptr, 1, &s, &waitmask, 0, nullptr, 0, nullptr};
+    VkPipelineStageFlags wait_mask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    for (uint32_t chain_length = 16; chain_length <= 4096; chain_length *= 16) {
+        for (uint32_t i = 0; i < chain_length; i++) {
+            VkSubmitInfo submit_info = {VK_STRUCTURE_TYPE_SUBMIT_INFO, nullptr, 0, nullptr, nullptr, 1, &cb, 0, nullptr};
+            if (i > 0) {
+                submit_info.waitSemaphoreCount = 1;
+                submit_info.pWaitSemaphores = &semaphores[(i - 1) % 2];
+                submit_info.pWaitDstStageMask = &wait_mask;
+            }
+            bool last = (i == chain_length - 1);
+            if (!last) {
+                submit_info.signalSemaphoreCount = 1;
+                submit_info.pSignalSemaphores = &semaphores[i % 2];
+            }
+            ASSERT_VK_SUCCESS(vkQueueSubmit(queues[i % queue_count], 1, &submit_info, last ? fence : VK_NULL_HANDLE));
+        }
 
-    err = vkQueueSubmit(q1, 1, &s1, VK_NULL_HANDLE);
-    ASSERT_VK_SUCCESS(err);
+        auto start = std::chrono::steady_clock::now();
+        ASSERT_VK_SUCCESS(vkWaitForFences(m_device->device(), 1, &fence, VK_TRUE, UINT64_MAX));
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        printf("             %u submissions across %u queues retired by one fence in %.3f ms\n", chain_length, queue_count,
+               elapsed.count() * 1000.0);
 
-    // Wait for q0 idle
-    err = vkQueueWaitIdle(q0);
-    ASSERT_VK_SUCCESS(err);
+        ASSERT_VK_SUCCESS(vkResetFences(m_device->device(), 1, &fence));
+    }
 
-    // Command buffer should have been completed (it was on q0); reset the pool.
-    vkFreeCommandBuffers(m_device->device(), pool, 1, &cb);
+    // Every submission in every chain was retired by its fence, so nothing still holds the command buffer
+    vkResetCommandBuffer(cb, 0);
 
     m_errorMonitor->VerifyNotFound();
 
-    // Force device completely idle and clean up resources
-    vkDeviceWaitIdle(m_device->device());
-    vkDestroyCommandPool(m_device->device(), pool, nullptr);
-    vkDestroySemaphore(m_device->device(), s, nullptr);
+    vkDestroyFence(m_device->device(), fence, nullptr);
+    for (auto semaphore : semaphores) {
+        vkDestroySemaphore(m_device->device(), semaphore, nullptr);
+    }
 }
 
-// This is a positive test.  No errors should be generated.
 TEST_F(VkPositiveLayerTest, TwoQueueSubmitsSeparateQueuesWithSemaphoreAndOneFence) {
     TEST_DESCRIPTION(
         "Two command buffers, each in a separate QueueSubmit call "
@@ -24634,6 +26214,505 @@ TEST_F(VkPositiveLayerTest, ThreadNullFenceCollision) {
     m_errorMonitor->VerifyNotFound();
 }
 
+struct record_thread_data_struct {
+    VkCommandBuffer commandBuffer;
+    VkEvent event;
+    uint32_t iterations;
+};
+
+extern "C" void *RecordSetResetEvents(void *arg) {
+    struct record_thread_data_struct *data = (struct record_thread_data_struct *)arg;
+
+    for (uint32_t i = 0; i < data->iterations; i++) {
+        vkCmdSetEvent(data->commandBuffer, data->event, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+        vkCmdResetEvent(data->commandBuffer, data->event, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+    }
+    return NULL;
+}
+
+TEST_F(VkPositiveLayerTest, ThreadedCommandBufferRecording) {
+    TEST_DESCRIPTION(
+        "Record command buffers on several threads at once, all using the same event, then submit them and check that "
+        "no errors are reported.");
+
+    m_errorMonitor->ExpectSuccess();
+
+    ASSERT_NO_FATAL_FAILURE(Init());
+
+    VkEventCreateInfo event_info = {VK_STRUCTURE_TYPE_EVENT_CREATE_INFO, nullptr, 0};
+    VkEvent event;
+    VkResult err = vkCreateEvent(m_device->device(), &event_info, nullptr, &event);
+    ASSERT_VK_SUCCESS(err);
+
+    const uint32_t thread_count = 4;
+    const uint32_t iterations = 100;
+    // Command pools are externally synchronized, so each thread records into a buffer from its own pool
+    std::vector<std::unique_ptr<VkCommandPoolObj>> pools;
+    std::vector<std::unique_ptr<VkCommandBufferObj>> command_buffers;
+    std::vector<record_thread_data_struct> data(thread_count);
+    std::vector<test_platform_thread> threads(thread_count);
+    for (uint32_t i = 0; i < thread_count; i++) {
+        pools.emplace_back(new VkCommandPoolObj(m_device, m_device->graphics_queue_node_index_));
+        command_buffers.emplace_back(new VkCommandBufferObj(m_device, pools.back().get()));
+        command_buffers.back()->BeginCommandBuffer();
+        data[i] = {command_buffers.back()->GetBufferHandle(), event, iterations};
+    }
+
+    for (uint32_t i = 0; i < thread_count; i++) {
+        test_platform_thread_create(&threads[i], RecordSetResetEvents, (void *)&data[i]);
+    }
+    for (uint32_t i = 0; i < thread_count; i++) {
+        test_platform_thread_join(threads[i], NULL);
+    }
+
+    std::vector<VkCommandBuffer> handles;
+    for (auto &command_buffer : command_buffers) {
+        command_buffer->EndCommandBuffer();
+        handles.push_back(command_buffer->GetBufferHandle());
+    }
+
+    VkSubmitInfo submit_info = {};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = static_cast<uint32_t>(handles.size());
+    submit_info.pCommandBuffers = handles.data();
+    ASSERT_VK_SUCCESS(vkQueueSubmit(m_device->m_queue, 1, &submit_info, VK_NULL_HANDLE));
+    ASSERT_VK_SUCCESS(vkQueueWaitIdle(m_device->m_queue));
+
+    vkDestroyEvent(m_device->device(), event, nullptr);
+
+    m_errorMonitor->VerifyNotFound();
+}
+
+// Timing based, so disabled by default; run with --gtest_also_run_disabled_tests
+TEST_F(VkPositiveLayerTest, DISABLED_ThreadedCommandBufferRecordingScaling) {
+    TEST_DESCRIPTION(
+        "Record command buffers on 1, 2, 4 and 8 threads at once, all using the same event, and report the recording "
+        "throughput for each thread count.");
+
+    m_errorMonitor->ExpectSuccess();
+
+    ASSERT_NO_FATAL_FAILURE(Init());
+
+    VkEventCreateInfo event_info = {VK_STRUCTURE_TYPE_EVENT_CREATE_INFO, nullptr, 0};
+    VkEvent event;
+    VkResult err = vkCreateEvent(m_device->device(), &event_info, nullptr, &event);
+    ASSERT_VK_SUCCESS(err);
+
+    const uint32_t iterations = 10000;
+    for (uint32_t thread_count = 1; thread_count <= 8; thread_count *= 2) {
+        // Command pools are externally synchronized, so each thread records into a buffer from its own pool
+        std::vector<std::unique_ptr<VkCommandPoolObj>> pools;
+        std::vector<std::unique_ptr<VkCommandBufferObj>> command_buffers;
+        std::vector<record_thread_data_struct> data(thread_count);
+        std::vector<test_platform_thread> threads(thread_count);
+        for (uint32_t i = 0; i < thread_count; i++) {
+            pools.emplace_back(new VkCommandPoolObj(m_device, m_device->graphics_queue_node_index_));
+            command_buffers.emplace_back(new VkCommandBufferObj(m_device, pools.back().get()));
+            command_buffers.back()->BeginCommandBuffer();
+            data[i] = {command_buffers.back()->GetBufferHandle(), event, iterations};
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < thread_count; i++) {
+            test_platform_thread_create(&threads[i], RecordSetResetEvents, (void *)&data[i]);
+        }
+        for (uint32_t i = 0; i < thread_count; i++) {
+            test_platform_thread_join(threads[i], NULL);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        for (auto &command_buffer : command_buffers) {
+            command_buffer->EndCommandBuffer();
+        }
+        printf("             %u recording thread(s): %.0f commands/sec\n", thread_count,
+               2.0 * iterations * thread_count / elapsed.count());
+    }
+
+    vkDestroyEvent(m_device->device(), event, nullptr);
+
+    m_errorMonitor->VerifyNotFound();
+}
+
+// Timing based, so disabled by default; run with --gtest_also_run_disabled_tests
+TEST_F(VkPositiveLayerTest, DISABLED_DrawWithUnchangedStateOverhead) {
+    TEST_DESCRIPTION(
+        "Record many draws with a pipeline and a uniform buffer descriptor set that stay bound, then as many again with the "
+        "descriptor set rebound before each draw so every draw is fully validated, and report the cost of a draw in each case.");
+
+    m_errorMonitor->ExpectSuccess();
+
+    ASSERT_NO_FATAL_FAILURE(Init());
+    ASSERT_NO_FATAL_FAILURE(InitViewport());
+    ASSERT_NO_FATAL_FAILURE(InitRenderTarget());
+
+    char const *vsSource =
+        "#version 450\n"
+        "\n"
+        "void main(){\n"
+        "   gl_Position = vec4(1);\n"
+        "}\n";
+    char const *fsSource =
+        "#version 450\n"
+        "\n"
+        "layout(location=0) out vec4 x;\n"
+        "layout(set=0) layout(binding=0) uniform foo { vec4 y; } bar;\n"
+        "void main(){\n"
+        "   x = bar.y;\n"
+        "}\n";
+    VkShaderObj vs(m_device, vsSource, VK_SHADER_STAGE_VERTEX_BIT, this);
+    VkShaderObj fs(m_device, fsSource, VK_SHADER_STAGE_FRAGMENT_BIT, this);
+
+    const float data[4] = {};
+    VkConstantBufferObj uniform_buffer(m_device, 4, sizeof(float), (const void *)data, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+    VkDescriptorSetObj descriptorSet(m_device);
+    descriptorSet.AppendBuffer(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, uniform_buffer);
+    descriptorSet.CreateVKDescriptorSet(m_commandBuffer);
+
+    VkPipelineObj pipe(m_device);
+    pipe.AddShader(&vs);
+    pipe.AddShader(&fs);
+    pipe.AddColorAttachment();
+    pipe.CreateVKPipeline(descriptorSet.GetPipelineLayout(), renderPass());
+
+    m_commandBuffer->BeginCommandBuffer();
+    m_commandBuffer->BeginRenderPass(m_renderPassBeginInfo);
+    VkViewport viewport = {0, 0, 16, 16, 0, 1};
+    vkCmdSetViewport(m_commandBuffer->handle(), 0, 1, &viewport);
+    VkRect2D scissor = {{0, 0}, {16, 16}};
+    vkCmdSetScissor(m_commandBuffer->handle(), 0, 1, &scissor);
+    m_commandBuffer->BindPipeline(pipe);
+    m_commandBuffer->BindDescriptorSet(descriptorSet);
+
+    const uint32_t draw_count = 100000;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < draw_count; i++) {
+        Draw(3, 1, 0, 0);
+    }
+    std::chrono::duration<double> unchanged = std::chrono::steady_clock::now() - start;
+
+    // Rebinding the set changes the bound state each time, so no draw can reuse the result of the one before it
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < draw_count; i++) {
+        m_commandBuffer->BindDescriptorSet(descriptorSet);
+        Draw(3, 1, 0, 0);
+    }
+    std::chrono::duration<double> rebound = std::chrono::steady_clock::now() - start;
+
+    m_commandBuffer->EndRenderPass();
+    m_commandBuffer->EndCommandBuffer();
+
+    printf("             %u draws with unchanged state: %.1f ns/draw\n", draw_count, unchanged.count() * 1e9 / draw_count);
+    printf("             %u draws with the set rebound before each: %.1f ns/draw, bind included\n", draw_count,
+           rebound.count() * 1e9 / draw_count);
+
+    m_errorMonitor->VerifyNotFound();
+}
+
+TEST_F(VkPositiveLayerTest, ProfileFileReportsCalls) {
+    TEST_DESCRIPTION(
+        "Set profile_file, record and submit some draws, destroy the device, and check that the report it writes lists the "
+        "draws and submits with at least as many calls as were made.");
+
+    if (!ScopedLayerSetting::Supported()) {
+        printf("             Layer settings can't be changed from this test on this platform; skipped.\n");
+        return;
+    }
+    const char *path = "vk_test_profile.csv";
+    remove(path);
+
+    const uint32_t submit_count = 4;
+    const uint32_t draws_per_submit = 8;
+    {
+        ScopedLayerSetting profile_file("lunarg_core_validation.profile_file", path);
+        m_errorMonitor->ExpectSuccess();
+        ASSERT_NO_FATAL_FAILURE(Init());
+        ASSERT_NO_FATAL_FAILURE(InitViewport());
+        ASSERT_NO_FATAL_FAILURE(InitRenderTarget());
+
+        VkShaderObj vs(m_device, bindStateVertShaderText, VK_SHADER_STAGE_VERTEX_BIT, this);
+        VkShaderObj fs(m_device, bindStateFragShaderText, VK_SHADER_STAGE_FRAGMENT_BIT, this);
+
+        VkDescriptorSetObj descriptorSet(m_device);
+        descriptorSet.AppendDummy();
+        descriptorSet.CreateVKDescriptorSet(m_commandBuffer);
+
+        VkPipelineObj pipe(m_device);
+        pipe.AddShader(&vs);
+        pipe.AddShader(&fs);
+        pipe.AddColorAttachment();
+        pipe.CreateVKPipeline(descriptorSet.GetPipelineLayout(), renderPass());
+
+        for (uint32_t submit = 0; submit < submit_count; submit++) {
+            m_commandBuffer->BeginCommandBuffer();
+            m_commandBuffer->BeginRenderPass(m_renderPassBeginInfo);
+            VkViewport viewport = {0, 0, 16, 16, 0, 1};
+            vkCmdSetViewport(m_commandBuffer->handle(), 0, 1, &viewport);
+            VkRect2D scissor = {{0, 0}, {16, 16}};
+            vkCmdSetScissor(m_commandBuffer->handle(), 0, 1, &scissor);
+            m_commandBuffer->BindPipeline(pipe);
+            m_commandBuffer->BindDescriptorSet(descriptorSet);
+            for (uint32_t draw = 0; draw < draws_per_submit; draw++) {
+                Draw(3, 1, 0, 0);
+            }
+            m_commandBuffer->EndRenderPass();
+            m_commandBuffer->EndCommandBuffer();
+            m_commandBuffer->QueueCommandBuffer();
+        }
+        m_errorMonitor->VerifyNotFound();
+
+        // The report is written when the device is destroyed
+        ShutdownFramework();
+    }
+
+    FILE *report = fopen(path, "r");
+    ASSERT_NE(report, nullptr) << "no profile report was written to " << path;
+    char line[1024];
+    ASSERT_NE(fgets(line, sizeof(line), report), nullptr);
+    EXPECT_EQ(strncmp(line, "layer,entry_point,calls,", strlen("layer,entry_point,calls,")), 0) << "unexpected header: " << line;
+
+    // Calls are counted for the whole process, so earlier devices may add to them
+    unsigned long long draw_calls = 0, submit_calls = 0;
+    while (fgets(line, sizeof(line), report)) {
+        sscanf(line, "lunarg_core_validation,vkCmdDraw,%llu,", &draw_calls);
+        sscanf(line, "lunarg_core_validation,vkQueueSubmit,%llu,", &submit_calls);
+    }
+    fclose(report);
+    remove(path);
+
+    EXPECT_GE(draw_calls, submit_count * draws_per_submit);
+    EXPECT_GE(submit_calls, submit_count);
+}
+
+// Step p over one JSON value and the whitespace around it; false if the text there isn't one
+static bool SkipJsonValue(const char *&p) {
+    auto skip_space = [&p] {
+        while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') p++;
+    };
+    skip_space();
+    if (*p == '{' || *p == '[') {
+        const char close = *p == '{' ? '}' : ']';
+        const bool object = close == '}';
+        p++;
+        skip_space();
+        if (*p == close) {
+            p++;
+            skip_space();
+            return true;
+        }
+        for (;;) {
+            if (object) {
+                if (*p != '"' || !SkipJsonValue(p) || *p++ != ':') return false;
+            }
+            if (!SkipJsonValue(p)) return false;
+            if (*p == close) break;
+            if (*p++ != ',') return false;
+        }
+        p++;
+    } else if (*p == '"') {
+        for (p++; *p != '"'; p++) {
+            if (!*p || static_cast<unsigned char>(*p) < 0x20) return false;
+            if (*p == '\\' && !*++p) return false;
+        }
+        p++;
+    } else if (!strncmp(p, "true", 4) || !strncmp(p, "null", 4)) {
+        p += 4;
+    } else if (!strncmp(p, "false", 5)) {
+        p += 5;
+    } else {
+        char *end = nullptr;
+        strtod(p, &end);
+        if (end == p) return false;
+        p = end;
+    }
+    skip_space();
+    return true;
+}
+
+// The value of the string member key of a JSON object written on one line, or "" if it has none
+static std::string JsonStringMember(const std::string &object, const char *key) {
+    const std::string prefix = std::string("\"") + key + "\":\"";
+    auto start = object.find(prefix);
+    if (start == std::string::npos) return "";
+    start += prefix.size();
+    return object.substr(start, object.find('"', start) - start);
+}
+
+TEST_F(VkPositiveLayerTest, TraceFileSpansEachSubmission) {
+    TEST_DESCRIPTION(
+        "Set trace_file, submit and wait for some work, destroy the device, and check that the trace is a JSON array once "
+        "its closing bracket is added, with one submission span per vkQueueSubmit whose begin and end events share an id.");
+
+    if (!ScopedLayerSetting::Supported()) {
+        printf("             Layer settings can't be changed from this test on this platform; skipped.\n");
+        return;
+    }
+    const char *path = "vk_test_trace.json";
+    remove(path);
+
+    const uint32_t submit_count = 4;
+    {
+        ScopedLayerSetting trace_file("lunarg_core_validation.trace_file", path);
+        m_errorMonitor->ExpectSuccess();
+        ASSERT_NO_FATAL_FAILURE(Init());
+        for (uint32_t submit = 0; submit < submit_count; submit++) {
+            m_commandBuffer->BeginCommandBuffer();
+            m_commandBuffer->EndCommandBuffer();
+            // Waits for the queue to go idle, which ends the submission's span
+            m_commandBuffer->QueueCommandBuffer();
+        }
+        m_errorMonitor->VerifyNotFound();
+
+        // The trace is closed when the last device writing to it is destroyed
+        ShutdownFramework();
+    }
+
+    FILE *file = fopen(path, "r");
+    ASSERT_NE(file, nullptr) << "no trace was written to " << path;
+    std::string text;
+    char buffer[4096];
+    for (size_t read; (read = fread(buffer, 1, sizeof(buffer), file)) != 0;) text.append(buffer, read);
+    fclose(file);
+    remove(path);
+
+    // The writer never closes the array
+    const std::string json = text + "]";
+    const char *p = json.c_str();
+    while (*p == ' ' || *p == '\n') p++;
+    EXPECT_EQ(*p, '[') << text;
+    EXPECT_TRUE(SkipJsonValue(p) && !*p) << "not a JSON array after appending ']':\n" << text;
+
+    // One event per line
+    std::vector<std::string> begins, ends;
+    std::istringstream lines(text);
+    for (std::string line; std::getline(lines, line);) {
+        if (JsonStringMember(line, "name") != "submission") continue;
+        const std::string phase = JsonStringMember(line, "ph");
+        if (phase == "b") begins.push_back(JsonStringMember(line, "id"));
+        if (phase == "e") ends.push_back(JsonStringMember(line, "id"));
+    }
+    EXPECT_EQ(begins.size(), submit_count) << text;
+    std::sort(begins.begin(), begins.end());
+    std::sort(ends.begin(), ends.end());
+    EXPECT_EQ(std::unique(begins.begin(), begins.end()), begins.end()) << "submission span ids are not unique:\n" << text;
+    EXPECT_EQ(begins, ends) << text;
+}
+
+// Timing based, so disabled by default; run with --gtest_also_run_disabled_tests
+TEST_F(VkPositiveLayerTest, DISABLED_BindManyBuffersToOneAllocationScaling) {
+    TEST_DESCRIPTION(
+        "Sub-allocate 1k, 10k and 100k buffers from a single memory allocation, binding each at its own offset, report the "
+        "bind throughput for each count and check that the cost of a bind grows far slower than the number of bindings.");
+
+    m_errorMonitor->ExpectSuccess();
+
+    ASSERT_NO_FATAL_FAILURE(Init());
+
+    VkBufferCreateInfo buf_info = {};
+    buf_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buf_info.size = 256;
+    buf_info.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    buf_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    double first_bind_seconds = 0;
+    uint32_t first_count = 0;
+    for (uint32_t buffer_count = 1000; buffer_count <= 100000; buffer_count *= 10) {
+        std::vector<VkBuffer> buffers(buffer_count);
+        for (auto &buffer : buffers) {
+            ASSERT_VK_SUCCESS(vkCreateBuffer(m_device->device(), &buf_info, NULL, &buffer));
+        }
+        VkMemoryRequirements mem_reqs;
+        vkGetBufferMemoryRequirements(m_device->device(), buffers[0], &mem_reqs);
+        const VkDeviceSize stride = (mem_reqs.size + mem_reqs.alignment - 1) & ~(mem_reqs.alignment - 1);
+
+        VkMemoryAllocateInfo alloc_info = {};
+        alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        alloc_info.allocationSize = stride * buffer_count;
+        bool pass = m_device->phy().set_memory_type(mem_reqs.memoryTypeBits, &alloc_info, 0);
+        VkDeviceMemory mem = VK_NULL_HANDLE;
+        if (pass) {
+            pass = (vkAllocateMemory(m_device->device(), &alloc_info, NULL, &mem) == VK_SUCCESS);
+        }
+        if (pass) {
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < buffer_count; i++) {
+                ASSERT_VK_SUCCESS(vkBindBufferMemory(m_device->device(), buffers[i], mem, stride * i));
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            const double bind_seconds = elapsed.count() / buffer_count;
+            printf("             %u buffers in one allocation: %.0f binds/sec\n", buffer_count, 1 / bind_seconds);
+            if (!first_count) {
+                first_count = buffer_count;
+                first_bind_seconds = bind_seconds;
+            } else {
+                // A bind that scanned every bound range would cost about buffer_count / first_count times as much here;
+                //  O(log N) stays within a small factor
+                EXPECT_LT(bind_seconds, first_bind_seconds * 10) << buffer_count << " bindings against " << first_count;
+            }
+        } else {
+            printf("             Unable to allocate memory for %u buffers, skipping.\n", buffer_count);
+        }
+
+        for (auto buffer : buffers) {
+            vkDestroyBuffer(m_device->device(), buffer, NULL);
+        }
+        if (mem != VK_NULL_HANDLE) {
+            vkFreeMemory(m_device->device(), mem, NULL);
+        }
+    }
+
+    m_errorMonitor->VerifyNotFound();
+}
+
+TEST_F(VkPositiveLayerTest, RerecordCommandBufferAfterPoolReset) {
+    TEST_DESCRIPTION(
+        "Record, submit and reset the same command buffer many times with event, query and buffer state so that its recorded "
+        "state is repeatedly released and rebuilt.");
+
+    m_errorMonitor->ExpectSuccess();
+
+    ASSERT_NO_FATAL_FAILURE(Init());
+
+    VkEvent event;
+    VkEventCreateInfo event_create_info{};
+    event_create_info.sType = VK_STRUCTURE_TYPE_EVENT_CREATE_INFO;
+    vkCreateEvent(m_device->device(), &event_create_info, nullptr, &event);
+
+    VkQueryPool query_pool;
+    VkQueryPoolCreateInfo query_pool_create_info{};
+    query_pool_create_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    query_pool_create_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    query_pool_create_info.queryCount = 1;
+    vkCreateQueryPool(m_device->device(), &query_pool_create_info, nullptr, &query_pool);
+
+    VkMemoryPropertyFlags reqs = 0;
+    vk_testing::Buffer buffer;
+    buffer.init_as_dst(*m_device, 256, reqs);
+
+    for (uint32_t frame = 0; frame < 64; frame++) {
+        m_commandBuffer->BeginCommandBuffer();
+        vkCmdFillBuffer(m_commandBuffer->handle(), buffer.handle(), 0, VK_WHOLE_SIZE, frame);
+        vkCmdSetEvent(m_commandBuffer->handle(), event, VK_PIPELINE_STAGE_TRANSFER_BIT);
+        vkCmdWaitEvents(m_commandBuffer->handle(), 1, &event, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                        nullptr, 0, nullptr, 0, nullptr);
+        vkCmdResetEvent(m_commandBuffer->handle(), event, VK_PIPELINE_STAGE_TRANSFER_BIT);
+        vkCmdResetQueryPool(m_commandBuffer->handle(), query_pool, 0, 1);
+        vkCmdWriteTimestamp(m_commandBuffer->handle(), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, query_pool, 0);
+        m_commandBuffer->EndCommandBuffer();
+
+        VkSubmitInfo submit_info{};
+        submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit_info.commandBufferCount = 1;
+        submit_info.pCommandBuffers = &m_commandBuffer->handle();
+        vkQueueSubmit(m_device->m_queue, 1, &submit_info, VK_NULL_HANDLE);
+        vkQueueWaitIdle(m_device->m_queue);
+        vkResetCommandPool(m_device->device(), m_commandPool->handle(), 0);
+    }
+
+    vkDestroyQueryPool(m_device->device(), query_pool, nullptr);
+    vkDestroyEvent(m_device->device(), event, nullptr);
+    m_errorMonitor->VerifyNotFound();
+}
+
 #if 0  // A few devices have issues with this test so disabling for now
 TEST_F(VkPositiveLayerTest, LongFenceChain)
 {